@@ -0,0 +1,226 @@
+#pragma once
+// Timing harness shared by the benchmarks, machine readable results and regression checks against an earlier run
+//
+// Every benchmark takes:
+//   --count <N>          Elements per run, what an element is depends on the benchmark
+//   --iterations <N>     Runs per result, the median is reported
+//   --json <file>        Writes the results as JSON
+//   --baseline <file>    Compares with the JSON of an earlier run, the exit code is the number of regressions
+//   --tolerance <ratio>  How much slower than the baseline a median may be, default 0.15 (15%)
+//
+// Results are matched by name, so baselines only compare runs made with the same options.
+
+#include <fileio/FileIO.hpp>
+#include <fileio/MemoryStream.hpp>
+#include <fileio/Serialization.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace KS
+{
+
+// Options every benchmark has, benchmarks with more derive from it
+struct BenchmarkOptions
+{
+    uint32_t count = 100000;
+    uint32_t iterations = 10;
+};
+
+// Keeps results alive so the compiler cannot drop the measured loops
+inline volatile uint64_t benchmark_sink = 0;
+
+class BenchmarkReport
+{
+public:
+    enum class TimeUnit
+    {
+        MILLISECONDS,
+        MICROSECONDS
+    };
+
+    // What is printed next to the median of a run
+    struct RunInfo
+    {
+        const char* element = nullptr; // Time per element of BenchmarkOptions::count, as "ns/<element>"
+        uint64_t bytes = 0; // Throughput of this many bytes per run, in MB/s
+    };
+
+    struct Result
+    {
+        std::string name {};
+        std::string unit {};
+        double median = 0.0;
+        double min = 0.0;
+
+        template <typename A>
+        void serialize(A& ar)
+        {
+            ar(cereal::make_nvp("Name", name), cereal::make_nvp("Unit", unit), cereal::make_nvp("Median", median),
+                cereal::make_nvp("Min", min));
+        }
+    };
+
+    BenchmarkReport(TimeUnit unit = TimeUnit::MILLISECONDS)
+        : unit(unit)
+    {
+    }
+
+    // For benchmarks that parse their own arguments, so they can skip these
+    static bool TakesValue(const std::string& arg)
+    {
+        return arg == "--count" || arg == "--iterations" || arg == "--json" || arg == "--baseline" || arg == "--tolerance";
+    }
+
+    void ParseArguments(int argc, char** argv, BenchmarkOptions& options)
+    {
+        benchmark = std::filesystem::path(argv[0]).stem().string();
+
+        for (int i = 1; i + 1 < argc; i++)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "--count")
+                options.count = std::max(1ul, std::stoul(argv[++i]));
+            else if (arg == "--iterations")
+                options.iterations = std::max(1ul, std::stoul(argv[++i]));
+            else if (arg == "--json")
+                json_path = argv[++i];
+            else if (arg == "--baseline")
+                baseline_path = argv[++i];
+            else if (arg == "--tolerance")
+                tolerance = std::stod(argv[++i]);
+        }
+    }
+
+    // Times work for options.iterations runs, prints and records the median. Setup runs before every run, untimed.
+    // Returns what the last run of work returned
+    uint64_t Run(const std::string& name, const BenchmarkOptions& options, const RunInfo& info,
+        const std::function<uint64_t()>& work, const std::function<void()>& setup = {})
+    {
+        std::vector<double> times {};
+        uint64_t value = 0;
+
+        for (uint32_t i = 0; i < options.iterations; i++)
+        {
+            if (setup)
+                setup();
+
+            auto start = std::chrono::steady_clock::now();
+            value = work();
+            auto end = std::chrono::steady_clock::now();
+
+            benchmark_sink = benchmark_sink + value;
+
+            if (unit == TimeUnit::MILLISECONDS)
+                times.emplace_back(std::chrono::duration<double, std::milli>(end - start).count());
+            else
+                times.emplace_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+
+        std::sort(times.begin(), times.end());
+        const char* unit_name = unit == TimeUnit::MILLISECONDS ? "ms" : "us";
+        results.emplace_back(Result { name, unit_name, times[times.size() / 2], times.front() });
+
+        double median = times[times.size() / 2];
+        double median_ns = median * (unit == TimeUnit::MILLISECONDS ? 1000000.0 : 1000.0);
+
+        std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(3) << std::setw(10)
+                  << median << " " << unit_name;
+
+        if (info.element)
+            std::cout << "  " << std::setw(8) << std::setprecision(2) << median_ns / options.count << " ns/" << info.element;
+
+        if (info.bytes)
+        {
+            double megabytes = static_cast<double>(info.bytes) / (1024.0 * 1024.0);
+            std::cout << "  " << std::setw(10) << std::setprecision(1) << megabytes / (median_ns / 1e9) << " MB/s";
+        }
+
+        std::cout << "  (min " << std::setprecision(3) << times.front() << " " << unit_name << ")\n";
+        return value;
+    }
+
+    // Writes and compares as requested, returns the exit code for main
+    int Finish() const
+    {
+        int failures = 0;
+
+        if (!json_path.empty() && !FileIO::WriteFileAtomic(json_path, [&](std::ostream& out)
+            {
+                JSONSaver json { out };
+                json(cereal::make_nvp("Benchmark", benchmark), cereal::make_nvp("Results", results));
+            }))
+        {
+            std::cerr << "Could not write " << json_path << "\n";
+            failures++;
+        }
+
+        if (!baseline_path.empty())
+            failures += CompareBaseline();
+
+        return failures;
+    }
+
+private:
+    int CompareBaseline() const
+    {
+        std::vector<Result> baseline {};
+
+        auto file = FileIO::ReadFile(baseline_path);
+        if (!file)
+        {
+            std::cerr << "Could not read baseline " << baseline_path << "\n";
+            return 1;
+        }
+
+        try
+        {
+            MemoryReadStream stream { file->GetBytes() };
+            JSONLoader json { stream };
+            std::string name {};
+            json(cereal::make_nvp("Benchmark", name), cereal::make_nvp("Results", baseline));
+        }
+        catch (const cereal::Exception& e)
+        {
+            std::cerr << "Baseline " << baseline_path << " is not a benchmark result: " << e.what() << "\n";
+            return 1;
+        }
+
+        int regressions = 0;
+        for (const Result& result : results)
+        {
+            for (const Result& before : baseline)
+            {
+                if (before.name != result.name || before.unit != result.unit || before.median <= 0.0)
+                    continue;
+
+                double ratio = result.median / before.median;
+                if (ratio > 1.0 + tolerance)
+                {
+                    std::cerr << "REGRESSION " << benchmark << " " << result.name << ": " << result.median << " " << result.unit
+                              << ", baseline " << before.median << " " << result.unit << " (" << (ratio - 1.0) * 100.0 << "% slower)\n";
+                    regressions++;
+                }
+            }
+        }
+
+        return regressions;
+    }
+
+    TimeUnit unit {};
+    std::string benchmark {};
+    std::string json_path {};
+    std::string baseline_path {};
+    double tolerance = 0.15;
+    std::vector<Result> results {};
+};
+
+}
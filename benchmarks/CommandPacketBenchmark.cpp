@@ -0,0 +1,110 @@
+// Records draws as command packets the way ModelRenderer does, on one thread and on all of them,
+// and submits them through the null translator: recording, sorting and state filtering without a GPU.
+//
+// Usage: KSBenchCommandPackets [--count N] [--iterations N] [--meshes N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <renderer/CommandPackets.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Options : KS::BenchmarkOptions
+{
+    uint32_t meshes = 200;
+};
+
+KS::BenchmarkReport report {};
+
+// The packets only carry addresses, the null translator never follows them
+template <typename T>
+T* Fake(uint32_t id)
+{
+    return reinterpret_cast<T*>(uintptr_t(0x10000) + uintptr_t(id) * 64);
+}
+
+void RecordDraws(KS::CommandStream& stream, const Options& options, uint32_t begin, uint32_t end)
+{
+    KS::ShaderInputDesc input {};
+
+    for (uint32_t draw = begin; draw < end; draw++)
+    {
+        uint32_t mesh = (draw * 2654435761u) % options.meshes;
+
+        stream.Begin(KS::MakeSortKey(1, mesh, draw));
+        stream.BindInput(Fake<KS::ShaderInput>(1), input, draw);
+        for (uint32_t slot = 0; slot < 4; slot++)
+            stream.BindVertexBuffer(Fake<KS::StorageBuffer>(1000 + mesh * 8 + slot), slot);
+        stream.BindIndexBuffer(Fake<KS::StorageBuffer>(1000 + mesh * 8 + 4));
+        for (uint32_t texture = 0; texture < 5; texture++)
+            stream.BindInput(Fake<KS::ShaderInput>(100000 + mesh * 8 + texture), input);
+        stream.DrawIndexed(300);
+    }
+}
+
+uint64_t Frame(KS::CommandRecorder& recorder, const Options& options, uint32_t jobs, KS::CommandRecorder::SubmitStats* stats = nullptr)
+{
+    auto& setup = recorder.AddStream();
+    setup.Begin(KS::MakeSortKey(0, 0, 0));
+    setup.BindPipeline(Fake<KS::Shader>(1));
+
+    uint32_t per_job = (options.count + jobs - 1) / jobs;
+    recorder.Record(jobs, [&](uint32_t job, KS::CommandStream& stream)
+    {
+        RecordDraws(stream, options, job * per_job, std::min(options.count, (job + 1) * per_job));
+    });
+
+    KS::NullCommandTranslator translator {};
+    auto result = recorder.Submit(translator);
+    if (stats) *stats = result;
+    return translator.GetHash();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options {};
+    report.ParseArguments(argc, argv, options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--meshes" && i + 1 < argc)
+            options.meshes = std::max(1ul, std::stoul(argv[++i]));
+    }
+
+    KS::CommandRecorder serial { 0 };
+    KS::CommandRecorder parallel {};
+
+    KS::CommandRecorder::SubmitStats stats {};
+    Frame(serial, options, 1, &stats);
+    std::cout << options.count << " draws of " << options.meshes << " meshes, " << stats.packets << " packets submitted, "
+              << stats.skipped << " redundant binds dropped, " << parallel.GetWorkerCount() + 1 << " threads\n";
+
+    report.Run("record only, 1 thread", options, { "draw" }, [&]()
+    {
+        auto& stream = serial.AddStream();
+        RecordDraws(stream, options, 0, options.count);
+        uint64_t packets = stream.GetPacketCount();
+        stream.Clear();
+        KS::NullCommandTranslator translator {};
+        serial.Submit(translator);
+        return packets;
+    });
+
+    report.Run("record + submit, 1 thread", options, { "draw" }, [&]() { return Frame(serial, options, 1); });
+    report.Run("record + submit, all threads", options, { "draw" },
+        [&]() { return Frame(parallel, options, parallel.GetWorkerCount() + 1); });
+
+    return report.Finish();
+}
@@ -0,0 +1,192 @@
+// Compares ways of reading a whole asset tree into memory
+//
+// Usage: KSBenchFileRead [directory] [--iterations N] [--queue-depth N] [--cold]
+//   directory       Defaults to assets/models
+//   --cold          Evicts the files from the page cache before every run (Linux only)
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <fileio/AsyncFileReader.hpp>
+#include <fileio/FileIO.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+struct Options : KS::BenchmarkOptions
+{
+    std::filesystem::path directory = "assets/models";
+    uint32_t queue_depth = 64;
+    bool cold = false;
+};
+
+void EvictFromCache(const std::vector<std::filesystem::path>& files)
+{
+#if defined(__linux__)
+    for (const auto& file : files)
+    {
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+#else
+    (void)files;
+#endif
+}
+
+// Touches one byte per page, so lazily mapped data is actually read
+uint64_t Checksum(const std::byte* data, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += 4096)
+        sum += static_cast<uint8_t>(data[i]);
+    return sum;
+}
+
+uint64_t ReadStreams(const std::vector<std::filesystem::path>& files)
+{
+    uint64_t sum = 0;
+    for (const auto& file : files)
+    {
+        if (auto stream = KS::FileIO::OpenReadStream(file, std::ios::binary))
+        {
+            auto dump = KS::FileIO::DumpFullStream(stream.value());
+            sum += Checksum(reinterpret_cast<const std::byte*>(dump.data()), dump.size());
+        }
+    }
+    return sum;
+}
+
+uint64_t ReadMapped(const std::vector<std::filesystem::path>& files)
+{
+    uint64_t sum = 0;
+    for (const auto& file : files)
+    {
+        if (auto mapping = KS::FileIO::MapReadOnly(file))
+            sum += Checksum(mapping->GetData(), mapping->GetSize());
+    }
+    return sum;
+}
+
+uint64_t ReadAsync(KS::AsyncFileReader& reader, const std::vector<std::filesystem::path>& files)
+{
+    std::vector<KS::AsyncFileReader::ReadRequest> batch(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        batch[i].file = files[i];
+        batch[i].user_data = i;
+    }
+
+    reader.Submit(batch);
+    reader.WaitIdle();
+
+    std::vector<KS::AsyncFileReader::ReadResult> results {};
+    reader.PollCompletions(results);
+
+    uint64_t sum = 0;
+    for (const auto& result : results)
+        sum += Checksum(result.buffer.data(), result.buffer.size());
+    return sum;
+}
+
+KS::BenchmarkReport report {};
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options {};
+    report.ParseArguments(argc, argv, options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--queue-depth" && i + 1 < argc)
+            options.queue_depth = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--cold")
+            options.cold = true;
+        else if (KS::BenchmarkReport::TakesValue(arg) && i + 1 < argc)
+            i++;
+        else
+            options.directory = arg;
+    }
+
+    std::vector<std::filesystem::path> files {};
+    uint64_t total_bytes = 0;
+
+    if (std::filesystem::is_directory(options.directory))
+    {
+        for (const auto& it : std::filesystem::recursive_directory_iterator(options.directory))
+        {
+            if (it.is_regular_file())
+            {
+                files.emplace_back(it.path());
+                total_bytes += it.file_size();
+            }
+        }
+    }
+
+    if (files.empty())
+    {
+        std::cerr << "No files found in " << options.directory.string() << "\n";
+        return 1;
+    }
+
+    std::cout << files.size() << " files, " << total_bytes << " bytes, " << options.iterations << " iterations"
+              << (options.cold ? ", cold cache" : ", warm cache") << "\n";
+
+    KS::AsyncFileReaderSettings uring_settings {};
+    uring_settings.queue_depth = options.queue_depth;
+    KS::AsyncFileReader uring_reader { uring_settings };
+
+    KS::AsyncFileReaderSettings pool_settings {};
+    pool_settings.queue_depth = options.queue_depth;
+    pool_settings.allow_io_uring = false;
+    KS::AsyncFileReader pool_reader { pool_settings };
+
+    // Every way of reading has to see the same bytes
+    std::vector<uint64_t> checksums {};
+    auto Read = [&](const std::string& name, const std::function<uint64_t()>& read)
+    {
+        auto evict = [&]()
+        {
+            if (options.cold)
+                EvictFromCache(files);
+        };
+
+        checksums.emplace_back(report.Run(name, options, { nullptr, total_bytes }, read, evict));
+    };
+
+    Read("OpenReadStream+Dump", [&]() { return ReadStreams(files); });
+    Read("MapReadOnly", [&]() { return ReadMapped(files); });
+
+    if (uring_reader.GetBackend() == KS::AsyncFileReader::Backend::IO_URING)
+        Read("AsyncFileReader (io_uring)", [&]() { return ReadAsync(uring_reader, files); });
+    else
+        std::cout << "io_uring not available, skipped\n";
+
+    Read("AsyncFileReader (threads)", [&]() { return ReadAsync(pool_reader, files); });
+
+    if (std::adjacent_find(checksums.begin(), checksums.end(), std::not_equal_to<>()) != checksums.end())
+    {
+        std::cerr << "Readers returned different data\n";
+        return report.Finish() + 1;
+    }
+
+    return report.Finish();
+}
@@ -0,0 +1,99 @@
+// Throughput of the bounding box math that culling and spatial index refits run for every object:
+// moving local boxes into world space, one at a time and in batches per SIMD level, and testing them against a camera frustum
+//
+// Usage: KSBenchGeometry [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <math/Geometry.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+
+KS::BenchmarkReport report {};
+
+// Mesh bounds around their origin, each with a rotated, scaled and placed instance transform
+void MakeObjects(uint32_t count, std::mt19937& random, std::vector<KS::BoundingBox>& boxes, std::vector<glm::mat4>& transforms)
+{
+    std::uniform_real_distribution<float> ground { -500.0f, 500.0f };
+    std::uniform_real_distribution<float> size { 0.5f, 5.0f };
+    std::uniform_real_distribution<float> angle { 0.0f, glm::two_pi<float>() };
+
+    boxes.reserve(count);
+    transforms.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        boxes.emplace_back(glm::vec3(0.0f, size(random), 0.0f), glm::vec3(size(random), size(random), size(random)));
+
+        auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(ground(random), 0.0f, ground(random)));
+        transform = glm::rotate(transform, angle(random), glm::normalize(glm::vec3(size(random), size(random), size(random))));
+        transforms.emplace_back(glm::scale(transform, glm::vec3(size(random) * 0.5f)));
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    options.iterations = 20;
+    report.ParseArguments(argc, argv, options);
+
+    std::mt19937 random { 1234 };
+    std::vector<KS::BoundingBox> boxes {};
+    std::vector<glm::mat4> transforms {};
+    MakeObjects(options.count, random, boxes, transforms);
+
+    std::vector<KS::BoundingBox> world_boxes(boxes.size());
+
+    // Sees roughly a fifth of the level
+    auto frustum = KS::Camera::Perspective(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 10.0f, 100.0f), 16.0f / 9.0f,
+        glm::radians(70.0f), 0.1f, 500.0f).GetFrustum();
+
+    report.Run("ApplyTransform", options, { "box" }, [&]()
+    {
+        for (size_t i = 0; i < boxes.size(); i++)
+            world_boxes[i] = boxes[i].ApplyTransform(transforms[i]);
+        return static_cast<uint64_t>(world_boxes.back().GetExtents().x);
+    });
+
+    KS::BoundingBoxArray local {}, world {};
+    local.Resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++)
+        local.Set(i, boxes[i]);
+
+    for (auto [name, level] : { std::pair { "TransformBoundingBoxes scalar", KS::SimdLevel::SCALAR },
+             std::pair { "TransformBoundingBoxes SSE", KS::SimdLevel::SSE }, std::pair { "TransformBoundingBoxes AVX", KS::SimdLevel::AVX } })
+    {
+        report.Run(name, options, { "box" }, [&, level = level]()
+        {
+            KS::TransformBoundingBoxes(local, transforms, world, level);
+            return static_cast<uint64_t>(world.extent_x.back());
+        });
+    }
+
+    report.Run("FrustumTest", options, { "box" }, [&]()
+    {
+        uint64_t visible = 0;
+        for (const auto& box : world_boxes)
+            visible += box.FrustumTest(frustum) ? 1 : 0;
+        return visible;
+    });
+
+    report.Run("ApplyTransform+FrustumTest", options, { "box" }, [&]()
+    {
+        uint64_t visible = 0;
+        for (size_t i = 0; i < boxes.size(); i++)
+            visible += boxes[i].ApplyTransform(transforms[i]).FrustumTest(frustum) ? 1 : 0;
+        return visible;
+    });
+
+    return report.Finish();
+}
@@ -0,0 +1,134 @@
+// Compares FlatHashMap against std::unordered_map on the engine's lookup tables:
+// asset paths looked up with string views, and 64 bit handle keys
+//
+// Usage: KSBenchHashMap [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <containers/FlatHashMap.hpp>
+#include <containers/StringHash.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+KS::BenchmarkReport report {};
+
+// Paths shaped like the ones the scene caches are keyed on, sharing long prefixes
+std::vector<std::string> MakePaths(uint32_t count, uint32_t seed)
+{
+    const char* folders[] = { "models", "textures", "materials", "meshes" };
+    const char* extensions[] = { ".ksmodel", ".kstex", ".ksmat", ".ksmesh" };
+    std::mt19937 random { seed };
+
+    std::vector<std::string> paths {};
+    paths.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t type = random() % 4;
+        paths.emplace_back(std::string("assets/") + folders[type] + "/set_" + std::to_string(random() % 64) + "/asset_"
+                           + std::to_string(i) + "_" + std::to_string(seed) + extensions[type]);
+    }
+    return paths;
+}
+
+std::vector<uint64_t> MakeHandles(uint32_t count, uint32_t seed)
+{
+    std::mt19937_64 random { seed };
+    std::vector<uint64_t> handles(count);
+    for (auto& handle : handles)
+        handle = random();
+    return handles;
+}
+
+// The same workloads for every map type, queries come in as the type the engine passes around
+template <typename Map, typename Key, typename Query>
+void RunSuite(const std::string& label, const KS::BenchmarkOptions& options, const std::vector<Key>& keys,
+    const std::vector<Key>& missing)
+{
+    std::vector<Query> hits(keys.begin(), keys.end());
+    std::vector<Query> misses(missing.begin(), missing.end());
+    std::shuffle(hits.begin(), hits.end(), std::mt19937 { 1234 });
+
+    report.Run("insert      " + label, options, { "element" }, [&]()
+    {
+        Map map {};
+        for (uint32_t i = 0; i < keys.size(); i++)
+            map.emplace(keys[i], i);
+        return map.size();
+    });
+
+    Map map {};
+    for (uint32_t i = 0; i < keys.size(); i++)
+        map.emplace(keys[i], i);
+
+    report.Run("hit         " + label, options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (const auto& query : hits)
+            sum += map.find(query)->second;
+        return sum;
+    });
+
+    report.Run("miss        " + label, options, { "element" }, [&]()
+    {
+        uint64_t found = 0;
+        for (const auto& query : misses)
+            found += map.find(query) != map.end();
+        return found;
+    });
+
+    report.Run("iterate     " + label, options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (const auto& [key, value] : map)
+            sum += value;
+        return sum;
+    });
+
+    // Assets being unloaded and others streamed in
+    report.Run("erase+fill  " + label, options, { "element" }, [&]()
+    {
+        for (uint32_t i = 0; i < keys.size(); i += 2)
+            map.erase(map.find(hits[i]));
+        for (uint32_t i = 0; i < keys.size(); i += 2)
+            map.emplace(Key(hits[i]), i);
+        return map.size();
+    });
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    report.ParseArguments(argc, argv, options);
+
+    std::cout << options.count << " elements, " << options.iterations << " iterations\n";
+
+    auto paths = MakePaths(options.count, 1);
+    auto missing_paths = MakePaths(options.count, 2);
+
+    // Both string maps use the transparent hash, so neither builds a std::string per query
+    RunSuite<KS::StringMap<uint32_t>, std::string, std::string_view>("FlatHashMap<string>", options, paths, missing_paths);
+    RunSuite<std::unordered_map<std::string, uint32_t, KS::StringHash, std::equal_to<>>, std::string, std::string_view>(
+        "unordered_map<string>", options, paths, missing_paths);
+
+    auto handles = MakeHandles(options.count, 1);
+    auto missing_handles = MakeHandles(options.count, 2);
+
+    RunSuite<KS::FlatHashMap<uint64_t, uint32_t>, uint64_t, uint64_t>("FlatHashMap<uint64>", options, handles, missing_handles);
+    RunSuite<std::unordered_map<uint64_t, uint32_t>, uint64_t, uint64_t>("unordered_map<uint64>", options, handles,
+                                                                         missing_handles);
+
+    return report.Finish();
+}
@@ -0,0 +1,169 @@
+// Runs the CPU side of a frame on the null device: snapshot extraction, Scene::Tick uploads and the model renderer's
+// draw recording and submission. Counts what the device would have been asked to do per frame.
+//
+// Usage: KSBenchHeadlessFrame [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <components/ComponentWorldTransform.hpp>
+#include <device/Device.hpp>
+#include <fileio/FileIO.hpp>
+#include <fileio/Serialization.hpp>
+#include <renderer/CommandPackets.hpp>
+#include <renderer/ModelRenderer.hpp>
+#include <renderer/Shader.hpp>
+#include <resources/Image.hpp>
+#include <resources/Mesh.hpp>
+#include <resources/Model.hpp>
+#include <resources/Texture.hpp>
+#include <scene/Scene.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+
+KS::BenchmarkReport report { KS::BenchmarkReport::TimeUnit::MICROSECONDS };
+
+// A cube's worth of vertices with a small texture, written where the scene loads it from
+KS::ResourceHandle<KS::Model> WriteModel(const std::filesystem::path& directory)
+{
+    std::filesystem::create_directories(directory);
+
+    KS::ResourceHandle<KS::Mesh> mesh_handle { (directory / "mesh.bin").string() };
+    KS::ResourceHandle<KS::Texture> texture_handle { (directory / "texture.png").string() };
+    KS::ResourceHandle<KS::Model> model_handle { (directory / "model.json").string() };
+
+    std::vector<uint32_t> indices(36);
+    std::vector<glm::vec3> vectors(24, glm::vec3(1.0f));
+    std::vector<glm::vec2> uvs(24, glm::vec2(0.5f));
+    for (uint32_t i = 0; i < indices.size(); i++) indices[i] = i % 24;
+
+    KS::MeshData mesh {};
+    mesh.AddAttribute(KS::VertexAttribute::INDICES, KS::ByteBuffer(indices.data(), indices.size()));
+    mesh.AddAttribute(KS::VertexAttribute::POSITIONS, KS::ByteBuffer(vectors.data(), vectors.size()));
+    mesh.AddAttribute(KS::VertexAttribute::NORMALS, KS::ByteBuffer(vectors.data(), vectors.size()));
+    mesh.AddAttribute(KS::VertexAttribute::TEXTURE_UVS, KS::ByteBuffer(uvs.data(), uvs.size()));
+
+    std::vector<uint8_t> pixels(64 * 64 * 4, 255);
+    auto png = KS::SaveImageToPNG(KS::Image(KS::ByteBuffer(pixels.data(), pixels.size()), 64, 64));
+
+    KS::Material material {};
+    material.AddParameter(KS::MaterialConstants::BASE_TEXTURE, texture_handle);
+
+    KS::Model model {};
+    model.nodes.emplace_back(KS::Model::Node { glm::mat4(1.0f), { { 0, 0 } } });
+    model.meshes.emplace_back(mesh_handle);
+    model.materials.emplace_back(std::make_shared<const KS::Material>(material));
+
+    KS::FileIO::WriteFileAtomic(mesh_handle.path, [&](std::ostream& out) { KS::BinarySaver { out }(mesh); });
+    KS::FileIO::WriteFileAtomic(texture_handle.path, [&](std::ostream& out)
+        { out.write(png->GetView<char>().begin(), png->GetView<char>().count()); });
+    KS::FileIO::WriteFileAtomic(model_handle.path, [&](std::ostream& out) { KS::JSONSaver { out }(model); });
+
+    return model_handle;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    options.count = KS::Scene::MAX_DRAWS;
+    options.iterations = 100;
+    report.ParseArguments(argc, argv, options);
+    options.count = std::min<uint32_t>(options.count, KS::Scene::MAX_DRAWS);
+
+    auto directory = std::filesystem::temp_directory_path() / "KSBenchHeadlessFrame";
+    auto model = WriteModel(directory);
+
+    KS::Device device { KS::DeviceInitParams {} };
+    entt::registry world {};
+    KS::Scene scene { device, world };
+    KS::CommandRecorder recorder { 0 };
+
+    // The main pass's vertex inputs, the shader input descs only matter to a real pipeline
+    KS::ModelRenderer::DrawInputs draw_inputs {};
+    draw_inputs.meshInputFlags = KS::Shader::HAS_POSITIONS | KS::Shader::HAS_NORMALS | KS::Shader::HAS_UVS | KS::Shader::HAS_TANGENTS;
+
+    std::vector<entt::entity> entities {};
+    for (uint32_t i = 0; i < options.count; i++)
+    {
+        auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(float(i % 16) * 3.0f, 0.0f, float(i / 16) * 3.0f));
+        auto spawned = scene.SpawnModel(model, transform, "Cube");
+        entities.insert(entities.end(), spawned.begin(), spawned.end());
+    }
+
+    KS::RenderSnapshot snapshot {};
+    scene.ExtractSnapshot(snapshot, 1.0f);
+    scene.Tick(device, snapshot);
+
+    // One frame's worth of counters, after everything was loaded
+    device.GetCounters().Reset();
+    device.NewFrame();
+    scene.ExtractSnapshot(snapshot, 0.5f);
+    scene.Tick(device, snapshot);
+    KS::ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+    KS::DeviceCommandTranslator translator { device };
+    recorder.Submit(translator);
+
+    const auto& counters = device.GetCounters();
+    std::cout << scene.GetModelCount() << " draws, per frame: " << counters.uploads << " uploads (" << counters.upload_bytes
+              << " bytes), " << counters.binds << " binds, " << counters.barriers << " barriers, " << counters.draws << " draws\n";
+
+    // A tenth of the entities moves every step, so interpolation has work to do
+    uint32_t step = 0;
+    auto Move = [&]()
+    {
+        step++;
+        for (size_t i = step % 10; i < entities.size(); i += 10)
+        {
+            auto& transform = world.get<KS::ComponentWorldTransform>(entities[i]);
+            transform.previous = transform.matrix;
+            transform.matrix[3].y = float(step % 7);
+        }
+    };
+
+    report.Run("extract snapshot", options, { "draw" }, [&]()
+    {
+        Move();
+        scene.ExtractSnapshot(snapshot, 0.5f);
+        return snapshot.draws.size();
+    });
+
+    report.Run("scene tick", options, { "draw" }, [&]()
+    {
+        device.NewFrame();
+        scene.Tick(device, snapshot);
+        return scene.GetModelCount();
+    });
+
+    report.Run("record + submit", options, { "draw" }, [&]()
+    {
+        KS::ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+        return recorder.Submit(translator).packets;
+    });
+
+    report.Run("whole frame", options, { "draw" }, [&]()
+    {
+        Move();
+        device.NewFrame();
+        scene.ExtractSnapshot(snapshot, 0.5f);
+        scene.Tick(device, snapshot);
+        KS::ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+        auto stats = recorder.Submit(translator);
+        device.EndFrame();
+        return stats.packets;
+    });
+
+    std::filesystem::remove_all(directory);
+    return report.Finish();
+}
@@ -0,0 +1,291 @@
+// Throughput of the queue primitives against a mutex protected std::deque
+//
+// Usage: KSBenchQueue [--count N] [--iterations N] [--threads N]
+//   --threads sets the producers and the consumers of the multi threaded runs (default 4 each)
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <containers/BlockingQueue.hpp>
+#include <containers/MPMCQueue.hpp>
+#include <containers/SPSCQueue.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Options : KS::BenchmarkOptions
+{
+    uint32_t threads = 4;
+};
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t BATCH = 32;
+
+KS::BenchmarkReport report {};
+
+// Baseline every subsystem would otherwise write
+class MutexQueue
+{
+public:
+    using value_type = uint64_t;
+
+    MutexQueue(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    bool TryPush(uint64_t item)
+    {
+        std::scoped_lock lock { mutex };
+        if (items.size() == capacity)
+            return false;
+        items.push_back(item);
+        return true;
+    }
+
+    bool TryPop(uint64_t& out)
+    {
+        std::scoped_lock lock { mutex };
+        if (items.empty())
+            return false;
+        out = items.front();
+        items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex {};
+    std::deque<uint64_t> items {};
+    size_t capacity {};
+};
+
+// Splits count items over producers and consumers that spin on TryPush / TryPop
+template <typename Queue>
+uint64_t RunThreads(Queue& queue, uint64_t count, uint32_t producers, uint32_t consumers)
+{
+    std::atomic<uint64_t> consumed { 0 };
+    std::atomic<uint64_t> sum { 0 };
+    std::vector<std::thread> threads {};
+
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p]()
+        {
+            for (uint64_t i = p; i < count; i += producers)
+            {
+                while (!queue.TryPush(i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    for (uint32_t c = 0; c < consumers; c++)
+    {
+        threads.emplace_back([&]()
+        {
+            uint64_t local = 0;
+            uint64_t item = 0;
+            while (consumed.load(std::memory_order_relaxed) < count)
+            {
+                if (queue.TryPop(item))
+                {
+                    local += item;
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                    std::this_thread::yield();
+            }
+            sum += local;
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return sum;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options {};
+    options.count = 1000000;
+    options.iterations = 5;
+    report.ParseArguments(argc, argv, options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc)
+            options.threads = std::max(1ul, std::stoul(argv[++i]));
+    }
+
+    std::cout << options.count << " items, " << options.iterations << " iterations, " << options.threads
+              << " producers and consumers, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    // Push and pop on one thread, the cost of the operations without contention
+    report.Run("1 thread     SPSCQueue", options, { "item" }, [&]()
+    {
+        KS::SPSCQueue<uint64_t> queue { CAPACITY };
+        uint64_t sum = 0, item = 0;
+        for (uint64_t i = 0; i < options.count; i++)
+        {
+            queue.TryPush(i);
+            queue.TryPop(item);
+            sum += item;
+        }
+        return sum;
+    });
+
+    report.Run("1 thread     MPMCQueue", options, { "item" }, [&]()
+    {
+        KS::MPMCQueue<uint64_t> queue { CAPACITY };
+        uint64_t sum = 0, item = 0;
+        for (uint64_t i = 0; i < options.count; i++)
+        {
+            queue.TryPush(i);
+            queue.TryPop(item);
+            sum += item;
+        }
+        return sum;
+    });
+
+    report.Run("1 thread     mutex + deque", options, { "item" }, [&]()
+    {
+        MutexQueue queue { CAPACITY };
+        uint64_t sum = 0, item = 0;
+        for (uint64_t i = 0; i < options.count; i++)
+        {
+            queue.TryPush(i);
+            queue.TryPop(item);
+            sum += item;
+        }
+        return sum;
+    });
+
+    report.Run("1p/1c        SPSCQueue", options, { "item" }, [&]()
+    {
+        KS::SPSCQueue<uint64_t> queue { CAPACITY };
+        return RunThreads(queue, options.count, 1, 1);
+    });
+
+    report.Run("1p/1c        SPSCQueue batched", options, { "item" }, [&]()
+    {
+        KS::SPSCQueue<uint64_t> queue { CAPACITY };
+
+        std::thread producer([&]()
+        {
+            uint64_t batch[BATCH] {};
+            for (uint64_t i = 0; i < options.count;)
+            {
+                size_t count = std::min<uint64_t>(BATCH, options.count - i);
+                for (size_t j = 0; j < count; j++)
+                    batch[j] = i + j;
+
+                size_t pushed = 0;
+                while (pushed < count)
+                {
+                    size_t now = queue.TryPushBatch(std::span(batch + pushed, count - pushed));
+                    if (now == 0)
+                        std::this_thread::yield();
+                    pushed += now;
+                }
+                i += count;
+            }
+        });
+
+        uint64_t sum = 0, popped = 0;
+        uint64_t batch[BATCH] {};
+        while (popped < options.count)
+        {
+            size_t count = queue.TryPopBatch(batch);
+            if (count == 0)
+                std::this_thread::yield();
+            for (size_t j = 0; j < count; j++)
+                sum += batch[j];
+            popped += count;
+        }
+
+        producer.join();
+        return sum;
+    });
+
+    report.Run("1p/1c        MPMCQueue", options, { "item" }, [&]()
+    {
+        KS::MPMCQueue<uint64_t> queue { CAPACITY };
+        return RunThreads(queue, options.count, 1, 1);
+    });
+
+    report.Run("1p/1c        mutex + deque", options, { "item" }, [&]()
+    {
+        MutexQueue queue { CAPACITY };
+        return RunThreads(queue, options.count, 1, 1);
+    });
+
+    std::string contended = std::to_string(options.threads) + "p/" + std::to_string(options.threads) + "c";
+    contended.resize(13, ' ');
+
+    report.Run(contended + "MPMCQueue", options, { "item" }, [&]()
+    {
+        KS::MPMCQueue<uint64_t> queue { CAPACITY };
+        return RunThreads(queue, options.count, options.threads, options.threads);
+    });
+
+    report.Run(contended + "mutex + deque", options, { "item" }, [&]()
+    {
+        MutexQueue queue { CAPACITY };
+        return RunThreads(queue, options.count, options.threads, options.threads);
+    });
+
+    // Blocking handoff, the way a worker pool waits for jobs
+    report.Run(contended + "BlockingQueue<MPMC>", options, { "item" }, [&]()
+    {
+        KS::BlockingQueue<KS::MPMCQueue<uint64_t>> queue { CAPACITY };
+        std::atomic<uint64_t> sum { 0 };
+        std::vector<std::thread> consumers {};
+
+        for (uint32_t c = 0; c < options.threads; c++)
+        {
+            consumers.emplace_back([&]()
+            {
+                uint64_t local = 0;
+                while (auto item = queue.Pop())
+                    local += *item;
+                sum += local;
+            });
+        }
+
+        std::vector<std::thread> producers {};
+        for (uint32_t p = 0; p < options.threads; p++)
+        {
+            producers.emplace_back([&, p]()
+            {
+                for (uint64_t i = p; i < options.count; i += options.threads)
+                    queue.Push(i);
+            });
+        }
+
+        for (auto& producer : producers)
+            producer.join();
+
+        queue.Close();
+        for (auto& consumer : consumers)
+            consumer.join();
+
+        return sum.load();
+    });
+
+    return report.Finish();
+}
@@ -0,0 +1,215 @@
+// Decodes the cooked assets the engine loads at runtime, with the files already in memory so only parsing is measured:
+// mesh binaries, textures through LoadImageFileFromMemory and model descriptions as JSON against the same models
+// as cereal binary. With assimp available, also imports the source models the way AssetReloader does.
+//
+// Usage: KSBenchResourceLoad [directory] [--iterations N]
+//   directory       Defaults to assets/models
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <fileio/FileIO.hpp>
+#include <fileio/MemoryStream.hpp>
+#include <fileio/Serialization.hpp>
+#include <resources/Image.hpp>
+#include <resources/Mesh.hpp>
+#include <resources/Model.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Options : KS::BenchmarkOptions
+{
+    std::filesystem::path directory = "assets/models";
+};
+
+KS::BenchmarkReport report {};
+
+struct LoadedFile
+{
+    std::filesystem::path path {};
+    std::vector<std::byte> bytes {};
+};
+
+std::vector<LoadedFile> ReadFiles(const std::filesystem::path& directory, const std::vector<std::string>& extensions)
+{
+    std::vector<LoadedFile> files {};
+
+    if (!std::filesystem::is_directory(directory))
+        return files;
+
+    for (const auto& it : std::filesystem::recursive_directory_iterator(directory))
+    {
+        auto extension = it.path().extension().string();
+        if (!it.is_regular_file() || std::find(extensions.begin(), extensions.end(), extension) == extensions.end())
+            continue;
+
+        if (auto data = KS::FileIO::ReadFile(it.path()))
+            files.emplace_back(LoadedFile { it.path(), { data->GetBytes().begin(), data->GetBytes().end() } });
+    }
+
+    // Directory order is not stable between runs
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+    return files;
+}
+
+uint64_t TotalBytes(const std::vector<LoadedFile>& files)
+{
+    uint64_t total = 0;
+    for (const auto& file : files)
+        total += file.bytes.size();
+    return total;
+}
+
+template <typename Loader, typename T>
+void Parse(std::span<const std::byte> bytes, T& value)
+{
+    KS::MemoryReadStream stream { bytes };
+    Loader archive { stream };
+    archive(value);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options {};
+    report.ParseArguments(argc, argv, options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (KS::BenchmarkReport::TakesValue(arg) && i + 1 < argc)
+            i++;
+        else
+            options.directory = arg;
+    }
+
+    auto meshes = ReadFiles(options.directory, { ".bin" });
+    auto images = ReadFiles(options.directory, { ".png", ".jpg", ".jpeg" });
+
+    // Cooked models sit next to their mesh and texture folders, other JSON files are skipped
+    std::vector<LoadedFile> model_json {};
+    std::vector<LoadedFile> model_binary {};
+    for (auto& file : ReadFiles(options.directory, { ".json" }))
+    {
+        KS::Model model {};
+        try
+        {
+            Parse<KS::JSONLoader>(file.bytes, model);
+        }
+        catch (const cereal::Exception&)
+        {
+            continue;
+        }
+
+        std::stringstream stream {};
+        {
+            KS::BinarySaver archive { stream };
+            archive(model);
+        }
+
+        auto binary = stream.str();
+        auto* begin = reinterpret_cast<const std::byte*>(binary.data());
+        model_binary.emplace_back(LoadedFile { file.path, { begin, begin + binary.size() } });
+        model_json.emplace_back(std::move(file));
+    }
+
+    if (meshes.empty() && images.empty() && model_json.empty())
+    {
+        std::cerr << "No assets found in " << options.directory.string() << "\n";
+        return 1;
+    }
+
+    std::cout << meshes.size() << " meshes, " << images.size() << " images, " << model_json.size() << " models, "
+              << options.iterations << " iterations\n";
+
+    report.Run("MeshData binary load", options, { nullptr, TotalBytes(meshes) }, [&]()
+    {
+        uint64_t attributes = 0;
+        for (const auto& file : meshes)
+        {
+            KS::MeshData mesh {};
+            Parse<KS::BinaryLoader>(file.bytes, mesh);
+            attributes += mesh.HasAttribute(KS::VertexAttribute::POSITIONS) ? 1 : 0;
+        }
+        return attributes;
+    });
+
+    report.Run("LoadImageFileFromMemory", options, { nullptr, TotalBytes(images) }, [&]()
+    {
+        uint64_t pixels = 0;
+        for (const auto& file : images)
+        {
+            if (auto image = KS::LoadImageFileFromMemory(file.bytes.data(), file.bytes.size()))
+                pixels += image->GetWidth() * image->GetHeight();
+        }
+        return pixels;
+    });
+
+    report.Run("Model parse JSON", options, { nullptr, TotalBytes(model_json) }, [&]()
+    {
+        uint64_t nodes = 0;
+        for (const auto& file : model_json)
+        {
+            KS::Model model {};
+            Parse<KS::JSONLoader>(file.bytes, model);
+            nodes += model.nodes.size();
+        }
+        return nodes;
+    });
+
+    report.Run("Model parse binary", options, { nullptr, TotalBytes(model_binary) }, [&]()
+    {
+        uint64_t nodes = 0;
+        for (const auto& file : model_binary)
+        {
+            KS::Model model {};
+            Parse<KS::BinaryLoader>(file.bytes, model);
+            nodes += model.nodes.size();
+        }
+        return nodes;
+    });
+
+#ifdef KS_HAS_ASSIMP
+    // Imports write their output next to the source, so the sources are copied out of the asset tree first
+    auto import_directory = std::filesystem::temp_directory_path() / "KSBenchResourceLoad";
+    std::filesystem::create_directories(import_directory);
+
+    std::vector<std::filesystem::path> sources {};
+    for (const auto& file : ReadFiles(options.directory, { ".glb", ".gltf", ".fbx", ".obj" }))
+    {
+        auto copy = import_directory / file.path.filename();
+        std::filesystem::copy_file(file.path, copy, std::filesystem::copy_options::overwrite_existing);
+        sources.emplace_back(copy);
+    }
+
+    uint64_t source_bytes = 0;
+    for (const auto& source : sources)
+        source_bytes += std::filesystem::file_size(source);
+
+    report.Run("ModelImporter::ImportFromFile", options, { nullptr, source_bytes }, [&]()
+    {
+        uint64_t imported = 0;
+        for (const auto& source : sources)
+            imported += KS::ModelImporter::ImportFromFile(source).has_value() ? 1 : 0;
+        return imported;
+    });
+
+    std::filesystem::remove_all(import_directory);
+#else
+    std::cout << "assimp not available, ModelImporter skipped\n";
+#endif
+
+    return report.Finish();
+}
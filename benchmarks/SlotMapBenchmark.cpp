@@ -0,0 +1,127 @@
+// Compares SlotMap against std::unordered_map for the access patterns of scene storage
+//
+// Usage: KSBenchSlotMap [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <containers/SlotMap.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+// Roughly the size of a draw entry, so iteration is not dominated by a tiny value type
+struct Payload
+{
+    float transform[16] {};
+    uint32_t index = 0;
+};
+
+KS::BenchmarkReport report {};
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    report.ParseArguments(argc, argv, options);
+
+    std::cout << options.count << " elements, " << options.iterations << " iterations\n";
+
+    using SlotMap = KS::SlotMap<Payload>;
+    using HashMap = std::unordered_map<uint64_t, Payload>;
+
+    // Lookups happen in random order, the way handles are resolved while recording a frame
+    std::vector<uint32_t> order(options.count);
+    for (uint32_t i = 0; i < options.count; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937 { 1234 });
+
+    report.Run("insert      SlotMap", options, { "element" }, [&]()
+    {
+        SlotMap map {};
+        for (uint32_t i = 0; i < options.count; i++)
+            map.Emplace(Payload { {}, i });
+        return map.Size();
+    });
+
+    report.Run("insert      unordered_map", options, { "element" }, [&]()
+    {
+        HashMap map {};
+        for (uint32_t i = 0; i < options.count; i++)
+            map[i].index = i;
+        return map.size();
+    });
+
+    SlotMap slot_map {};
+    HashMap hash_map {};
+    std::vector<SlotMap::Key> keys {};
+
+    for (uint32_t i = 0; i < options.count; i++)
+    {
+        keys.emplace_back(slot_map.Emplace());
+        slot_map.Get(keys.back())->index = i;
+        hash_map[i].index = i;
+    }
+
+    report.Run("lookup      SlotMap", options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (auto i : order)
+            sum += slot_map.Get(keys[i])->index;
+        return sum;
+    });
+
+    report.Run("lookup      unordered_map", options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (auto i : order)
+            sum += hash_map.find(i)->second.index;
+        return sum;
+    });
+
+    report.Run("iterate     SlotMap", options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (const auto& value : slot_map)
+            sum += value.index;
+        return sum;
+    });
+
+    report.Run("iterate     unordered_map", options, { "element" }, [&]()
+    {
+        uint64_t sum = 0;
+        for (const auto& [key, value] : hash_map)
+            sum += value.index;
+        return sum;
+    });
+
+    // Erase and refill half of the elements, which also exercises slot reuse
+    report.Run("erase+fill  SlotMap", options, { "element" }, [&]()
+    {
+        for (uint32_t i = 0; i < options.count / 2; i++)
+            slot_map.Erase(keys[order[i]]);
+        for (uint32_t i = 0; i < options.count / 2; i++)
+            keys[order[i]] = slot_map.Emplace();
+        return slot_map.Size();
+    });
+
+    report.Run("erase+fill  unordered_map", options, { "element" }, [&]()
+    {
+        for (uint32_t i = 0; i < options.count / 2; i++)
+            hash_map.erase(order[i]);
+        for (uint32_t i = 0; i < options.count / 2; i++)
+            hash_map[order[i]].index = order[i];
+        return hash_map.size();
+    });
+
+    return report.Finish();
+}
@@ -0,0 +1,118 @@
+// Compares culling through DynamicAABBTree against testing every box, with a camera that sees a small part
+// of a large scene. Also measures updating moving objects, incremental optimization and full rebuilds.
+//
+// Usage: KSBenchSpatialIndex [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <math/DynamicAABBTree.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+KS::BenchmarkReport report {};
+
+// Props spread over a large flat level, like the instances of an open scene
+std::vector<KS::BoundingBox> MakeBoxes(uint32_t count, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> ground { -2000.0f, 2000.0f };
+    std::uniform_real_distribution<float> height { 0.0f, 50.0f };
+    std::uniform_real_distribution<float> size { 0.5f, 5.0f };
+
+    std::vector<KS::BoundingBox> boxes {};
+    boxes.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+        boxes.emplace_back(glm::vec3(ground(random), height(random), ground(random)), glm::vec3(size(random), size(random), size(random)));
+    return boxes;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    report.ParseArguments(argc, argv, options);
+
+    std::mt19937 random { 1234 };
+    auto boxes = MakeBoxes(options.count, random);
+
+    KS::DynamicAABBTree tree {};
+    std::vector<KS::DynamicAABBTree::ProxyID> proxies {};
+    proxies.reserve(boxes.size());
+    for (uint32_t i = 0; i < boxes.size(); i++)
+        proxies.emplace_back(tree.Insert(boxes[i], i));
+
+    auto frustum = KS::Camera::Perspective(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 10.0f, 100.0f), 16.0f / 9.0f,
+        glm::radians(70.0f), 0.1f, 300.0f).GetFrustum();
+
+    std::vector<uint32_t> visible {};
+    tree.QueryFrustum(frustum, visible);
+    std::cout << options.count << " objects, " << visible.size() << " visible, " << options.iterations << " iterations\n";
+
+    report.Run("cull every box", options, { "object" }, [&]()
+    {
+        visible.clear();
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            if (boxes[i].FrustumTest(frustum))
+                visible.emplace_back(i);
+        }
+        return visible.size();
+    });
+
+    report.Run("cull tree", options, { "object" }, [&]()
+    {
+        visible.clear();
+        tree.QueryFrustum(frustum, visible);
+        return visible.size();
+    });
+
+    report.Run("ray casts (1000)", options, { "object" }, [&]()
+    {
+        uint64_t hits = 0;
+        for (int i = 0; i < 1000; i++)
+        {
+            float angle = i * 0.00628f;
+            hits += tree.RayCast(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(std::cos(angle), 0.0f, std::sin(angle))).has_value();
+        }
+        return hits;
+    });
+
+    // A tenth of the scene moves a little every frame, most stays inside its fat bounds
+    std::uniform_real_distribution<float> step { -0.05f, 0.05f };
+    report.Run("update moving tenth", options, { "object" }, [&]()
+    {
+        uint64_t moved = 0;
+        for (uint32_t i = 0; i < boxes.size(); i += 10)
+        {
+            glm::vec3 offset { step(random), 0.0f, step(random) };
+            boxes[i] = KS::BoundingBox(boxes[i].GetCenter() + offset, boxes[i].GetExtents());
+            moved += tree.Update(proxies[i], boxes[i], offset);
+        }
+        return moved;
+    });
+
+    report.Run("optimize 1000 leaves", options, { "object" }, [&]()
+    {
+        tree.Optimize(1000);
+        return tree.GetHeight();
+    });
+
+    float cost = tree.GetCost();
+    report.Run("rebuild", options, { "object" }, [&]()
+    {
+        tree.Rebuild();
+        return tree.GetHeight();
+    });
+
+    std::cout << "cost after updates " << cost << ", after rebuild " << tree.GetCost() << "\n";
+    return report.Finish();
+}
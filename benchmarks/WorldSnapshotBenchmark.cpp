@@ -0,0 +1,108 @@
+// Saves and loads a level sized world through WorldSnapshot: capture, write, read and apply measured apart,
+// so it shows whether loading keeps up with the disk. Also measures a delta after moving a tenth of the entities.
+//
+// Usage: KSBenchWorldSnapshot [--count N] [--iterations N]
+//   Results can also be written as JSON and checked against an earlier run, see BenchmarkReport.hpp
+
+#include "BenchmarkReport.hpp"
+
+#include <components/ComponentName.hpp>
+#include <components/ComponentWorldTransform.hpp>
+#include <ecs/WorldSnapshot.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+KS::BenchmarkReport report {};
+
+// Static geometry with a moving tenth, a third named as props placed in the editor would be
+void Populate(entt::registry& registry, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto entity = registry.create();
+        auto& transform = registry.emplace<KS::ComponentWorldTransform>(entity);
+        transform.matrix[3] = glm::vec4(float(i % 1000), 0.0f, float(i / 1000), 1.0f);
+        transform.previous = transform.matrix;
+
+        if (i % 3 == 0)
+            registry.emplace<KS::ComponentName>(entity, "Prop " + std::to_string(i));
+    }
+}
+
+template <typename T>
+std::vector<std::byte> Save(const T& value)
+{
+    std::vector<std::byte> bytes {};
+    KS::MemoryWriteStream stream { bytes };
+    KS::BinarySaver archive { stream };
+    archive(value);
+    return bytes;
+}
+
+template <typename T>
+T Load(const std::vector<std::byte>& bytes)
+{
+    KS::MemoryReadStream stream { bytes };
+    KS::BinaryLoader archive { stream };
+    T value {};
+    archive(value);
+    return value;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    KS::BenchmarkOptions options {};
+    report.ParseArguments(argc, argv, options);
+
+    std::cout << options.count << " entities, " << options.iterations << " iterations\n";
+
+    KS::WorldSerializer serializer {};
+    serializer.Register<KS::ComponentWorldTransform>("WorldTransform");
+    serializer.Register<KS::ComponentName>("Name");
+
+    entt::registry world {};
+    Populate(world, options.count);
+
+    auto snapshot = serializer.Capture(world);
+    auto bytes = Save(snapshot);
+    std::cout << "full snapshot " << bytes.size() / 1024 << " KB\n";
+
+    KS::BenchmarkReport::RunInfo full { "entity", bytes.size() };
+    report.Run("capture", options, full, [&]() { return serializer.Capture(world).GetEntities().size(); });
+    report.Run("save", options, full, [&]() { return Save(snapshot).size(); });
+    report.Run("load", options, full, [&]() { return Load<KS::WorldSnapshot>(bytes).GetEntities().size(); });
+
+    report.Run("apply", options, full, [&]()
+    {
+        entt::registry level {};
+        KS::EntityMap map {};
+        serializer.Apply(snapshot, level, map);
+        return level.storage<entt::entity>().in_use();
+    });
+
+    // Level streaming: the saved baseline plus what moved since
+    uint32_t moved = 0;
+    for (auto [entity, transform] : world.view<KS::ComponentWorldTransform>().each())
+    {
+        if (moved++ % 10 == 0)
+            transform.matrix[3].y += 1.0f;
+    }
+
+    auto current = serializer.Capture(world);
+    auto delta_bytes = Save(KS::WorldSnapshot::Diff(snapshot, current)).size();
+    std::cout << "delta for " << options.count / 10 << " moved entities " << delta_bytes / 1024 << " KB\n";
+
+    KS::BenchmarkReport::RunInfo delta { "entity", delta_bytes };
+    report.Run("diff", options, delta, [&]() { return KS::WorldSnapshot::Diff(snapshot, current).GetChunks().size(); });
+
+    return report.Finish();
+}
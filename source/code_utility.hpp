@@ -22,4 +22,14 @@
 #define ASSERT(expr) // empty
 #define DEBUG_ONLY(expr) // empty
 
-#endif
\ No newline at end of file
+#endif
+
+// Memory layout
+
+#include <cstddef>
+
+namespace KS
+{
+// Padding unit that keeps data written by different threads apart (false sharing)
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+}
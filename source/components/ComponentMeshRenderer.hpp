@@ -0,0 +1,18 @@
+#pragma once
+#include <fileio/ResourceHandle.hpp>
+#include <resources/Material.hpp>
+
+namespace KS
+{
+
+class Mesh;
+
+// Draws one mesh with one material at the entity's ComponentWorldTransform.
+// The Scene gathers every entity with both components once per frame, see Scene::Tick.
+struct ComponentMeshRenderer
+{
+    ResourceHandle<Mesh> mesh {};
+    MaterialInstance material {};
+};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+
+namespace KS
+{
+
+// Display name for the editor, not unique
+struct ComponentName
+{
+    std::string name {};
+
+    template <typename A>
+    void serialize(A& ar)
+    {
+        ar(name);
+    }
+};
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <glm/glm.hpp>
+
+namespace KS
+{
+
+// The final world matrix an entity is drawn with. Moving a drawn entity is a write to this component.
+struct ComponentWorldTransform
+{
+    glm::mat4 matrix = glm::mat4(1.0f);
+
+    // The matrix before the last simulation step, rendering blends between the two. Set both to teleport.
+    glm::mat4 previous = glm::mat4(1.0f);
+};
+
+}
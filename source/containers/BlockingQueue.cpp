@@ -0,0 +1,86 @@
+#include "BlockingQueue.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+void KS::Tests::TestBlockingQueue()
+{
+    // A tiny queue forces producers and consumers to park on each other
+    {
+        constexpr uint64_t COUNT = 20000;
+        BlockingQueue<SPSCQueue<uint64_t>> queue { 2 };
+
+        std::thread producer([&]()
+        {
+            for (uint64_t i = 0; i < COUNT; i++)
+                queue.Push(i);
+        });
+
+        bool in_order = true;
+        for (uint64_t i = 0; i < COUNT; i++)
+            in_order &= queue.Pop().value() == i;
+
+        producer.join();
+
+        if (!in_order)
+        {
+            throw;
+        }
+    }
+
+    // Several workers drain the queue, closing it lets them exit once it is empty
+    {
+        constexpr uint32_t WORKERS = 3;
+        constexpr uint64_t COUNT = 30000;
+        BlockingQueue<MPMCQueue<uint64_t>> queue { 16 };
+
+        std::atomic<uint64_t> sum { 0 };
+        std::atomic<uint64_t> count { 0 };
+        std::vector<std::thread> workers {};
+
+        for (uint32_t i = 0; i < WORKERS; i++)
+        {
+            workers.emplace_back([&]()
+            {
+                while (auto item = queue.Pop())
+                {
+                    sum += *item;
+                    count++;
+                }
+            });
+        }
+
+        for (uint64_t i = 1; i <= COUNT; i++)
+            queue.Push(i);
+
+        queue.Close();
+
+        for (auto& worker : workers)
+            worker.join();
+
+        if (count != COUNT || sum != COUNT * (COUNT + 1) / 2)
+        {
+            throw;
+        }
+
+        if (queue.Push(1) || queue.TryPush(1) || queue.Pop().has_value())
+        {
+            throw;
+        }
+    }
+
+    // Close wakes consumers that are parked on an empty queue
+    {
+        BlockingQueue<MPMCQueue<int>> queue { 4 };
+        std::thread waiting([&]()
+        {
+            if (queue.Pop().has_value())
+                std::terminate();
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.Close();
+        waiting.join();
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <containers/MPMCQueue.hpp>
+#include <containers/SPSCQueue.hpp>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace KS
+{
+
+namespace detail
+{
+    // Tells the CPU we are spinning, so the other hyperthread gets the core
+    inline void CpuRelax()
+    {
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+// Blocking push and pop on top of SPSCQueue or MPMCQueue.
+// Waiting threads spin for a short while first (handoffs are usually quick), then park on an atomic wait.
+// Close wakes everything up: pushes fail from then on and pops drain what is left before failing.
+template <typename Queue>
+class BlockingQueue
+{
+public:
+    using value_type = typename Queue::value_type;
+
+    static constexpr uint32_t SPIN_COUNT = 256;
+
+    explicit BlockingQueue(size_t capacity)
+        : queue(capacity)
+    {
+    }
+
+    NON_COPYABLE(BlockingQueue);
+    NON_MOVABLE(BlockingQueue);
+
+    // Returns false if the queue was closed, the item is not pushed then
+    bool Push(value_type item);
+
+    // Empty once the queue is closed and drained
+    std::optional<value_type> Pop();
+
+    bool TryPush(value_type item);
+    std::optional<value_type> TryPop();
+
+    void Close();
+    bool IsClosed() const { return closed.load(std::memory_order_acquire); }
+
+    size_t SizeApprox() const { return queue.SizeApprox(); }
+    size_t Capacity() const { return queue.Capacity(); }
+
+private:
+    void Signal(std::atomic<uint32_t>& epoch, const std::atomic<uint32_t>& waiters);
+
+    Queue queue;
+    std::atomic<bool> closed { false };
+
+    // Bumped on every push / pop, parked threads wait for the value to change
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> push_epoch { 0 };
+    std::atomic<uint32_t> waiting_consumers { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> pop_epoch { 0 };
+    std::atomic<uint32_t> waiting_producers { 0 };
+};
+
+template <typename Queue>
+inline void BlockingQueue<Queue>::Signal(std::atomic<uint32_t>& epoch, const std::atomic<uint32_t>& waiters)
+{
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+
+    // Skips the wake up call in the common case of nobody parked
+    if (waiters.load(std::memory_order_seq_cst) != 0)
+        epoch.notify_one();
+}
+
+template <typename Queue>
+inline bool BlockingQueue<Queue>::TryPush(value_type item)
+{
+    if (IsClosed() || !queue.TryPush(std::move(item)))
+        return false;
+
+    Signal(push_epoch, waiting_consumers);
+    return true;
+}
+
+template <typename Queue>
+inline std::optional<typename BlockingQueue<Queue>::value_type> BlockingQueue<Queue>::TryPop()
+{
+    auto item = queue.TryPop();
+    if (item)
+        Signal(pop_epoch, waiting_producers);
+    return item;
+}
+
+template <typename Queue>
+inline bool BlockingQueue<Queue>::Push(value_type item)
+{
+    for (uint32_t spin = 0;; spin++)
+    {
+        uint32_t epoch = pop_epoch.load(std::memory_order_seq_cst);
+
+        if (IsClosed())
+            return false;
+
+        if (queue.TryPush(std::move(item)))
+        {
+            Signal(push_epoch, waiting_consumers);
+            return true;
+        }
+
+        if (spin < SPIN_COUNT)
+        {
+            detail::CpuRelax();
+            continue;
+        }
+
+        // Full, sleep until a consumer made room (or the queue closes)
+        waiting_producers.fetch_add(1, std::memory_order_seq_cst);
+        pop_epoch.wait(epoch, std::memory_order_seq_cst);
+        waiting_producers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+template <typename Queue>
+inline std::optional<typename BlockingQueue<Queue>::value_type> BlockingQueue<Queue>::Pop()
+{
+    for (uint32_t spin = 0;; spin++)
+    {
+        uint32_t epoch = push_epoch.load(std::memory_order_seq_cst);
+
+        if (auto item = queue.TryPop())
+        {
+            Signal(pop_epoch, waiting_producers);
+            return item;
+        }
+
+        // Anything pushed before the close became visible is still handed out
+        if (IsClosed())
+        {
+            auto item = queue.TryPop();
+            if (item)
+                Signal(pop_epoch, waiting_producers);
+            return item;
+        }
+
+        if (spin < SPIN_COUNT)
+        {
+            detail::CpuRelax();
+            continue;
+        }
+
+        waiting_consumers.fetch_add(1, std::memory_order_seq_cst);
+        push_epoch.wait(epoch, std::memory_order_seq_cst);
+        waiting_consumers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+template <typename Queue>
+inline void BlockingQueue<Queue>::Close()
+{
+    closed.store(true, std::memory_order_seq_cst);
+
+    push_epoch.fetch_add(1, std::memory_order_seq_cst);
+    push_epoch.notify_all();
+    pop_epoch.fetch_add(1, std::memory_order_seq_cst);
+    pop_epoch.notify_all();
+}
+
+namespace Tests
+{
+    void TestBlockingQueue();
+}
+
+}
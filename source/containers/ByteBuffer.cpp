@@ -1,7 +1,215 @@
 #include "ByteBuffer.hpp"
 
-KS::ByteBuffer::ByteBuffer(const void* data, size_t byte_count)
+#include <bit>
+#include <containers/MemoryResources.hpp>
+#include <cstring>
+#include <memory>
+
+KS::ByteBuffer::ByteBuffer(const void* data, size_t byte_count, size_t alignment, std::pmr::memory_resource* resource)
+    : ByteBuffer(Allocate(byte_count, alignment, resource))
+{
+    if (byte_count != 0)
+        std::memcpy(this->data, data, byte_count);
+}
+
+KS::ByteBuffer::~ByteBuffer()
+{
+    Release();
+}
+
+KS::ByteBuffer::ByteBuffer(const ByteBuffer& other)
+    : ByteBuffer(other.data, other.size, other.resource ? other.alignment : DEFAULT_ALIGNMENT,
+        other.resource ? other.resource : GetTrackedResource(MemoryTag::BYTE_BUFFER))
 {
-    storage.resize(byte_count);
-    std::memcpy(storage.data(), data, byte_count);
+}
+
+KS::ByteBuffer& KS::ByteBuffer::operator=(const ByteBuffer& other)
+{
+    if (this != &other)
+        *this = ByteBuffer(other);
+    return *this;
+}
+
+KS::ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
+    : data(std::exchange(other.data, nullptr))
+    , size(std::exchange(other.size, 0))
+    , alignment(other.alignment)
+    , resource(std::exchange(other.resource, nullptr))
+    , deleter(std::exchange(other.deleter, nullptr))
+    , context(std::exchange(other.context, nullptr))
+{
+}
+
+KS::ByteBuffer& KS::ByteBuffer::operator=(ByteBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        alignment = other.alignment;
+        resource = std::exchange(other.resource, nullptr);
+        deleter = std::exchange(other.deleter, nullptr);
+        context = std::exchange(other.context, nullptr);
+    }
+    return *this;
+}
+
+KS::ByteBuffer KS::ByteBuffer::Allocate(size_t byte_count, size_t alignment, std::pmr::memory_resource* resource)
+{
+    ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+    ByteBuffer out {};
+    out.alignment = alignment;
+
+    if (byte_count != 0)
+    {
+        out.data = static_cast<std::byte*>(resource->allocate(byte_count, alignment));
+        out.size = byte_count;
+        out.resource = resource;
+    }
+
+    return out;
+}
+
+KS::ByteBuffer KS::ByteBuffer::Adopt(void* data, size_t byte_count, Deleter deleter, void* context)
+{
+    ByteBuffer out {};
+    out.data = static_cast<std::byte*>(data);
+    out.size = byte_count;
+    out.deleter = deleter;
+    out.context = context;
+
+    if (deleter)
+        MemoryTracker::RecordAllocation(MemoryTag::BYTE_BUFFER, byte_count);
+
+    // Only what the pointer happens to be aligned to is known
+    out.alignment = size_t(1) << std::countr_zero(reinterpret_cast<uintptr_t>(data) | (uintptr_t(1) << 12));
+    return out;
+}
+
+void KS::ByteBuffer::Release()
+{
+    if (resource)
+        resource->deallocate(data, size, alignment);
+    else if (deleter)
+    {
+        MemoryTracker::RecordFree(MemoryTag::BYTE_BUFFER, size);
+        deleter(data, size, context);
+    }
+
+    data = nullptr;
+    size = 0;
+    resource = nullptr;
+    deleter = nullptr;
+    context = nullptr;
+}
+
+void KS::Tests::TestByteBuffer()
+{
+    const uint32_t numbers[] = { 1, 2, 3, 4, 5 };
+
+    // Alignment is honoured for every resource
+    for (std::pmr::memory_resource* resource : { std::pmr::get_default_resource(), static_cast<std::pmr::memory_resource*>(GetPageResource()) })
+    {
+        for (size_t alignment : { size_t(16), size_t(64) })
+        {
+            ByteBuffer buffer { numbers, 5, alignment, resource };
+
+            if (reinterpret_cast<uintptr_t>(buffer.GetBytes().data()) % alignment != 0)
+            {
+                throw;
+            }
+
+            auto view = buffer.GetView<uint32_t>();
+            if (view.count() != 5 || view.begin()[4] != 5)
+            {
+                throw;
+            }
+        }
+    }
+
+    // Buffers allocated from an arena, copies stay in the same arena
+    std::byte arena_memory[256];
+    std::pmr::monotonic_buffer_resource arena { arena_memory, sizeof(arena_memory), std::pmr::null_memory_resource() };
+
+    ByteBuffer arena_buffer { numbers, 5, 64, &arena };
+    ByteBuffer arena_copy = arena_buffer;
+
+    auto in_arena = [&](const ByteBuffer& buffer)
+    {
+        return buffer.GetBytes().data() >= arena_memory && buffer.GetBytes().data() < arena_memory + sizeof(arena_memory);
+    };
+
+    if (!in_arena(arena_buffer) || !in_arena(arena_copy) || arena_copy.GetView<uint32_t>().begin()[2] != 3)
+    {
+        throw;
+    }
+
+    // Moves hand over the pointer
+    const auto* moved_data = arena_buffer.GetBytes().data();
+    ByteBuffer moved = std::move(arena_buffer);
+
+    if (moved.GetBytes().data() != moved_data || !arena_buffer.Empty())
+    {
+        throw;
+    }
+
+    // Adopted memory is freed through the deleter, exactly once
+    int frees = 0;
+    {
+        auto* external = new uint32_t[3] { 7, 8, 9 };
+        ByteBuffer adopted = ByteBuffer::Adopt(external, sizeof(uint32_t) * 3, [](void* data, size_t, void* context)
+        {
+            delete[] static_cast<uint32_t*>(data);
+            (*static_cast<int*>(context))++;
+        }, &frees);
+
+        ByteBuffer adopted_moved = std::move(adopted);
+
+        if (adopted_moved.GetView<uint32_t>().begin() != external || frees != 0)
+        {
+            throw;
+        }
+    }
+
+    if (frees != 1)
+    {
+        throw;
+    }
+
+    // Adopting an owner keeps it alive without copying the bytes
+    auto shared = std::make_shared<std::vector<std::byte>>(32, std::byte { 5 });
+    {
+        std::span<const std::byte> bytes = *shared;
+        ByteBuffer owned = ByteBuffer::Adopt(shared, bytes);
+
+        if (owned.GetBytes().data() != shared->data() || shared.use_count() != 2)
+        {
+            throw;
+        }
+    }
+
+    if (shared.use_count() != 1)
+    {
+        throw;
+    }
+
+    // Buffers count towards their tag for as long as they hold memory, adopted memory included
+    auto before = MemoryTracker::TakeSnapshot();
+    {
+        ByteBuffer tracked { numbers, 5 };
+        ByteBuffer adopted = ByteBuffer::Adopt(std::vector<uint32_t>(4), std::span<const std::byte>(arena_memory, 16));
+
+        auto during = MemoryTracker::Diff(before, MemoryTracker::TakeSnapshot());
+        if (during[MemoryTag::BYTE_BUFFER].current != sizeof(numbers) + 16 || during[MemoryTag::BYTE_BUFFER].count != 2)
+        {
+            throw;
+        }
+    }
+
+    if (MemoryTracker::Diff(before, MemoryTracker::TakeSnapshot())[MemoryTag::BYTE_BUFFER].current != 0)
+    {
+        throw;
+    }
 }
@@ -1,24 +1,70 @@
 #pragma once
 
+#include <algorithm>
 #include <code_utility.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <fileio/Serialization.hpp>
+#include <memory_resource>
+#include <span>
+#include <tools/MemoryTracker.hpp>
+#include <utility>
 #include <vector>
 
 namespace KS
 {
 
+// Owned block of bytes with a guaranteed alignment.
+// Memory comes from a std::pmr::memory_resource (heap, arena, pages), or is adopted from somewhere else
+// together with a function that frees it, so decoded images and mapped files can be kept without a copy.
+// Everything it holds, adopted memory included, is counted under MemoryTag::BYTE_BUFFER unless another resource is passed.
 class ByteBuffer
 {
 public:
+    // Enough for SSE loads and every glm type
+    static constexpr size_t DEFAULT_ALIGNMENT = 16;
+
+    // Frees adopted memory, context is the pointer passed to Adopt
+    using Deleter = void (*)(void* data, size_t byte_count, void* context);
+
     ByteBuffer() = default;
-    ByteBuffer(const void* data, size_t byte_count);
+    ~ByteBuffer();
+
+    ByteBuffer(const void* data, size_t byte_count, size_t alignment = DEFAULT_ALIGNMENT,
+        std::pmr::memory_resource* resource = GetTrackedResource(MemoryTag::BYTE_BUFFER));
 
     template <typename T>
-    ByteBuffer(const T* data, size_t count)
-        : ByteBuffer(static_cast<const void*>(data), count * sizeof(T))
+    ByteBuffer(const T* data, size_t count, size_t alignment = std::max(DEFAULT_ALIGNMENT, alignof(T)),
+        std::pmr::memory_resource* resource = GetTrackedResource(MemoryTag::BYTE_BUFFER))
+        : ByteBuffer(static_cast<const void*>(data), count * sizeof(T), alignment, resource)
     {
     }
 
+    // Copies allocate from the same resource, adopted memory is copied to the ByteBuffer resource
+    ByteBuffer(const ByteBuffer& other);
+    ByteBuffer& operator=(const ByteBuffer& other);
+
+    ByteBuffer(ByteBuffer&& other) noexcept;
+    ByteBuffer& operator=(ByteBuffer&& other) noexcept;
+
+    // Uninitialized bytes, to be filled through GetMutableBytes
+    static ByteBuffer Allocate(size_t byte_count, size_t alignment = DEFAULT_ALIGNMENT,
+        std::pmr::memory_resource* resource = GetTrackedResource(MemoryTag::BYTE_BUFFER));
+
+    // Takes ownership of memory that was allocated elsewhere, deleter is called once the buffer is destroyed
+    static ByteBuffer Adopt(void* data, size_t byte_count, Deleter deleter, void* context = nullptr);
+
+    // Keeps an owning object (a MappedFile, a vector) alive for as long as the bytes inside it are used
+    template <typename Owner>
+    static ByteBuffer Adopt(Owner&& owner, std::span<const std::byte> bytes);
+
+    std::span<const std::byte> GetBytes() const { return { data, size }; }
+    size_t GetSize() const { return size; }
+    bool Empty() const { return size == 0; }
+
+    // Adopted memory may be read only (mapped files), only write to buffers made with Allocate
+    std::span<std::byte> GetMutableBytes() { return { data, size }; }
+
     template <typename T>
     class View
     {
@@ -39,8 +85,10 @@ public:
     template <typename T>
     View<T> GetView() const
     {
-        ASSERT(storage.size() % sizeof(T) == 0
+        ASSERT(size % sizeof(T) == 0
             && "Size of buffer must be divisible by the size of T for proper iteration");
+        ASSERT(reinterpret_cast<uintptr_t>(data) % alignof(T) == 0
+            && "Buffer is not aligned for T");
         return View<T>(this);
     }
 
@@ -53,19 +101,40 @@ public:
 private:
     friend class cereal::access;
 
-    std::vector<uint8_t> storage {};
+    void Release();
+
+    std::byte* data {};
+    size_t size {};
+    size_t alignment = DEFAULT_ALIGNMENT;
+
+    // Set for memory allocated here, otherwise the deleter frees adopted memory
+    std::pmr::memory_resource* resource {};
+    Deleter deleter {};
+    void* context {};
 };
 
+template <typename Owner>
+inline ByteBuffer ByteBuffer::Adopt(Owner&& owner, std::span<const std::byte> bytes)
+{
+    using Stored = std::remove_cvref_t<Owner>;
+
+    // Moving the owner must not move the bytes, which holds for mappings and heap containers
+    auto* stored = new Stored(std::forward<Owner>(owner));
+    auto* bytes_ptr = const_cast<std::byte*>(bytes.data());
+
+    return Adopt(bytes_ptr, bytes.size(), [](void*, size_t, void* context) { delete static_cast<Stored*>(context); }, stored);
+}
+
 template <typename T>
 inline const T* ByteBuffer::View<T>::begin() const
 {
-    return reinterpret_cast<const T*>(source->storage.data());
+    return reinterpret_cast<const T*>(source->data);
 }
 
 template <typename T>
 inline const T* KS::ByteBuffer::View<T>::end() const
 {
-    return reinterpret_cast<const T*>(source->storage.data() + source->storage.size());
+    return reinterpret_cast<const T*>(source->data + source->size);
 }
 
 template <typename T>
@@ -74,13 +143,23 @@ inline size_t ByteBuffer::View<T>::count() const
     return end() - begin();
 }
 
+// Same layout as the std::vector<uint8_t> this used to store, so existing files still load
 template <typename A>
 inline void KS::ByteBuffer::save(A& ar, const uint32_t v) const
 {
     switch (v)
     {
     case 0:
-        ar(cereal::make_nvp("Contents", storage));
+        if constexpr (cereal::traits::is_output_serializable<cereal::BinaryData<const std::byte*>, A>::value)
+        {
+            ar(cereal::make_size_tag(static_cast<cereal::size_type>(size)));
+            ar(cereal::binary_data(data, size));
+        }
+        else
+        {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+            ar(cereal::make_nvp("Contents", std::vector<uint8_t>(bytes, bytes + size)));
+        }
         break;
 
     default:
@@ -95,13 +174,32 @@ inline void KS::ByteBuffer::load(A& ar, const uint32_t v)
     {
     case 0:
     {
-        ar(cereal::make_nvp("Contents", storage));
+        if constexpr (cereal::traits::is_input_serializable<cereal::BinaryData<std::byte*>, A>::value)
+        {
+            cereal::size_type byte_count {};
+            ar(cereal::make_size_tag(byte_count));
+
+            *this = Allocate(static_cast<size_t>(byte_count));
+            ar(cereal::binary_data(data, size));
+        }
+        else
+        {
+            std::vector<uint8_t> contents {};
+            ar(cereal::make_nvp("Contents", contents));
+            *this = ByteBuffer(contents.data(), contents.size());
+        }
         break;
     }
     default:
         break;
     }
 }
+
+namespace Tests
+{
+    void TestByteBuffer();
+}
+
 }
 
 CEREAL_CLASS_VERSION(KS::ByteBuffer, 0);
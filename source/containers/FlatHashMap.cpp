@@ -0,0 +1,225 @@
+#include "FlatHashMap.hpp"
+
+#include <containers/LinearArena.hpp>
+#include <containers/StringHash.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+void KS::Tests::TestFlatHashMap()
+{
+    // Basic insert, lookup and overwrite
+    {
+        FlatHashMap<int, int> map;
+
+        if (!map.empty() || map.find(3) != map.end() || map.contains(3))
+        {
+            throw;
+        }
+
+        map[3] = 30;
+        auto [it, inserted] = map.try_emplace(4, 40);
+
+        if (!inserted || it->second != 40 || map.size() != 2 || map.at(3) != 30)
+        {
+            throw;
+        }
+
+        if (map.try_emplace(4, 41).second || map.at(4) != 40 || map.insert({ 3, 31 }).second)
+        {
+            throw;
+        }
+
+        map.insert_or_assign(4, 42);
+        if (map.at(4) != 42 || map.count(4) != 1 || map.count(5) != 0)
+        {
+            throw;
+        }
+    }
+
+    // Grows through many rehashes and matches std::unordered_map the whole way, with erases mixed in
+    {
+        FlatHashMap<uint64_t, uint64_t> map;
+        std::unordered_map<uint64_t, uint64_t> reference;
+
+        for (uint64_t i = 0; i < 20000; i++)
+        {
+            // Sequential keys are the worst case for a weak hash
+            map.emplace(i * 64, i);
+            reference.emplace(i * 64, i);
+
+            if (i % 3 == 0)
+            {
+                map.erase(i * 32);
+                reference.erase(i * 32);
+            }
+        }
+
+        if (map.size() != reference.size())
+        {
+            throw;
+        }
+
+        for (const auto& [key, value] : reference)
+        {
+            auto it = map.find(key);
+            if (it == map.end() || it->second != value)
+            {
+                throw;
+            }
+        }
+
+        size_t visited = 0;
+        for (const auto& [key, value] : map)
+        {
+            if (reference.at(key) != value)
+            {
+                throw;
+            }
+            visited++;
+        }
+
+        if (visited != reference.size() || map.load_factor() > 0.875f)
+        {
+            throw;
+        }
+    }
+
+    // Insert and erase churn on a small table reuses tombstones instead of growing forever
+    {
+        FlatHashMap<int, int> map;
+        map.reserve(8);
+        size_t capacity = map.bucket_count();
+
+        for (int i = 0; i < 100000; i++)
+        {
+            map.emplace(i, i);
+            if (map.erase(i) != 1)
+            {
+                throw;
+            }
+        }
+
+        if (!map.empty() || map.bucket_count() != capacity)
+        {
+            throw;
+        }
+    }
+
+    // Erasing while iterating returns the next element
+    {
+        FlatHashMap<int, int> map;
+        for (int i = 0; i < 100; i++)
+        {
+            map.emplace(i, i);
+        }
+
+        for (auto it = map.begin(); it != map.end();)
+        {
+            if (it->first % 2 == 0)
+                it = map.erase(it);
+            else
+                ++it;
+        }
+
+        if (map.size() != 50 || map.contains(10) || !map.contains(11))
+        {
+            throw;
+        }
+    }
+
+    // Heterogeneous lookup on string keys, no std::string built for the query
+    {
+        StringMap<int> map { { "models/helmet.ksmodel", 1 }, { "textures/albedo.kstex", 2 } };
+        std::string_view query = "textures/albedo.kstex";
+
+        if (map.find(query) == map.end() || map.at(query) != 2 || !map.contains("models/helmet.ksmodel"))
+        {
+            throw;
+        }
+
+        map["shaders/pbr.hlsl"] = 3;
+        if (map.erase(std::string_view("models/helmet.ksmodel")) != 1 || map.size() != 2 || map.at("shaders/pbr.hlsl") != 3)
+        {
+            throw;
+        }
+    }
+
+    // Elements are destroyed exactly once, through moves, copies, erases and clear
+    {
+        auto value = std::make_shared<int>(5);
+
+        {
+            FlatHashMap<int, std::shared_ptr<int>> map;
+            for (int i = 0; i < 64; i++)
+            {
+                map.emplace(i, value);
+            }
+
+            FlatHashMap<int, std::shared_ptr<int>> copy = map;
+            if (value.use_count() != 129 || copy != map)
+            {
+                throw;
+            }
+
+            FlatHashMap<int, std::shared_ptr<int>> moved = std::move(copy);
+            if (value.use_count() != 129 || !copy.empty() || moved.size() != 64)
+            {
+                throw;
+            }
+
+            moved.erase(0);
+            map.clear();
+            if (value.use_count() != 64 || !map.empty() || map.find(1) != map.end())
+            {
+                throw;
+            }
+
+            // Cleared tables are reusable
+            map.emplace(1, value);
+            if (map.at(1) != value)
+            {
+                throw;
+            }
+        }
+
+        if (value.use_count() != 1)
+        {
+            throw;
+        }
+    }
+
+    // Custom allocators get both the control bytes and the slots
+    {
+        LinearArena arena { 1 << 16 };
+        FlatHashMap<int, int, std::hash<int>, std::equal_to<int>, ArenaAllocator<std::pair<const int, int>>> map {
+            ArenaAllocator<std::pair<const int, int>> { arena }
+        };
+
+        for (int i = 0; i < 200; i++)
+        {
+            map.emplace(i, i * 2);
+        }
+
+        if (arena.GetUsed() == 0 || map.at(199) != 398)
+        {
+            throw;
+        }
+    }
+
+    // Sets
+    {
+        FlatHashSet<std::string, StringHash, std::equal_to<>> set { "a", "b" };
+
+        if (!set.insert("c").second || set.insert("a").second || set.size() != 3 || !set.contains(std::string_view("b")))
+        {
+            throw;
+        }
+
+        set.erase(std::string_view("a"));
+        if (set.contains("a") || set.size() != 2)
+        {
+            throw;
+        }
+    }
+}
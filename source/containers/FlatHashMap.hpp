@@ -0,0 +1,757 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <code_utility.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KS_FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace KS
+{
+
+namespace detail
+{
+    // One control byte per slot: empty, deleted, or the low 7 bits of the hash for a full slot.
+    // Full slots have the top bit clear, so empty and deleted slots can be found with one sign test.
+    using ControlByte = int8_t;
+    constexpr ControlByte CTRL_EMPTY = -128;
+    constexpr ControlByte CTRL_DELETED = -2;
+
+    // Slots are probed sixteen at a time, with SSE2 one compare covers a whole group
+    constexpr size_t GROUP_WIDTH = 16;
+
+    // Control bytes of a table without storage, so empty tables do not allocate
+    alignas(GROUP_WIDTH) inline const ControlByte EMPTY_CONTROL[GROUP_WIDTH] = { CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY };
+
+    struct Group
+    {
+        explicit Group(const ControlByte* position)
+        {
+#if defined(KS_FLAT_HASH_SSE2)
+            control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+#else
+            std::memcpy(control, position, GROUP_WIDTH);
+#endif
+        }
+
+        // Bit i is set when slot i of the group holds the given 7 bit hash
+        uint32_t Match(ControlByte hash) const
+        {
+#if defined(KS_FLAT_HASH_SSE2)
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), control)));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++)
+                mask |= uint32_t(control[i] == hash) << i;
+            return mask;
+#endif
+        }
+
+        uint32_t MatchEmpty() const { return Match(CTRL_EMPTY); }
+
+        uint32_t MatchEmptyOrDeleted() const
+        {
+#if defined(KS_FLAT_HASH_SSE2)
+            return static_cast<uint32_t>(_mm_movemask_epi8(control));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; i++)
+                mask |= uint32_t(control[i] < 0) << i;
+            return mask;
+#endif
+        }
+
+#if defined(KS_FLAT_HASH_SSE2)
+        __m128i control;
+#else
+        ControlByte control[GROUP_WIDTH];
+#endif
+    };
+
+    // std::hash is the identity for integers on some standard libraries, the table needs every bit mixed
+    inline uint64_t MixHash(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    template <typename K, typename V>
+    struct FlatMapPolicy
+    {
+        using key_type = K;
+        using value_type = std::pair<const K, V>;
+
+        // Users see pairs with a const key, moving elements to a new table needs a mutable key
+        union Slot
+        {
+            Slot() { }
+            ~Slot() { }
+
+            value_type value;
+            std::pair<K, V> mutable_value;
+        };
+
+        static const K& GetKey(const value_type& value) { return value.first; }
+
+        static void Transfer(Slot* target, Slot* source)
+        {
+            new (&target->mutable_value) std::pair<K, V>(std::move(source->mutable_value));
+            std::destroy_at(&source->mutable_value);
+        }
+    };
+
+    template <typename K>
+    struct FlatSetPolicy
+    {
+        using key_type = K;
+        using value_type = K;
+
+        union Slot
+        {
+            Slot() { }
+            ~Slot() { }
+
+            K value;
+        };
+
+        static const K& GetKey(const K& value) { return value; }
+
+        static void Transfer(Slot* target, Slot* source)
+        {
+            new (&target->value) K(std::move(source->value));
+            std::destroy_at(&source->value);
+        }
+    };
+
+    template <typename Hash, typename Equal>
+    concept TransparentLookup = requires {
+        typename Hash::is_transparent;
+        typename Equal::is_transparent;
+    };
+
+    // Open addressing table with Swiss table style probing, shared by FlatHashMap and FlatHashSet
+    template <typename Policy, typename Hash, typename Equal, typename Allocator>
+    class FlatHashTable
+    {
+        using Slot = typename Policy::Slot;
+        using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+        using ControlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ControlByte>;
+
+    public:
+        using key_type = typename Policy::key_type;
+        using value_type = typename Policy::value_type;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = Equal;
+        using allocator_type = Allocator;
+
+        template <bool IsConst>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename Policy::value_type;
+            using difference_type = ptrdiff_t;
+            using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+            using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+
+            Iterator() = default;
+
+            template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            Iterator(const Iterator<OtherConst>& other)
+                : control(other.control)
+                , slot(other.slot)
+                , control_end(other.control_end)
+            {
+            }
+
+            reference operator*() const { return slot->value; }
+            pointer operator->() const { return &slot->value; }
+
+            Iterator& operator++()
+            {
+                ++control;
+                ++slot;
+                SkipEmpty();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            template <bool OtherConst>
+            bool operator==(const Iterator<OtherConst>& other) const { return slot == other.slot; }
+
+        private:
+            friend class FlatHashTable;
+            template <bool>
+            friend class Iterator;
+
+            Iterator(const ControlByte* control, Slot* slot, const ControlByte* control_end)
+                : control(control)
+                , slot(slot)
+                , control_end(control_end)
+            {
+                SkipEmpty();
+            }
+
+            void SkipEmpty()
+            {
+                while (control != control_end && *control < 0)
+                {
+                    ++control;
+                    ++slot;
+                }
+            }
+
+            const ControlByte* control {};
+            Slot* slot {};
+            const ControlByte* control_end {};
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashTable() = default;
+
+        explicit FlatHashTable(size_t bucket_count, const Hash& hash = Hash(), const Equal& equal = Equal(), const Allocator& allocator = Allocator())
+            : hash(hash)
+            , equal(equal)
+            , allocator(allocator)
+        {
+            reserve(bucket_count);
+        }
+
+        explicit FlatHashTable(const Allocator& allocator)
+            : allocator(allocator)
+        {
+        }
+
+        template <typename InputIt>
+        FlatHashTable(InputIt first, InputIt last, size_t bucket_count = 0, const Hash& hash = Hash(), const Equal& equal = Equal(),
+            const Allocator& allocator = Allocator())
+            : FlatHashTable(bucket_count, hash, equal, allocator)
+        {
+            insert(first, last);
+        }
+
+        FlatHashTable(std::initializer_list<value_type> values, size_t bucket_count = 0, const Hash& hash = Hash(),
+            const Equal& equal = Equal(), const Allocator& allocator = Allocator())
+            : FlatHashTable(values.begin(), values.end(), bucket_count ? bucket_count : values.size(), hash, equal, allocator)
+        {
+        }
+
+        FlatHashTable(const FlatHashTable& other)
+            : FlatHashTable(other.size(), other.hash, other.equal,
+                std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator))
+        {
+            insert(other.begin(), other.end());
+        }
+
+        FlatHashTable(FlatHashTable&& other) noexcept
+            : hash(std::move(other.hash))
+            , equal(std::move(other.equal))
+            , allocator(std::move(other.allocator))
+        {
+            StealFrom(other);
+        }
+
+        FlatHashTable& operator=(const FlatHashTable& other)
+        {
+            if (this != &other)
+            {
+                FlatHashTable copy { other };
+                swap(copy);
+            }
+            return *this;
+        }
+
+        // Allocators always move with the storage
+        FlatHashTable& operator=(FlatHashTable&& other) noexcept
+        {
+            if (this != &other)
+            {
+                DestroyAll();
+                hash = std::move(other.hash);
+                equal = std::move(other.equal);
+                allocator = std::move(other.allocator);
+                StealFrom(other);
+            }
+            return *this;
+        }
+
+        ~FlatHashTable() { DestroyAll(); }
+
+        iterator begin() { return iterator(control, slots, control + capacity); }
+        iterator end() { return iterator(control + capacity, slots + capacity, control + capacity); }
+        const_iterator begin() const { return const_iterator(control, slots, control + capacity); }
+        const_iterator end() const { return const_iterator(control + capacity, slots + capacity, control + capacity); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        size_t size() const { return element_count; }
+        bool empty() const { return element_count == 0; }
+        size_t bucket_count() const { return capacity; }
+        float load_factor() const { return capacity ? static_cast<float>(element_count) / capacity : 0.0f; }
+        allocator_type get_allocator() const { return allocator; }
+        hasher hash_function() const { return hash; }
+        key_equal key_eq() const { return equal; }
+
+        void clear()
+        {
+            if (capacity == 0)
+                return;
+
+            for (size_t i = 0; i < capacity; i++)
+            {
+                if (control[i] >= 0)
+                    std::destroy_at(&slots[i].value);
+            }
+
+            std::memset(control, static_cast<uint8_t>(CTRL_EMPTY), capacity + GROUP_WIDTH);
+            element_count = 0;
+            growth_left = MaxLoad(capacity);
+        }
+
+        // Makes room for at least element_count elements without rehashing
+        void reserve(size_t element_count)
+        {
+            if (element_count > this->element_count + growth_left)
+                Resize(CapacityFor(element_count));
+        }
+
+        void rehash(size_t bucket_count) { reserve(std::max(bucket_count, element_count)); }
+
+        // Lookup, also with keys that only compare equal to key_type (string_view for string keys)
+        // when both the hash and the equality are transparent
+        template <typename K = key_type>
+        iterator find(const K& key)
+            requires(std::is_same_v<K, key_type> || TransparentLookup<Hash, Equal>)
+        {
+            size_t index = FindIndex(key);
+            return index == NOT_FOUND ? end() : IteratorAt(index);
+        }
+
+        template <typename K = key_type>
+        const_iterator find(const K& key) const
+            requires(std::is_same_v<K, key_type> || TransparentLookup<Hash, Equal>)
+        {
+            size_t index = FindIndex(key);
+            return index == NOT_FOUND ? end() : IteratorAt(index);
+        }
+
+        template <typename K = key_type>
+        bool contains(const K& key) const
+            requires(std::is_same_v<K, key_type> || TransparentLookup<Hash, Equal>)
+        {
+            return FindIndex(key) != NOT_FOUND;
+        }
+
+        template <typename K = key_type>
+        size_t count(const K& key) const
+            requires(std::is_same_v<K, key_type> || TransparentLookup<Hash, Equal>)
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+        std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+        template <typename InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+                emplace(*first);
+        }
+
+        void insert(std::initializer_list<value_type> values) { insert(values.begin(), values.end()); }
+
+        // The element is built first to find its key, prefer try_emplace on maps to skip that when the key exists
+        template <typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            // Constructing in a local slot keeps the value alive while looking up its key
+            Slot local {};
+            new (&local.value) value_type(std::forward<Args>(args)...);
+
+            auto [index, inserted] = FindOrPrepareInsert(Policy::GetKey(local.value));
+            if (inserted)
+            {
+                Policy::Transfer(&slots[index], &local);
+                CommitInsert(index);
+            }
+            else
+            {
+                std::destroy_at(&local.value);
+            }
+
+            return { IteratorAt(index), inserted };
+        }
+
+        iterator erase(const_iterator position)
+        {
+            size_t index = static_cast<size_t>(position.slot - slots);
+            EraseAt(index);
+
+            iterator next { control + index, slots + index, control + capacity };
+            return next;
+        }
+
+        iterator erase(iterator position) { return erase(const_iterator(position)); }
+
+        template <typename K = key_type>
+        size_t erase(const K& key)
+            requires(std::is_same_v<K, key_type> || TransparentLookup<Hash, Equal>)
+        {
+            size_t index = FindIndex(key);
+            if (index == NOT_FOUND)
+                return 0;
+
+            EraseAt(index);
+            return 1;
+        }
+
+        void swap(FlatHashTable& other) noexcept
+        {
+            using std::swap;
+            swap(hash, other.hash);
+            swap(equal, other.equal);
+            swap(allocator, other.allocator);
+            swap(control, other.control);
+            swap(slots, other.slots);
+            swap(capacity, other.capacity);
+            swap(element_count, other.element_count);
+            swap(growth_left, other.growth_left);
+        }
+
+        friend bool operator==(const FlatHashTable& a, const FlatHashTable& b)
+        {
+            if (a.size() != b.size())
+                return false;
+
+            for (const auto& value : a)
+            {
+                auto it = b.find(Policy::GetKey(value));
+                if (it == b.end() || !(*it == value))
+                    return false;
+            }
+            return true;
+        }
+
+    protected:
+        static constexpr size_t NOT_FOUND = ~size_t(0);
+
+        iterator IteratorAt(size_t index) { return iterator(control + index, slots + index, control + capacity); }
+        const_iterator IteratorAt(size_t index) const { return const_iterator(control + index, slots + index, control + capacity); }
+        Slot* SlotAt(size_t index) { return &slots[index]; }
+
+        template <typename K>
+        size_t HashOf(const K& key) const
+        {
+            return static_cast<size_t>(MixHash(static_cast<uint64_t>(hash(key))));
+        }
+
+        static ControlByte H2(size_t hash_value) { return static_cast<ControlByte>(hash_value & 0x7F); }
+        static size_t H1(size_t hash_value) { return hash_value >> 7; }
+
+        template <typename K>
+        size_t FindIndex(const K& key) const
+        {
+            size_t hash_value = HashOf(key);
+            size_t mask = capacity ? capacity - 1 : 0;
+            size_t offset = H1(hash_value) & mask;
+
+            for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH)
+            {
+                Group group { control + offset };
+
+                for (uint32_t matches = group.Match(H2(hash_value)); matches != 0; matches &= matches - 1)
+                {
+                    size_t index = (offset + std::countr_zero(matches)) & mask;
+                    if (equal(Policy::GetKey(slots[index].value), key))
+                        return index;
+                }
+
+                // An empty slot ends the probe, the key would have been placed there
+                if (group.MatchEmpty() != 0)
+                    return NOT_FOUND;
+
+                offset = (offset + step) & mask;
+            }
+        }
+
+        // Returns the slot holding the key, or an empty slot reserved for it that the caller must fill
+        // and then pass to CommitInsert
+        template <typename K>
+        std::pair<size_t, bool> FindOrPrepareInsert(const K& key)
+        {
+            size_t index = FindIndex(key);
+            if (index != NOT_FOUND)
+                return { index, false };
+
+            size_t hash_value = HashOf(key);
+            index = capacity == 0 ? NOT_FOUND : FindFirstNonFull(hash_value);
+
+            // Deleted slots can be reused without growing, empty ones use up the load budget
+            if (index == NOT_FOUND || (growth_left == 0 && control[index] != CTRL_DELETED))
+            {
+                Grow();
+                index = FindFirstNonFull(hash_value);
+            }
+
+            pending_hash = hash_value;
+            return { index, true };
+        }
+
+        void CommitInsert(size_t index)
+        {
+            if (control[index] == CTRL_EMPTY)
+                growth_left--;
+
+            SetControl(index, H2(pending_hash));
+            element_count++;
+        }
+
+    private:
+        static size_t MaxLoad(size_t slot_count) { return slot_count - slot_count / 8; }
+
+        static size_t CapacityFor(size_t element_count)
+        {
+            size_t slot_count = GROUP_WIDTH;
+            while (MaxLoad(slot_count) < element_count)
+                slot_count *= 2;
+            return slot_count;
+        }
+
+        size_t FindFirstNonFull(size_t hash_value) const
+        {
+            size_t mask = capacity - 1;
+            size_t offset = H1(hash_value) & mask;
+
+            for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH)
+            {
+                if (uint32_t free = Group(control + offset).MatchEmptyOrDeleted())
+                    return (offset + std::countr_zero(free)) & mask;
+
+                offset = (offset + step) & mask;
+            }
+        }
+
+        // The first group is mirrored after the end, so a group can be loaded at any slot without wrapping
+        void SetControl(size_t index, ControlByte value)
+        {
+            control[index] = value;
+            if (index < GROUP_WIDTH)
+                control[capacity + index] = value;
+        }
+
+        void EraseAt(size_t index)
+        {
+            std::destroy_at(&slots[index].value);
+            element_count--;
+
+            // A slot that no probe ever had to pass can become empty again, instead of a tombstone.
+            // That holds when the empty slots around it leave no full group window that covers it.
+            size_t mask = capacity - 1;
+            uint32_t empty_after = Group(control + index).MatchEmpty();
+            uint32_t empty_before = Group(control + ((index - GROUP_WIDTH) & mask)).MatchEmpty();
+
+            bool never_full = empty_before != 0 && empty_after != 0
+                && static_cast<size_t>(std::countr_zero(empty_after) + std::countl_zero(static_cast<uint16_t>(empty_before))) < GROUP_WIDTH;
+
+            SetControl(index, never_full ? CTRL_EMPTY : CTRL_DELETED);
+            growth_left += never_full ? 1 : 0;
+        }
+
+        void Grow()
+        {
+            // Mostly tombstones, rebuilding at the same size is enough
+            if (capacity != 0 && element_count <= MaxLoad(capacity) / 2)
+                Resize(capacity);
+            else
+                Resize(capacity == 0 ? GROUP_WIDTH : capacity * 2);
+        }
+
+        void Resize(size_t new_capacity)
+        {
+            ControlByte* old_control = control;
+            Slot* old_slots = slots;
+            size_t old_capacity = capacity;
+
+            ControlAllocator control_allocator { allocator };
+            SlotAllocator slot_allocator { allocator };
+
+            control = std::allocator_traits<ControlAllocator>::allocate(control_allocator, new_capacity + GROUP_WIDTH);
+            slots = std::allocator_traits<SlotAllocator>::allocate(slot_allocator, new_capacity);
+            capacity = new_capacity;
+            std::memset(control, static_cast<uint8_t>(CTRL_EMPTY), new_capacity + GROUP_WIDTH);
+
+            for (size_t i = 0; i < old_capacity; i++)
+            {
+                if (old_control[i] < 0)
+                    continue;
+
+                size_t hash_value = HashOf(Policy::GetKey(old_slots[i].value));
+                size_t index = FindFirstNonFull(hash_value);
+                Policy::Transfer(&slots[index], &old_slots[i]);
+                SetControl(index, H2(hash_value));
+            }
+
+            growth_left = MaxLoad(capacity) - element_count;
+
+            if (old_capacity != 0)
+            {
+                std::allocator_traits<ControlAllocator>::deallocate(control_allocator, old_control, old_capacity + GROUP_WIDTH);
+                std::allocator_traits<SlotAllocator>::deallocate(slot_allocator, old_slots, old_capacity);
+            }
+        }
+
+        void DestroyAll()
+        {
+            if (capacity == 0)
+                return;
+
+            clear();
+
+            ControlAllocator control_allocator { allocator };
+            SlotAllocator slot_allocator { allocator };
+            std::allocator_traits<ControlAllocator>::deallocate(control_allocator, control, capacity + GROUP_WIDTH);
+            std::allocator_traits<SlotAllocator>::deallocate(slot_allocator, slots, capacity);
+
+            ResetEmpty();
+        }
+
+        void StealFrom(FlatHashTable& other)
+        {
+            control = std::exchange(other.control, const_cast<ControlByte*>(EMPTY_CONTROL));
+            slots = std::exchange(other.slots, nullptr);
+            capacity = std::exchange(other.capacity, 0);
+            element_count = std::exchange(other.element_count, 0);
+            growth_left = std::exchange(other.growth_left, 0);
+        }
+
+        void ResetEmpty()
+        {
+            control = const_cast<ControlByte*>(EMPTY_CONTROL);
+            slots = nullptr;
+            capacity = 0;
+            element_count = 0;
+            growth_left = 0;
+        }
+
+        // Never written while capacity is zero
+        ControlByte* control = const_cast<ControlByte*>(EMPTY_CONTROL);
+        Slot* slots = nullptr;
+        size_t capacity = 0;
+        size_t element_count = 0;
+        size_t growth_left = 0;
+        size_t pending_hash = 0;
+
+        [[no_unique_address]] Hash hash {};
+        [[no_unique_address]] Equal equal {};
+        [[no_unique_address]] Allocator allocator {};
+    };
+}
+
+// Open addressing hash map that stores its elements in one flat array (Swiss table design).
+// Lookups compare sixteen 7 bit hash fragments at once, so a probe rarely touches an element that does not match.
+// Unlike std::unordered_map, inserting or rehashing moves elements: references and iterators are only stable
+// until the next insertion. Erasing does not move other elements.
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>,
+    typename Allocator = std::allocator<std::pair<const K, V>>>
+class FlatHashMap : public detail::FlatHashTable<detail::FlatMapPolicy<K, V>, Hash, Equal, Allocator>
+{
+    using Base = detail::FlatHashTable<detail::FlatMapPolicy<K, V>, Hash, Equal, Allocator>;
+
+public:
+    using mapped_type = V;
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using Base::Base;
+
+    // Only constructs the value when the key is not present yet
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        requires(std::is_same_v<std::remove_cvref_t<Key>, K> || detail::TransparentLookup<Hash, Equal>)
+    {
+        auto [index, inserted] = this->FindOrPrepareInsert(key);
+        if (inserted)
+        {
+            new (&this->SlotAt(index)->value) typename Base::value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+            this->CommitInsert(index);
+        }
+        return { this->IteratorAt(index), inserted };
+    }
+
+    template <typename Key, typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value)
+    {
+        auto result = try_emplace(std::forward<Key>(key), std::forward<M>(value));
+        if (!result.second)
+            result.first->second = std::forward<M>(value);
+        return result;
+    }
+
+    template <typename Key>
+    V& operator[](Key&& key)
+        requires(std::is_same_v<std::remove_cvref_t<Key>, K> || detail::TransparentLookup<Hash, Equal>)
+    {
+        return try_emplace(std::forward<Key>(key)).first->second;
+    }
+
+    template <typename Key>
+    V& at(const Key& key)
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+            throw std::out_of_range("FlatHashMap::at key not found");
+        return it->second;
+    }
+
+    template <typename Key>
+    const V& at(const Key& key) const
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+            throw std::out_of_range("FlatHashMap::at key not found");
+        return it->second;
+    }
+};
+
+// Set version of FlatHashMap, the same stability rules apply
+template <typename K, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>, typename Allocator = std::allocator<K>>
+class FlatHashSet : public detail::FlatHashTable<detail::FlatSetPolicy<K>, Hash, Equal, Allocator>
+{
+    using Base = detail::FlatHashTable<detail::FlatSetPolicy<K>, Hash, Equal, Allocator>;
+
+public:
+    using Base::Base;
+};
+
+namespace Tests
+{
+    void TestFlatHashMap();
+}
+
+}
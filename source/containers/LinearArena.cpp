@@ -0,0 +1,212 @@
+#include "LinearArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <tools/MemoryTracker.hpp>
+
+namespace
+{
+
+// Blocks only need the strictest fundamental alignment, larger alignments are handled per allocation
+constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+KS::LinearArena::LinearArena(size_t initial_size, std::pmr::memory_resource* upstream)
+    : upstream(upstream)
+{
+    if (initial_size != 0)
+        AddBlock(initial_size);
+}
+
+KS::LinearArena::~LinearArena()
+{
+    ReleaseBlocks();
+}
+
+void* KS::LinearArena::Allocate(size_t byte_count, size_t alignment)
+{
+    ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+    if (blocks.empty())
+        AddBlock(std::max(DEFAULT_BLOCK_SIZE, byte_count + alignment));
+
+    while (true)
+    {
+        Block& block = blocks[current];
+
+        // Aligned on the address, blocks themselves may be less aligned than the request
+        auto address = reinterpret_cast<uintptr_t>(block.data) + block.offset;
+        size_t start = block.offset + (AlignUp(address, alignment) - address);
+
+        if (start + byte_count <= block.size)
+        {
+            block.offset = start + byte_count;
+            peak = std::max(peak, used_in_previous_blocks + block.offset);
+            return block.data + start;
+        }
+
+        // Blocks left over from before a Rewind are reused before asking upstream for more
+        used_in_previous_blocks += block.offset;
+
+        if (current + 1 == blocks.size())
+            AddBlock(std::max(blocks.back().size * 2, byte_count + alignment));
+
+        current++;
+        blocks[current].offset = 0;
+    }
+}
+
+void KS::LinearArena::Rewind(Marker marker)
+{
+    if (blocks.empty())
+        return;
+
+    ASSERT((marker.block < current || (marker.block == current && marker.offset <= blocks[current].offset))
+        && "Rewinding to a marker that is ahead of the arena");
+
+    for (size_t i = marker.block; i < current; i++)
+        used_in_previous_blocks -= blocks[i].offset;
+
+    for (size_t i = marker.block + 1; i <= current; i++)
+        blocks[i].offset = 0;
+
+    current = marker.block;
+    blocks[current].offset = marker.offset;
+}
+
+void KS::LinearArena::Reset()
+{
+    // Everything needed last time fits in one block from now on
+    if (blocks.size() > 1)
+    {
+        size_t total = GetCapacity();
+        ReleaseBlocks();
+        AddBlock(total);
+    }
+
+    for (auto& block : blocks)
+        block.offset = 0;
+
+    current = 0;
+    used_in_previous_blocks = 0;
+}
+
+size_t KS::LinearArena::GetUsed() const
+{
+    return blocks.empty() ? 0 : used_in_previous_blocks + blocks[current].offset;
+}
+
+size_t KS::LinearArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : blocks)
+        capacity += block.size;
+    return capacity;
+}
+
+void KS::LinearArena::AddBlock(size_t min_size)
+{
+    size_t size = AlignUp(min_size, BLOCK_ALIGNMENT);
+    blocks.emplace_back(Block { static_cast<std::byte*>(upstream->allocate(size, BLOCK_ALIGNMENT)), size, 0 });
+}
+
+void KS::LinearArena::ReleaseBlocks()
+{
+    for (const auto& block : blocks)
+        upstream->deallocate(block.data, block.size, BLOCK_ALIGNMENT);
+
+    blocks.clear();
+    current = 0;
+    used_in_previous_blocks = 0;
+}
+
+KS::LinearArena& KS::GetScratchArena()
+{
+    thread_local LinearArena arena { 256 * 1024, GetTrackedResource(MemoryTag::SCRATCH) };
+    return arena;
+}
+
+void KS::Tests::TestLinearArena()
+{
+    LinearArena arena { 1024 };
+
+    // Allocations are aligned and do not overlap
+    auto* a = static_cast<std::byte*>(arena.Allocate(10, 1));
+    auto* b = static_cast<std::byte*>(arena.Allocate(64, 64));
+
+    if (reinterpret_cast<uintptr_t>(b) % 64 != 0 || b < a + 10)
+    {
+        throw;
+    }
+
+    // Growing past the first block
+    for (int i = 0; i < 100; i++)
+    {
+        arena.Allocate(100, 16);
+    }
+
+    if (arena.GetCapacity() <= 1024 || arena.GetUsed() < 100 * 100)
+    {
+        throw;
+    }
+
+    // After a reset the same work fits without growing again
+    size_t peak = arena.GetPeak();
+    arena.Reset();
+    size_t capacity = arena.GetCapacity();
+
+    if (arena.GetUsed() != 0 || capacity < peak)
+    {
+        throw;
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        arena.Allocate(100, 16);
+    }
+
+    if (arena.GetCapacity() != capacity)
+    {
+        throw;
+    }
+
+    // Scopes give back what was allocated inside them, also across blocks
+    arena.Reset();
+    arena.Allocate(100);
+    size_t before = arena.GetUsed();
+    {
+        ScratchScope scope { arena };
+
+        ArenaVector<int> numbers { scope.GetAllocator<int>() };
+        for (int i = 0; i < 10000; i++)
+        {
+            numbers.push_back(i);
+        }
+
+        if (numbers[9999] != 9999 || arena.GetUsed() <= before)
+        {
+            throw;
+        }
+    }
+
+    if (arena.GetUsed() != before)
+    {
+        throw;
+    }
+
+    // Works as a memory resource for pmr containers
+    std::pmr::vector<int> pmr_numbers { &arena };
+    pmr_numbers.assign(100, 3);
+
+    ArenaString text { "Long enough to not fit the small string buffer", ArenaAllocator<char>(arena) };
+    if (pmr_numbers[99] != 3 || text.size() < 16)
+    {
+        throw;
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <code_utility.hpp>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KS
+{
+
+// Bump allocator for memory that all dies at the same time (one frame, one task).
+// Individual deallocations do nothing, Reset releases everything at once.
+// Grows by adding blocks from the upstream resource. After a Reset the blocks are merged into one,
+// so a workload that repeats (a frame) stops allocating from upstream after its first run.
+// Not thread safe, every thread needs its own arena.
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    LinearArena(size_t initial_size = DEFAULT_BLOCK_SIZE, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~LinearArena() override;
+
+    NON_COPYABLE(LinearArena);
+    NON_MOVABLE(LinearArena);
+
+    // Position in the arena, everything allocated after it can be released with Rewind
+    struct Marker
+    {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    void* Allocate(size_t byte_count, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args)
+    {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    Marker GetMarker() const { return { current, blocks.empty() ? 0 : blocks[current].offset }; }
+    void Rewind(Marker marker);
+
+    // Invalidates every allocation, no destructors are run
+    void Reset();
+
+    size_t GetUsed() const;
+    size_t GetCapacity() const;
+
+    // Most memory in use at once since the arena was created
+    size_t GetPeak() const { return peak; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return Allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override { }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct Block
+    {
+        std::byte* data {};
+        size_t size {};
+        size_t offset {};
+    };
+
+    void AddBlock(size_t min_size);
+    void ReleaseBlocks();
+
+    std::pmr::memory_resource* upstream {};
+    std::vector<Block> blocks {};
+    size_t current = 0;
+    size_t used_in_previous_blocks = 0;
+    size_t peak = 0;
+};
+
+// STL allocator on top of an arena, cheaper than std::pmr::polymorphic_allocator since nothing is virtual.
+// Deallocation is a no-op, containers that grow leave their old storage behind until the arena is reset.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(LinearArena& arena) noexcept
+        : arena(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena(other.GetArena())
+    {
+    }
+
+    T* allocate(size_t count) { return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept { }
+
+    LinearArena* GetArena() const { return arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.GetArena(); }
+
+private:
+    LinearArena* arena {};
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+// Arena of the calling thread for short lived temporary work, meant to be used through ScratchScope
+LinearArena& GetScratchArena();
+
+// Releases everything allocated from the scratch arena while the scope was alive.
+// Scopes nest, as long as inner scopes end before outer ones.
+class ScratchScope
+{
+public:
+    ScratchScope(LinearArena& arena = GetScratchArena())
+        : arena(arena)
+        , marker(arena.GetMarker())
+    {
+    }
+
+    ~ScratchScope() { arena.Rewind(marker); }
+
+    NON_COPYABLE(ScratchScope);
+    NON_MOVABLE(ScratchScope);
+
+    LinearArena& GetArena() const { return arena; }
+
+    template <typename T>
+    ArenaAllocator<T> GetAllocator() const { return ArenaAllocator<T>(arena); }
+
+private:
+    LinearArena& arena;
+    LinearArena::Marker marker;
+};
+
+namespace Tests
+{
+    void TestLinearArena();
+}
+
+}
@@ -0,0 +1,120 @@
+#include "MPMCQueue.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+void KS::Tests::TestMPMCQueue()
+{
+    // Single threaded behaviour matches a plain FIFO
+    {
+        MPMCQueue<int> queue { 4 };
+        int items[6] = { 0, 1, 2, 3, 4, 5 };
+
+        if (queue.TryPushBatch(items) != 4 || queue.TryPush(9) || queue.TryPop().value() != 0 || !queue.TryPush(9))
+        {
+            throw;
+        }
+
+        int popped[8] {};
+        if (queue.TryPopBatch(popped) != 4 || popped[0] != 1 || popped[3] != 9 || queue.TryPop().has_value())
+        {
+            throw;
+        }
+    }
+
+    // Remaining items are destroyed with the queue
+    auto shared = std::make_shared<int>(1);
+    {
+        MPMCQueue<std::shared_ptr<int>> queue { 4 };
+        queue.TryPush(shared);
+        queue.TryPush(shared);
+    }
+
+    if (shared.use_count() != 1)
+    {
+        throw;
+    }
+
+    // Every item arrives exactly once with several producers and consumers,
+    // and the items of one producer arrive in the order they were pushed
+    {
+        constexpr uint32_t PRODUCERS = 4;
+        constexpr uint32_t CONSUMERS = 4;
+        constexpr uint64_t PER_PRODUCER = 50000;
+
+        MPMCQueue<uint64_t> queue { 128 };
+        std::atomic<uint64_t> consumed { 0 };
+        std::vector<std::vector<uint32_t>> seen(CONSUMERS, std::vector<uint32_t>(PRODUCERS * PER_PRODUCER));
+        std::atomic<bool> in_order { true };
+
+        std::vector<std::thread> threads {};
+        for (uint64_t p = 0; p < PRODUCERS; p++)
+        {
+            threads.emplace_back([&, p]()
+            {
+                for (uint64_t i = 0; i < PER_PRODUCER;)
+                {
+                    if (queue.TryPush(p * PER_PRODUCER + i))
+                        i++;
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        for (uint32_t c = 0; c < CONSUMERS; c++)
+        {
+            threads.emplace_back([&, c]()
+            {
+                std::vector<int64_t> last(PRODUCERS, -1);
+                uint64_t batch[4] {};
+
+                while (consumed.load() < PRODUCERS * PER_PRODUCER)
+                {
+                    size_t count = queue.TryPopBatch(batch);
+                    if (count == 0)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        uint64_t producer = batch[i] / PER_PRODUCER;
+                        auto index = static_cast<int64_t>(batch[i] % PER_PRODUCER);
+
+                        if (index <= last[producer])
+                            in_order = false;
+
+                        last[producer] = index;
+                        seen[c][batch[i]]++;
+                    }
+
+                    consumed += count;
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (uint64_t i = 0; i < PRODUCERS * PER_PRODUCER; i++)
+        {
+            uint32_t total = 0;
+            for (const auto& consumer : seen)
+                total += consumer[i];
+
+            if (total != 1)
+            {
+                throw;
+            }
+        }
+
+        if (!in_order || consumed != PRODUCERS * PER_PRODUCER || !queue.EmptyApprox())
+        {
+            throw;
+        }
+    }
+}
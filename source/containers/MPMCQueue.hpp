@@ -0,0 +1,211 @@
+#pragma once
+#include <containers/SPSCQueue.hpp>
+
+namespace KS
+{
+
+// Bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's design).
+// Every cell carries a sequence number that says whether it is ready to be written or read for a
+// given position, so producers and consumers only contend on their own index.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class MPMCQueue
+{
+public:
+    using value_type = T;
+
+    explicit MPMCQueue(size_t capacity);
+    ~MPMCQueue();
+
+    NON_COPYABLE(MPMCQueue);
+    NON_MOVABLE(MPMCQueue);
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args);
+    bool TryPush(const T& item) { return TryEmplace(item); }
+    bool TryPush(T&& item) { return TryEmplace(std::move(item)); }
+
+    std::optional<T> TryPop();
+    bool TryPop(T& out);
+
+    // Batches keep their order but are not atomic as a whole, other threads may interleave with them.
+    // They return how many items were moved, from the front of the span.
+    size_t TryPushBatch(std::span<T> items);
+    size_t TryPopBatch(std::span<T> out);
+
+    size_t SizeApprox() const;
+    bool EmptyApprox() const { return SizeApprox() == 0; }
+    size_t Capacity() const { return mask + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence {};
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T* Get() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // Claims the cell for the next write or read position, null when the queue is full or empty
+    Cell* ClaimPush(size_t& position);
+    Cell* ClaimPop(size_t& position);
+
+    alignas(CACHE_LINE_SIZE) std::unique_ptr<Cell[]> cells {};
+    size_t mask = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_position { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_position { 0 };
+};
+
+template <typename T>
+inline MPMCQueue<T>::MPMCQueue(size_t capacity)
+{
+    size_t size = detail::NextPowerOfTwo(capacity < 2 ? 2 : capacity);
+    cells = std::make_unique<Cell[]>(size);
+    mask = size - 1;
+
+    for (size_t i = 0; i < size; i++)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline MPMCQueue<T>::~MPMCQueue()
+{
+    size_t position = 0;
+    while (Cell* cell = ClaimPop(position))
+    {
+        cell->Get()->~T();
+        cell->sequence.store(position + mask + 1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+inline typename MPMCQueue<T>::Cell* MPMCQueue<T>::ClaimPush(size_t& position)
+{
+    position = enqueue_position.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Cell* cell = &cells[position & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (difference == 0)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return cell;
+        }
+        else if (difference < 0)
+        {
+            return nullptr; // Still holds an item from the previous lap
+        }
+        else
+        {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+inline typename MPMCQueue<T>::Cell* MPMCQueue<T>::ClaimPop(size_t& position)
+{
+    position = dequeue_position.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Cell* cell = &cells[position & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+        if (difference == 0)
+        {
+            if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return cell;
+        }
+        else if (difference < 0)
+        {
+            return nullptr; // Not written yet
+        }
+        else
+        {
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+template <typename... Args>
+inline bool MPMCQueue<T>::TryEmplace(Args&&... args)
+{
+    size_t position = 0;
+    Cell* cell = ClaimPush(position);
+    if (cell == nullptr)
+        return false;
+
+    new (cell->storage) T(std::forward<Args>(args)...);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline bool MPMCQueue<T>::TryPop(T& out)
+{
+    size_t position = 0;
+    Cell* cell = ClaimPop(position);
+    if (cell == nullptr)
+        return false;
+
+    T* item = cell->Get();
+    out = std::move(*item);
+    item->~T();
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline std::optional<T> MPMCQueue<T>::TryPop()
+{
+    size_t position = 0;
+    Cell* cell = ClaimPop(position);
+    if (cell == nullptr)
+        return std::nullopt;
+
+    T* item = cell->Get();
+    std::optional<T> out { std::move(*item) };
+    item->~T();
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return out;
+}
+
+template <typename T>
+inline size_t MPMCQueue<T>::TryPushBatch(std::span<T> items)
+{
+    size_t count = 0;
+    while (count < items.size() && TryEmplace(std::move(items[count])))
+        count++;
+    return count;
+}
+
+template <typename T>
+inline size_t MPMCQueue<T>::TryPopBatch(std::span<T> out)
+{
+    size_t count = 0;
+    while (count < out.size() && TryPop(out[count]))
+        count++;
+    return count;
+}
+
+template <typename T>
+inline size_t MPMCQueue<T>::SizeApprox() const
+{
+    size_t dequeued = dequeue_position.load(std::memory_order_acquire);
+    size_t enqueued = enqueue_position.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+namespace Tests
+{
+    void TestMPMCQueue();
+}
+
+}
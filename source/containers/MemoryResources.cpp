@@ -0,0 +1,67 @@
+#include "MemoryResources.hpp"
+
+#include <code_utility.hpp>
+#include <new>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+size_t KS::PageMemoryResource::GetPageSize()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info {};
+    GetSystemInfo(&info);
+
+    // Reservations are made at allocation granularity, not page size
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void* KS::PageMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    // Pages are aligned to at least the page size, larger alignments are not supported
+    ASSERT(alignment <= GetPageSize() && "Alignment larger than a page");
+    (void)alignment;
+
+#if defined(_WIN32)
+    void* ptr = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+#else
+    void* ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        throw std::bad_alloc();
+#endif
+
+    return ptr;
+}
+
+void KS::PageMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t)
+{
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    ::munmap(ptr, bytes);
+#endif
+}
+
+bool KS::PageMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    // Stateless, any instance can free the memory of another
+    return dynamic_cast<const PageMemoryResource*>(&other) != nullptr;
+}
+
+KS::PageMemoryResource* KS::GetPageResource()
+{
+    static PageMemoryResource resource {};
+    return &resource;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <memory_resource>
+
+namespace KS
+{
+
+// Allocates whole pages directly from the OS (mmap / VirtualAlloc), freed memory goes straight back.
+// Meant for large, long lived buffers (textures, meshes) that would otherwise fragment the heap.
+class PageMemoryResource : public std::pmr::memory_resource
+{
+public:
+    static size_t GetPageSize();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+// Shared instance, the resource has no state
+PageMemoryResource* GetPageResource();
+
+}
@@ -0,0 +1,119 @@
+#include "SPSCQueue.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+void KS::Tests::TestSPSCQueue()
+{
+    // Capacity is rounded up, full and empty are reported
+    {
+        SPSCQueue<int> queue { 3 };
+        if (queue.Capacity() != 4 || queue.TryPop().has_value())
+        {
+            throw;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (!queue.TryPush(i))
+            {
+                throw;
+            }
+        }
+
+        if (queue.TryPush(4) || queue.SizeApprox() != 4 || queue.TryPop().value() != 0)
+        {
+            throw;
+        }
+    }
+
+    // Batches wrap around the end of the ring and stop at what fits
+    {
+        SPSCQueue<int> queue { 8 };
+        int first[6] = { 0, 1, 2, 3, 4, 5 };
+        int popped[8] {};
+
+        if (queue.TryPushBatch(first) != 6 || queue.TryPopBatch(std::span(popped, 4)) != 4 || popped[3] != 3)
+        {
+            throw;
+        }
+
+        int second[8] = { 6, 7, 8, 9, 10, 11, 12, 13 };
+        if (queue.TryPushBatch(second) != 6 || queue.TryPopBatch(popped) != 8 || popped[0] != 4 || popped[7] != 11)
+        {
+            throw;
+        }
+    }
+
+    // Items left in the queue are destroyed with it, moved out items exactly once
+    auto shared = std::make_shared<int>(1);
+    {
+        SPSCQueue<std::shared_ptr<int>> queue { 4 };
+        queue.TryPush(shared);
+        queue.TryPush(shared);
+        auto popped = queue.TryPop();
+
+        if (shared.use_count() != 3 || !popped)
+        {
+            throw;
+        }
+    }
+
+    if (shared.use_count() != 1)
+    {
+        throw;
+    }
+
+    // Order and contents survive a producer and consumer running at the same time
+    {
+        constexpr uint64_t COUNT = 200000;
+        SPSCQueue<uint64_t> queue { 64 };
+
+        std::thread producer([&]()
+        {
+            uint64_t batch[16] {};
+            for (uint64_t i = 0; i < COUNT;)
+            {
+                // Mix single pushes and batches
+                if (i % 3 == 0)
+                {
+                    size_t count = 0;
+                    for (; count < 16 && i + count < COUNT; count++)
+                        batch[count] = i + count;
+
+                    size_t pushed = queue.TryPushBatch(std::span(batch, count));
+                    i += pushed;
+                    if (pushed == 0)
+                        std::this_thread::yield();
+                }
+                else if (queue.TryPush(i))
+                    i++;
+                else
+                    std::this_thread::yield();
+            }
+        });
+
+        uint64_t expected = 0;
+        bool in_order = true;
+        uint64_t batch[8] {};
+
+        while (expected < COUNT)
+        {
+            size_t count = queue.TryPopBatch(batch);
+            if (count == 0)
+                std::this_thread::yield();
+
+            for (size_t i = 0; i < count; i++)
+                in_order &= batch[i] == expected++;
+        }
+
+        producer.join();
+
+        if (!in_order || !queue.EmptyApprox())
+        {
+            throw;
+        }
+    }
+}
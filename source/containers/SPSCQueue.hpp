@@ -0,0 +1,214 @@
+#pragma once
+#include <atomic>
+#include <code_utility.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace KS
+{
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Head and tail live on their own cache lines, and each side keeps a cached copy of the other side's
+// index so most operations do not touch the other thread's cache line at all.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SPSCQueue
+{
+public:
+    using value_type = T;
+
+    explicit SPSCQueue(size_t capacity);
+    ~SPSCQueue();
+
+    NON_COPYABLE(SPSCQueue);
+    NON_MOVABLE(SPSCQueue);
+
+    // Producer side
+    template <typename... Args>
+    bool TryEmplace(Args&&... args);
+    bool TryPush(const T& item) { return TryEmplace(item); }
+    bool TryPush(T&& item) { return TryEmplace(std::move(item)); }
+
+    // Moves as many items as fit, returns how many were pushed (always from the front of items)
+    size_t TryPushBatch(std::span<T> items);
+
+    // Consumer side
+    std::optional<T> TryPop();
+    bool TryPop(T& out);
+
+    // Moves up to out.size() items into out, returns how many were popped
+    size_t TryPopBatch(std::span<T> out);
+
+    // Exact only when called from the producer or consumer while the other side is idle
+    size_t SizeApprox() const;
+    bool EmptyApprox() const { return SizeApprox() == 0; }
+    size_t Capacity() const { return mask + 1; }
+
+private:
+    struct Slot
+    {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    T* At(size_t index) { return std::launder(reinterpret_cast<T*>(slots[index & mask].storage)); }
+
+    // Written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head { 0 };
+    size_t cached_tail = 0;
+
+    // Written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail { 0 };
+    size_t cached_head = 0;
+
+    alignas(CACHE_LINE_SIZE) std::unique_ptr<Slot[]> slots {};
+    size_t mask = 0;
+};
+
+namespace detail
+{
+    inline size_t NextPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+}
+
+template <typename T>
+inline SPSCQueue<T>::SPSCQueue(size_t capacity)
+{
+    size_t size = detail::NextPowerOfTwo(capacity < 2 ? 2 : capacity);
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+}
+
+template <typename T>
+inline SPSCQueue<T>::~SPSCQueue()
+{
+    size_t end = tail.load(std::memory_order_relaxed);
+    for (size_t i = head.load(std::memory_order_relaxed); i != end; i++)
+        At(i)->~T();
+}
+
+template <typename T>
+template <typename... Args>
+inline bool SPSCQueue<T>::TryEmplace(Args&&... args)
+{
+    size_t current = tail.load(std::memory_order_relaxed);
+
+    if (current - cached_head > mask)
+    {
+        cached_head = head.load(std::memory_order_acquire);
+        if (current - cached_head > mask)
+            return false;
+    }
+
+    new (slots[current & mask].storage) T(std::forward<Args>(args)...);
+    tail.store(current + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::TryPushBatch(std::span<T> items)
+{
+    size_t current = tail.load(std::memory_order_relaxed);
+    size_t free = Capacity() - (current - cached_head);
+
+    if (free < items.size())
+    {
+        cached_head = head.load(std::memory_order_acquire);
+        free = Capacity() - (current - cached_head);
+    }
+
+    size_t count = free < items.size() ? free : items.size();
+    for (size_t i = 0; i < count; i++)
+        new (slots[(current + i) & mask].storage) T(std::move(items[i]));
+
+    // One release for the whole batch
+    if (count != 0)
+        tail.store(current + count, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::TryPop(T& out)
+{
+    size_t current = head.load(std::memory_order_relaxed);
+
+    if (current == cached_tail)
+    {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (current == cached_tail)
+            return false;
+    }
+
+    T* item = At(current);
+    out = std::move(*item);
+    item->~T();
+    head.store(current + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+inline std::optional<T> SPSCQueue<T>::TryPop()
+{
+    size_t current = head.load(std::memory_order_relaxed);
+
+    if (current == cached_tail)
+    {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (current == cached_tail)
+            return std::nullopt;
+    }
+
+    T* item = At(current);
+    std::optional<T> out { std::move(*item) };
+    item->~T();
+    head.store(current + 1, std::memory_order_release);
+    return out;
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::TryPopBatch(std::span<T> out)
+{
+    size_t current = head.load(std::memory_order_relaxed);
+    size_t available = cached_tail - current;
+
+    if (available < out.size())
+    {
+        cached_tail = tail.load(std::memory_order_acquire);
+        available = cached_tail - current;
+    }
+
+    size_t count = available < out.size() ? available : out.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        T* item = At(current + i);
+        out[i] = std::move(*item);
+        item->~T();
+    }
+
+    if (count != 0)
+        head.store(current + count, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::SizeApprox() const
+{
+    size_t current_head = head.load(std::memory_order_acquire);
+    size_t current_tail = tail.load(std::memory_order_acquire);
+    return current_tail - current_head;
+}
+
+namespace Tests
+{
+    void TestSPSCQueue();
+}
+
+}
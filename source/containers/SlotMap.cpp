@@ -1,6 +1,7 @@
 #include "SlotMap.hpp"
 
 #include <memory>
+#include <string>
 
 void KS::Tests::TestSlotMap()
 {
@@ -34,6 +35,20 @@ void KS::Tests::TestSlotMap()
         throw;
     }
 
+    // Two inserts after an erase have to end up in different slots
+    auto key4 = IntCache.Insert(32);
+
+    if (key4 == key2 || *IntCache.Get(key2) != 31 || *IntCache.Get(key4) != 32)
+    {
+        throw;
+    }
+
+    // Erased keys stay invalid when their slot gets reused
+    if (IntCache.Get(key) != nullptr || IntCache.Erase(key))
+    {
+        throw;
+    }
+
     SlotMap<std::shared_ptr<float>> FloatCache;
 
     auto float_elem = std::make_shared<float>(13.8f);
@@ -50,4 +65,71 @@ void KS::Tests::TestSlotMap()
     {
         throw;
     }
+
+    // Reusing the slot constructs a new value instead of assigning to a destroyed one
+    auto key5 = FloatCache.Insert(float_elem);
+
+    if (float_elem.use_count() != 2 || FloatCache.Get(key5)->get() != float_elem.get())
+    {
+        throw;
+    }
+
+    FloatCache.Clear();
+
+    if (float_elem.use_count() != 1 || FloatCache.Contains(key5) || !FloatCache.Empty())
+    {
+        throw;
+    }
+
+    // Erasing moves the last value into the gap, all other keys keep working
+    SlotMap<std::string> StringCache;
+    StringCache.Reserve(4);
+
+    auto a = StringCache.Emplace(3, 'a');
+    auto b = StringCache.Emplace("b");
+    auto c = StringCache.Insert(std::string("c"));
+
+    StringCache.Erase(a);
+
+    if (StringCache.Size() != 2 || *StringCache.Get(b) != "b" || *StringCache.Get(c) != "c")
+    {
+        throw;
+    }
+
+    // Values are packed, and the key of every position matches its value
+    std::string joined {};
+    for (const auto& str : StringCache)
+    {
+        joined += str;
+    }
+
+    if (joined.size() != 2 || StringCache.GetValues().size() != 2)
+    {
+        throw;
+    }
+
+    for (size_t i = 0; i < StringCache.Size(); i++)
+    {
+        if (StringCache.Get(StringCache.GetKeyAt(i)) != &StringCache[i])
+        {
+            throw;
+        }
+    }
+
+    // Slots are retired before their version wraps around, so old keys can never match a new value
+    SlotMap<int, uint8_t> SmallVersions;
+
+    auto first = SmallVersions.Insert(0);
+    auto last = first;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        SmallVersions.Erase(last);
+        last = SmallVersions.Insert(i);
+
+        if (SmallVersions.Contains(first) || SmallVersions.Size() != 1 || *SmallVersions.Get(last) != i)
+        {
+            throw;
+        }
+    }
 }
@@ -1,62 +1,63 @@
 #pragma once
+#include <code_utility.hpp>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace KS
 {
 
-// Not used currently, could be useful for something
-template <typename T>
+// Stores values densely, addressed through keys that stay valid until the value is erased.
+// Keys hold a slot index and a version, so erased keys are detected instead of aliasing newer values.
+// Iteration goes over the packed value array, erasing moves the last value into the gap (order is not kept).
+// Pointers to values are only stable until the next insert or erase.
+template <typename T, typename V = uint32_t>
 class SlotMap
 {
 public:
+    static_assert(std::is_unsigned_v<V> && sizeof(V) <= sizeof(uint32_t), "Versions have to fit in the lower half of a key");
+
     using Key = uint64_t;
-    using Version = uint32_t;
+    using Version = V;
     using Index = uint32_t;
-    using Self = SlotMap<T>;
+    using Self = SlotMap<T, V>;
+
+    static constexpr Key NULL_KEY = std::numeric_limits<Key>::max();
 
     void Reserve(size_t capacity)
     {
-        storage.reserve(capacity);
+        slots.reserve(capacity);
+        values.reserve(capacity);
+        value_slots.reserve(capacity);
     }
 
+    // Invalidates all existing keys
     void Clear()
     {
-        storage.clear();
-        free_list.clear();
+        while (!values.empty())
+        {
+            Index slot = value_slots.back();
+            Erase(MakeKey(slot, slots[slot].version));
+        }
     }
 
-    size_t Size() const
-    {
-        return storage.size();
-    }
+    size_t Size() const { return values.size(); }
+    bool Empty() const { return values.empty(); }
 
     bool Contains(Key k) const
     {
-
         auto [index, version] = SplitKey(k);
-
-        if (index >= storage.size())
-        {
-            return false;
-        }
-
-        auto& [current_version, element] = storage.at(index);
-
-        if (current_version != version)
-        {
-            return false;
-        }
-
-        return true;
+        return index < slots.size() && slots[index].version == version && IsOccupied(version);
     }
 
     const T* Get(Key k) const
     {
         if (Contains(k))
         {
-            auto [index, version] = SplitKey(k);
-            auto& [current_version, element] = storage.at(index);
-            return &element;
+            return &values[slots[SplitKey(k).first].value_or_next_free];
         }
 
         return nullptr;
@@ -69,59 +70,121 @@ public:
 
     Key Insert(const T& val)
     {
-        T copy = val;
-        return Insert(std::move(copy));
+        return Emplace(val);
     }
 
     Key Insert(T&& val)
     {
-        auto new_index = NewIndex();
-        auto& [version, new_element] = storage.at(new_index);
-        new_element = std::move(val);
-        return MakeKey(new_index, version);
+        return Emplace(std::move(val));
     }
 
-    void Erase(Key k)
+    template <typename... Args>
+    Key Emplace(Args&&... args)
     {
+        values.emplace_back(std::forward<Args>(args)...);
 
-        if (Contains(k))
+        Index slot_index = AcquireSlot();
+        auto& slot = slots[slot_index];
+
+        slot.value_or_next_free = static_cast<Index>(values.size() - 1);
+        slot.version++;
+
+        value_slots.emplace_back(slot_index);
+        return MakeKey(slot_index, slot.version);
+    }
+
+    // Returns false if the key was not (or no longer) in the map
+    bool Erase(Key k)
+    {
+        if (!Contains(k))
+        {
+            return false;
+        }
+
+        Index slot_index = SplitKey(k).first;
+        auto& slot = slots[slot_index];
+        Index removed = slot.value_or_next_free;
+
+        // Swap remove, the slot of the moved value points to its new position
+        if (removed != values.size() - 1)
         {
-            auto [index, version] = SplitKey(k);
-            auto& [current_version, element] = storage.at(index);
+            values[removed] = std::move(values.back());
+            value_slots[removed] = value_slots.back();
+            slots[value_slots[removed]].value_or_next_free = removed;
+        }
+
+        values.pop_back();
+        value_slots.pop_back();
 
-            free_list.emplace_back(index);
-            current_version += 1;
-            element.~T();
+        // Slots whose version is about to wrap around are retired, so stale keys can never match again
+        slot.version++;
+        if (slot.version != RETIRED_VERSION)
+        {
+            slot.value_or_next_free = free_head;
+            free_head = slot_index;
         }
+
+        return true;
     }
 
+    // Key of the value at a position in the packed array, for iterating keys and values together
+    Key GetKeyAt(size_t position) const
+    {
+        Index slot = value_slots[position];
+        return MakeKey(slot, slots[slot].version);
+    }
+
+    std::span<T> GetValues() { return values; }
+    std::span<const T> GetValues() const { return values; }
+
+    T& operator[](size_t position) { return values[position]; }
+    const T& operator[](size_t position) const { return values[position]; }
+
+    auto begin() { return values.begin(); }
+    auto end() { return values.end(); }
+    auto begin() const { return values.begin(); }
+    auto end() const { return values.end(); }
+
 private:
-    std::pair<Index, Version> SplitKey(Key k) const
+    // Odd versions are occupied, even versions are free
+    static constexpr Version RETIRED_VERSION = std::numeric_limits<Version>::max() - 1;
+    static constexpr Index NO_FREE_SLOT = std::numeric_limits<Index>::max();
+
+    struct Slot
     {
-        return { k >> 32, Version(k) };
+        Index value_or_next_free = NO_FREE_SLOT; // Position in values when occupied, next free slot otherwise
+        Version version = 0;
+    };
+
+    static bool IsOccupied(Version v) { return (v & 1) != 0; }
+
+    static std::pair<Index, Version> SplitKey(Key k)
+    {
+        return { Index(k >> 32), Version(k) };
     }
 
-    Key MakeKey(Index i, Version v) const
+    static Key MakeKey(Index i, Version v)
     {
-        return (uint64_t(i) << 32) | (uint64_t(v));
+        return (uint64_t(i) << 32) | uint64_t(v);
     }
 
-    Index NewIndex()
+    Index AcquireSlot()
     {
-        if (free_list.empty())
+        if (free_head == NO_FREE_SLOT)
         {
-            storage.emplace_back();
-            return storage.size() - 1;
+            slots.emplace_back();
+            return static_cast<Index>(slots.size() - 1);
         }
 
-        return free_list.back();
+        Index slot = free_head;
+        free_head = slots[slot].value_or_next_free;
+        return slot;
     }
 
-    // Holds pairs of version, item
-    std::vector<std::pair<Version, T>> storage {};
-
-    // Keeps track of freed elements
-    std::vector<Index> free_list {};
+    std::vector<Slot> slots {};
+    std::vector<T> values {};
+    std::vector<Index> value_slots {}; // Slot of every value, for fixing up slots after a swap remove
+    Index free_head = NO_FREE_SLOT;
 };
 
 namespace Tests
@@ -129,4 +192,4 @@ namespace Tests
     void TestSlotMap();
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <containers/FlatHashMap.hpp>
+#include <string>
+#include <string_view>
+
+namespace KS
+{
+
+// Lets string keyed maps be searched with a std::string_view or a literal, without building a std::string first
+struct StringHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const { return std::hash<std::string_view> {}(str); }
+};
+
+template <typename T>
+using StringMap = FlatHashMap<std::string, T, StringHash, std::equal_to<>>;
+
+}
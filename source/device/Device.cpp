@@ -9,8 +9,12 @@
 #include <renderer/DX12/Helpers/DXCommandList.hpp>
 #include <renderer/DX12/Helpers/DXCommandQueue.hpp>
 #include <tools/Log.hpp>
+#include <tools/MemoryTracker.hpp>
 #include "DX12/DXFactory.hpp"
 
+#define GLFW_EXPOSE_NATIVE_WIN32
+#include <GLFW/glfw3.h>
+#include <GLFW/glfw3native.h>
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_dx12.h>
@@ -63,6 +67,8 @@ public:
 KS::Device::Device(const DeviceInitParams& params)
 {
     m_impl = std::make_unique<Impl>();
+    for (int i = 0; i < FRAME_BUFFER_COUNT; i++)
+        m_frame_arenas.emplace_back(std::make_unique<LinearArena>(LinearArena::DEFAULT_BLOCK_SIZE, GetTrackedResource(MemoryTag::FRAME_ARENA)));
     m_fullscreen = false;
     m_width = params.window_width;
     m_height = params.window_height;
@@ -114,6 +120,10 @@ void KS::Device::NewFrame()
     m_frame_index = m_impl->GetFramebufferIndex();
     m_cpu_frame = (m_frame_index + 1) % FRAME_BUFFER_COUNT;
     m_impl->StartFrame(m_frame_index, m_cpu_frame, m_clear_color);
+
+    // StartFrame waited for the GPU, the last submission of this frame is done with its memory
+    m_frame_arenas[m_cpu_frame]->Reset();
+
     m_swapchainRT->Bind(*this, m_swapchainDS.get());
     m_swapchainRT->Clear(*this);
     m_swapchainDS->Clear(*this);
@@ -137,6 +147,8 @@ void KS::Device::EndFrame()
     m_impl->EndFrame(m_cpu_frame);
     ImGui::EndFrame();
     ImGui::UpdatePlatformWindows();
+
+    MemoryTracker::EndFrame();
 }
 
 void KS::Device::InitializeSwapchain()
@@ -1,14 +1,11 @@
 #pragma once
 #include <code_utility.hpp>
+#include <containers/LinearArena.hpp>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
 
-#define NOMINMAX
-#define GLFW_EXPOSE_NATIVE_WIN32
-#include <GLFW/glfw3.h>
-#include <GLFW/glfw3native.h>
 #include <glm/glm.hpp>
 #include <renderer/RenderTarget.hpp>
 #include <renderer/DepthStencil.hpp>
@@ -28,6 +25,21 @@ struct DeviceInitParams
     glm::vec4 clear_color = glm::vec4(0.25f, 0.25f, 0.25f, 1.f);
 };
 
+// What the device was asked to do since the last reset. Only the null backend counts, so headless runs
+// can check and benchmark the work the engine submits without a GPU.
+struct DeviceCounters
+{
+    uint64_t uploads = 0;
+    uint64_t upload_bytes = 0;
+    uint64_t binds = 0;
+    uint64_t barriers = 0;
+    uint64_t draws = 0;
+    uint64_t dispatches = 0;
+    uint64_t frames = 0;
+
+    void Reset() { *this = DeviceCounters {}; }
+};
+
 class Device
 {
 public:
@@ -50,6 +62,9 @@ public:
 
     unsigned int GetFrameIndex() const { return m_frame_index; }
     unsigned int GetCPUFrameIndex() const { return m_cpu_frame; }
+
+    // Memory for the frame being recorded, released by NewFrame once the GPU finished with the frame
+    LinearArena& GetFrameArena() { return *m_frame_arenas[m_cpu_frame]; }
     int GetWidth() const { return m_width; }
     int GetHeight() const { return m_height; }
     void TrackResource(::std::shared_ptr<void> buffer);
@@ -62,12 +77,16 @@ public:
     // Blocks until all rendering operations are finished
     void Flush();
 
+    // Resources count through const references, their upload functions do not change the device otherwise
+    DeviceCounters& GetCounters() const { return m_counters; }
+
     NON_COPYABLE(Device);
     NON_MOVABLE(Device);
 
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
+    std::vector<std::unique_ptr<LinearArena>> m_frame_arenas;
     bool m_window_open {};
     unsigned int m_frame_index = 0;
     unsigned int m_cpu_frame = 0;
@@ -80,6 +99,7 @@ private:
     std::shared_ptr<Texture> m_swapchainDepthTex;
     std::shared_ptr<ShaderInputCollection> m_mipMapShaderInputs;
     std::shared_ptr<Shader> m_mipMapShader;
+    mutable DeviceCounters m_counters {};
 };
 
 } // namespace KS
@@ -0,0 +1,68 @@
+#include <device/Device.hpp>
+#include <tools/MemoryTracker.hpp>
+
+// Headless device without a window or a GPU. Frames only move the frame indices and arenas along, the null resources
+// keep their contents in CPU memory and count what the engine asks of them in GetCounters.
+
+namespace
+{
+
+// As many frames in flight as the DX12 swapchain has buffers
+constexpr unsigned int NULL_FRAME_COUNT = 2;
+
+}
+
+class KS::Device::Impl
+{
+};
+
+KS::Device::Device(const DeviceInitParams& params)
+{
+    m_impl = std::make_unique<Impl>();
+    for (unsigned int i = 0; i < NULL_FRAME_COUNT; i++)
+        m_frame_arenas.emplace_back(std::make_unique<LinearArena>(LinearArena::DEFAULT_BLOCK_SIZE, GetTrackedResource(MemoryTag::FRAME_ARENA)));
+    m_width = params.window_width;
+    m_height = params.window_height;
+    m_window_open = true;
+    m_clear_color = params.clear_color;
+    m_frame_index = 0;
+    m_cpu_frame = 1;
+}
+
+KS::Device::~Device() {}
+
+void* KS::Device::GetDevice() const { return nullptr; }
+
+void* KS::Device::GetCommandList() const { return nullptr; }
+
+void* KS::Device::GetResourceHeap() const { return nullptr; }
+
+void* KS::Device::GetDepthHeap() const { return nullptr; }
+
+void* KS::Device::GetRenderTargetHeap() const { return nullptr; }
+
+void* KS::Device::GetWindowHandle() const { return nullptr; }
+
+void KS::Device::NewFrame()
+{
+    // Same order as the swapchain: the frame being recorded is the one after the frame being presented
+    m_frame_index = (m_frame_index + 1) % NULL_FRAME_COUNT;
+    m_cpu_frame = (m_frame_index + 1) % NULL_FRAME_COUNT;
+
+    // Nothing runs on a GPU, so the frame's memory is free as soon as it comes around again
+    m_frame_arenas[m_cpu_frame]->Reset();
+    m_counters.frames++;
+}
+
+void KS::Device::EndFrame() { MemoryTracker::EndFrame(); }
+
+// There is nothing to present to, GetRenderTarget and GetDepthStencil stay empty
+void KS::Device::InitializeSwapchain() {}
+
+void KS::Device::FinishInitialization() {}
+
+void KS::Device::InitializeImGUI() {}
+
+void KS::Device::TrackResource(std::shared_ptr<void> buffer) {}
+
+void KS::Device::Flush() {}
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <code_utility.hpp>
+#include <components/ComponentName.hpp>
+#include <components/ComponentTransform.hpp>
+#include <components/ComponentWorldTransform.hpp>
+#include <ecs/FixedTimestep.hpp>
+#include <ecs/SystemScheduler.hpp>
+#include <ecs/WorldSnapshot.hpp>
 #include <entt/entity/registry.hpp>
 
 namespace KS
@@ -9,13 +15,49 @@ namespace KS
 class EntityComponentSystem
 {
 public:
-    EntityComponentSystem() = default;
+    explicit EntityComponentSystem(FixedTimestep timestep = FixedTimestep {})
+        : m_timestep(timestep)
+    {
+        // Mesh renderers point at loaded models, levels recreate them through Scene::SpawnModel
+        m_serializer.Register<ComponentTransform>("Transform");
+        m_serializer.Register<ComponentWorldTransform>("WorldTransform");
+        m_serializer.Register<ComponentName>("Name");
+    }
     ~EntityComponentSystem() = default;
 
     entt::registry& GetWorld() { return m_world; }
+    SystemScheduler& GetScheduler() { return m_scheduler; }
+    const FixedTimestep& GetTimestep() const { return m_timestep; }
+
+    // The components saved in world snapshots, games register their own on top
+    WorldSerializer& GetSerializer() { return m_serializer; }
+
+    // Systems run in registration order wherever their component access conflicts, see SystemScheduler
+    SystemScheduler::SystemID AddSystem(std::string name, SystemAccess access, SystemScheduler::SystemFunction function)
+    {
+        return m_scheduler.AddSystem(std::move(name), std::move(access), std::move(function));
+    }
+
+    // Runs the systems once for every fixed step the frame time covers, each gets the step length as dt.
+    // Returns how far rendering is between the last two steps, see ComponentWorldTransform::previous.
+    float Update(float frame_milliseconds)
+    {
+        uint32_t steps = m_timestep.Advance(frame_milliseconds);
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            for (auto [entity, transform] : m_world.view<ComponentWorldTransform>().each())
+                transform.previous = transform.matrix;
+
+            m_scheduler.Run(m_world, m_timestep.GetStepMilliseconds());
+        }
+        return m_timestep.GetAlpha();
+    }
 
 private:
     entt::registry m_world;
+    SystemScheduler m_scheduler;
+    FixedTimestep m_timestep;
+    WorldSerializer m_serializer;
 };
 
-} // namespace KS
\ No newline at end of file
+} // namespace KS
@@ -0,0 +1,140 @@
+#include "FixedTimestep.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+uint32_t KS::FixedTimestep::Advance(float frame_milliseconds)
+{
+    accumulator += frame_milliseconds;
+
+    uint32_t steps = static_cast<uint32_t>(accumulator / step_milliseconds);
+    if (steps > max_steps)
+    {
+        // Catching up would make the next frame even slower, the simulation falls behind wall time instead
+        float excess = accumulator - step_milliseconds * max_steps;
+        float kept = accumulator - static_cast<float>(steps) * step_milliseconds;
+        dropped_milliseconds += excess - kept;
+        accumulator = step_milliseconds * max_steps + kept;
+        steps = max_steps;
+    }
+
+    accumulator -= static_cast<float>(steps) * step_milliseconds;
+
+    // Float error can leave the accumulator a hair outside of a step
+    accumulator = glm::clamp(accumulator, 0.0f, step_milliseconds * 0.9999f);
+
+    total_steps += steps;
+    return steps;
+}
+
+glm::mat4 KS::InterpolateTransform(const glm::mat4& from, const glm::mat4& to, float alpha)
+{
+    glm::vec3 from_scale { glm::length(glm::vec3(from[0])), glm::length(glm::vec3(from[1])), glm::length(glm::vec3(from[2])) };
+    glm::vec3 to_scale { glm::length(glm::vec3(to[0])), glm::length(glm::vec3(to[1])), glm::length(glm::vec3(to[2])) };
+
+    glm::mat3 from_rotation { glm::vec3(from[0]) / from_scale.x, glm::vec3(from[1]) / from_scale.y, glm::vec3(from[2]) / from_scale.z };
+    glm::mat3 to_rotation { glm::vec3(to[0]) / to_scale.x, glm::vec3(to[1]) / to_scale.y, glm::vec3(to[2]) / to_scale.z };
+
+    glm::quat rotation = glm::slerp(glm::quat_cast(from_rotation), glm::quat_cast(to_rotation), alpha);
+    glm::vec3 scale = glm::mix(from_scale, to_scale, alpha);
+    glm::vec3 translation = glm::mix(glm::vec3(from[3]), glm::vec3(to[3]), alpha);
+
+    glm::mat4 result = glm::mat4_cast(rotation);
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = glm::vec4(translation, 1.0f);
+    return result;
+}
+
+void KS::Tests::TestFixedTimestep()
+{
+    auto near = [](float a, float b) { return glm::abs(a - b) < 0.001f; };
+
+    // Steps are only taken once enough time has built up, the rest carries over
+    {
+        FixedTimestep timestep { 10.0f, 5 };
+
+        if (timestep.Advance(4.0f) != 0 || !near(timestep.GetAlpha(), 0.4f))
+        {
+            throw;
+        }
+
+        if (timestep.Advance(7.0f) != 1 || !near(timestep.GetAlpha(), 0.1f))
+        {
+            throw;
+        }
+
+        if (timestep.Advance(29.0f) != 3 || timestep.GetTotalSteps() != 4 || !near(timestep.GetAlpha(), 0.0f))
+        {
+            throw;
+        }
+    }
+
+    // The step count does not depend on how time is split into frames
+    {
+        FixedTimestep fast { 1000.0f / 60.0f };
+        FixedTimestep slow { 1000.0f / 60.0f };
+
+        for (int i = 0; i < 1440; i++)
+        {
+            fast.Advance(1000.0f / 144.0f);
+        }
+
+        for (int i = 0; i < 300; i++)
+        {
+            slow.Advance(1000.0f / 30.0f);
+        }
+
+        if (fast.GetTotalSteps() < 599 || fast.GetTotalSteps() > 600 || slow.GetTotalSteps() < 599 || slow.GetTotalSteps() > 600)
+        {
+            throw;
+        }
+    }
+
+    // A long stall is capped and the rest dropped, the fraction of a step is kept
+    {
+        FixedTimestep timestep { 10.0f, 4 };
+
+        if (timestep.Advance(1005.0f) != 4 || !near(timestep.GetDroppedMilliseconds(), 960.0f) || !near(timestep.GetAlpha(), 0.5f))
+        {
+            throw;
+        }
+
+        if (timestep.Advance(5.0f) != 1)
+        {
+            throw;
+        }
+    }
+
+    // Interpolation hits both ends and blends rotation, translation and scale in between
+    {
+        glm::mat4 from = glm::mat4(1.0f);
+        glm::mat4 to = glm::mat4_cast(glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        to[0] *= 3.0f;
+        to[1] *= 3.0f;
+        to[2] *= 3.0f;
+        to[3] = glm::vec4(2.0f, 4.0f, 6.0f, 1.0f);
+
+        auto start = InterpolateTransform(from, to, 0.0f);
+        auto end = InterpolateTransform(from, to, 1.0f);
+        auto half = InterpolateTransform(from, to, 0.5f);
+
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                if (!near(start[column][row], from[column][row]) || !near(end[column][row], to[column][row]))
+                {
+                    throw;
+                }
+            }
+        }
+
+        // 45 degrees around Y at scale 2
+        glm::vec3 x_axis = glm::vec3(half[0]);
+        if (!near(glm::length(x_axis), 2.0f) || !near(x_axis.x, x_axis.z * -1.0f) || !near(half[3].y, 2.0f))
+        {
+            throw;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace KS
+{
+
+// Turns variable frame times into a whole number of fixed simulation steps. Time that does not fill a step is
+// carried over to the next frame, what is left over afterwards is the interpolation factor for rendering.
+class FixedTimestep
+{
+public:
+    // Frames slower than max_steps * step_milliseconds drop the excess instead of simulating ever more steps to catch up
+    explicit FixedTimestep(float step_milliseconds = 1000.0f / 60.0f, uint32_t max_steps = 5)
+        : step_milliseconds(step_milliseconds)
+        , max_steps(max_steps)
+    {
+    }
+
+    // Adds the frame time and returns how many steps to simulate this frame
+    uint32_t Advance(float frame_milliseconds);
+
+    float GetStepMilliseconds() const { return step_milliseconds; }
+    uint32_t GetMaxSteps() const { return max_steps; }
+
+    // How far the rendered frame is between the last two simulation states, in [0, 1)
+    float GetAlpha() const { return accumulator / step_milliseconds; }
+
+    uint64_t GetTotalSteps() const { return total_steps; }
+    float GetDroppedMilliseconds() const { return dropped_milliseconds; }
+
+private:
+    float step_milliseconds;
+    uint32_t max_steps;
+    float accumulator = 0.0f;
+    uint64_t total_steps = 0;
+    float dropped_milliseconds = 0.0f;
+};
+
+// Blends two rigid transforms with scale: translation and scale are lerped, rotation is slerped. Shear is lost.
+glm::mat4 InterpolateTransform(const glm::mat4& from, const glm::mat4& to, float alpha);
+
+namespace Tests
+{
+    void TestFixedTimestep();
+}
+
+}
@@ -0,0 +1,357 @@
+#include "SystemScheduler.hpp"
+
+namespace
+{
+
+bool Overlaps(const std::vector<entt::id_type>& a, const std::vector<entt::id_type>& b)
+{
+    for (auto id : a)
+    {
+        if (std::find(b.begin(), b.end(), id) != b.end())
+            return true;
+    }
+    return false;
+}
+
+float MillisecondsSince(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+{
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+}
+
+bool KS::SystemAccess::ConflictsWith(const SystemAccess& other) const
+{
+    if (structural || other.structural)
+        return true;
+
+    return Overlaps(writes, other.writes) || Overlaps(writes, other.reads) || Overlaps(reads, other.writes);
+}
+
+KS::SystemScheduler::SystemScheduler(uint32_t worker_count)
+{
+    for (uint32_t i = 0; i < worker_count; i++)
+        workers.emplace_back([this, i]() { WorkerLoop(i + 1); });
+}
+
+KS::SystemScheduler::~SystemScheduler()
+{
+    worker_queue.Close();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+KS::SystemScheduler::SystemID KS::SystemScheduler::AddSystem(std::string name, SystemAccess access, SystemFunction function)
+{
+    ASSERT(systems.size() < MAX_SYSTEMS && "Too many systems for the scheduler queues");
+
+    systems.emplace_back(System { std::move(name), std::move(access), std::move(function) });
+    pending = std::make_unique<std::atomic<uint32_t>[]>(systems.size());
+    return systems.size() - 1;
+}
+
+void KS::SystemScheduler::BuildGraph()
+{
+    for (auto& system : systems)
+    {
+        system.dependents.clear();
+        system.dependency_count = 0;
+    }
+
+    // Only earlier systems become dependencies, so the graph has no cycles and matches registration order
+    for (SystemID later = 0; later < systems.size(); later++)
+    {
+        if (!systems[later].enabled)
+            continue;
+
+        for (SystemID earlier = 0; earlier < later; earlier++)
+        {
+            if (systems[earlier].enabled && systems[earlier].access.ConflictsWith(systems[later].access))
+            {
+                systems[earlier].dependents.emplace_back(later);
+                systems[later].dependency_count++;
+            }
+        }
+    }
+}
+
+void KS::SystemScheduler::Run(entt::registry& registry, float dt)
+{
+    this->registry = &registry;
+    this->dt = dt;
+    run_start = std::chrono::high_resolution_clock::now();
+
+    timings.resize(systems.size());
+    for (SystemID i = 0; i < systems.size(); i++)
+    {
+        timings[i] = SystemTiming { systems[i].name };
+
+        if (systems[i].enabled)
+        {
+            ASSERT((!systems[i].access.main_thread || std::this_thread::get_id() == main_thread)
+                && "A MainThread system is enabled, but Run is called off the thread that created the scheduler");
+
+            for (auto prepare : systems[i].access.prepare)
+                prepare(registry);
+        }
+    }
+
+    if (single_threaded)
+    {
+        for (SystemID i = 0; i < systems.size(); i++)
+        {
+            if (systems[i].enabled)
+                Execute(i, 0);
+        }
+    }
+    else
+    {
+        BuildGraph();
+
+        uint32_t enabled = 0;
+        for (SystemID i = 0; i < systems.size(); i++)
+        {
+            pending[i].store(systems[i].dependency_count, std::memory_order_relaxed);
+            enabled += systems[i].enabled ? 1 : 0;
+        }
+        remaining.store(enabled, std::memory_order_release);
+
+        for (SystemID i = 0; i < systems.size(); i++)
+        {
+            if (systems[i].enabled && systems[i].dependency_count == 0)
+            {
+                if (systems[i].access.main_thread)
+                    main_queue.TryPush(i);
+                else
+                    worker_queue.Push(i);
+            }
+        }
+
+        // The calling thread runs main thread systems and otherwise helps the workers
+        while (true)
+        {
+            uint32_t left = remaining.load(std::memory_order_acquire);
+            if (left == 0)
+                break;
+
+            SystemID system {};
+            if (main_queue.TryPop(system))
+                Execute(system, 0);
+            else if (auto worker_system = worker_queue.TryPop())
+                Execute(*worker_system, 0);
+            else
+                remaining.wait(left, std::memory_order_acquire);
+        }
+    }
+
+    run_milliseconds = MillisecondsSince(run_start, std::chrono::high_resolution_clock::now());
+    this->registry = nullptr;
+}
+
+void KS::SystemScheduler::Execute(SystemID system, uint32_t thread)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    systems[system].function(*registry, dt);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto& timing = timings[system];
+    timing.start_milliseconds = MillisecondsSince(run_start, start);
+    timing.milliseconds = MillisecondsSince(start, end);
+    timing.thread = thread;
+
+    if (single_threaded)
+        return;
+
+    for (SystemID dependent : systems[system].dependents)
+    {
+        if (pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            if (systems[dependent].access.main_thread)
+                main_queue.TryPush(dependent);
+            else
+                worker_queue.Push(dependent);
+        }
+    }
+
+    // Newly ready systems are queued before this, so a woken main thread finds them
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+    remaining.notify_one();
+}
+
+void KS::SystemScheduler::WorkerLoop(uint32_t thread)
+{
+    while (auto system = worker_queue.Pop())
+        Execute(*system, thread);
+}
+
+namespace
+{
+
+struct Position
+{
+    int value = 0;
+};
+
+struct Velocity
+{
+    int value = 0;
+};
+
+struct Health
+{
+    int value = 0;
+};
+
+// Builds the same world and systems for both modes, so their results can be compared
+struct SchedulerFixture
+{
+    SchedulerFixture(uint32_t workers)
+        : scheduler(workers)
+    {
+        for (int i = 0; i < 1000; i++)
+        {
+            auto entity = registry.create();
+            registry.emplace<Position>(entity, i);
+            registry.emplace<Velocity>(entity, 1);
+            registry.emplace<Health>(entity, 100);
+        }
+
+        // Three chains that only depend on themselves, and one system that reads what two of them write
+        scheduler.AddSystem("Accelerate", KS::SystemAccess {}.Write<Velocity>(), [this](entt::registry& registry, float)
+        {
+            Track(0);
+            for (auto [entity, velocity] : registry.view<Velocity>().each())
+                velocity.value += 1;
+            Untrack(0);
+        });
+
+        scheduler.AddSystem("Move", KS::SystemAccess {}.Read<Velocity>().Write<Position>(), [this](entt::registry& registry, float)
+        {
+            Track(1);
+            for (auto [entity, position, velocity] : registry.view<Position, const Velocity>().each())
+                position.value += velocity.value;
+            Untrack(1);
+        });
+
+        scheduler.AddSystem("Damage", KS::SystemAccess {}.Write<Health>(), [this](entt::registry& registry, float)
+        {
+            Track(2);
+            for (auto [entity, health] : registry.view<Health>().each())
+                health.value -= 1;
+            Untrack(2);
+        });
+
+        scheduler.AddSystem("Checksum", KS::SystemAccess {}.Read<Position, Health>(), [this](entt::registry& registry, float)
+        {
+            Track(3);
+            int64_t sum = 0;
+            for (auto [entity, position, health] : registry.view<const Position, const Health>().each())
+                sum += position.value * 3 + health.value;
+            checksums.emplace_back(sum);
+            Untrack(3);
+        });
+
+        scheduler.AddSystem("Main", KS::SystemAccess {}.MainThread(), [this](entt::registry&, float)
+        {
+            main_thread_ok = main_thread_ok && std::this_thread::get_id() == main_thread;
+        });
+    }
+
+    // Conflicting systems must never overlap
+    void Track(int system)
+    {
+        int before = running[system].fetch_add(1);
+        bool conflict = (system == 0 && running[1].load() != 0) || (system == 1 && (running[0].load() != 0 || running[3].load() != 0))
+            || (system == 2 && running[3].load() != 0) || (system == 3 && (running[1].load() != 0 || running[2].load() != 0));
+        if (before != 0 || conflict)
+            overlap = true;
+    }
+
+    void Untrack(int system) { running[system].fetch_sub(1); }
+
+    entt::registry registry {};
+    KS::SystemScheduler scheduler;
+    std::vector<int64_t> checksums {};
+    std::atomic<int> running[4] {};
+    std::atomic<bool> overlap { false };
+    bool main_thread_ok = true;
+    std::thread::id main_thread = std::this_thread::get_id();
+};
+
+}
+
+void KS::Tests::TestSystemScheduler()
+{
+    // Access conflicts
+    {
+        auto reader = SystemAccess {}.Read<Position>();
+        auto writer = SystemAccess {}.Write<Position>();
+        auto other = SystemAccess {}.Write<Velocity>();
+
+        if (reader.ConflictsWith(reader) || !reader.ConflictsWith(writer) || !writer.ConflictsWith(writer)
+            || writer.ConflictsWith(other) || !other.ConflictsWith(SystemAccess {}.Structural()))
+        {
+            throw;
+        }
+    }
+
+    // Parallel runs give the same results as registration order
+    SchedulerFixture serial { 0 };
+    serial.scheduler.SetSingleThreaded(true);
+
+    SchedulerFixture parallel { 3 };
+
+    for (int frame = 0; frame < 50; frame++)
+    {
+        serial.scheduler.Run(serial.registry, 0.016f);
+        parallel.scheduler.Run(parallel.registry, 0.016f);
+    }
+
+    if (serial.checksums != parallel.checksums || parallel.overlap || !parallel.main_thread_ok || !serial.main_thread_ok)
+    {
+        throw;
+    }
+
+    // Timings cover every system, disabled ones stay empty
+    parallel.scheduler.SetSystemEnabled(2, false);
+    parallel.scheduler.Run(parallel.registry, 0.016f);
+
+    const auto& timings = parallel.scheduler.GetTimings();
+    if (timings.size() != 5 || timings[1].name != "Move" || timings[2].milliseconds != 0.0f || timings[4].thread != 0
+        || parallel.checksums.size() != 51)
+    {
+        throw;
+    }
+
+    for (const auto& timing : timings)
+    {
+        if (timing.start_milliseconds + timing.milliseconds > parallel.scheduler.GetLastRunMilliseconds() + 0.001f)
+        {
+            throw;
+        }
+    }
+
+    // Structural systems run alone, and can add storages the other systems then use
+    {
+        SchedulerFixture structural { 2 };
+        structural.scheduler.AddSystem("Spawn", SystemAccess {}.Structural(), [&](entt::registry& registry, float)
+        {
+            for (int i = 0; i < 4; i++)
+                structural.overlap = structural.overlap || structural.running[i].load() != 0;
+
+            auto entity = registry.create();
+            registry.emplace<Position>(entity, 0);
+            registry.emplace<Health>(entity, 1);
+        });
+
+        for (int frame = 0; frame < 10; frame++)
+        {
+            structural.scheduler.Run(structural.registry, 0.016f);
+        }
+
+        if (structural.overlap || structural.registry.view<Position>().size() != 1010)
+        {
+            throw;
+        }
+    }
+}
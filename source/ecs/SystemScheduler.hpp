@@ -0,0 +1,159 @@
+#pragma once
+#include <code_utility.hpp>
+#include <containers/BlockingQueue.hpp>
+#include <containers/MPMCQueue.hpp>
+#include <entt/entity/registry.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace KS
+{
+
+// The components a system uses. Two systems may run at the same time only if neither writes a component the other uses.
+// Systems should iterate read components through const views (registry.view<const T>()).
+class SystemAccess
+{
+public:
+    template <typename... T>
+    SystemAccess& Read()
+    {
+        (Add<T>(reads), ...);
+        return *this;
+    }
+
+    template <typename... T>
+    SystemAccess& Write()
+    {
+        (Add<T>(writes), ...);
+        return *this;
+    }
+
+    // Creates or destroys entities, or adds or removes components. The registry itself is not thread safe, so these run alone.
+    SystemAccess& Structural()
+    {
+        structural = true;
+        return *this;
+    }
+
+    // Uses something bound to the main thread (the window, input or the device). Runs on the thread that created
+    // the scheduler, which must then be the one calling Run.
+    SystemAccess& MainThread()
+    {
+        main_thread = true;
+        return *this;
+    }
+
+    bool ConflictsWith(const SystemAccess& other) const;
+
+private:
+    friend class SystemScheduler;
+
+    template <typename T>
+    void Add(std::vector<entt::id_type>& ids)
+    {
+        ids.emplace_back(entt::type_hash<T>::value());
+
+        // Storages are created on first access, which modifies the registry, so it is done before systems run in parallel
+        prepare.emplace_back([](entt::registry& registry) { registry.storage<T>(); });
+    }
+
+    std::vector<entt::id_type> reads {};
+    std::vector<entt::id_type> writes {};
+    std::vector<void (*)(entt::registry&)> prepare {};
+    bool structural = false;
+    bool main_thread = false;
+};
+
+// Runs the registered systems once per Run call. Every run builds a dependency graph from the systems' access:
+// a system waits for every earlier registered system it conflicts with, so the result is the same as running them
+// in registration order, while systems that don't conflict run in parallel on the worker threads.
+class SystemScheduler
+{
+public:
+    using SystemFunction = std::function<void(entt::registry& registry, float dt)>;
+    using SystemID = size_t;
+
+    struct SystemTiming
+    {
+        std::string_view name {};
+        float start_milliseconds = 0.0f; // Since the start of the run
+        float milliseconds = 0.0f;
+        uint32_t thread = 0; // 0 is the thread that called Run
+    };
+
+    static constexpr size_t MAX_SYSTEMS = 1024;
+
+    // The calling thread helps out during Run, so by default one worker less than there are hardware threads
+    explicit SystemScheduler(uint32_t worker_count = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    ~SystemScheduler();
+
+    NON_COPYABLE(SystemScheduler);
+    NON_MOVABLE(SystemScheduler);
+
+    SystemID AddSystem(std::string name, SystemAccess access, SystemFunction function);
+    void SetSystemEnabled(SystemID system, bool enabled) { systems[system].enabled = enabled; }
+
+    void Run(entt::registry& registry, float dt);
+
+    // Runs every system in registration order on the calling thread, for debugging and reproducible runs
+    void SetSingleThreaded(bool single_threaded) { this->single_threaded = single_threaded; }
+    bool IsSingleThreaded() const { return single_threaded; }
+
+    size_t GetSystemCount() const { return systems.size(); }
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // Timings of the last run in registration order, disabled systems have zero time
+    const std::vector<SystemTiming>& GetTimings() const { return timings; }
+    float GetLastRunMilliseconds() const { return run_milliseconds; }
+
+private:
+    struct System
+    {
+        std::string name {};
+        SystemAccess access {};
+        SystemFunction function {};
+        bool enabled = true;
+
+        // Rebuilt every run
+        std::vector<SystemID> dependents {};
+        uint32_t dependency_count = 0;
+    };
+
+    void BuildGraph();
+    void Execute(SystemID system, uint32_t thread);
+    void WorkerLoop(uint32_t thread);
+
+    std::vector<System> systems {};
+    std::vector<SystemTiming> timings {};
+    bool single_threaded = false;
+    float run_milliseconds = 0.0f;
+
+    // State of the current run
+    entt::registry* registry = nullptr;
+    float dt = 0.0f;
+    std::chrono::high_resolution_clock::time_point run_start {};
+    std::unique_ptr<std::atomic<uint32_t>[]> pending {};
+    std::atomic<uint32_t> remaining { 0 };
+
+    BlockingQueue<MPMCQueue<SystemID>> worker_queue { MAX_SYSTEMS };
+    MPMCQueue<SystemID> main_queue { MAX_SYSTEMS };
+    std::vector<std::thread> workers {};
+
+    // Where MainThread systems run
+    std::thread::id main_thread = std::this_thread::get_id();
+};
+
+namespace Tests
+{
+    void TestSystemScheduler();
+}
+
+}
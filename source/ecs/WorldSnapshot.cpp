@@ -0,0 +1,442 @@
+#include "WorldSnapshot.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+
+constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+uint32_t EntityIndex(entt::entity entity) { return static_cast<uint32_t>(entt::to_entity(entity)); }
+
+// Position of every entity of a list, looked up by entity index. The full id is checked by the caller.
+std::vector<uint32_t> IndexEntities(const std::vector<entt::entity>& entities)
+{
+    uint32_t highest = 0;
+    for (auto entity : entities)
+        highest = std::max(highest, EntityIndex(entity) + 1);
+
+    std::vector<uint32_t> positions(highest, NO_INDEX);
+    for (uint32_t i = 0; i < entities.size(); i++)
+        positions[EntityIndex(entities[i])] = i;
+
+    return positions;
+}
+
+uint32_t Find(const std::vector<uint32_t>& positions, const std::vector<entt::entity>& entities, entt::entity entity)
+{
+    uint32_t index = EntityIndex(entity);
+    if (index >= positions.size() || positions[index] == NO_INDEX || entities[positions[index]] != entity)
+        return NO_INDEX;
+
+    return positions[index];
+}
+
+bool SameBytes(std::span<const std::byte> a, std::span<const std::byte> b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+// The components of current that are new or differ from baseline, and the entities that lost theirs
+KS::ComponentChunk DiffChunk(const KS::ComponentChunk* baseline, const KS::ComponentChunk& current,
+    const std::vector<uint32_t>& alive_positions, const std::vector<entt::entity>& alive)
+{
+    KS::ComponentChunk delta {};
+    delta.type = current.type;
+    delta.stride = current.stride;
+
+    std::vector<uint32_t> baseline_positions = baseline ? IndexEntities(baseline->entities) : std::vector<uint32_t> {};
+    std::vector<uint32_t> changed {};
+
+    for (uint32_t i = 0; i < current.entities.size(); i++)
+    {
+        uint32_t previous = baseline ? Find(baseline_positions, baseline->entities, current.entities[i]) : NO_INDEX;
+        if (previous == NO_INDEX || !SameBytes(baseline->GetComponent(previous), current.GetComponent(i)))
+            changed.emplace_back(i);
+    }
+
+    // Entities that were destroyed lose their components anyway
+    if (baseline)
+    {
+        std::vector<uint32_t> current_positions = IndexEntities(current.entities);
+        for (auto entity : baseline->entities)
+        {
+            if (Find(current_positions, current.entities, entity) == NO_INDEX && Find(alive_positions, alive, entity) != NO_INDEX)
+                delta.removed.emplace_back(entity);
+        }
+    }
+
+    delta.entities.reserve(changed.size());
+    for (uint32_t i : changed)
+        delta.entities.emplace_back(current.entities[i]);
+
+    if (current.IsSerialized())
+    {
+        std::vector<std::byte> bytes {};
+        delta.offsets.reserve(changed.size() + 1);
+        for (uint32_t i : changed)
+        {
+            auto component = current.GetComponent(i);
+            delta.offsets.emplace_back(static_cast<uint32_t>(bytes.size()));
+            bytes.insert(bytes.end(), component.begin(), component.end());
+        }
+        delta.offsets.emplace_back(static_cast<uint32_t>(bytes.size()));
+
+        auto span = std::span<const std::byte>(bytes);
+        delta.data = KS::ByteBuffer::Adopt(std::move(bytes), span);
+    }
+    else if (current.stride != 0)
+    {
+        delta.data = KS::ByteBuffer::Allocate(changed.size() * current.stride);
+        std::byte* out = delta.data.GetMutableBytes().data();
+        for (uint32_t i : changed)
+        {
+            std::memcpy(out, current.GetComponent(i).data(), current.stride);
+            out += current.stride;
+        }
+    }
+
+    return delta;
+}
+
+}
+
+entt::entity KS::EntityMap::Get(entt::entity saved) const
+{
+    uint32_t index = EntityIndex(saved);
+    if (index >= slots.size() || slots[index].saved != saved)
+        return entt::null;
+
+    return slots[index].live;
+}
+
+void KS::EntityMap::Set(entt::entity saved, entt::entity live)
+{
+    uint32_t index = EntityIndex(saved);
+    if (index >= slots.size())
+        slots.resize(index + 1);
+
+    slots[index] = Slot { saved, live };
+}
+
+void KS::EntityMap::Erase(entt::entity saved)
+{
+    uint32_t index = EntityIndex(saved);
+    if (index < slots.size() && slots[index].saved == saved)
+        slots[index] = Slot {};
+}
+
+std::span<const std::byte> KS::ComponentChunk::GetComponent(size_t index) const
+{
+    if (IsSerialized())
+        return data.GetBytes().subspan(offsets[index], offsets[index + 1] - offsets[index]);
+
+    return data.GetBytes().subspan(index * stride, stride);
+}
+
+KS::WorldSnapshot KS::WorldSnapshot::Diff(const WorldSnapshot& baseline, const WorldSnapshot& current)
+{
+    ASSERT(!baseline.delta && !current.delta && "Deltas are made between two full snapshots");
+
+    WorldSnapshot delta {};
+    delta.delta = true;
+
+    auto baseline_positions = IndexEntities(baseline.entities);
+    auto current_positions = IndexEntities(current.entities);
+
+    for (auto entity : baseline.entities)
+    {
+        if (Find(current_positions, current.entities, entity) == NO_INDEX)
+            delta.destroyed.emplace_back(entity);
+    }
+
+    for (auto entity : current.entities)
+    {
+        if (Find(baseline_positions, baseline.entities, entity) == NO_INDEX)
+            delta.entities.emplace_back(entity);
+    }
+
+    for (const auto& chunk : current.chunks)
+    {
+        auto it = std::find_if(baseline.chunks.begin(), baseline.chunks.end(),
+            [&](const ComponentChunk& other) { return other.type == chunk.type; });
+
+        auto chunk_delta = DiffChunk(it != baseline.chunks.end() ? &*it : nullptr, chunk, current_positions, current.entities);
+        if (!chunk_delta.entities.empty() || !chunk_delta.removed.empty())
+            delta.chunks.emplace_back(std::move(chunk_delta));
+    }
+
+    return delta;
+}
+
+const KS::WorldSerializer::ComponentType* KS::WorldSerializer::FindType(uint32_t id) const
+{
+    for (const auto& type : types)
+    {
+        if (type.id == id)
+            return &type;
+    }
+    return nullptr;
+}
+
+KS::WorldSnapshot KS::WorldSerializer::Capture(const entt::registry& registry) const
+{
+    WorldSnapshot snapshot {};
+
+    const auto* entities = registry.storage<entt::entity>();
+    snapshot.entities.reserve(entities->in_use());
+    for (auto [entity] : entities->each())
+        snapshot.entities.emplace_back(entity);
+
+    snapshot.chunks.reserve(types.size());
+    for (const auto& type : types)
+    {
+        ComponentChunk chunk {};
+        chunk.type = type.id;
+        type.capture(registry, chunk);
+        snapshot.chunks.emplace_back(std::move(chunk));
+    }
+
+    return snapshot;
+}
+
+void KS::WorldSerializer::Apply(const WorldSnapshot& snapshot, entt::registry& registry, EntityMap& map) const
+{
+    if (snapshot.delta)
+    {
+        for (auto saved : snapshot.destroyed)
+        {
+            auto live = map.Get(saved);
+            if (live != entt::null && registry.valid(live))
+                registry.destroy(live);
+
+            map.Erase(saved);
+        }
+    }
+
+    std::vector<entt::entity> created(snapshot.entities.size());
+    registry.create(created.begin(), created.end());
+    for (size_t i = 0; i < created.size(); i++)
+        map.Set(snapshot.entities[i], created[i]);
+
+    std::vector<entt::entity> live {};
+    for (const auto& chunk : snapshot.chunks)
+    {
+        const auto* type = FindType(chunk.type);
+        if (type == nullptr)
+        {
+            LOG(Log::Severity::WARN, "Snapshot has components of an unregistered type {}, skipped", chunk.type);
+            continue;
+        }
+
+        if (!chunk.removed.empty())
+        {
+            live.resize(chunk.removed.size());
+            std::transform(chunk.removed.begin(), chunk.removed.end(), live.begin(), [&](entt::entity e) { return map.Get(e); });
+            type->remove(registry, live);
+        }
+
+        live.resize(chunk.entities.size());
+        std::transform(chunk.entities.begin(), chunk.entities.end(), live.begin(), [&](entt::entity e) { return map.Get(e); });
+
+        // A full snapshot only touches the entities it just created
+        bool fresh = !snapshot.delta && std::find(live.begin(), live.end(), entt::entity { entt::null }) == live.end();
+        type->apply(registry, chunk, live, fresh);
+    }
+}
+
+namespace
+{
+
+struct Position
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+// Versioned, cereal writes the version with the first one in an archive
+struct Name
+{
+    std::string value {};
+
+    template <typename A>
+    void serialize(A& ar, const uint32_t v)
+    {
+        ar(value);
+    }
+};
+
+struct Selected
+{
+};
+
+KS::WorldSerializer MakeSerializer()
+{
+    KS::WorldSerializer serializer {};
+    serializer.Register<Position>("Position");
+    serializer.Register<Name>("Name");
+    serializer.Register<Selected>("Selected");
+    return serializer;
+}
+
+template <typename Saver, typename Loader>
+KS::WorldSnapshot RoundTrip(const KS::WorldSnapshot& snapshot)
+{
+    std::stringstream stream {};
+    {
+        Saver archive { stream };
+        archive(cereal::make_nvp("World", snapshot));
+    }
+
+    KS::WorldSnapshot loaded {};
+    {
+        Loader archive { stream };
+        archive(cereal::make_nvp("World", loaded));
+    }
+    return loaded;
+}
+
+// Every entity of source has a counterpart in target with the same components
+bool Matches(entt::registry& source, entt::registry& target, const std::vector<std::pair<entt::entity, entt::entity>>& pairs)
+{
+    if (source.storage<entt::entity>().in_use() != target.storage<entt::entity>().in_use())
+        return false;
+
+    for (auto [from, to] : pairs)
+    {
+        if (!source.valid(from) || !target.valid(to))
+            return false;
+
+        auto* a = source.try_get<Position>(from);
+        auto* b = target.try_get<Position>(to);
+        if ((a == nullptr) != (b == nullptr) || (a && (a->x != b->x || a->y != b->y || a->z != b->z)))
+            return false;
+
+        auto* name_a = source.try_get<Name>(from);
+        auto* name_b = target.try_get<Name>(to);
+        if ((name_a == nullptr) != (name_b == nullptr) || (name_a && name_a->value != name_b->value))
+            return false;
+
+        if (source.all_of<Selected>(from) != target.all_of<Selected>(to))
+            return false;
+    }
+    return true;
+}
+
+}
+
+void KS::Tests::TestWorldSnapshot()
+{
+    auto serializer = MakeSerializer();
+
+    entt::registry source {};
+    std::vector<entt::entity> source_entities {};
+    for (int i = 0; i < 1000; i++)
+    {
+        auto entity = source.create();
+        source.emplace<Position>(entity, float(i), float(i * 2), float(i * 3));
+        if (i % 3 == 0) source.emplace<Name>(entity, "Entity " + std::to_string(i));
+        if (i % 7 == 0) source.emplace<Selected>(entity);
+        source_entities.emplace_back(entity);
+    }
+
+    // Destroyed entities leave holes, the loaded world must not depend on ids being dense
+    for (int i = 0; i < 1000; i += 10)
+        source.destroy(source_entities[i]);
+
+    auto pairs = [&](const EntityMap& map)
+    {
+        std::vector<std::pair<entt::entity, entt::entity>> result {};
+        for (auto [entity] : source.storage<entt::entity>().each())
+            result.emplace_back(entity, map.Get(entity));
+        return result;
+    };
+
+    // Full snapshots load into a world that already has entities, through binary and JSON
+    auto baseline = serializer.Capture(source);
+
+    entt::registry target {};
+    for (int i = 0; i < 50; i++)
+        target.emplace<Position>(target.create(), -1.0f, -1.0f, -1.0f);
+
+    EntityMap map {};
+    auto loaded = RoundTrip<BinarySaver, BinaryLoader>(baseline);
+    serializer.Apply(loaded, target, map);
+
+    // The 50 entities that were already there are not part of the comparison
+    if (target.storage<entt::entity>().in_use() != source.storage<entt::entity>().in_use() + 50)
+    {
+        throw;
+    }
+
+    {
+        entt::registry json_target {};
+        EntityMap json_map {};
+        serializer.Apply(RoundTrip<JSONSaver, JSONLoader>(baseline), json_target, json_map);
+
+        if (!Matches(source, json_target, pairs(json_map)))
+        {
+            throw;
+        }
+    }
+
+    for (auto [from, to] : pairs(map))
+    {
+        if (to == entt::null || target.get<Position>(to).y != source.get<Position>(from).y)
+        {
+            throw;
+        }
+    }
+
+    // Deltas carry only what changed: moves, renames, new and destroyed entities, added and removed components
+    source.get<Position>(source_entities[1]).x = 100.0f;
+    source.get<Name>(source_entities[3]).value = "Renamed";
+    source.remove<Name>(source_entities[6]);
+    source.emplace<Selected>(source_entities[2]);
+    source.remove<Selected>(source_entities[14]);
+    source.destroy(source_entities[5]);
+
+    auto added = source.create();
+    source.emplace<Position>(added, 7.0f, 8.0f, 9.0f);
+    source.emplace<Name>(added, "Added");
+
+    auto current = serializer.Capture(source);
+    auto delta = WorldSnapshot::Diff(baseline, current);
+
+    if (!delta.IsDelta() || delta.GetEntities().size() != 1 || delta.GetDestroyed().size() != 1)
+    {
+        throw;
+    }
+
+    for (const auto& chunk : delta.GetChunks())
+    {
+        // One moved and one added, one renamed and one added, one added and one removed
+        if (chunk.entities.size() + chunk.removed.size() > 3)
+        {
+            throw;
+        }
+    }
+
+    serializer.Apply(RoundTrip<BinarySaver, BinaryLoader>(delta), target, map);
+
+    std::vector<entt::entity> existing {};
+    for (auto [entity, position] : target.view<Position>().each())
+    {
+        if (position.x == -1.0f)
+            existing.emplace_back(entity);
+    }
+    target.destroy(existing.begin(), existing.end());
+
+    if (!Matches(source, target, pairs(map)))
+    {
+        throw;
+    }
+
+    // A delta against itself is empty
+    auto nothing = WorldSnapshot::Diff(current, serializer.Capture(source));
+    if (!nothing.GetEntities().empty() || !nothing.GetDestroyed().empty() || !nothing.GetChunks().empty())
+    {
+        throw;
+    }
+}
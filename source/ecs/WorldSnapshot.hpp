@@ -0,0 +1,406 @@
+#pragma once
+#include <containers/ByteBuffer.hpp>
+#include <entt/core/hashed_string.hpp>
+#include <entt/entity/registry.hpp>
+#include <fileio/MemoryStream.hpp>
+#include <fileio/Serialization.hpp>
+#include <tools/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace KS
+{
+
+// Entities get new ids when a snapshot is loaded, this translates saved ids to live ones.
+// Keep it around after loading a full snapshot, deltas on top of it are resolved through the same map.
+// Entity ids stored inside components are not translated.
+class EntityMap
+{
+public:
+    // entt::null for entities this map does not know
+    entt::entity Get(entt::entity saved) const;
+    void Set(entt::entity saved, entt::entity live);
+    void Erase(entt::entity saved);
+    void Clear() { slots.clear(); }
+
+private:
+    struct Slot
+    {
+        entt::entity saved = entt::null;
+        entt::entity live = entt::null;
+    };
+
+    // Indexed by the entity part of the saved id, the version is checked on lookup
+    std::vector<Slot> slots {};
+};
+
+// Every component of one type. Trivially copyable components are stored back to back and copied in bulk,
+// others are serialized one after the other with cereal.
+struct ComponentChunk
+{
+    uint32_t type = 0; // Hash of the registered name
+    uint32_t stride = 0; // Bytes per component when trivially copyable, 0 for empty and serialized ones
+    std::vector<entt::entity> entities {};
+    std::vector<uint32_t> offsets {}; // Serialized components only: where each starts in data, then the end
+    ByteBuffer data {};
+    std::vector<entt::entity> removed {}; // Deltas only: entities that lost the component
+
+    bool IsSerialized() const { return !offsets.empty(); }
+    std::span<const std::byte> GetComponent(size_t index) const;
+
+    template <typename A>
+    void save(A& ar, const uint32_t v) const;
+
+    template <typename A>
+    void load(A& ar, const uint32_t v);
+};
+
+// A copy of a world, made by WorldSerializer::Capture. Full snapshots hold every entity,
+// deltas only what changed since a baseline snapshot, see Diff.
+class WorldSnapshot
+{
+public:
+    // Changes from baseline to current, both full snapshots of the same world.
+    // Components are compared by their bytes, so only the ones that were written to with a different value end up in it.
+    static WorldSnapshot Diff(const WorldSnapshot& baseline, const WorldSnapshot& current);
+
+    bool IsDelta() const { return delta; }
+
+    // For deltas, the entities created since the baseline
+    const std::vector<entt::entity>& GetEntities() const { return entities; }
+    const std::vector<entt::entity>& GetDestroyed() const { return destroyed; }
+    const std::vector<ComponentChunk>& GetChunks() const { return chunks; }
+
+    template <typename A>
+    void save(A& ar, const uint32_t v) const;
+
+    template <typename A>
+    void load(A& ar, const uint32_t v);
+
+private:
+    friend class WorldSerializer;
+
+    bool delta = false;
+    std::vector<entt::entity> entities {};
+    std::vector<entt::entity> destroyed {};
+    std::vector<ComponentChunk> chunks {};
+};
+
+// Knows the component types that are saved, and moves them between registries and snapshots.
+// Types are identified in files by the hash of their registered name, so renaming the C++ type keeps files loading.
+class WorldSerializer
+{
+public:
+    // Components need a default constructor. Ones that are not trivially copyable also need a cereal serialize function.
+    template <typename T>
+    void Register(std::string_view name);
+
+    WorldSnapshot Capture(const entt::registry& registry) const;
+
+    // Full snapshots create new entities for everything they hold and record them in map.
+    // Deltas destroy, create and change the entities an earlier Apply with the same map created.
+    void Apply(const WorldSnapshot& snapshot, entt::registry& registry, EntityMap& map) const;
+
+private:
+    struct ComponentType
+    {
+        uint32_t id = 0;
+        std::string name {};
+        void (*capture)(const entt::registry& registry, ComponentChunk& chunk) = nullptr;
+
+        // live holds the chunk's entities translated, entt::null for ones that should be skipped.
+        // fresh means none of the entities has the component yet, so it can be added in bulk.
+        void (*apply)(entt::registry& registry, const ComponentChunk& chunk, std::span<const entt::entity> live, bool fresh)
+            = nullptr;
+        void (*remove)(entt::registry& registry, std::span<const entt::entity> live) = nullptr;
+    };
+
+    const ComponentType* FindType(uint32_t id) const;
+
+    std::vector<ComponentType> types {};
+};
+
+namespace detail
+{
+    // Entity lists are written as one block in binary archives
+    template <typename A>
+    void SaveEntities(A& ar, const char* name, const std::vector<entt::entity>& entities)
+    {
+        using Underlying = std::underlying_type_t<entt::entity>;
+
+        if constexpr (cereal::traits::is_output_serializable<cereal::BinaryData<const entt::entity*>, A>::value)
+        {
+            ar(cereal::make_size_tag(static_cast<cereal::size_type>(entities.size())));
+            ar(cereal::binary_data(entities.data(), entities.size() * sizeof(entt::entity)));
+        }
+        else
+        {
+            std::vector<Underlying> values(entities.size());
+            std::transform(entities.begin(), entities.end(), values.begin(), entt::to_integral<entt::entity>);
+            ar(cereal::make_nvp(name, values));
+        }
+    }
+
+    template <typename A>
+    void LoadEntities(A& ar, const char* name, std::vector<entt::entity>& entities)
+    {
+        using Underlying = std::underlying_type_t<entt::entity>;
+
+        if constexpr (cereal::traits::is_input_serializable<cereal::BinaryData<entt::entity*>, A>::value)
+        {
+            cereal::size_type count {};
+            ar(cereal::make_size_tag(count));
+            entities.resize(static_cast<size_t>(count));
+            ar(cereal::binary_data(entities.data(), entities.size() * sizeof(entt::entity)));
+        }
+        else
+        {
+            std::vector<Underlying> values {};
+            ar(cereal::make_nvp(name, values));
+            entities.resize(values.size());
+            std::transform(values.begin(), values.end(), entities.begin(), [](Underlying value) { return entt::entity { value }; });
+        }
+    }
+
+    // Copies count components from position first of a storage's packed array to out, a page at a time
+    template <typename Storage>
+    void CopyPacked(const Storage& storage, size_t first, size_t count, std::byte* out)
+    {
+        using T = typename Storage::value_type;
+        constexpr size_t PAGE = entt::component_traits<T>::page_size;
+
+        for (size_t i = first, end = first + count; i < end;)
+        {
+            size_t run = std::min(PAGE - i % PAGE, end - i);
+            std::memcpy(out, storage.raw()[i / PAGE] + i % PAGE, run * sizeof(T));
+            out += run * sizeof(T);
+            i += run;
+        }
+    }
+
+    // The other way around, over components that already exist
+    template <typename Storage>
+    void CopyPacked(const std::byte* in, Storage& storage, size_t first, size_t count)
+    {
+        using T = typename Storage::value_type;
+        constexpr size_t PAGE = entt::component_traits<T>::page_size;
+
+        for (size_t i = first, end = first + count; i < end;)
+        {
+            size_t run = std::min(PAGE - i % PAGE, end - i);
+            std::memcpy(static_cast<void*>(storage.raw()[i / PAGE] + i % PAGE), in, run * sizeof(T));
+            in += run * sizeof(T);
+            i += run;
+        }
+    }
+}
+
+template <typename A>
+inline void ComponentChunk::save(A& ar, const uint32_t v) const
+{
+    switch (v)
+    {
+    case 0:
+        ar(cereal::make_nvp("Type", type), cereal::make_nvp("Stride", stride));
+        detail::SaveEntities(ar, "Entities", entities);
+        ar(cereal::make_nvp("Offsets", offsets), cereal::make_nvp("Data", data));
+        detail::SaveEntities(ar, "Removed", removed);
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename A>
+inline void ComponentChunk::load(A& ar, const uint32_t v)
+{
+    switch (v)
+    {
+    case 0:
+        ar(cereal::make_nvp("Type", type), cereal::make_nvp("Stride", stride));
+        detail::LoadEntities(ar, "Entities", entities);
+        ar(cereal::make_nvp("Offsets", offsets), cereal::make_nvp("Data", data));
+        detail::LoadEntities(ar, "Removed", removed);
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename A>
+inline void WorldSnapshot::save(A& ar, const uint32_t v) const
+{
+    switch (v)
+    {
+    case 0:
+        ar(cereal::make_nvp("Delta", delta));
+        detail::SaveEntities(ar, "Entities", entities);
+        detail::SaveEntities(ar, "Destroyed", destroyed);
+        ar(cereal::make_nvp("Chunks", chunks));
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename A>
+inline void WorldSnapshot::load(A& ar, const uint32_t v)
+{
+    switch (v)
+    {
+    case 0:
+        ar(cereal::make_nvp("Delta", delta));
+        detail::LoadEntities(ar, "Entities", entities);
+        detail::LoadEntities(ar, "Destroyed", destroyed);
+        ar(cereal::make_nvp("Chunks", chunks));
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename T>
+void WorldSerializer::Register(std::string_view name)
+{
+    static_assert(std::is_default_constructible_v<T>, "Saved components need a default constructor");
+
+    ComponentType type {};
+    type.id = entt::hashed_string { name.data(), name.size() }.value();
+    type.name = std::string(name);
+
+    ASSERT(FindType(type.id) == nullptr && "Component name registered twice, or two names with the same hash");
+
+    type.capture = [](const entt::registry& registry, ComponentChunk& chunk)
+    {
+        const auto* storage = registry.storage<T>();
+        if (storage == nullptr) return;
+
+        // The entities in packed order, the order the components are stored in
+        const entt::sparse_set& set = *storage;
+        chunk.entities.assign(set.rbegin(), set.rend());
+
+        if constexpr (std::is_empty_v<T>)
+        {
+            // Tags, only which entities have them matters
+        }
+        else if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            chunk.stride = sizeof(T);
+            chunk.data = ByteBuffer::Allocate(chunk.entities.size() * sizeof(T), std::max(ByteBuffer::DEFAULT_ALIGNMENT, alignof(T)));
+            detail::CopyPacked(*storage, 0, chunk.entities.size(), chunk.data.GetMutableBytes().data());
+        }
+        else
+        {
+            std::vector<std::byte> bytes {};
+            chunk.offsets.reserve(chunk.entities.size() + 1);
+            {
+                MemoryWriteStream stream { bytes };
+
+                for (auto entity : chunk.entities)
+                {
+                    chunk.offsets.emplace_back(static_cast<uint32_t>(bytes.size()));
+
+                    // Cereal writes a class version once per archive, so each component gets its own archive.
+                    // Deltas pick single components out of the chunk, and every one must load on its own.
+                    BinarySaver archive { stream };
+                    archive(storage->get(entity));
+                }
+            }
+            chunk.offsets.emplace_back(static_cast<uint32_t>(bytes.size()));
+
+            auto span = std::span<const std::byte>(bytes);
+            chunk.data = ByteBuffer::Adopt(std::move(bytes), span);
+        }
+    };
+
+    type.apply = [](entt::registry& registry, const ComponentChunk& chunk, std::span<const entt::entity> live, bool fresh)
+    {
+        auto& storage = registry.storage<T>();
+
+        if constexpr (std::is_empty_v<T>)
+        {
+            for (auto entity : live)
+            {
+                if (entity != entt::null && !storage.contains(entity)) storage.emplace(entity);
+            }
+        }
+        else if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (chunk.stride != sizeof(T))
+            {
+                LOG(Log::Severity::WARN, "Saved component size does not match, skipped {} components", live.size());
+                return;
+            }
+
+            // Default constructed in one go at the end of the packed array, then the saved bytes are copied over them
+            if (fresh)
+            {
+                size_t first = storage.size();
+                storage.insert(live.begin(), live.end());
+                detail::CopyPacked(chunk.data.GetBytes().data(), storage, first, live.size());
+                return;
+            }
+
+            const std::byte* in = chunk.data.GetBytes().data();
+            for (auto entity : live)
+            {
+                if (entity != entt::null)
+                {
+                    if (!storage.contains(entity)) storage.emplace(entity);
+                    std::memcpy(static_cast<void*>(&storage.get(entity)), in, sizeof(T));
+                }
+                in += sizeof(T);
+            }
+        }
+        else
+        {
+            // Every component was written with its own archive, see capture
+            for (size_t i = 0; i < live.size(); i++)
+            {
+                if (live[i] == entt::null) continue;
+
+                MemoryReadStream stream { chunk.GetComponent(i) };
+                BinaryLoader archive { stream };
+
+                T component {};
+                archive(component);
+
+                if (storage.contains(live[i]))
+                    storage.get(live[i]) = std::move(component);
+                else
+                    storage.emplace(live[i], std::move(component));
+            }
+        }
+    };
+
+    type.remove = [](entt::registry& registry, std::span<const entt::entity> live)
+    {
+        auto& storage = registry.storage<T>();
+        for (auto entity : live)
+        {
+            if (entity != entt::null) storage.remove(entity);
+        }
+    };
+
+    types.emplace_back(std::move(type));
+}
+
+namespace Tests
+{
+    void TestWorldSnapshot();
+}
+
+}
+
+CEREAL_CLASS_VERSION(KS::ComponentChunk, 0);
+CEREAL_CLASS_VERSION(KS::WorldSnapshot, 0);
@@ -4,12 +4,15 @@
 #include <imgui/imgui_impl_dx12.h>
 #include <imgui/imgui_impl_glfw.h>
 
+#include <components/ComponentName.hpp>
+#include <components/ComponentWorldTransform.hpp>
 #include <device/Device.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/matrix_decompose.hpp>  // <-- This one is key
 #include <glm/gtx/quaternion.hpp>
 #include <scene/Scene.hpp>
+#include <tools/MemoryTracker.hpp>
 
 KS::Editor::Editor(Device& device) { device.InitializeImGUI(); }
 
@@ -18,26 +21,26 @@ KS::Editor::~Editor() {}
 void KS::Editor::RenderWindows(Device& device, Scene& scene)
 {
     SceneHierarchy(scene);
-    TransformWindow(device, scene);
+    TransformWindow(scene);
     FogWindow(device, scene);
+    MemoryWindow();
 }
 
 void KS::Editor::SceneHierarchy(Scene& scene)
 {
-    const auto& drawQueue = scene.GetQueue();
     bool open = true;
-    int i = 0;
     ImGui::Begin("Scene hierarchy", &open);
-    for (const auto& drawObject : drawQueue)
+    for (auto [entity, name] : scene.GetWorld().view<const ComponentName>().each())
     {
-        const auto& objectName = drawObject.first;
+        // Names are not unique, a model spawns one entity per mesh
+        ImGui::PushID(static_cast<int>(entt::to_integral(entity)));
 
-        const bool is_selected = (m_selectedObject == i);
-        if (ImGui::Selectable(objectName.c_str(), is_selected)) m_selectedObject = i;
+        const bool is_selected = (m_selectedObject == entity);
+        if (ImGui::Selectable(name.name.c_str(), is_selected)) m_selectedObject = entity;
 
         // Optionally focus selected item
         if (is_selected) ImGui::SetItemDefaultFocus();
-        i++;
+        ImGui::PopID();
     }
     ImGui::End();
 }
@@ -65,21 +68,20 @@ glm::mat4 RecomposeTransform(const glm::vec3& translation, const glm::vec3& rota
     return t * r * s;
 }
 
-void KS::Editor::TransformWindow(Device& device, Scene& scene)
+void KS::Editor::TransformWindow(Scene& scene)
 {
-    auto& drawQueue = scene.GetQueue();
+    auto& world = scene.GetWorld();
     bool open = true;
 
     ImGui::Begin("Transform", &open);
-    if (m_selectedObject == -1)
+    if (!world.valid(m_selectedObject) || !world.all_of<ComponentWorldTransform>(m_selectedObject))
         ImGui::Text("No object was selected");
     else
     {
-        auto& object = *std::next(drawQueue.begin(), m_selectedObject);
+        auto& transform = world.get<ComponentWorldTransform>(m_selectedObject);
 
         glm::vec3 translation, rotation, scale;
-        glm::mat4 oldTransform = object.second.modelMat;
-        DecomposeTransform(oldTransform, translation, rotation, scale);
+        DecomposeTransform(transform.matrix, translation, rotation, scale);
         bool transfromChanged = false;
         
         if (ImGui::DragFloat3("Translation", &translation.x, 0.1f)) transfromChanged = true;
@@ -88,9 +90,9 @@ void KS::Editor::TransformWindow(Device& device, Scene& scene)
 
         if (transfromChanged)
         {
-            glm::mat4 newTransform = RecomposeTransform(translation, rotation, scale);
-            glm::mat4 delta = glm::inverse(newTransform) * oldTransform;
-            scene.ApplyModelTransform(device, object.first, delta);
+            // Edits teleport, there is nothing to blend from
+            transform.matrix = RecomposeTransform(translation, rotation, scale);
+            transform.previous = transform.matrix;
         }
 
     }
@@ -116,3 +118,49 @@ void KS::Editor::FogWindow(Device& device, Scene& scene)
 
     ImGui::End();
 }
+
+void KS::Editor::MemoryWindow()
+{
+    bool open = true;
+    auto snapshot = MemoryTracker::TakeSnapshot();
+    const auto& frame_delta = MemoryTracker::GetFrameDelta();
+
+    constexpr float KB = 1024.0f;
+
+    ImGui::Begin("Memory", &open);
+    ImGui::Text("Tracked: %.1f KB", static_cast<float>(snapshot.GetTotalCurrent()) / KB);
+
+    if (ImGui::BeginTable("Memory tags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Current (KB)");
+        ImGui::TableSetupColumn("Peak (KB)");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Frame delta (KB)");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < snapshot.tags.size(); i++)
+        {
+            const auto& stats = snapshot.tags[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GetMemoryTagName(static_cast<MemoryTag>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<float>(stats.current) / KB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<float>(stats.peak) / KB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", static_cast<long long>(stats.count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%+.1f", static_cast<float>(frame_delta.tags[i].current) / KB);
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Dump to memory_report.json"))
+        MemoryTracker::WriteJSON("memory_report.json", snapshot);
+
+    ImGui::End();
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <entt/entity/entity.hpp>
 
 namespace KS
 {
@@ -13,10 +14,11 @@ public:
 
     void RenderWindows(Device& device, Scene& scene);
     void SceneHierarchy(Scene& scene);
-    void TransformWindow(Device& device, Scene& scene);
+    void TransformWindow(Scene& scene);
     void FogWindow(Device& device, Scene& scene);
+    void MemoryWindow();
 
 private:
-    int m_selectedObject = -1;
+    entt::entity m_selectedObject = entt::null;
 };
 }
@@ -0,0 +1,456 @@
+#include "AssetArchive.hpp"
+#include "Compression.hpp"
+#include "FileIO.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace
+{
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool IsPowerOfTwo(uint64_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint64_t BlockCount(uint64_t size, uint32_t block_size)
+{
+    return (size + block_size - 1) / block_size;
+}
+
+// Compresses every block of data, returns nullopt if the result is not worth storing
+std::optional<std::vector<std::byte>> CompressBlocks(std::span<const std::byte> data, uint32_t block_size, float max_ratio)
+{
+    uint64_t block_count = BlockCount(data.size(), block_size);
+    std::vector<uint32_t> block_ends {};
+    std::vector<std::byte> payload {};
+    std::vector<std::byte> scratch(KS::Compression::CompressBound(block_size));
+
+    for (uint64_t i = 0; i < block_count; i++)
+    {
+        auto block = data.subspan(i * block_size, std::min<uint64_t>(block_size, data.size() - i * block_size));
+        size_t compressed = KS::Compression::CompressBlock(block, scratch);
+
+        if (compressed != 0 && compressed < block.size())
+            payload.insert(payload.end(), scratch.begin(), scratch.begin() + compressed);
+        else
+            payload.insert(payload.end(), block.begin(), block.end());
+
+        block_ends.emplace_back(static_cast<uint32_t>(payload.size()));
+    }
+
+    size_t table_size = block_ends.size() * sizeof(uint32_t);
+    if (static_cast<float>(table_size + payload.size()) > static_cast<float>(data.size()) * max_ratio)
+        return std::nullopt;
+
+    std::vector<std::byte> out(table_size + payload.size());
+    std::memcpy(out.data(), block_ends.data(), table_size);
+    std::memcpy(out.data() + table_size, payload.data(), payload.size());
+    return out;
+}
+
+void WritePadding(std::ostream& stream, uint64_t& offset, uint64_t alignment)
+{
+    static constexpr char zeros[256] {};
+    uint64_t aligned = AlignUp(offset, alignment);
+
+    while (offset < aligned)
+    {
+        auto count = std::min<uint64_t>(aligned - offset, sizeof(zeros));
+        stream.write(zeros, count);
+        offset += count;
+    }
+}
+
+}
+
+std::optional<KS::AssetArchive> KS::AssetArchive::Open(const std::filesystem::path& path)
+{
+    using namespace ArchiveFormat;
+
+    auto mapping = MappedFile::Open(path);
+    if (!mapping || mapping->GetSize() < sizeof(Header))
+        return std::nullopt;
+
+    const std::byte* base = mapping->GetData();
+    const uint64_t size = mapping->GetSize();
+
+    Header header {};
+    std::memcpy(&header, base, sizeof(Header));
+
+    if (header.magic != MAGIC || header.version != VERSION || header.block_size == 0)
+        return std::nullopt;
+
+    // Bounds validation, so lookups never have to check again
+    uint64_t toc_size = uint64_t(header.entry_count) * sizeof(Entry);
+    if (header.toc_offset % alignof(Entry) != 0 || header.toc_offset > size || toc_size > size - header.toc_offset)
+        return std::nullopt;
+
+    if (header.names_offset > size || header.names_size > size - header.names_offset)
+        return std::nullopt;
+
+    AssetArchive out {};
+    out.entries = { reinterpret_cast<const Entry*>(base + header.toc_offset), header.entry_count };
+    out.names = { reinterpret_cast<const char*>(base + header.names_offset), header.names_size };
+    out.block_size = header.block_size;
+    out.source_path = path;
+
+    for (const auto& entry : out.entries)
+    {
+        if (uint64_t(entry.name_offset) + entry.name_length > header.names_size)
+            return std::nullopt;
+
+        if (entry.data_offset > size || entry.stored_size > size - entry.data_offset)
+            return std::nullopt;
+
+        switch (entry.compression)
+        {
+        case EntryCompression::NONE:
+            if (entry.stored_size != entry.original_size)
+                return std::nullopt;
+            break;
+
+        case EntryCompression::BLOCK_LZ:
+            if (entry.block_count != BlockCount(entry.original_size, header.block_size)
+                || entry.stored_size < uint64_t(entry.block_count) * sizeof(uint32_t))
+                return std::nullopt;
+            break;
+
+        default:
+            return std::nullopt;
+        }
+    }
+
+    out.mapping = std::move(mapping.value());
+    return out;
+}
+
+std::string KS::AssetArchive::NormalizePath(const std::filesystem::path& path)
+{
+    std::string raw = path.string();
+    std::replace(raw.begin(), raw.end(), '\\', '/');
+    return std::filesystem::path(raw).lexically_normal().generic_string();
+}
+
+const KS::AssetArchive::Entry* KS::AssetArchive::Find(const std::filesystem::path& path) const
+{
+    auto key = NormalizePath(path);
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), key,
+        [this](const Entry& entry, const std::string& k) { return GetName(entry) < k; });
+
+    if (it != entries.end() && GetName(*it) == key)
+        return &(*it);
+
+    return nullptr;
+}
+
+std::string_view KS::AssetArchive::GetName(const Entry& entry) const
+{
+    return names.substr(entry.name_offset, entry.name_length);
+}
+
+std::span<const std::byte> KS::AssetArchive::GetStoredData(const Entry& entry) const
+{
+    return { mapping.GetData() + entry.data_offset, entry.stored_size };
+}
+
+bool KS::AssetArchive::Extract(const Entry& entry, std::span<std::byte> out) const
+{
+    if (out.size() != entry.original_size)
+        return false;
+
+    auto stored = GetStoredData(entry);
+
+    if (entry.compression == ArchiveFormat::EntryCompression::NONE)
+    {
+        std::memcpy(out.data(), stored.data(), stored.size());
+        return true;
+    }
+
+    size_t table_size = entry.block_count * sizeof(uint32_t);
+    auto payload = stored.subspan(table_size);
+
+    uint32_t block_start = 0;
+    for (uint32_t i = 0; i < entry.block_count; i++)
+    {
+        uint32_t block_end {};
+        std::memcpy(&block_end, stored.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+
+        if (block_end < block_start || block_end > payload.size())
+            return false;
+
+        auto src = payload.subspan(block_start, block_end - block_start);
+        auto dst = out.subspan(uint64_t(i) * block_size, std::min<uint64_t>(block_size, out.size() - uint64_t(i) * block_size));
+
+        if (src.size() == dst.size())
+            std::memcpy(dst.data(), src.data(), src.size());
+        else if (!Compression::DecompressBlock(src, dst))
+            return false;
+
+        block_start = block_end;
+    }
+
+    return true;
+}
+
+KS::AssetArchiveWriter::AssetArchiveWriter(const AssetArchiveWriteSettings& settings)
+    : settings(settings)
+{
+    ASSERT(IsPowerOfTwo(settings.alignment) && "Archive alignment must be a power of two");
+}
+
+bool KS::AssetArchiveWriter::AddFile(const std::filesystem::path& file, const std::filesystem::path& archive_path, const AssetArchiveFileOptions& options)
+{
+    if (!std::filesystem::is_regular_file(file))
+        return false;
+
+    if (options.alignment && !IsPowerOfTwo(options.alignment.value()))
+        return false;
+
+    auto name = AssetArchive::NormalizePath(archive_path.empty() ? file : archive_path);
+
+    // Adding the same name twice replaces the previous file
+    auto it = std::find_if(files.begin(), files.end(), [&](const PendingFile& f) { return f.name == name; });
+    if (it != files.end())
+        *it = PendingFile { file, std::move(name), options };
+    else
+        files.emplace_back(PendingFile { file, std::move(name), options });
+
+    return true;
+}
+
+bool KS::AssetArchiveWriter::Write(const std::filesystem::path& output) const
+{
+    using namespace ArchiveFormat;
+
+    auto temp_path = output;
+    temp_path += ".tmp";
+
+    std::vector<const PendingFile*> sorted {};
+    for (const auto& file : files)
+        sorted.emplace_back(&file);
+
+    std::sort(sorted.begin(), sorted.end(), [](const PendingFile* a, const PendingFile* b) { return a->name < b->name; });
+
+    // The stream is closed when this returns, so a failed write can remove the temporary file
+    auto write = [&]() -> bool
+    {
+        auto stream = FileIO::OpenWriteStream(temp_path);
+        if (!stream)
+            return false;
+
+        auto& out = stream.value();
+
+        Header header {};
+        header.block_size = settings.block_size;
+        header.entry_count = static_cast<uint32_t>(sorted.size());
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        uint64_t offset = sizeof(Header);
+
+        std::vector<Entry> toc {};
+        std::string names {};
+
+        for (const auto* file : sorted)
+        {
+            auto source = MappedFile::Open(file->source);
+            if (!source)
+                return false;
+
+            std::span<const std::byte> contents { source->GetData(), source->GetSize() };
+
+            Entry entry {};
+            entry.original_size = contents.size();
+            entry.name_offset = static_cast<uint32_t>(names.size());
+            entry.name_length = static_cast<uint32_t>(file->name.size());
+            names += file->name;
+
+            std::optional<std::vector<std::byte>> compressed {};
+            if (file->options.compress.value_or(settings.compress) && !contents.empty())
+                compressed = CompressBlocks(contents, settings.block_size, settings.max_compressed_ratio);
+
+            if (compressed)
+            {
+                entry.compression = EntryCompression::BLOCK_LZ;
+                entry.block_count = static_cast<uint32_t>(BlockCount(contents.size(), settings.block_size));
+                contents = compressed.value();
+            }
+
+            WritePadding(out, offset, file->options.alignment.value_or(settings.alignment));
+
+            entry.data_offset = offset;
+            entry.stored_size = contents.size();
+            out.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+            offset += contents.size();
+
+            toc.emplace_back(entry);
+        }
+
+        WritePadding(out, offset, alignof(Entry));
+        header.toc_offset = offset;
+        out.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(Entry));
+        offset += toc.size() * sizeof(Entry);
+
+        header.names_offset = offset;
+        header.names_size = names.size();
+        out.write(names.data(), names.size());
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+        return out.good();
+    };
+
+    std::error_code e {};
+    if (write())
+    {
+        std::filesystem::rename(temp_path, output, e);
+        if (!e)
+            return true;
+    }
+
+    std::filesystem::remove(temp_path, e);
+    return false;
+}
+
+void KS::Tests::TestAssetArchive()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSAssetArchive";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "loose" / "textures");
+
+    auto WriteLoose = [&](const std::string& name, const std::vector<std::byte>& data)
+    {
+        std::ofstream file(directory / "loose" / name, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return directory / "loose" / name;
+    };
+
+    std::mt19937 random { 7 };
+    std::uniform_int_distribution<int> byte { 0, 255 };
+
+    // Several blocks of compressible data, noise that is stored as is, and an empty file
+    std::vector<std::byte> text {};
+    while (text.size() < 3 * ArchiveFormat::DEFAULT_BLOCK_SIZE + 100)
+    {
+        for (char c : std::string_view("vertex normal uv tangent "))
+            text.emplace_back(static_cast<std::byte>(c));
+        text.emplace_back(static_cast<std::byte>(byte(random) % 4));
+    }
+
+    std::vector<std::byte> noise(10000);
+    for (auto& b : noise)
+        b = static_cast<std::byte>(byte(random));
+
+    AssetArchiveWriteSettings settings {};
+    settings.compress = true;
+    AssetArchiveWriter writer { settings };
+
+    if (!writer.AddFile(WriteLoose("mesh.bin", text), "models/cube/mesh.bin")
+        || !writer.AddFile(WriteLoose("textures/noise.png", noise), "models\\cube\\textures\\..\\noise.png", { 4096, {} })
+        || !writer.AddFile(WriteLoose("empty.json", {}), "empty.json")
+        || !writer.AddFile(WriteLoose("plain.bin", text), "plain.bin", { {}, false })
+        || writer.AddFile(directory / "loose" / "missing.bin") || writer.AddFile(directory / "loose" / "plain.bin", {}, { 3, {} }))
+    {
+        throw;
+    }
+
+    auto archive_path = directory / "assets.kspak";
+    if (!writer.Write(archive_path) || std::filesystem::exists(directory / "assets.kspak.tmp"))
+    {
+        throw;
+    }
+
+    auto archive = AssetArchive::Open(archive_path);
+    if (!archive || archive->GetEntries().size() != 4 || archive->Find("models/missing.bin"))
+    {
+        throw;
+    }
+
+    // Names are sorted, so Find can binary search
+    for (size_t i = 1; i < archive->GetEntries().size(); i++)
+    {
+        if (!(archive->GetName(archive->GetEntries()[i - 1]) < archive->GetName(archive->GetEntries()[i])))
+        {
+            throw;
+        }
+    }
+
+    auto Extracted = [&](const std::filesystem::path& name)
+    {
+        const auto* entry = archive->Find(name);
+        if (!entry)
+        {
+            throw;
+        }
+
+        std::vector<std::byte> out(entry->original_size);
+        if (!archive->Extract(*entry, out))
+        {
+            throw;
+        }
+        return out;
+    };
+
+    const auto* mesh = archive->Find("./models/cube/mesh.bin");
+    const auto* image = archive->Find("models/cube/noise.png");
+    const auto* plain = archive->Find("plain.bin");
+    if (!mesh || mesh->compression != ArchiveFormat::EntryCompression::BLOCK_LZ || mesh->stored_size >= text.size()
+        || !image || image->compression != ArchiveFormat::EntryCompression::NONE || image->data_offset % 4096 != 0
+        || !plain || plain->compression != ArchiveFormat::EntryCompression::NONE)
+    {
+        throw;
+    }
+
+    if (Extracted("models/cube/mesh.bin") != text || Extracted("models/cube/noise.png") != noise
+        || !Extracted("empty.json").empty() || Extracted("plain.bin") != text)
+    {
+        throw;
+    }
+
+    // Mounted archives are read before loose files
+    if (!FileIO::MountArchive(archive_path))
+    {
+        throw;
+    }
+
+    auto read = FileIO::ReadFile("models/cube/mesh.bin");
+    bool matches = read && read->GetSize() == text.size() && std::memcmp(read->GetData(), text.data(), text.size()) == 0;
+    read.reset();
+    FileIO::UnmountArchives();
+
+    if (!matches)
+    {
+        throw;
+    }
+
+    // A failed write leaves neither the output nor its temporary file behind
+    std::filesystem::remove(directory / "loose" / "plain.bin");
+    auto failed_path = directory / "failed.kspak";
+    if (writer.Write(failed_path) || std::filesystem::exists(failed_path)
+        || std::filesystem::exists(directory / "failed.kspak.tmp"))
+    {
+        throw;
+    }
+
+    // Corrupt archives are rejected when opened
+    {
+        std::fstream file(archive_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write("XXXX", 4);
+    }
+
+    if (AssetArchive::Open(archive_path) || AssetArchive::Open(directory / "missing.kspak"))
+    {
+        throw;
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <code_utility.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+namespace KS
+{
+
+// Packed asset archive (.kspak)
+// Layout: [ArchiveHeader] [entry data, each aligned] [ArchiveEntry table, sorted by name] [name table]
+// All values are little endian. Names are normalized with AssetArchive::NormalizePath
+namespace ArchiveFormat
+{
+    constexpr uint32_t MAGIC = 0x4B50534B; // "KSPK"
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t DEFAULT_ALIGNMENT = 16;
+    constexpr uint32_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    enum class EntryCompression : uint32_t
+    {
+        NONE = 0,
+
+        // Data starts with uint32_t end offsets for every block, followed by the blocks themselves.
+        // Blocks that did not shrink are stored as is.
+        BLOCK_LZ = 1,
+    };
+
+    struct Header
+    {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t entry_count = 0;
+        uint32_t block_size = DEFAULT_BLOCK_SIZE;
+        uint64_t toc_offset = 0;
+        uint64_t names_offset = 0;
+        uint64_t names_size = 0;
+    };
+
+    struct Entry
+    {
+        uint64_t data_offset = 0; // From the start of the archive
+        uint64_t stored_size = 0; // Size inside the archive
+        uint64_t original_size = 0; // Size once extracted
+        uint32_t name_offset = 0; // Into the name table
+        uint32_t name_length = 0;
+        EntryCompression compression = EntryCompression::NONE;
+        uint32_t block_count = 0;
+    };
+
+    static_assert(sizeof(Header) == 40);
+    static_assert(sizeof(Entry) == 40);
+}
+
+// Read only access to a memory mapped .kspak file
+class AssetArchive
+{
+public:
+    using Entry = ArchiveFormat::Entry;
+
+    AssetArchive() = default;
+
+    // Nullopt if the file is missing or not a valid archive
+    static std::optional<AssetArchive> Open(const std::filesystem::path& path);
+
+    // Converts any path to the form used as archive key: forward slashes, no "." or ".." parts
+    static std::string NormalizePath(const std::filesystem::path& path);
+
+    // Binary search in the table of contents, null if the file is not in the archive
+    const Entry* Find(const std::filesystem::path& path) const;
+
+    std::string_view GetName(const Entry& entry) const;
+    std::span<const Entry> GetEntries() const { return entries; }
+    const std::filesystem::path& GetPath() const { return source_path; }
+
+    // Bytes as stored in the archive, only the same as the file contents if the entry is not compressed
+    std::span<const std::byte> GetStoredData(const Entry& entry) const;
+
+    // Decompresses (or copies) the entry into out, which must be exactly entry.original_size bytes
+    bool Extract(const Entry& entry, std::span<std::byte> out) const;
+
+private:
+    MappedFile mapping {};
+    std::filesystem::path source_path {};
+    uint32_t block_size {};
+    std::span<const Entry> entries {};
+    std::string_view names {};
+};
+
+struct AssetArchiveFileOptions
+{
+    std::optional<uint32_t> alignment {}; // Overrides the archive alignment, must be a power of two
+    std::optional<bool> compress {}; // Overrides the archive compression setting
+};
+
+struct AssetArchiveWriteSettings
+{
+    uint32_t alignment = ArchiveFormat::DEFAULT_ALIGNMENT;
+    uint32_t block_size = ArchiveFormat::DEFAULT_BLOCK_SIZE;
+
+    // Entries are only stored compressed when they shrink below this fraction of the original size
+    bool compress = false;
+    float max_compressed_ratio = 0.9f;
+};
+
+// Collects loose files and writes them into a single archive
+class AssetArchiveWriter
+{
+public:
+    AssetArchiveWriter(const AssetArchiveWriteSettings& settings = {});
+
+    // Adds a single file, stored under archive_path (or its own path if empty)
+    bool AddFile(const std::filesystem::path& file, const std::filesystem::path& archive_path = {}, const AssetArchiveFileOptions& options = {});
+
+    // Writes to a temporary file next to output and renames it over output once complete
+    bool Write(const std::filesystem::path& output) const;
+
+    size_t GetFileCount() const { return files.size(); }
+
+private:
+    struct PendingFile
+    {
+        std::filesystem::path source {};
+        std::string name {};
+        AssetArchiveFileOptions options {};
+    };
+
+    AssetArchiveWriteSettings settings {};
+    std::vector<PendingFile> files {};
+};
+
+namespace Tests
+{
+    void TestAssetArchive();
+}
+
+}
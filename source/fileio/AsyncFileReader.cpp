@@ -0,0 +1,695 @@
+#include "AsyncFileReader.hpp"
+
+#include <fileio/FileIO.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define KS_ASYNC_IO_URING
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace
+{
+
+constexpr KS::AsyncFileReader::FileHandle INVALID_FILE = -1;
+
+// Positional read of up to size bytes, returns the amount read or -1 on error
+int64_t ReadAt(KS::AsyncFileReader::FileHandle file, std::byte* destination, uint64_t size, uint64_t offset)
+{
+#if defined(_WIN32)
+    OVERLAPPED overlapped {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    DWORD read = 0;
+    DWORD request = static_cast<DWORD>(std::min<uint64_t>(size, UINT32_MAX));
+    if (!::ReadFile(reinterpret_cast<HANDLE>(file), destination, request, &read, &overlapped))
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    return read;
+#else
+    while (true)
+    {
+        auto read = ::pread(static_cast<int>(file), destination, size, static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR)
+            continue;
+        return read;
+    }
+#endif
+}
+
+}
+
+struct KS::AsyncFileReader::Operation
+{
+    FileHandle file = INVALID_FILE;
+    bool owns_file = false;
+    bool failed = false;
+
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint64_t done = 0;
+    std::byte* destination {};
+    std::vector<std::byte> buffer {};
+
+    uint64_t user_data = 0;
+    Callback callback {};
+
+#if defined(KS_ASYNC_IO_URING)
+    iovec vector {};
+#endif
+};
+
+#if defined(KS_ASYNC_IO_URING)
+
+// Minimal io_uring wrapper on top of the raw system calls, so no liburing is needed.
+// All submission side calls must be serialized by the caller, completions are only read by one thread.
+class KS::AsyncFileReader::Ring
+{
+public:
+    static constexpr uint64_t WAKE_UP = 0;
+
+    static std::unique_ptr<Ring> Create(uint32_t entries)
+    {
+        io_uring_params params {};
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+            return nullptr;
+
+        auto out = std::unique_ptr<Ring>(new Ring());
+        out->fd = fd;
+
+        out->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        out->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+
+        if (single_map)
+            out->sq_map_size = out->cq_map_size = std::max(out->sq_map_size, out->cq_map_size);
+
+        out->sq_map = ::mmap(nullptr, out->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (out->sq_map == MAP_FAILED)
+            return nullptr;
+
+        out->cq_map = single_map
+            ? out->sq_map
+            : ::mmap(nullptr, out->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (out->cq_map == MAP_FAILED)
+            return nullptr;
+
+        out->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, out->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            return nullptr;
+
+        auto* sq = static_cast<std::byte*>(out->sq_map);
+        auto* cq = static_cast<std::byte*>(out->cq_map);
+
+        out->sqes = static_cast<io_uring_sqe*>(sqes);
+        out->sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        out->sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        out->sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        out->cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        out->cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        out->cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        out->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return out;
+    }
+
+    ~Ring()
+    {
+        if (sqes)
+            ::munmap(sqes, sqes_size);
+        if (cq_map && cq_map != MAP_FAILED && cq_map != sq_map)
+            ::munmap(cq_map, cq_map_size);
+        if (sq_map && sq_map != MAP_FAILED)
+            ::munmap(sq_map, sq_map_size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    // Queues a read of the part of op that is still missing
+    void PushRead(Operation* op)
+    {
+        op->vector.iov_base = op->destination + op->done;
+        op->vector.iov_len = op->length - op->done;
+
+        auto& sqe = NextEntry();
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = static_cast<int>(op->file);
+        sqe.off = op->offset + op->done;
+        sqe.addr = reinterpret_cast<uint64_t>(&op->vector);
+        sqe.len = 1;
+        sqe.user_data = reinterpret_cast<uint64_t>(op);
+        PublishEntry();
+    }
+
+    void PushWakeUp()
+    {
+        auto& sqe = NextEntry();
+        sqe.opcode = IORING_OP_NOP;
+        sqe.user_data = WAKE_UP;
+        PublishEntry();
+    }
+
+    // Hands every queued entry to the kernel
+    void Submit()
+    {
+        while (unsubmitted > 0)
+        {
+            int submitted = static_cast<int>(::syscall(__NR_io_uring_enter, fd, unsubmitted, 0, 0, nullptr, 0));
+            if (submitted < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                    continue;
+                break;
+            }
+            unsubmitted -= static_cast<uint32_t>(submitted);
+        }
+    }
+
+    // Blocks until at least one completion is available
+    void WaitForCompletion()
+    {
+        ::syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+
+    template <typename F>
+    uint32_t ForEachCompletion(F&& function)
+    {
+        uint32_t head = *cq_head;
+        uint32_t tail = std::atomic_ref<uint32_t>(*cq_tail).load(std::memory_order_acquire);
+        uint32_t count = tail - head;
+
+        for (; head != tail; head++)
+            function(cqes[head & cq_mask]);
+
+        std::atomic_ref<uint32_t>(*cq_head).store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    Ring() = default;
+
+    io_uring_sqe& NextEntry()
+    {
+        uint32_t tail = *sq_tail;
+        uint32_t index = tail & sq_mask;
+
+        auto& sqe = sqes[index];
+        sqe = {};
+        sq_array[index] = index;
+        return sqe;
+    }
+
+    // Makes the entry returned by NextEntry visible to the kernel once it is filled in
+    void PublishEntry()
+    {
+        std::atomic_ref<uint32_t>(*sq_tail).store(*sq_tail + 1, std::memory_order_release);
+        unsubmitted++;
+    }
+
+    int fd = -1;
+    uint32_t unsubmitted = 0;
+
+    void* sq_map {};
+    void* cq_map {};
+    size_t sq_map_size = 0;
+    size_t cq_map_size = 0;
+    size_t sqes_size = 0;
+
+    io_uring_sqe* sqes {};
+    uint32_t* sq_tail {};
+    uint32_t* sq_array {};
+    uint32_t sq_mask = 0;
+
+    io_uring_cqe* cqes {};
+    uint32_t* cq_head {};
+    uint32_t* cq_tail {};
+    uint32_t cq_mask = 0;
+};
+
+#else
+
+// Placeholder so the unique_ptr member can be destroyed on platforms without io_uring
+class KS::AsyncFileReader::Ring
+{
+};
+
+#endif
+
+KS::AsyncFileReader::AsyncFileReader(const AsyncFileReaderSettings& settings)
+    : settings(settings)
+{
+    ASSERT(settings.queue_depth > 0 && "Async reader needs a queue depth of at least 1");
+
+#if defined(KS_ASYNC_IO_URING)
+    if (settings.allow_io_uring)
+        ring = Ring::Create(settings.queue_depth + 1); // One spare entry for waking up the completion thread
+#endif
+
+    if (ring)
+    {
+        backend = Backend::IO_URING;
+        threads.emplace_back([this]() { RingLoop(); });
+    }
+    else
+    {
+        backend = Backend::THREAD_POOL;
+        for (uint32_t i = 0; i < std::max(settings.worker_threads, 1u); i++)
+            threads.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+KS::AsyncFileReader::~AsyncFileReader()
+{
+    WaitIdle();
+
+    {
+        std::scoped_lock lock { queue_mutex };
+        stopping = true;
+
+#if defined(KS_ASYNC_IO_URING)
+        if (ring)
+        {
+            ring->PushWakeUp();
+            ring->Submit();
+        }
+#endif
+    }
+
+    queue_signal.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+std::optional<KS::AsyncFileReader::FileHandle> KS::AsyncFileReader::OpenFile(const std::filesystem::path& path)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return std::nullopt;
+    return reinterpret_cast<FileHandle>(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return std::nullopt;
+    return fd;
+#endif
+}
+
+void KS::AsyncFileReader::CloseFile(FileHandle file)
+{
+#if defined(_WIN32)
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+    ::close(static_cast<int>(file));
+#endif
+}
+
+std::optional<uint64_t> KS::AsyncFileReader::GetFileSize(FileHandle file)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER size {};
+    if (!GetFileSizeEx(reinterpret_cast<HANDLE>(file), &size))
+        return std::nullopt;
+    return static_cast<uint64_t>(size.QuadPart);
+#else
+    struct stat info {};
+    if (::fstat(static_cast<int>(file), &info) != 0)
+        return std::nullopt;
+    return static_cast<uint64_t>(info.st_size);
+#endif
+}
+
+void KS::AsyncFileReader::Submit(std::span<ReadRequest> batch)
+{
+    std::vector<std::unique_ptr<Operation>> ready {};
+    std::vector<std::unique_ptr<Operation>> finished {};
+
+    for (auto& request : batch)
+    {
+        auto op = std::make_unique<Operation>();
+        op->offset = request.offset;
+        op->user_data = request.user_data;
+        op->callback = std::move(request.callback);
+
+        if (auto* path = std::get_if<std::filesystem::path>(&request.file))
+        {
+            op->file = OpenFile(*path).value_or(INVALID_FILE);
+            op->owns_file = op->file != INVALID_FILE;
+        }
+        else
+        {
+            op->file = std::get<FileHandle>(request.file);
+        }
+
+        std::optional<uint64_t> file_size {};
+        if (op->file != INVALID_FILE)
+            file_size = GetFileSize(op->file);
+
+        if (!file_size)
+        {
+            op->failed = true;
+            finished.emplace_back(std::move(op));
+            continue;
+        }
+
+        uint64_t available = file_size.value() - std::min(request.offset, file_size.value());
+        op->length = request.length == WHOLE_FILE ? available : request.length;
+
+        if (request.destination.empty())
+        {
+            op->buffer.resize(op->length);
+            op->destination = op->buffer.data();
+        }
+        else
+        {
+            op->destination = request.destination.data();
+            op->failed = request.destination.size() < op->length;
+        }
+
+        if (op->failed || op->length == 0)
+            finished.emplace_back(std::move(op));
+        else
+            ready.emplace_back(std::move(op));
+    }
+
+    {
+        std::scoped_lock lock { queue_mutex };
+        in_flight += ready.size() + finished.size();
+
+        for (auto& op : ready)
+            pending.emplace_back(std::move(op));
+
+        if (ring)
+            PumpRing();
+    }
+
+    if (!ring)
+        queue_signal.notify_all();
+
+    for (auto& op : finished)
+        Complete(std::move(op));
+}
+
+void KS::AsyncFileReader::Submit(ReadRequest&& request)
+{
+    Submit(std::span<ReadRequest>(&request, 1));
+}
+
+size_t KS::AsyncFileReader::PollCompletions(std::vector<ReadResult>& out)
+{
+    std::scoped_lock lock { queue_mutex };
+    size_t count = completed.size();
+
+    for (auto& result : completed)
+        out.emplace_back(std::move(result));
+
+    completed.clear();
+    return count;
+}
+
+void KS::AsyncFileReader::WaitIdle()
+{
+    std::unique_lock lock { queue_mutex };
+    idle_signal.wait(lock, [this]() { return in_flight == 0; });
+}
+
+void KS::AsyncFileReader::Complete(std::unique_ptr<Operation> op)
+{
+    if (op->owns_file)
+        CloseFile(op->file);
+
+    ReadResult result {};
+    result.user_data = op->user_data;
+    result.bytes_read = op->done;
+    result.success = !op->failed && op->done == op->length;
+    result.buffer = std::move(op->buffer);
+
+    if (op->callback)
+        op->callback(result);
+
+    std::scoped_lock lock { queue_mutex };
+
+    if (!op->callback)
+        completed.emplace_back(std::move(result));
+
+    if (--in_flight == 0)
+        idle_signal.notify_all();
+}
+
+void KS::AsyncFileReader::WorkerLoop()
+{
+    while (true)
+    {
+        std::unique_ptr<Operation> op {};
+
+        {
+            std::unique_lock lock { queue_mutex };
+            queue_signal.wait(lock, [this]() { return stopping || !pending.empty(); });
+
+            if (pending.empty())
+                return;
+
+            op = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        while (op->done < op->length)
+        {
+            auto read = ReadAt(op->file, op->destination + op->done, op->length - op->done, op->offset + op->done);
+            if (read <= 0)
+            {
+                op->failed = read < 0;
+                break;
+            }
+            op->done += static_cast<uint64_t>(read);
+        }
+
+        Complete(std::move(op));
+    }
+}
+
+#if defined(KS_ASYNC_IO_URING)
+
+void KS::AsyncFileReader::PumpRing()
+{
+    // Expects queue_mutex to be held
+    uint32_t pushed = 0;
+
+    while (!pending.empty() && ring_in_flight < settings.queue_depth)
+    {
+        ring->PushRead(pending.front().release());
+        pending.pop_front();
+        ring_in_flight++;
+        pushed++;
+    }
+
+    if (pushed > 0)
+        ring->Submit();
+}
+
+void KS::AsyncFileReader::RingLoop()
+{
+    std::vector<std::unique_ptr<Operation>> finished {};
+    std::vector<std::unique_ptr<Operation>> retry {};
+
+    while (true)
+    {
+        ring->WaitForCompletion();
+
+        bool wake_up = false;
+        uint32_t reads_done = ring->ForEachCompletion(
+            [&](const io_uring_cqe& cqe)
+            {
+                if (cqe.user_data == Ring::WAKE_UP)
+                {
+                    wake_up = true;
+                    return;
+                }
+
+                auto op = std::unique_ptr<Operation>(reinterpret_cast<Operation*>(cqe.user_data));
+
+                if (cqe.res == -EAGAIN || cqe.res == -EINTR)
+                {
+                    retry.emplace_back(std::move(op));
+                    return;
+                }
+
+                if (cqe.res < 0)
+                    op->failed = true;
+                else
+                    op->done += static_cast<uint64_t>(cqe.res);
+
+                // Short reads are continued where they stopped, a read of 0 bytes means the file got shorter
+                if (!op->failed && cqe.res > 0 && op->done < op->length)
+                    retry.emplace_back(std::move(op));
+                else
+                    finished.emplace_back(std::move(op));
+            });
+
+        {
+            std::scoped_lock lock { queue_mutex };
+            ring_in_flight -= reads_done - (wake_up ? 1 : 0);
+
+            for (auto& op : retry)
+                pending.emplace_front(std::move(op));
+            retry.clear();
+
+            PumpRing();
+
+            if (wake_up && stopping)
+                return;
+        }
+
+        for (auto& op : finished)
+            Complete(std::move(op));
+        finished.clear();
+    }
+}
+
+#else
+
+void KS::AsyncFileReader::PumpRing()
+{
+}
+
+void KS::AsyncFileReader::RingLoop()
+{
+}
+
+#endif
+
+void KS::Tests::TestAsyncFileReader()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSAsyncFileReader";
+    std::filesystem::create_directories(directory);
+    auto path = directory / "data.bin";
+
+    // A pattern that differs per offset, so every read can be checked against where it came from
+    std::vector<std::byte> contents(10000);
+    for (size_t i = 0; i < contents.size(); i++)
+        contents[i] = static_cast<std::byte>((i * 7) % 251);
+
+    if (!FileIO::WriteFileAtomic(path, [&](std::ostream& out)
+        { out.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size())); }))
+    {
+        throw;
+    }
+
+    auto Matches = [&](std::span<const std::byte> bytes, uint64_t offset)
+    {
+        return offset + bytes.size() <= contents.size() && std::equal(bytes.begin(), bytes.end(), contents.begin() + offset);
+    };
+
+    // Without io_uring support (old kernels, containers that block it) both runs use the thread pool
+    for (bool allow_io_uring : { true, false })
+    {
+        AsyncFileReaderSettings settings {};
+        settings.allow_io_uring = allow_io_uring;
+        settings.queue_depth = 4; // Less than a batch, so reads wait for a free ring entry
+        AsyncFileReader reader { settings };
+
+        if (!allow_io_uring && reader.GetBackend() != AsyncFileReader::Backend::THREAD_POOL)
+        {
+            throw;
+        }
+
+        auto file = AsyncFileReader::OpenFile(path);
+        if (!file || AsyncFileReader::GetFileSize(*file) != contents.size())
+        {
+            throw;
+        }
+
+        // Overlapping ranges of one opened file, half into destinations and half into buffers the reader allocates
+        std::vector<std::vector<std::byte>> destinations(8, std::vector<std::byte>(1000));
+        std::vector<AsyncFileReader::ReadRequest> batch {};
+        for (uint64_t i = 0; i < 16; i++)
+        {
+            AsyncFileReader::ReadRequest request {};
+            request.file = *file;
+            request.offset = i * 600;
+            request.length = 1000;
+            request.user_data = i;
+            if (i < destinations.size()) request.destination = destinations[i];
+            batch.emplace_back(std::move(request));
+        }
+
+        // Cut short by the end of the file, the whole file by path, and a file that does not exist
+        batch.emplace_back(AsyncFileReader::ReadRequest { *file, 9500, 1000, {}, 100 });
+        batch.emplace_back(AsyncFileReader::ReadRequest { path, 0, AsyncFileReader::WHOLE_FILE, {}, 101 });
+        batch.emplace_back(AsyncFileReader::ReadRequest { directory / "missing.bin", 0, AsyncFileReader::WHOLE_FILE, {}, 102 });
+
+        reader.Submit(batch);
+        reader.WaitIdle();
+        AsyncFileReader::CloseFile(*file);
+
+        std::vector<AsyncFileReader::ReadResult> results {};
+        if (reader.PollCompletions(results) != batch.size())
+        {
+            throw;
+        }
+
+        for (const auto& result : results)
+        {
+            bool ok = false;
+            if (result.user_data < destinations.size())
+                ok = result.success && result.bytes_read == 1000 && Matches(destinations[result.user_data], result.user_data * 600);
+            else if (result.user_data < 16)
+                ok = result.success && result.bytes_read == 1000 && Matches(result.buffer, result.user_data * 600);
+            else if (result.user_data == 100)
+                ok = !result.success && result.bytes_read == 500 && Matches(std::span(result.buffer).first(500), 9500);
+            else if (result.user_data == 101)
+                ok = result.success && result.bytes_read == contents.size() && Matches(result.buffer, 0);
+            else if (result.user_data == 102)
+                ok = !result.success && result.bytes_read == 0;
+
+            if (!ok)
+            {
+                throw;
+            }
+        }
+
+        // Requests with a callback are handed to it on the I/O thread, and never reach PollCompletions
+        std::atomic<uint32_t> called { 0 };
+        std::atomic<bool> callbacks_ok { true };
+        for (uint64_t i = 0; i < 4; i++)
+        {
+            AsyncFileReader::ReadRequest request { path, i * 100, 100, {}, i };
+            request.callback = [&, i](AsyncFileReader::ReadResult& result)
+            {
+                if (!result.success || result.user_data != i || !Matches(result.buffer, i * 100))
+                    callbacks_ok = false;
+                called++;
+            };
+            reader.Submit(std::move(request));
+        }
+        reader.WaitIdle();
+
+        results.clear();
+        if (called != 4 || !callbacks_ok || reader.PollCompletions(results) != 0)
+        {
+            throw;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <code_utility.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace KS
+{
+
+struct AsyncFileReaderSettings
+{
+    uint32_t queue_depth = 64; // Reads kept in flight at once
+    uint32_t worker_threads = 4; // Only used by the thread pool backend
+    bool allow_io_uring = true;
+};
+
+// Batched asynchronous file reads.
+// Uses io_uring on Linux when the kernel supports it, a pool of blocking reader threads otherwise.
+// Callbacks run on an internal I/O thread, requests without a callback end up in the completion queue instead.
+class AsyncFileReader
+{
+public:
+    enum class Backend
+    {
+        IO_URING,
+        THREAD_POOL,
+    };
+
+    // File opened through OpenFile, cheaper than passing a path when reading many ranges from one file
+    using FileHandle = intptr_t;
+
+    // Reads up to the end of the file
+    static constexpr uint64_t WHOLE_FILE = UINT64_MAX;
+
+    struct ReadResult
+    {
+        uint64_t user_data = 0;
+        uint64_t bytes_read = 0;
+        bool success = false; // All requested bytes were read
+
+        // Holds the data if the request had no destination
+        std::vector<std::byte> buffer {};
+    };
+
+    using Callback = std::function<void(ReadResult&)>;
+
+    struct ReadRequest
+    {
+        std::variant<std::filesystem::path, FileHandle> file {};
+        uint64_t offset = 0;
+        uint64_t length = WHOLE_FILE;
+
+        // Must stay alive until completion and fit length bytes. If empty, a buffer is allocated for the result
+        std::span<std::byte> destination {};
+
+        uint64_t user_data = 0;
+        Callback callback {};
+    };
+
+    AsyncFileReader(const AsyncFileReaderSettings& settings = {});
+    ~AsyncFileReader();
+
+    NON_COPYABLE(AsyncFileReader);
+    NON_MOVABLE(AsyncFileReader);
+
+    static std::optional<FileHandle> OpenFile(const std::filesystem::path& path);
+    static void CloseFile(FileHandle file);
+    static std::optional<uint64_t> GetFileSize(FileHandle file);
+
+    // Queues all requests at once. Requests whose file can't be opened complete immediately with success = false
+    void Submit(std::span<ReadRequest> batch);
+    void Submit(ReadRequest&& request);
+
+    // Moves finished requests without a callback into out, returns how many were added
+    size_t PollCompletions(std::vector<ReadResult>& out);
+
+    // Blocks until every submitted request has completed
+    void WaitIdle();
+
+    Backend GetBackend() const { return backend; }
+
+private:
+    struct Operation;
+    class Ring;
+
+    void Complete(std::unique_ptr<Operation> op);
+    void WorkerLoop();
+    void RingLoop();
+    void PumpRing();
+
+    AsyncFileReaderSettings settings {};
+    Backend backend = Backend::THREAD_POOL;
+
+    std::mutex queue_mutex {};
+    std::condition_variable queue_signal {};
+    std::condition_variable idle_signal {};
+    std::deque<std::unique_ptr<Operation>> pending {};
+    std::vector<ReadResult> completed {};
+    uint64_t in_flight = 0;
+    bool stopping = false;
+
+    std::unique_ptr<Ring> ring {};
+    uint32_t ring_in_flight = 0; // Reads currently owned by the kernel
+    std::vector<std::thread> threads {};
+};
+
+namespace Tests
+{
+    void TestAsyncFileReader();
+}
+
+}
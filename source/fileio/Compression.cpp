@@ -0,0 +1,294 @@
+#include "Compression.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Stream of sequences, LZ4 style:
+// [token] [extra literal length] [literals] [offset u16] [extra match length]
+// Token high nibble is the literal count, low nibble the match length minus MIN_MATCH.
+// A nibble of 15 is followed by bytes that are added to it until one of them is not 255.
+// The final sequence only holds literals and ends the block.
+
+namespace
+{
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr uint32_t HASH_BITS = 12;
+
+uint32_t Read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+class Writer
+{
+public:
+    Writer(uint8_t* begin, uint8_t* end)
+        : begin(begin)
+        , ptr(begin)
+        , end(end)
+    {
+    }
+
+    bool Byte(uint8_t b)
+    {
+        if (ptr == end)
+            return false;
+        *ptr++ = b;
+        return true;
+    }
+
+    bool Bytes(const uint8_t* src, size_t count)
+    {
+        if (static_cast<size_t>(end - ptr) < count)
+            return false;
+        std::memcpy(ptr, src, count);
+        ptr += count;
+        return true;
+    }
+
+    bool Length(size_t remainder)
+    {
+        while (remainder >= 255)
+        {
+            if (!Byte(255))
+                return false;
+            remainder -= 255;
+        }
+        return Byte(static_cast<uint8_t>(remainder));
+    }
+
+    size_t Written() const { return ptr - begin; }
+
+private:
+    uint8_t* begin;
+    uint8_t* ptr;
+    uint8_t* end;
+};
+
+bool EmitSequence(Writer& out, const uint8_t* literals, size_t literal_count, size_t offset, size_t match_length)
+{
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+
+    uint8_t token = static_cast<uint8_t>((literal_count >= 15 ? 15 : literal_count) << 4);
+    token |= static_cast<uint8_t>(match_code >= 15 ? 15 : match_code);
+
+    if (!out.Byte(token))
+        return false;
+    if (literal_count >= 15 && !out.Length(literal_count - 15))
+        return false;
+    if (!out.Bytes(literals, literal_count))
+        return false;
+
+    // Last sequence, no match follows
+    if (match_length == 0)
+        return true;
+
+    if (!out.Byte(static_cast<uint8_t>(offset & 0xFF)) || !out.Byte(static_cast<uint8_t>(offset >> 8)))
+        return false;
+    if (match_code >= 15 && !out.Length(match_code - 15))
+        return false;
+
+    return true;
+}
+
+bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length)
+{
+    uint8_t b = 255;
+    while (b == 255)
+    {
+        if (ip == iend)
+            return false;
+        b = *ip++;
+        length += b;
+    }
+    return true;
+}
+
+}
+
+size_t KS::Compression::CompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t KS::Compression::CompressBlock(std::span<const std::byte> src, std::span<std::byte> dst)
+{
+    const auto* in = reinterpret_cast<const uint8_t*>(src.data());
+    const auto* iend = in + src.size();
+
+    auto* out_begin = reinterpret_cast<uint8_t*>(dst.data());
+    Writer out { out_begin, out_begin + dst.size() };
+
+    const uint8_t* ip = in;
+    const uint8_t* anchor = in;
+
+    if (src.size() > MIN_MATCH + LAST_LITERALS)
+    {
+        const uint8_t* match_limit = iend - LAST_LITERALS;
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+        while (ip + MIN_MATCH <= match_limit)
+        {
+            uint32_t sequence = Read32(ip);
+            uint32_t& slot = table[Hash(sequence)];
+            const uint8_t* ref = in + slot;
+            slot = static_cast<uint32_t>(ip - in);
+
+            if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != sequence)
+            {
+                ip++;
+                continue;
+            }
+
+            size_t length = MIN_MATCH;
+            while (ip + length < match_limit && ref[length] == ip[length])
+                length++;
+
+            if (!EmitSequence(out, anchor, ip - anchor, ip - ref, length))
+                return 0;
+
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    if (!EmitSequence(out, anchor, iend - anchor, 0, 0))
+        return 0;
+
+    return out.Written();
+}
+
+bool KS::Compression::DecompressBlock(std::span<const std::byte> src, std::span<std::byte> dst)
+{
+    const auto* ip = reinterpret_cast<const uint8_t*>(src.data());
+    const auto* iend = ip + src.size();
+
+    auto* out = reinterpret_cast<uint8_t*>(dst.data());
+    auto* op = out;
+    auto* oend = out + dst.size();
+
+    while (ip < iend)
+    {
+        uint8_t token = *ip++;
+
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !ReadLength(ip, iend, literal_count))
+            return false;
+
+        if (static_cast<size_t>(iend - ip) < literal_count || static_cast<size_t>(oend - op) < literal_count)
+            return false;
+
+        std::memcpy(op, ip, literal_count);
+        ip += literal_count;
+        op += literal_count;
+
+        if (ip == iend)
+            return op == oend;
+
+        if (iend - ip < 2)
+            return false;
+
+        size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - out))
+            return false;
+
+        size_t match_length = token & 0xF;
+        if (match_length == 15 && !ReadLength(ip, iend, match_length))
+            return false;
+        match_length += MIN_MATCH;
+
+        if (static_cast<size_t>(oend - op) < match_length)
+            return false;
+
+        // Matches may overlap the output they are produced into, so copy byte by byte
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < match_length; i++)
+            op[i] = match[i];
+        op += match_length;
+    }
+
+    return false;
+}
+
+void KS::Tests::TestCompression()
+{
+    auto RoundTrip = [](const std::vector<std::byte>& data)
+    {
+        std::vector<std::byte> compressed(Compression::CompressBound(data.size()));
+        size_t size = Compression::CompressBlock(data, compressed);
+        if (size == 0)
+        {
+            throw;
+        }
+
+        std::vector<std::byte> decompressed(data.size());
+        if (!Compression::DecompressBlock({ compressed.data(), size }, decompressed) || decompressed != data)
+        {
+            throw;
+        }
+
+        return size;
+    };
+
+    std::mt19937 random { 42 };
+    std::uniform_int_distribution<int> byte { 0, 255 };
+
+    // Repeating text with some noise compresses well, overlapping matches included
+    std::vector<std::byte> text {};
+    const char* words[] = { "mesh ", "texture ", "material ", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "\n" };
+    while (text.size() < 65536)
+    {
+        for (char c : std::string_view(words[byte(random) % 5]))
+            text.emplace_back(static_cast<std::byte>(c));
+        if (byte(random) < 16)
+            text.emplace_back(static_cast<std::byte>(byte(random)));
+    }
+
+    if (RoundTrip(text) >= text.size() / 2)
+    {
+        throw;
+    }
+
+    // Incompressible data still round trips within the bound
+    std::vector<std::byte> noise(4096);
+    for (auto& b : noise)
+        b = static_cast<std::byte>(byte(random));
+    RoundTrip(noise);
+
+    // Long runs need the extended length bytes, tiny inputs are only literals
+    RoundTrip(std::vector<std::byte>(100000, std::byte { 7 }));
+    RoundTrip({ std::byte { 1 }, std::byte { 2 }, std::byte { 3 } });
+    RoundTrip({});
+
+    // Too small an output is reported, not overrun
+    std::vector<std::byte> small(16);
+    if (Compression::CompressBlock(noise, small) != 0)
+    {
+        throw;
+    }
+
+    // Malformed input is rejected: truncated, and decoding into the wrong size
+    std::vector<std::byte> compressed(Compression::CompressBound(text.size()));
+    size_t size = Compression::CompressBlock(text, compressed);
+    std::vector<std::byte> out(text.size());
+
+    if (Compression::DecompressBlock({ compressed.data(), size / 2 }, out)
+        || Compression::DecompressBlock({ compressed.data(), size }, std::span(out).first(out.size() - 1)))
+    {
+        throw;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace KS
+{
+
+/// @brief Small LZ77 block codec used for packed asset archives.
+/// Blocks are independent, so any block of an entry can be decoded without touching the others.
+namespace Compression
+{
+    /// <summary>
+    /// Worst case output size of CompressBlock for an input of size bytes
+    /// </summary>
+    size_t CompressBound(size_t size);
+
+    /// <summary>
+    /// Compresses a block into dst. Returns the compressed size, or 0 if the result does not fit inside dst
+    /// </summary>
+    size_t CompressBlock(std::span<const std::byte> src, std::span<std::byte> dst);
+
+    /// <summary>
+    /// Decompresses a block, dst must be exactly the original size. Returns false on malformed input
+    /// </summary>
+    bool DecompressBlock(std::span<const std::byte> src, std::span<std::byte> dst);
+}
+
+namespace Tests
+{
+    void TestCompression();
+}
+
+}
@@ -1,4 +1,5 @@
 #include "FileIO.hpp"
+#include "AssetArchive.hpp"
 #include <filesystem>
 
 std::optional<std::ifstream> KS::FileIO::OpenReadStream(const Path& path,
@@ -6,7 +7,7 @@ std::optional<std::ifstream> KS::FileIO::OpenReadStream(const Path& path,
 {
     if (Exists(path))
     {
-        return std::ifstream(path, flags);
+        return std::ifstream(path, static_cast<std::ios::openmode>(flags));
     }
     else
     {
@@ -17,7 +18,7 @@ std::optional<std::ifstream> KS::FileIO::OpenReadStream(const Path& path,
 std::optional<std::ofstream>
 KS::FileIO::OpenWriteStream(const Path& path, int flags)
 {
-    std::ofstream stream(path, flags);
+    std::ofstream stream(path, static_cast<std::ios::openmode>(flags));
     if (stream.is_open())
     {
         return stream;
@@ -28,6 +29,39 @@ KS::FileIO::OpenWriteStream(const Path& path, int flags)
     }
 }
 
+bool KS::FileIO::WriteFileAtomic(const Path& path, const std::function<void(std::ostream&)>& writer, int flags)
+{
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        auto stream = OpenWriteStream(temp_path, flags);
+        if (!stream)
+            return false;
+
+        writer(stream.value());
+        stream->flush();
+
+        if (!stream->good())
+        {
+            std::error_code e {};
+            stream->close();
+            std::filesystem::remove(temp_path, e);
+            return false;
+        }
+    }
+
+    std::error_code e {};
+    std::filesystem::rename(temp_path, path, e);
+
+    if (e != std::error_code {})
+    {
+        std::filesystem::remove(temp_path, e);
+        return false;
+    }
+    return true;
+}
+
 bool KS::FileIO::Exists(const Path& path)
 {
     return std::filesystem::exists(path);
@@ -65,3 +99,108 @@ std::vector<char> KS::FileIO::DumpFullStream(std::istream& stream)
     stream.read(out.data(), size);
     return out;
 }
+
+std::optional<KS::MappedFile> KS::FileIO::MapReadOnly(const Path& path, AccessHint hint)
+{
+    if (auto mapping = MappedFile::Open(path))
+    {
+        mapping->Advise(hint);
+        return mapping;
+    }
+
+    // Some files can't be mapped (pipes, special or network files), read them the regular way
+    else if (auto stream = OpenReadStream(path))
+    {
+        auto& file = stream.value();
+        file.seekg(0, std::ios::end);
+        auto size = file.tellg();
+
+        if (size < 0)
+            return std::nullopt;
+
+        std::vector<std::byte> buffer(static_cast<size_t>(size));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+        if (!file)
+            return std::nullopt;
+
+        return MappedFile::FromBuffer(std::move(buffer));
+    }
+
+    return std::nullopt;
+}
+
+std::optional<uint64_t> KS::FileIO::HashFile(const Path& path)
+{
+    auto file = MapReadOnly(path, AccessHint::SEQUENTIAL);
+    if (!file)
+        return std::nullopt;
+
+    uint64_t hash = 14695981039346656037ull;
+    for (auto byte : file->GetBytes())
+    {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace KS::FileIO::detail
+{
+std::vector<AssetArchive> mounted_archives {};
+}
+
+bool KS::FileIO::MountArchive(const Path& archive)
+{
+    if (auto opened = AssetArchive::Open(archive))
+    {
+        detail::mounted_archives.emplace_back(std::move(opened.value()));
+        return true;
+    }
+    return false;
+}
+
+void KS::FileIO::UnmountArchives()
+{
+    detail::mounted_archives.clear();
+}
+
+bool KS::FileIO::ExistsInArchive(const Path& path)
+{
+    for (const auto& archive : detail::mounted_archives)
+    {
+        if (archive.Find(path))
+            return true;
+    }
+    return false;
+}
+
+std::optional<KS::FileIO::FileData> KS::FileIO::ReadFile(const Path& path)
+{
+    // Later mounts override earlier ones
+    for (auto it = detail::mounted_archives.rbegin(); it != detail::mounted_archives.rend(); ++it)
+    {
+        if (const auto* entry = it->Find(path))
+        {
+            if (entry->compression == ArchiveFormat::EntryCompression::NONE)
+            {
+                return FileData { it->GetStoredData(*entry) };
+            }
+
+            std::vector<std::byte> out(entry->original_size);
+            if (it->Extract(*entry, out))
+            {
+                return FileData { MappedFile::FromBuffer(std::move(out)) };
+            }
+            return std::nullopt;
+        }
+    }
+
+    if (auto mapping = MapReadOnly(path))
+    {
+        return FileData { std::move(mapping.value()) };
+    }
+
+    return std::nullopt;
+}
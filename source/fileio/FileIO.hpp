@@ -4,7 +4,10 @@
 #include <code_utility.hpp>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <fileio/MappedFile.hpp>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace KS
@@ -19,6 +22,33 @@ namespace FileIO
     using FileTime = std::chrono::time_point<std::chrono::file_clock>;
     using Path = std::filesystem::path;
 
+    /// <summary>
+    /// Contents of a file read through ReadFile. Either points straight into a mounted archive
+    /// (valid until the archive is unmounted) or owns a mapping / buffer of its own.
+    /// </summary>
+    class FileData
+    {
+    public:
+        FileData(std::span<const std::byte> view)
+            : view(view)
+        {
+        }
+
+        FileData(MappedFile&& storage)
+            : view(storage.GetBytes())
+            , storage(std::move(storage))
+        {
+        }
+
+        std::span<const std::byte> GetBytes() const { return view; }
+        const std::byte* GetData() const { return view.data(); }
+        size_t GetSize() const { return view.size(); }
+
+    private:
+        std::span<const std::byte> view {};
+        MappedFile storage {};
+    };
+
     /// <summary>
     /// Open a file stream for reading. Specify 0 or std::ios::flags
     /// </summary>
@@ -32,10 +62,29 @@ namespace FileIO
         int flags = DEFAULT_WRITE_FLAGS);
 
     /// <summary>
-    /// Dumps all bytes of a stream into a vector
+    /// Writes through a temporary file next to path, which replaces path once the writer is done.
+    /// Readers never see a partially written file and a failed write leaves the old file untouched
+    /// </summary>
+    bool WriteFileAtomic(const Path& path, const std::function<void(std::ostream&)>& writer,
+        int flags = DEFAULT_WRITE_FLAGS);
+
+    /// <summary>
+    /// Dumps all bytes of a stream into a vector. Prefer MapReadOnly for whole files
     /// </summary>
     std::vector<char> DumpFullStream(std::istream& stream);
 
+    /// <summary>
+    /// Maps a whole file into memory without copying it. Falls back to a buffered read when mapping fails.
+    /// Nullopt if the file can't be opened at all
+    /// </summary>
+    std::optional<MappedFile> MapReadOnly(const Path& path, AccessHint hint = AccessHint::SEQUENTIAL);
+
+    /// <summary>
+    /// 64 bit FNV-1a hash of the file contents, meant for change detection only.
+    /// Nullopt if the file can't be read
+    /// </summary>
+    std::optional<uint64_t> HashFile(const Path& path);
+
     /// <summary>
     /// Check if a file exists.
     /// </summary>
@@ -50,6 +99,27 @@ namespace FileIO
     /// Check the last time a file was modified. Nullopt if file doesn't exist
     /// </summary>
     std::optional<FileTime> GetLastModifiedTime(const Path& path);
+
+    /// <summary>
+    /// Mounts a packed asset archive (.kspak). ReadFile checks mounted archives, most recently mounted first,
+    /// before falling back to loose files. Mount before loading, not while other threads are reading.
+    /// </summary>
+    bool MountArchive(const Path& archive);
+
+    /// <summary>
+    /// Unmounts all archives. Any FileData still pointing into them becomes invalid
+    /// </summary>
+    void UnmountArchives();
+
+    /// <summary>
+    /// Check if a file exists inside one of the mounted archives
+    /// </summary>
+    bool ExistsInArchive(const Path& path);
+
+    /// <summary>
+    /// Reads a whole file through the virtual file system. Nullopt if the file can't be found anywhere
+    /// </summary>
+    std::optional<FileData> ReadFile(const Path& path);
 };
 
 } // namespace KS
\ No newline at end of file
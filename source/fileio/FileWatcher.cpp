@@ -0,0 +1,296 @@
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+std::filesystem::path Normalize(const std::filesystem::path& path)
+{
+    std::error_code e {};
+    auto absolute = std::filesystem::absolute(path, e);
+    return (e ? path : absolute).lexically_normal();
+}
+
+bool IsInside(const std::filesystem::path& path, const std::filesystem::path& directory)
+{
+    auto [dir_end, path_end] = std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+
+    // A trailing separator shows up as an empty last element
+    return dir_end == directory.end() || (std::next(dir_end) == directory.end() && dir_end->empty());
+}
+
+}
+
+KS::FileWatcher::FileWatcher(const FileWatcherSettings& settings)
+    : settings(settings)
+{
+#if defined(__linux__)
+    if (settings.allow_native)
+        native_handle = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+    backend = native_handle >= 0 ? Backend::INOTIFY : Backend::POLLING;
+}
+
+KS::FileWatcher::~FileWatcher()
+{
+#if defined(__linux__)
+    if (native_handle >= 0)
+        ::close(native_handle);
+#endif
+}
+
+bool KS::FileWatcher::Watch(const std::filesystem::path& path)
+{
+    auto normalized = Normalize(path);
+    std::error_code e {};
+
+    if (std::filesystem::is_directory(normalized, e))
+    {
+        watched_directories.emplace_back(normalized);
+
+        if (backend == Backend::INOTIFY)
+        {
+            AddNativeWatch(normalized);
+            for (const auto& it : std::filesystem::recursive_directory_iterator(normalized, e))
+            {
+                if (it.is_directory())
+                    AddNativeWatch(it.path());
+            }
+        }
+    }
+    else if (std::filesystem::is_regular_file(normalized, e))
+    {
+        watched_files.emplace_back(normalized);
+
+        // Editors often save through a temporary file and a rename, so the directory is watched instead of the file
+        if (backend == Backend::INOTIFY)
+            AddNativeWatch(normalized.parent_path());
+    }
+    else
+    {
+        return false;
+    }
+
+    // Remember the current state, so the first poll does not report everything as changed
+    if (backend == Backend::POLLING)
+        Scan(normalized, nullptr);
+
+    return true;
+}
+
+std::vector<std::filesystem::path> KS::FileWatcher::PollChanges()
+{
+    std::vector<std::filesystem::path> changes {};
+
+    if (backend == Backend::INOTIFY)
+    {
+        ReadNativeEvents(changes);
+    }
+    else
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_scan < settings.poll_interval)
+            return changes;
+
+        last_scan = now;
+
+        for (const auto& file : watched_files)
+            Scan(file, &changes);
+
+        for (const auto& directory : watched_directories)
+            Scan(directory, &changes);
+    }
+
+    std::sort(changes.begin(), changes.end());
+    changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+    return changes;
+}
+
+bool KS::FileWatcher::IsWatched(const std::filesystem::path& path) const
+{
+    if (std::find(watched_files.begin(), watched_files.end(), path) != watched_files.end())
+        return true;
+
+    return std::any_of(watched_directories.begin(), watched_directories.end(),
+        [&](const std::filesystem::path& directory) { return IsInside(path, directory); });
+}
+
+void KS::FileWatcher::Scan(const std::filesystem::path& path, std::vector<std::filesystem::path>* changes)
+{
+    auto Check = [&](const std::filesystem::path& file)
+    {
+        // Checked separately, the file can disappear between the two calls
+        std::error_code time_error {};
+        std::error_code size_error {};
+        FileState state { std::filesystem::last_write_time(file, time_error), std::filesystem::file_size(file, size_error) };
+        if (time_error || size_error)
+            return;
+
+        auto [it, inserted] = known_files.try_emplace(file.string(), state);
+        if (!inserted && (it->second.time != state.time || it->second.size != state.size))
+        {
+            it->second = state;
+            if (changes)
+                changes->emplace_back(file);
+        }
+        else if (inserted && changes)
+        {
+            changes->emplace_back(file);
+        }
+    };
+
+    std::error_code e {};
+    if (std::filesystem::is_directory(path, e))
+    {
+        for (const auto& it : std::filesystem::recursive_directory_iterator(path, e))
+        {
+            if (it.is_regular_file())
+                Check(it.path());
+        }
+    }
+    else
+    {
+        Check(path);
+    }
+}
+
+#if defined(__linux__)
+
+void KS::FileWatcher::AddNativeWatch(const std::filesystem::path& directory)
+{
+    int watch = ::inotify_add_watch(native_handle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch >= 0)
+        native_watches[watch] = directory;
+}
+
+void KS::FileWatcher::ReadNativeEvents(std::vector<std::filesystem::path>& out)
+{
+    alignas(inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        auto length = ::read(native_handle, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char* ptr = buffer; ptr < buffer + length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_IGNORED)
+            {
+                native_watches.erase(event->wd);
+                continue;
+            }
+
+            auto it = native_watches.find(event->wd);
+            if (it == native_watches.end() || event->len == 0)
+                continue;
+
+            auto path = it->second / event->name;
+
+            if (event->mask & IN_ISDIR)
+            {
+                // New directories below a watched one are watched too, files may already be inside
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && IsWatched(path))
+                {
+                    AddNativeWatch(path);
+
+                    std::error_code e {};
+                    for (const auto& entry : std::filesystem::recursive_directory_iterator(path, e))
+                    {
+                        if (entry.is_directory())
+                            AddNativeWatch(entry.path());
+                        else if (entry.is_regular_file())
+                            out.emplace_back(entry.path());
+                    }
+                }
+            }
+
+            // Files are reported once they are closed, not on every partial write
+            else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && IsWatched(path))
+            {
+                out.emplace_back(path);
+            }
+        }
+    }
+}
+
+#else
+
+void KS::FileWatcher::AddNativeWatch(const std::filesystem::path&)
+{
+}
+
+void KS::FileWatcher::ReadNativeEvents(std::vector<std::filesystem::path>&)
+{
+}
+
+#endif
+
+void KS::Tests::TestFileWatcher()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSFileWatcher";
+    auto watched = directory / "watched";
+    auto other = directory / "other";
+
+    auto Write = [](const std::filesystem::path& path, const std::string& text) { std::ofstream(path) << text; };
+    using Changes = std::vector<std::filesystem::path>;
+
+    for (bool allow_native : { true, false })
+    {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(watched);
+        std::filesystem::create_directories(other);
+
+        FileWatcherSettings settings {};
+        settings.poll_interval = std::chrono::milliseconds { 0 };
+        settings.allow_native = allow_native;
+        FileWatcher watcher { settings };
+
+        if (!watcher.Watch(watched) || !watcher.PollChanges().empty())
+        {
+            throw;
+        }
+
+        // Created, then written again with a different size, so polling sees it within the clock resolution
+        Write(watched / "a.txt", "created");
+        if (watcher.PollChanges() != Changes { watched / "a.txt" })
+        {
+            throw;
+        }
+
+        Write(watched / "a.txt", "modified contents");
+        if (watcher.PollChanges() != Changes { watched / "a.txt" })
+        {
+            throw;
+        }
+
+        // Deleted files are not reported, and neither are files outside the watched directory
+        std::filesystem::remove(watched / "a.txt");
+        Write(other / "b.txt", "not watched");
+        if (!watcher.PollChanges().empty())
+        {
+            throw;
+        }
+
+        // Directories created after Watch are included
+        std::filesystem::create_directories(watched / "sub");
+        Write(watched / "sub" / "c.txt", "nested");
+        if (watcher.PollChanges() != Changes { watched / "sub" / "c.txt" })
+        {
+            throw;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
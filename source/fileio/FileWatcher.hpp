@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <code_utility.hpp>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace KS
+{
+
+struct FileWatcherSettings
+{
+    // Only used by the polling backend, rescans are skipped until this much time has passed
+    std::chrono::milliseconds poll_interval { 500 };
+    bool allow_native = true;
+};
+
+// Reports files that were written, created or moved into place.
+// Uses inotify on Linux and falls back to comparing modification times everywhere else.
+class FileWatcher
+{
+public:
+    enum class Backend
+    {
+        INOTIFY,
+        POLLING,
+    };
+
+    FileWatcher(const FileWatcherSettings& settings = {});
+    ~FileWatcher();
+
+    NON_COPYABLE(FileWatcher);
+    NON_MOVABLE(FileWatcher);
+
+    // Watches a single file, or every file below a directory (including directories created later)
+    bool Watch(const std::filesystem::path& path);
+
+    // Files changed since the last call, without duplicates. Never blocks
+    std::vector<std::filesystem::path> PollChanges();
+
+    Backend GetBackend() const { return backend; }
+
+private:
+    struct FileState
+    {
+        std::filesystem::file_time_type time {};
+        uintmax_t size = 0;
+    };
+
+    bool IsWatched(const std::filesystem::path& path) const;
+    void AddNativeWatch(const std::filesystem::path& directory);
+    void ReadNativeEvents(std::vector<std::filesystem::path>& out);
+    void Scan(const std::filesystem::path& path, std::vector<std::filesystem::path>* changes);
+
+    FileWatcherSettings settings {};
+    Backend backend = Backend::POLLING;
+
+    std::vector<std::filesystem::path> watched_files {};
+    std::vector<std::filesystem::path> watched_directories {};
+
+    // inotify
+    int native_handle = -1;
+    std::unordered_map<int, std::filesystem::path> native_watches {};
+
+    // Polling
+    std::unordered_map<std::string, FileState> known_files {};
+    std::chrono::steady_clock::time_point last_scan {};
+};
+
+namespace Tests
+{
+    void TestFileWatcher();
+}
+
+}
@@ -0,0 +1,242 @@
+#include "MappedFile.hpp"
+
+#include <fileio/FileIO.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+KS::MappedFile::~MappedFile()
+{
+    Release();
+}
+
+KS::MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr))
+    , size(std::exchange(other.size, 0))
+    , buffer(std::move(other.buffer))
+    , file_handle(std::exchange(other.file_handle, nullptr))
+    , mapping_handle(std::exchange(other.mapping_handle, nullptr))
+{
+}
+
+KS::MappedFile& KS::MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        buffer = std::move(other.buffer);
+        file_handle = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+    }
+    return *this;
+}
+
+KS::MappedFile KS::MappedFile::FromBuffer(std::vector<std::byte>&& buffer)
+{
+    MappedFile out {};
+    out.buffer = std::move(buffer);
+    return out;
+}
+
+#if defined(_WIN32)
+
+std::optional<KS::MappedFile> KS::MappedFile::Open(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return std::nullopt;
+
+    LARGE_INTEGER file_size {};
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    MappedFile out {};
+    out.file_handle = file;
+    out.size = static_cast<size_t>(file_size.QuadPart);
+
+    // Zero sized files cannot be mapped, but are still valid (empty) files
+    if (out.size == 0)
+        return out;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+        return std::nullopt;
+
+    out.mapping_handle = mapping;
+    out.data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (out.data == nullptr)
+        return std::nullopt;
+
+    return out;
+}
+
+void KS::MappedFile::Advise(AccessHint hint) const
+{
+    // Windows has no read-ahead control per mapping, prefetching is the closest equivalent
+    if (IsMapped() && hint == AccessHint::SEQUENTIAL)
+    {
+        WIN32_MEMORY_RANGE_ENTRY range { const_cast<std::byte*>(data), size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+void KS::MappedFile::Release()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+
+    data = nullptr;
+    size = 0;
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+}
+
+#else
+
+std::optional<KS::MappedFile> KS::MappedFile::Open(const std::filesystem::path& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return std::nullopt;
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    MappedFile out {};
+    out.size = static_cast<size_t>(info.st_size);
+
+    if (out.size != 0)
+    {
+        void* mapped = ::mmap(nullptr, out.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            return std::nullopt;
+        }
+        out.data = static_cast<const std::byte*>(mapped);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return out;
+}
+
+void KS::MappedFile::Advise(AccessHint hint) const
+{
+    if (!IsMapped())
+        return;
+
+    void* address = const_cast<std::byte*>(data);
+
+    switch (hint)
+    {
+    case AccessHint::SEQUENTIAL:
+        ::madvise(address, size, MADV_SEQUENTIAL);
+        ::madvise(address, size, MADV_WILLNEED);
+        break;
+
+    case AccessHint::RANDOM:
+        ::madvise(address, size, MADV_RANDOM);
+        break;
+
+    default:
+        ::madvise(address, size, MADV_NORMAL);
+        break;
+    }
+}
+
+void KS::MappedFile::Release()
+{
+    if (data)
+        ::munmap(const_cast<std::byte*>(data), size);
+
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+void KS::Tests::TestMappedFile()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSMappedFile";
+    std::filesystem::create_directories(directory);
+
+    std::string text = "Mapped and read through the file system should give the same bytes";
+    auto regular_path = directory / "regular.txt";
+    auto empty_path = directory / "empty.txt";
+    auto missing_path = directory / "missing.txt";
+
+    if (!FileIO::WriteFileAtomic(regular_path, [&](std::ostream& out) { out << text; })
+        || !FileIO::WriteFileAtomic(empty_path, [](std::ostream&) {}))
+    {
+        throw;
+    }
+
+    // The view has to match what the virtual file system reads, regardless of how either got the bytes
+    auto SameAsReadFile = [](const MappedFile& mapped, const std::filesystem::path& path)
+    {
+        auto read = FileIO::ReadFile(path);
+        return read && std::ranges::equal(mapped.GetBytes(), read->GetBytes());
+    };
+
+    if (MappedFile::Open(missing_path) || FileIO::MapReadOnly(missing_path) || FileIO::ReadFile(missing_path))
+    {
+        throw;
+    }
+
+    // Nothing to map, but still a valid file
+    auto empty = MappedFile::Open(empty_path);
+    if (!empty || empty->IsMapped() || empty->GetSize() != 0 || !SameAsReadFile(*empty, empty_path))
+    {
+        throw;
+    }
+
+    auto regular = MappedFile::Open(regular_path);
+    if (!regular || !regular->IsMapped() || regular->GetSize() != text.size() || !SameAsReadFile(*regular, regular_path))
+    {
+        throw;
+    }
+
+    // Moving hands over the mapping itself, the moved from file is left empty
+    const std::byte* data = regular->GetData();
+    MappedFile moved = std::move(*regular);
+    if (moved.GetData() != data || regular->IsMapped() || regular->GetSize() != 0 || !SameAsReadFile(moved, regular_path))
+    {
+        throw;
+    }
+
+    moved.Advise(AccessHint::RANDOM);
+    auto buffered = MappedFile::FromBuffer(std::vector<std::byte>(moved.GetBytes().begin(), moved.GetBytes().end()));
+    if (buffered.IsMapped() || !SameAsReadFile(buffered, regular_path))
+    {
+        throw;
+    }
+
+    std::filesystem::remove_all(directory);
+}
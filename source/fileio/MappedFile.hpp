@@ -0,0 +1,65 @@
+#pragma once
+
+#include <code_utility.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace KS
+{
+
+// How a mapped file is going to be read, forwarded to the OS paging system
+enum class AccessHint
+{
+    NORMAL,
+    SEQUENTIAL, // Read front to back once, pages are prefetched ahead
+    RANDOM, // Scattered reads, read-ahead is disabled
+};
+
+// Read only view of a whole file, unmapped once it falls out of scope
+// Normally backed by a memory mapping, but can also own a buffer when mapping was not possible
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    NON_COPYABLE(MappedFile);
+
+    // Nullopt if the file does not exist or cannot be mapped
+    static std::optional<MappedFile> Open(const std::filesystem::path& path);
+
+    // Wraps bytes that were loaded some other way, so callers can treat both cases the same
+    static MappedFile FromBuffer(std::vector<std::byte>&& buffer);
+
+    std::span<const std::byte> GetBytes() const { return { GetData(), GetSize() }; }
+    const std::byte* GetData() const { return IsMapped() ? data : buffer.data(); }
+    size_t GetSize() const { return IsMapped() ? size : buffer.size(); }
+    bool IsMapped() const { return data != nullptr; }
+
+    // Only a hint, has no effect on buffered files
+    void Advise(AccessHint hint) const;
+
+private:
+    void Release();
+
+    const std::byte* data {};
+    size_t size {};
+    std::vector<std::byte> buffer {};
+
+    // Platform handles, only meaningful while mapped
+    void* file_handle {};
+    void* mapping_handle {};
+};
+
+namespace Tests
+{
+    void TestMappedFile();
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <vector>
+
+namespace KS
+{
+
+// Non owning std::istream over a block of memory, used to feed in-memory files to cereal archives
+class MemoryReadStream : public std::istream
+{
+public:
+    MemoryReadStream(std::span<const std::byte> data)
+        : std::istream(&buffer)
+        , buffer(data)
+    {
+    }
+
+private:
+    class Buffer : public std::streambuf
+    {
+    public:
+        Buffer(std::span<const std::byte> data)
+        {
+            // streambuf only hands out const data to readers, the const_cast is never written through
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+            setg(begin, begin, begin + data.size());
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            if (!(which & std::ios_base::in))
+                return pos_type(off_type(-1));
+
+            off_type base = dir == std::ios_base::beg ? 0
+                : dir == std::ios_base::cur           ? gptr() - eback()
+                                                      : egptr() - eback();
+
+            return seekpos(pos_type(base + off), which);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            off_type target = off_type(pos);
+            if (!(which & std::ios_base::in) || target < 0 || target > egptr() - eback())
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + target, egptr());
+            return pos;
+        }
+    };
+
+    Buffer buffer;
+};
+
+// std::ostream appending to a byte vector, used to build in-memory files with cereal archives.
+// Unbuffered, so the vector size is the number of bytes written so far.
+class MemoryWriteStream : public std::ostream
+{
+public:
+    MemoryWriteStream(std::vector<std::byte>& target)
+        : std::ostream(&buffer)
+        , buffer(target)
+    {
+    }
+
+private:
+    class Buffer : public std::streambuf
+    {
+    public:
+        Buffer(std::vector<std::byte>& target)
+            : target(target)
+        {
+        }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                target.emplace_back(static_cast<std::byte>(ch));
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize count) override
+        {
+            const auto* bytes = reinterpret_cast<const std::byte*>(data);
+            target.insert(target.end(), bytes, bytes + count);
+            return count;
+        }
+
+    private:
+        std::vector<std::byte>& target;
+    };
+
+    Buffer buffer;
+};
+
+}
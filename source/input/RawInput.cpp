@@ -1,17 +1,43 @@
 #include "RawInput.hpp"
-#include <unordered_map>
+#include <containers/FlatHashMap.hpp>
+#include <tools/FrameCapture.hpp>
 
 #include <GLFW/glfw3.h>
 
 class KS::RawInput::Impl
 {
 public:
-    std::unordered_map<KeyboardKey, InputState> keys;
-    std::unordered_map<MouseButton, InputState> mouse_buttons;
+    FlatHashMap<KeyboardKey, InputState> keys;
+    FlatHashMap<MouseButton, InputState> mouse_buttons;
 
     float mouseX {}, mouseY {};
     float deltaX {}, deltaY {};
     float mouseScrollX {}, mouseScrollY {};
+
+    // Replays own the state, the callbacks leave it alone
+    bool replaying = false;
+
+    // Presses and releases last one frame
+    void AgeStates()
+    {
+        for (auto&& [key, state] : keys)
+        {
+            if (state == InputState::Down)
+                state = InputState::Pressed;
+
+            if (state == InputState::Release)
+                state = InputState::None;
+        }
+
+        for (auto&& [button, state] : mouse_buttons)
+        {
+            if (state == InputState::Down)
+                state = InputState::Pressed;
+
+            if (state == InputState::Release)
+                state = InputState::None;
+        }
+    }
 };
 
 namespace KS::detail
@@ -19,7 +45,8 @@ namespace KS::detail
 
 KS::RawInput::Impl* GetUser(GLFWwindow* window)
 {
-    return static_cast<KS::RawInput::Impl*>(glfwGetWindowUserPointer(window));
+    auto* data = static_cast<KS::RawInput::Impl*>(glfwGetWindowUserPointer(window));
+    return data && !data->replaying ? data : nullptr;
 }
 
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
@@ -113,43 +140,55 @@ KS::RawInput::~RawInput()
 
 void KS::RawInput::ProcessInput()
 {
-    // update keyboard key states
-    for (auto&& [key, state] : m_Impl->keys)
-    {
+    m_Impl->AgeStates();
 
-        if (state == InputState::Down)
-        {
-            state = InputState::Pressed;
-        }
+    auto prevX = m_Impl->mouseX;
+    auto prevY = m_Impl->mouseY;
 
-        if (state == InputState::Release)
-        {
-            state = InputState::None;
-        }
-    }
+    glfwPollEvents();
 
-    // update mouse button states
-    for (auto&& [key, state] : m_Impl->mouse_buttons)
-    {
+    m_Impl->deltaX = m_Impl->mouseX - prevX;
+    m_Impl->deltaY = m_Impl->mouseY - prevY;
+}
 
-        if (state == InputState::Down)
-        {
-            state = InputState::Pressed;
-        }
+void KS::RawInput::Record(CapturedFrame& frame) const
+{
+    for (auto&& [key, state] : m_Impl->keys)
+    {
+        if (state == InputState::Down || state == InputState::Release)
+            frame.input.emplace_back(InputChange { static_cast<uint16_t>(key), 0, static_cast<uint8_t>(state) });
+    }
 
-        if (state == InputState::Release)
-        {
-            state = InputState::None;
-        }
+    for (auto&& [button, state] : m_Impl->mouse_buttons)
+    {
+        if (state == InputState::Down || state == InputState::Release)
+            frame.input.emplace_back(InputChange { static_cast<uint16_t>(button), 1, static_cast<uint8_t>(state) });
     }
 
-    auto prevX = m_Impl->mouseX;
-    auto prevY = m_Impl->mouseY;
+    frame.mouse_position = { m_Impl->mouseX, m_Impl->mouseY };
+}
+
+void KS::RawInput::Replay(const CapturedFrame& frame)
+{
+    m_Impl->replaying = true;
+    m_Impl->AgeStates();
 
     glfwPollEvents();
 
-    m_Impl->deltaX = m_Impl->mouseX - prevX;
-    m_Impl->deltaY = m_Impl->mouseY - prevY;
+    for (const InputChange& change : frame.input)
+    {
+        auto state = static_cast<InputState>(change.state);
+
+        if (change.mouse)
+            m_Impl->mouse_buttons[static_cast<MouseButton>(change.code)] = state;
+        else
+            m_Impl->keys[static_cast<KeyboardKey>(change.code)] = state;
+    }
+
+    m_Impl->deltaX = frame.mouse_position.x - m_Impl->mouseX;
+    m_Impl->deltaY = frame.mouse_position.y - m_Impl->mouseY;
+    m_Impl->mouseX = frame.mouse_position.x;
+    m_Impl->mouseY = frame.mouse_position.y;
 }
 
 KS::InputState KS::RawInput::GetKeyboard(KeyboardKey key) const
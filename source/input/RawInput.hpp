@@ -6,6 +6,7 @@
 
 namespace KS
 {
+struct CapturedFrame;
 
 /// @brief TODO: only supports keyboard and is PC only
 class RawInput
@@ -16,6 +17,13 @@ public:
 
     void ProcessInput();
 
+    // Writes the keys and buttons that changed this frame and the mouse position into a capture, call after ProcessInput
+    void Record(CapturedFrame& frame) const;
+
+    // Instead of ProcessInput: the window is still polled, but the input comes from the capture.
+    // Live input is ignored from the first replayed frame on.
+    void Replay(const CapturedFrame& frame);
+
     InputState GetKeyboard(KeyboardKey key) const;
     InputState GetMouseButton(MouseButton button) const;
     std::pair<float, float> GetMousePos() const;
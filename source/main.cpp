@@ -1,5 +1,6 @@
 #include <components/ComponentCamera.hpp>
 #include <components/ComponentTransform.hpp>
+#include <components/ComponentWorldTransform.hpp>
 #include <device/Device.hpp>
 #include <ecs/EntityComponentSystem.hpp>
 #include <fileio/FileIO.hpp>
@@ -9,19 +10,26 @@
 #include <renderer/Renderer.hpp>
 #include <scene/Scene.hpp>
 #include <tools/Log.hpp>
+#include <resources/AssetReloader.hpp>
 #include <resources/Model.hpp>
+#include <tools/FrameCapture.hpp>
+#include <tools/FramePipeline.hpp>
 #include <tools/Timer.hpp>
 #include <editor/Editor.hpp>
 
-KS::Camera FreeCamSystem(std::shared_ptr<KS::RawInput> input, entt::registry& registry, float dt)
+#include <iostream>
+#include <optional>
+#include <string>
+
+void FreeCamSystem(const KS::RawInput& input, entt::registry& registry, float dt)
 {
     constexpr float MOUSE_SENSITIVITY = 0.003f;
     constexpr float CAM_SPEED = 0.003f;
 
-    auto [x, y] = input->GetMouseDelta();
+    auto [x, y] = input.GetMouseDelta();
     glm::vec3 eulerDelta {};
 
-    if (input->GetMouseButton(KS::MouseButton::Right) == KS::InputState::Pressed)
+    if (input.GetMouseButton(KS::MouseButton::Right) == KS::InputState::Pressed)
     {
         eulerDelta.y = x * MOUSE_SENSITIVITY;
         eulerDelta.x = y * MOUSE_SENSITIVITY;
@@ -29,22 +37,22 @@ KS::Camera FreeCamSystem(std::shared_ptr<KS::RawInput> input, entt::registry& re
     }
 
     glm::vec3 movement_dir {};
-    if (input->GetKeyboard(KS::KeyboardKey::W) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::W) == KS::InputState::Pressed)
         movement_dir += KS::World::FORWARD;
 
-    if (input->GetKeyboard(KS::KeyboardKey::S) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::S) == KS::InputState::Pressed)
         movement_dir -= KS::World::FORWARD;
 
-    if (input->GetKeyboard(KS::KeyboardKey::D) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::D) == KS::InputState::Pressed)
         movement_dir += KS::World::RIGHT;
 
-    if (input->GetKeyboard(KS::KeyboardKey::A) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::A) == KS::InputState::Pressed)
         movement_dir -= KS::World::RIGHT;
 
-    if (input->GetKeyboard(KS::KeyboardKey::E) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::E) == KS::InputState::Pressed)
         movement_dir += KS::World::UP;
 
-    if (input->GetKeyboard(KS::KeyboardKey::Q) == KS::InputState::Pressed)
+    if (input.GetKeyboard(KS::KeyboardKey::Q) == KS::InputState::Pressed)
         movement_dir -= KS::World::UP;
 
     if (glm::length(movement_dir) != 0.0f)
@@ -64,16 +72,49 @@ KS::Camera FreeCamSystem(std::shared_ptr<KS::RawInput> input, entt::registry& re
 
         transform.SetLocalTranslation(translation + rotation * (movement_dir * dt * CAM_SPEED));
         transform.SetLocalRotation(rotation);
+    }
+}
 
+KS::Camera GetActiveCamera(entt::registry& registry)
+{
+    auto view = registry.view<const KS::ComponentFirstPersonCamera, const KS::ComponentTransform>();
+    for (auto&& [e, camera, transform] : view.each())
+    {
         return camera.GenerateCamera(transform.GetWorldMatrix());
     }
 
     return KS::Camera {};
 }
 
-int main()
+// Usage: KEngine [--capture <file>] [--replay <file> [--timings <file>]]
+//   --capture records frame times, input and scene calls until the window closes
+//   --replay runs a capture again instead of live input and writes how long each frame stage took
+int main(int argc, char** argv)
 {
-    auto model = KS::ModelImporter::ImportFromFile("assets/models/Gears.glb").value();
+    std::string capture_path {}, replay_path {}, timings_path = "replay_timings.json";
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--capture")
+            capture_path = argv[++i];
+        else if (arg == "--replay")
+            replay_path = argv[++i];
+        else if (arg == "--timings")
+            timings_path = argv[++i];
+    }
+
+    std::optional<KS::FrameCapture> replay {};
+    if (!replay_path.empty() && !(replay = KS::FrameCapture::Load(replay_path)))
+        return 1;
+
+    // Packed assets take priority over loose files when present, see tools/ArchiveBuilder.cpp
+    if (KS::FileIO::Exists("assets.kspak"))
+        KS::FileIO::MountArchive("assets.kspak");
+
+    // Source models are watched, saving them again re-imports them while the app is running
+    KS::AssetReloader reloader {};
+    auto model = reloader.ImportAndWatch("assets/models/Gears.glb").value();
 
     KS::DeviceInitParams params {};
     params.window_width = 1280;
@@ -92,8 +133,12 @@ int main()
     device->NewFrame();
 
     KS::Renderer renderer = KS::Renderer(*device);
-    KS::Scene scene = KS::Scene(*device);
+    KS::Scene scene = KS::Scene(*device, ecs->GetWorld());
 
+    // The setup below is the same code on every run, replays only need the frames after it
+    KS::FrameCapture capture {};
+    if (!capture_path.empty())
+        scene.SetCapture(&capture);
 
     // Scene Setup
     {
@@ -127,32 +172,95 @@ int main()
     transform4 = glm::scale(transform4, glm::vec3(0.1f));
     transform5 = glm::scale(transform5, glm::vec3(0.1f));
 
-    float rotationSpeed = 0.1f;
+    constexpr float GEAR_DEGREES_PER_SECOND = 6.f;
 
     scene.QueuePointLight(lightPosition1, glm::vec3(0.597202f, 0.450786f, 1.f), 5.f, 10.f);
-    scene.QueueModel(*device, model, transform, "Gear1");
-    scene.QueueModel(*device, model, transform2, "Gear2");
-    scene.QueueModel(*device, model, transform3, "Gear3");
+    std::vector<entt::entity> gears {};
+    auto spawn_gear = [&](const glm::mat4& gear_transform, std::string_view name)
+    {
+        auto entities = scene.SpawnModel(model, gear_transform, name);
+        gears.insert(gears.end(), entities.begin(), entities.end());
+    };
+
+    spawn_gear(transform, "Gear1");
+    spawn_gear(transform2, "Gear2");
+    spawn_gear(transform3, "Gear3");
+
+    // Moving a drawn entity is a component write, the scene picks it up when it gathers the frame
+    ecs->AddSystem("SpinGears", KS::SystemAccess {}.Write<KS::ComponentWorldTransform>(),
+        [gears](entt::registry& registry, float dt)
+        {
+            float degrees = GEAR_DEGREES_PER_SECOND * dt / 1000.f;
+            auto rotation = glm::rotate(glm::mat4(1.f), glm::radians(degrees), glm::vec3(0.f, 1.f, 0.f));
+            for (auto gear : gears)
+            {
+                auto& world_transform = registry.get<KS::ComponentWorldTransform>(gear);
+                world_transform.matrix = world_transform.matrix * rotation;
+            }
+        });
 
     device->EndFrame();
 
+    // The next frame is simulated and extracted on the pipeline thread while the current one is recorded and
+    // submitted here. The systems run on the pipeline thread, so none may be marked MainThread (Update asserts this).
+    // Work that needs the main thread goes between Wait and Kick below, like FreeCamSystem.
+    float simulate_milliseconds = 0.f;
+    KS::FramePipeline<KS::RenderSnapshot> pipeline { [&](KS::RenderSnapshot& snapshot)
+    {
+        // Simulation runs at a fixed rate, frames render in between its last two steps
+        float alpha = ecs->Update(simulate_milliseconds);
+        scene.ExtractSnapshot(snapshot, alpha);
+    } };
+    pipeline.Kick();
+
+    KS::StageTimings timings {};
+    KS::Timer stagetimer {};
+    size_t replay_frame = 1;
+
     while (device->IsWindowOpen())
     {
         auto dt = frametimer.Tick();
 
-        input->ProcessInput();
+        if (replay)
+        {
+            if (replay_frame == replay->GetFrames().size())
+                break;
+
+            const auto& frame = replay->GetFrames()[replay_frame++];
+            dt = KS::Timer::FloatMilliseconds(frame.dt);
+            input->Replay(frame);
+        }
+        else
+        {
+            input->ProcessInput();
+
+            if (!capture_path.empty())
+                input->Record(capture.BeginFrame(dt.count()));
+        }
+
+        stagetimer.Reset();
         device->NewFrame();
 
-        auto camera = FreeCamSystem(input, ecs->GetWorld(), dt.count());
+        // From here until Kick the pipeline thread is idle, everything that touches the world happens in between
+        const KS::RenderSnapshot& snapshot = pipeline.Wait();
+        timings.Add("new frame", stagetimer.Tick().count());
+
+        scene.ReloadAssets(*device, reloader.Update());
+
+        // Mouse deltas are per frame, so the camera follows the frame rate rather than the simulation
+        FreeCamSystem(*input, ecs->GetWorld(), dt.count());
+        auto camera = GetActiveCamera(ecs->GetWorld());
+        editor->RenderWindows(*device, scene);
+
+        if (replay)
+            scene.Replay(*device, replay->GetFrames()[replay_frame - 1]);
+
+        simulate_milliseconds = dt.count();
+        pipeline.Kick();
 
         if (input->GetKeyboard(KS::KeyboardKey::Space) == KS::InputState::Down)
             raytraced = !raytraced;
 
-        auto newTransform = glm::rotate(glm::mat4(1.f), glm::radians(rotationSpeed), glm::vec3(0.f, 1.f, 0.f));
-        scene.ApplyModelTransform(*device, "Gear1", newTransform);
-        scene.ApplyModelTransform(*device, "Gear2", newTransform);
-        scene.ApplyModelTransform(*device, "Gear3", newTransform);
-
         auto renderParams = KS::RenderTickParams();
         renderParams.cpuFrame = device->GetFrameIndex();
         renderParams.projectionMatrix = camera.GetProjection();
@@ -160,13 +268,24 @@ int main()
         renderParams.cameraPos = camera.GetPosition();
         renderParams.cameraRight = camera.GetRight();
 
-        scene.Tick(*device);
+        timings.Add("update", stagetimer.Tick().count());
+        scene.Tick(*device, snapshot);
+        timings.Add("scene tick", stagetimer.Tick().count());
         renderer.Render(*device, scene, renderParams, raytraced);
-        editor->RenderWindows(*device, scene);
+        timings.Add("render", stagetimer.Tick().count());
         device->EndFrame();
+        timings.Add("end frame", stagetimer.Tick().count());
+        timings.Add("frame", frametimer.TimePassed().count());
     }
 
+    pipeline.Wait();
     device->Flush();
 
+    if (!capture_path.empty() && !capture.Save(capture_path))
+        std::cerr << "Could not save frame capture " << capture_path << "\n";
+
+    if (replay && !timings.WriteJSON(timings_path))
+        std::cerr << "Could not write replay timings " << timings_path << "\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,840 @@
+#include "DynamicAABBTree.hpp"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+
+template <typename B>
+B Union(const B& a, const B& b)
+{
+    return B { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+// Half the surface area, only ever compared
+template <typename B>
+float Area(const B& box)
+{
+    glm::vec3 size = box.max - box.min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+template <typename B>
+bool Contains(const B& outer, const B& inner)
+{
+    return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+}
+
+template <typename B>
+bool Overlaps(const B& a, const B& b)
+{
+    return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::greaterThanEqual(a.max, b.min));
+}
+
+// Same corner choice as BoundingBox::FrustumTest, so leaves give the same answer as testing every box
+bool OutsidePlane(const KS::Plane& plane, const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 normal = plane.GetNormal();
+    glm::vec3 positive = glm::vec3(normal.x > 0 ? max.x : min.x, normal.y > 0 ? max.y : min.y, normal.z > 0 ? max.z : min.z);
+    return plane.GetSignedDistance(positive) < 0.0f;
+}
+
+bool InsidePlane(const KS::Plane& plane, const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 normal = plane.GetNormal();
+    glm::vec3 negative = glm::vec3(normal.x > 0 ? min.x : max.x, normal.y > 0 ? min.y : max.y, normal.z > 0 ? min.z : max.z);
+    return plane.GetSignedDistance(negative) >= 0.0f;
+}
+
+// Distance at which the ray enters the box, or a negative value when it misses it within max_distance
+float RayEntry(const glm::vec3& origin, const glm::vec3& inverse, const glm::vec3& min, const glm::vec3& max, float max_distance)
+{
+    glm::vec3 t1 = (min - origin) * inverse;
+    glm::vec3 t2 = (max - origin) * inverse;
+    glm::vec3 near = glm::min(t1, t2);
+    glm::vec3 far = glm::max(t1, t2);
+
+    float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    float exit = std::min(std::min(far.x, far.y), std::min(far.z, max_distance));
+    return entry <= exit ? entry : -1.0f;
+}
+
+constexpr uint32_t ALL_PLANES = (1u << 6) - 1;
+constexpr uint32_t SAH_BINS = 12;
+
+}
+
+KS::DynamicAABBTree::DynamicAABBTree(float margin)
+    : margin(margin)
+{
+}
+
+KS::DynamicAABBTree::ProxyID KS::DynamicAABBTree::Insert(const BoundingBox& bounds, uint32_t user_data)
+{
+    uint32_t leaf = AllocateNode();
+    Node& node = nodes[leaf];
+    node.tight = Box { bounds.GetStart(), bounds.GetEnd() };
+    node.fat = Box { node.tight.min - glm::vec3(margin), node.tight.max + glm::vec3(margin) };
+    node.user_data = user_data;
+
+    InsertLeaf(leaf);
+    proxy_count++;
+    return leaf;
+}
+
+void KS::DynamicAABBTree::Remove(ProxyID proxy)
+{
+    ASSERT(proxy < nodes.size() && nodes[proxy].height == 0 && "Not a proxy of this tree");
+
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    proxy_count--;
+}
+
+bool KS::DynamicAABBTree::Update(ProxyID proxy, const BoundingBox& bounds, const glm::vec3& displacement)
+{
+    ASSERT(proxy < nodes.size() && nodes[proxy].height == 0 && "Not a proxy of this tree");
+
+    Node& node = nodes[proxy];
+    node.tight = Box { bounds.GetStart(), bounds.GetEnd() };
+
+    if (Contains(node.fat, node.tight))
+        return false;
+
+    RemoveLeaf(proxy);
+
+    // Stretched towards where the object is going, so it stays inside for longer
+    Box fat { node.tight.min - glm::vec3(margin), node.tight.max + glm::vec3(margin) };
+    fat.min += glm::min(displacement, glm::vec3(0.0f));
+    fat.max += glm::max(displacement, glm::vec3(0.0f));
+    nodes[proxy].fat = fat;
+
+    InsertLeaf(proxy);
+    return true;
+}
+
+KS::BoundingBox KS::DynamicAABBTree::GetBounds(ProxyID proxy) const
+{
+    const Box& box = nodes[proxy].tight;
+    return BoundingBox((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f);
+}
+
+KS::BoundingBox KS::DynamicAABBTree::GetFatBounds(ProxyID proxy) const
+{
+    const Box& box = nodes[proxy].fat;
+    return BoundingBox((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f);
+}
+
+void KS::DynamicAABBTree::QueryFrustum(const std::array<Plane, 6>& frustum, std::vector<uint32_t>& result) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    // Each entry carries the planes its parent was not completely inside of, none left means accept everything below
+    thread_local std::vector<std::pair<uint32_t, uint32_t>> stack {};
+    stack.clear();
+    stack.emplace_back(root, ALL_PLANES);
+
+    while (!stack.empty())
+    {
+        auto [index, planes] = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        const Box& box = node.IsLeaf() ? node.tight : node.fat;
+
+        bool culled = false;
+        for (uint32_t i = 0; i < 6 && !culled; i++)
+        {
+            if ((planes & (1u << i)) == 0)
+                continue;
+
+            if (OutsidePlane(frustum[i], box.min, box.max))
+                culled = true;
+            else if (InsidePlane(frustum[i], box.min, box.max))
+                planes &= ~(1u << i);
+        }
+
+        if (culled)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            result.emplace_back(node.user_data);
+        }
+        else
+        {
+            stack.emplace_back(node.children[1], planes);
+            stack.emplace_back(node.children[0], planes);
+        }
+    }
+}
+
+void KS::DynamicAABBTree::QueryOverlap(const BoundingBox& bounds, std::vector<uint32_t>& result) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    Box query { bounds.GetStart(), bounds.GetEnd() };
+
+    thread_local std::vector<uint32_t> stack {};
+    stack.clear();
+    stack.emplace_back(root);
+
+    while (!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (node.IsLeaf())
+        {
+            if (Overlaps(node.tight, query))
+                result.emplace_back(node.user_data);
+        }
+        else if (Overlaps(node.fat, query))
+        {
+            stack.emplace_back(node.children[1]);
+            stack.emplace_back(node.children[0]);
+        }
+    }
+}
+
+std::optional<KS::DynamicAABBTree::RayHit> KS::DynamicAABBTree::RayCast(
+    const glm::vec3& origin, const glm::vec3& direction, float max_distance) const
+{
+    if (root == NULL_NODE)
+        return std::nullopt;
+
+    glm::vec3 inverse = 1.0f / direction;
+    std::optional<RayHit> closest {};
+    float limit = max_distance;
+
+    // Nodes are stored with their entry distance, the nearer child is visited first
+    thread_local std::vector<std::pair<uint32_t, float>> stack {};
+    stack.clear();
+
+    float root_entry = RayEntry(origin, inverse, nodes[root].fat.min, nodes[root].fat.max, limit);
+    if (root_entry >= 0.0f)
+        stack.emplace_back(root, root_entry);
+
+    while (!stack.empty())
+    {
+        auto [index, entry] = stack.back();
+        stack.pop_back();
+
+        // Something closer was hit since this was pushed
+        if (entry > limit)
+            continue;
+
+        const Node& node = nodes[index];
+        if (node.IsLeaf())
+        {
+            float distance = RayEntry(origin, inverse, node.tight.min, node.tight.max, limit);
+            if (distance >= 0.0f)
+            {
+                closest = RayHit { node.user_data, distance };
+                limit = distance;
+            }
+            continue;
+        }
+
+        const Node& first = nodes[node.children[0]];
+        const Node& second = nodes[node.children[1]];
+        float first_entry = RayEntry(origin, inverse, first.fat.min, first.fat.max, limit);
+        float second_entry = RayEntry(origin, inverse, second.fat.min, second.fat.max, limit);
+
+        if (first_entry >= 0.0f && second_entry >= 0.0f && second_entry < first_entry)
+        {
+            stack.emplace_back(node.children[0], first_entry);
+            stack.emplace_back(node.children[1], second_entry);
+        }
+        else
+        {
+            if (second_entry >= 0.0f) stack.emplace_back(node.children[1], second_entry);
+            if (first_entry >= 0.0f) stack.emplace_back(node.children[0], first_entry);
+        }
+    }
+
+    return closest;
+}
+
+void KS::DynamicAABBTree::Optimize(uint32_t budget)
+{
+    if (nodes.empty())
+        return;
+
+    // Reinserting finds the best place for a leaf in the tree as it is now, rather than when it was inserted
+    for (size_t visited = 0; visited < nodes.size() && budget > 0; visited++)
+    {
+        optimize_cursor = (optimize_cursor + 1) % nodes.size();
+        if (nodes[optimize_cursor].height != 0)
+            continue;
+
+        RemoveLeaf(optimize_cursor);
+        InsertLeaf(optimize_cursor);
+        budget--;
+    }
+}
+
+void KS::DynamicAABBTree::Rebuild()
+{
+    std::vector<uint32_t> leaves {};
+    leaves.reserve(proxy_count);
+
+    for (uint32_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].height == 0)
+            leaves.emplace_back(i);
+        else if (nodes[i].height > 0)
+            FreeNode(i);
+    }
+
+    root = leaves.empty() ? NULL_NODE : BuildRange(leaves, 0, leaves.size());
+    if (root != NULL_NODE)
+        nodes[root].parent = NULL_NODE;
+}
+
+uint32_t KS::DynamicAABBTree::GetHeight() const
+{
+    return root == NULL_NODE ? 0 : static_cast<uint32_t>(nodes[root].height);
+}
+
+float KS::DynamicAABBTree::GetCost() const
+{
+    if (root == NULL_NODE || nodes[root].IsLeaf())
+        return 0.0f;
+
+    float total = 0.0f;
+    for (const auto& node : nodes)
+    {
+        if (node.height > 0)
+            total += Area(node.fat);
+    }
+    return total / std::max(Area(nodes[root].fat), std::numeric_limits<float>::min());
+}
+
+bool KS::DynamicAABBTree::IsValid() const
+{
+    if (root == NULL_NODE)
+        return proxy_count == 0;
+
+    if (nodes[root].parent != NULL_NODE)
+        return false;
+
+    size_t leaves = 0;
+    std::vector<uint32_t> stack { root };
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+
+        if (node.IsLeaf())
+        {
+            if (node.height != 0 || !Contains(node.fat, node.tight))
+                return false;
+
+            leaves++;
+            continue;
+        }
+
+        const Node& a = nodes[node.children[0]];
+        const Node& b = nodes[node.children[1]];
+        if (a.parent != index || b.parent != index || node.height != 1 + std::max(a.height, b.height))
+            return false;
+
+        Box expected = Union(a.fat, b.fat);
+        if (expected.min != node.fat.min || expected.max != node.fat.max)
+            return false;
+
+        stack.emplace_back(node.children[0]);
+        stack.emplace_back(node.children[1]);
+    }
+
+    return leaves == proxy_count;
+}
+
+uint32_t KS::DynamicAABBTree::AllocateNode()
+{
+    uint32_t index {};
+    if (free_list != NULL_NODE)
+    {
+        index = free_list;
+        free_list = nodes[index].parent;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    nodes[index] = Node {};
+    nodes[index].height = 0;
+    return index;
+}
+
+void KS::DynamicAABBTree::FreeNode(uint32_t node)
+{
+    nodes[node].parent = free_list;
+    nodes[node].height = -1;
+    free_list = node;
+}
+
+void KS::DynamicAABBTree::InsertLeaf(uint32_t leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Walks down to the sibling that makes the tree grow the least in surface area
+    Box box = nodes[leaf].fat;
+    uint32_t index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        const Node& node = nodes[index];
+        float area = Area(node.fat);
+        float combined = Area(Union(node.fat, box));
+
+        // Pairing with this node makes a new parent, going further down grows this node by the inherited cost
+        float cost = 2.0f * combined;
+        float inherited = 2.0f * (combined - area);
+
+        float child_costs[2] {};
+        for (int i = 0; i < 2; i++)
+        {
+            const Node& child = nodes[node.children[i]];
+            float grown = Area(Union(child.fat, box));
+            child_costs[i] = (child.IsLeaf() ? grown : grown - Area(child.fat)) + inherited;
+        }
+
+        if (cost < child_costs[0] && cost < child_costs[1])
+            break;
+
+        index = child_costs[0] < child_costs[1] ? node.children[0] : node.children[1];
+    }
+
+    uint32_t sibling = index;
+    uint32_t old_parent = nodes[sibling].parent;
+    uint32_t new_parent = AllocateNode();
+
+    Node& parent = nodes[new_parent];
+    parent.parent = old_parent;
+    parent.fat = Union(box, nodes[sibling].fat);
+    parent.height = nodes[sibling].height + 1;
+    parent.children[0] = sibling;
+    parent.children[1] = leaf;
+
+    if (old_parent == NULL_NODE)
+        root = new_parent;
+    else if (nodes[old_parent].children[0] == sibling)
+        nodes[old_parent].children[0] = new_parent;
+    else
+        nodes[old_parent].children[1] = new_parent;
+
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    // From the new parent up, so it is balanced as well
+    Refit(new_parent);
+}
+
+void KS::DynamicAABBTree::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    // The parent goes away and the sibling takes its place
+    uint32_t parent = nodes[leaf].parent;
+    uint32_t grandparent = nodes[parent].parent;
+    uint32_t sibling = nodes[parent].children[0] == leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+    if (grandparent == NULL_NODE)
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+        return;
+    }
+
+    if (nodes[grandparent].children[0] == parent)
+        nodes[grandparent].children[0] = sibling;
+    else
+        nodes[grandparent].children[1] = sibling;
+
+    nodes[sibling].parent = grandparent;
+    FreeNode(parent);
+
+    Refit(grandparent);
+}
+
+void KS::DynamicAABBTree::Refit(uint32_t index)
+{
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = nodes[index];
+        const Node& a = nodes[node.children[0]];
+        const Node& b = nodes[node.children[1]];
+        node.height = 1 + std::max(a.height, b.height);
+        node.fat = Union(a.fat, b.fat);
+
+        index = node.parent;
+    }
+}
+
+uint32_t KS::DynamicAABBTree::Balance(uint32_t ia)
+{
+    Node& a = nodes[ia];
+    if (a.IsLeaf() || a.height < 2)
+        return ia;
+
+    uint32_t ib = a.children[0];
+    uint32_t ic = a.children[1];
+    Node& b = nodes[ib];
+    Node& c = nodes[ic];
+
+    int32_t balance = c.height - b.height;
+
+    // Rotates the taller child up into a's place, a takes one of its children
+    auto rotate = [&](uint32_t iup, Node& up, uint32_t replaced_side, Node& other)
+    {
+        uint32_t i_f = up.children[0];
+        uint32_t i_g = up.children[1];
+        Node& f = nodes[i_f];
+        Node& g = nodes[i_g];
+
+        up.children[0] = ia;
+        up.parent = a.parent;
+        a.parent = iup;
+
+        if (up.parent == NULL_NODE)
+            root = iup;
+        else if (nodes[up.parent].children[0] == ia)
+            nodes[up.parent].children[0] = iup;
+        else
+            nodes[up.parent].children[1] = iup;
+
+        // The taller grandchild stays with up, the shorter one moves under a
+        uint32_t i_tall = f.height > g.height ? i_f : i_g;
+        uint32_t i_short = f.height > g.height ? i_g : i_f;
+        Node& tall = nodes[i_tall];
+        Node& shorter = nodes[i_short];
+
+        up.children[1] = i_tall;
+        a.children[replaced_side] = i_short;
+        shorter.parent = ia;
+
+        a.fat = Union(other.fat, shorter.fat);
+        up.fat = Union(a.fat, tall.fat);
+        a.height = 1 + std::max(other.height, shorter.height);
+        up.height = 1 + std::max(a.height, tall.height);
+    };
+
+    if (balance > 1)
+    {
+        // c moves up, a keeps b and takes one of c's children on the right
+        rotate(ic, c, 1, b);
+        return ic;
+    }
+
+    if (balance < -1)
+    {
+        // b moves up, a keeps c and takes one of b's children on the left
+        rotate(ib, b, 0, c);
+        return ib;
+    }
+
+    return ia;
+}
+
+uint32_t KS::DynamicAABBTree::BuildRange(std::vector<uint32_t>& leaves, size_t begin, size_t end)
+{
+    if (end - begin == 1)
+        return leaves[begin];
+
+    auto centroid = [&](uint32_t leaf) { return (nodes[leaf].fat.min + nodes[leaf].fat.max) * 0.5f; };
+
+    glm::vec3 low = centroid(leaves[begin]);
+    glm::vec3 high = low;
+    for (size_t i = begin; i < end; i++)
+    {
+        low = glm::min(low, centroid(leaves[i]));
+        high = glm::max(high, centroid(leaves[i]));
+    }
+
+    glm::vec3 extent = high - low;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    size_t middle = begin + (end - begin) / 2;
+
+    if (extent[axis] > 0.0f)
+    {
+        // Binned surface area heuristic along the widest axis
+        struct Bin
+        {
+            Box box { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+            uint32_t count = 0;
+        };
+        Bin bins[SAH_BINS] {};
+
+        float scale = SAH_BINS / extent[axis];
+        auto bin_of = [&](uint32_t leaf)
+        {
+            return std::min(SAH_BINS - 1, static_cast<uint32_t>((centroid(leaf)[axis] - low[axis]) * scale));
+        };
+
+        for (size_t i = begin; i < end; i++)
+        {
+            Bin& bin = bins[bin_of(leaves[i])];
+            bin.box = Union(bin.box, nodes[leaves[i]].fat);
+            bin.count++;
+        }
+
+        // Cost of the right side of every split, then sweep from the left
+        float right_costs[SAH_BINS] {};
+        Bin right {};
+        for (uint32_t i = SAH_BINS - 1; i > 0; i--)
+        {
+            right.box = Union(right.box, bins[i].box);
+            right.count += bins[i].count;
+            right_costs[i] = right.count ? Area(right.box) * right.count : 0.0f;
+        }
+
+        Bin left {};
+        float best_cost = std::numeric_limits<float>::max();
+        uint32_t best_split = 0;
+        for (uint32_t i = 1; i < SAH_BINS; i++)
+        {
+            left.box = Union(left.box, bins[i - 1].box);
+            left.count += bins[i - 1].count;
+
+            float cost = (left.count ? Area(left.box) * left.count : 0.0f) + right_costs[i];
+            if (left.count > 0 && left.count < end - begin && cost < best_cost)
+            {
+                best_cost = cost;
+                best_split = i;
+            }
+        }
+
+        if (best_split != 0)
+        {
+            auto split = std::partition(leaves.begin() + begin, leaves.begin() + end,
+                [&](uint32_t leaf) { return bin_of(leaf) < best_split; });
+            middle = static_cast<size_t>(split - leaves.begin());
+        }
+    }
+
+    // All centroids in one place, or every leaf in one bin
+    if (middle == begin || middle == end)
+        middle = begin + (end - begin) / 2;
+
+    uint32_t left = BuildRange(leaves, begin, middle);
+    uint32_t right = BuildRange(leaves, middle, end);
+
+    uint32_t index = AllocateNode();
+    Node& node = nodes[index];
+    node.children[0] = left;
+    node.children[1] = right;
+    node.fat = Union(nodes[left].fat, nodes[right].fat);
+    node.height = 1 + std::max(nodes[left].height, nodes[right].height);
+    nodes[left].parent = index;
+    nodes[right].parent = index;
+
+    return index;
+}
+
+namespace
+{
+
+KS::BoundingBox RandomBox(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> position { -100.0f, 100.0f };
+    std::uniform_real_distribution<float> size { 0.1f, 4.0f };
+    return KS::BoundingBox(glm::vec3(position(random), position(random), position(random)), glm::vec3(size(random), size(random), size(random)));
+}
+
+// Every query is checked against testing every box one by one
+bool MatchesBruteForce(const KS::DynamicAABBTree& tree, const std::vector<KS::BoundingBox>& boxes, const std::vector<bool>& alive,
+    std::mt19937& random)
+{
+    std::vector<uint32_t> found {};
+    std::vector<uint32_t> expected {};
+
+    auto same = [&]()
+    {
+        std::sort(found.begin(), found.end());
+        std::sort(expected.begin(), expected.end());
+        return found == expected;
+    };
+
+    std::uniform_real_distribution<float> position { -120.0f, 120.0f };
+
+    for (int query = 0; query < 20; query++)
+    {
+        glm::vec3 eye { position(random), position(random), position(random) };
+        glm::vec3 target { position(random), position(random), position(random) };
+        auto frustum = KS::Camera::Perspective(eye, target, 16.0f / 9.0f, glm::radians(70.0f), 0.1f, 150.0f).GetFrustum();
+
+        found.clear();
+        expected.clear();
+        tree.QueryFrustum(frustum, found);
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            if (alive[i] && boxes[i].FrustumTest(frustum))
+                expected.emplace_back(i);
+        }
+
+        if (!same())
+            return false;
+
+        auto area = KS::BoundingBox(target, glm::vec3(20.0f, 10.0f, 30.0f));
+        found.clear();
+        expected.clear();
+        tree.QueryOverlap(area, found);
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            glm::vec3 a_min = boxes[i].GetStart(), a_max = boxes[i].GetEnd();
+            if (alive[i] && glm::all(glm::lessThanEqual(a_min, area.GetEnd())) && glm::all(glm::greaterThanEqual(a_max, area.GetStart())))
+                expected.emplace_back(i);
+        }
+
+        if (!same())
+            return false;
+
+        // Only the distance has to match, boxes can overlap where the ray enters them
+        glm::vec3 direction = glm::normalize(target - eye);
+        auto hit = tree.RayCast(eye, direction, 500.0f);
+
+        float closest = std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            if (!alive[i])
+                continue;
+
+            float distance = RayEntry(eye, 1.0f / direction, boxes[i].GetStart(), boxes[i].GetEnd(), 500.0f);
+            if (distance >= 0.0f)
+                closest = std::min(closest, distance);
+        }
+
+        if (hit.has_value() != (closest != std::numeric_limits<float>::max()) || (hit && hit->distance != closest))
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+void KS::Tests::TestDynamicAABBTree()
+{
+    std::mt19937 random { 42 };
+
+    DynamicAABBTree tree { 0.5f };
+    std::vector<BoundingBox> boxes {};
+    std::vector<DynamicAABBTree::ProxyID> proxies {};
+    std::vector<bool> alive {};
+
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        boxes.emplace_back(RandomBox(random));
+        proxies.emplace_back(tree.Insert(boxes.back(), i));
+        alive.emplace_back(true);
+    }
+
+    if (!tree.IsValid() || tree.GetProxyCount() != 2000 || !MatchesBruteForce(tree, boxes, alive, random))
+    {
+        throw;
+    }
+
+    // Inserting keeps the tree balanced by height
+    if (tree.GetHeight() > 30)
+    {
+        throw;
+    }
+
+    // Small moves stay inside the fat bounds and leave the tree alone, large ones move the proxy
+    std::uniform_real_distribution<float> jitter { -0.2f, 0.2f };
+    std::uniform_real_distribution<float> jump { -30.0f, 30.0f };
+
+    for (int frame = 0; frame < 20; frame++)
+    {
+        uint32_t reinserted = 0;
+        for (uint32_t i = 0; i < boxes.size(); i += 4)
+        {
+            if (!alive[i])
+                continue;
+
+            glm::vec3 offset = frame % 5 == 0 ? glm::vec3(jump(random), jump(random), jump(random))
+                                              : glm::vec3(jitter(random), jitter(random), jitter(random));
+            boxes[i] = BoundingBox(boxes[i].GetCenter() + offset, boxes[i].GetExtents());
+            reinserted += tree.Update(proxies[i], boxes[i], offset) ? 1 : 0;
+        }
+
+        if (frame % 5 != 0 && reinserted > boxes.size() / 8)
+        {
+            throw;
+        }
+
+        for (uint32_t i = frame; i < boxes.size(); i += 97)
+        {
+            if (alive[i])
+            {
+                tree.Remove(proxies[i]);
+                alive[i] = false;
+            }
+        }
+
+        tree.Optimize(100);
+    }
+
+    if (!tree.IsValid() || !MatchesBruteForce(tree, boxes, alive, random))
+    {
+        throw;
+    }
+
+    // Freed proxies are reused, user data stays with the proxy
+    auto added = tree.Insert(BoundingBox(glm::vec3(0.0f), glm::vec3(1.0f)), 12345);
+    if (tree.GetUserData(added) != 12345 || !tree.IsValid())
+    {
+        throw;
+    }
+    tree.Remove(added);
+
+    // A full rebuild keeps every proxy and does not make the tree worse than incremental updates did
+    float cost = tree.GetCost();
+    tree.Rebuild();
+
+    if (!tree.IsValid() || tree.GetCost() > cost || !MatchesBruteForce(tree, boxes, alive, random))
+    {
+        throw;
+    }
+
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        if (alive[i] && tree.GetUserData(proxies[i]) != i)
+        {
+            throw;
+        }
+    }
+
+    // Everything removed
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        if (alive[i])
+            tree.Remove(proxies[i]);
+    }
+
+    std::vector<uint32_t> none {};
+    tree.QueryOverlap(BoundingBox(glm::vec3(0.0f), glm::vec3(1000.0f)), none);
+    if (!tree.IsValid() || !none.empty() || tree.RayCast(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f)).has_value())
+    {
+        throw;
+    }
+}
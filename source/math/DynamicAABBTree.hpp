@@ -0,0 +1,117 @@
+#pragma once
+#include <code_utility.hpp>
+#include <math/Geometry.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace KS
+{
+
+// Bounding volume hierarchy over the world bounds of scene instances, for culling, overlap and ray queries.
+// Leaves store fattened bounds, so objects that move a little do not touch the tree at all. Objects that leave
+// their fat bounds are removed and inserted again, which is cheap, but the tree slowly gets worse as the scene
+// changes. Optimize reinserts a few leaves per call to make up for it, Rebuild builds the whole tree again.
+class DynamicAABBTree
+{
+public:
+    using ProxyID = uint32_t;
+    static constexpr ProxyID NULL_PROXY = std::numeric_limits<uint32_t>::max();
+
+    struct RayHit
+    {
+        uint32_t user_data = 0;
+        float distance = 0.0f; // Along the direction, in units of its length
+    };
+
+    // Fat bounds grow by margin on every side
+    explicit DynamicAABBTree(float margin = 0.1f);
+
+    // user_data is what queries return, usually an index or entity id
+    ProxyID Insert(const BoundingBox& bounds, uint32_t user_data);
+    void Remove(ProxyID proxy);
+
+    // Returns true when the fat bounds were left and the proxy moved in the tree.
+    // displacement is how far the object is expected to move until the next update, the fat bounds are stretched by it.
+    bool Update(ProxyID proxy, const BoundingBox& bounds, const glm::vec3& displacement = glm::vec3(0.0f));
+
+    uint32_t GetUserData(ProxyID proxy) const { return nodes[proxy].user_data; }
+    BoundingBox GetBounds(ProxyID proxy) const;
+    BoundingBox GetFatBounds(ProxyID proxy) const;
+
+    // Queries append the user data of matching proxies to result, tested against their exact bounds.
+    // Whole subtrees inside the frustum are added without further tests, so the cost follows the number of visible proxies.
+    void QueryFrustum(const std::array<Plane, 6>& frustum, std::vector<uint32_t>& result) const;
+    void QueryOverlap(const BoundingBox& bounds, std::vector<uint32_t>& result) const;
+
+    // Closest proxy whose bounds the ray enters within max_distance, a ray starting inside a box hits it at 0
+    std::optional<RayHit> RayCast(const glm::vec3& origin, const glm::vec3& direction,
+        float max_distance = std::numeric_limits<float>::max()) const;
+
+    // Reinserts up to budget leaves, continuing where the last call stopped. Spread over frames it keeps the tree
+    // close to the quality of a fresh build without a hitch.
+    void Optimize(uint32_t budget);
+
+    // Builds the tree again from all leaves, top down with the surface area heuristic. Proxy ids stay the same.
+    void Rebuild();
+
+    size_t GetProxyCount() const { return proxy_count; }
+    uint32_t GetHeight() const;
+
+    // Summed surface area of the internal nodes relative to the root, lower is better
+    float GetCost() const;
+
+    // Checks parent links, bounds and heights of every node, for tests
+    bool IsValid() const;
+
+private:
+    static constexpr uint32_t NULL_NODE = NULL_PROXY;
+
+    struct Box
+    {
+        glm::vec3 min {};
+        glm::vec3 max {};
+    };
+
+    struct Node
+    {
+        Box fat {};
+        Box tight {}; // Leaves only
+
+        uint32_t parent = NULL_NODE; // Next free node while on the free list
+        uint32_t children[2] = { NULL_NODE, NULL_NODE };
+        int32_t height = -1; // 0 for leaves, -1 for free nodes
+        uint32_t user_data = 0;
+
+        bool IsLeaf() const { return children[0] == NULL_NODE; }
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t node);
+
+    void InsertLeaf(uint32_t leaf);
+    void RemoveLeaf(uint32_t leaf);
+
+    // Refits the bounds and heights from node up to the root, rotating where the heights get uneven
+    void Refit(uint32_t node);
+    uint32_t Balance(uint32_t node);
+
+    uint32_t BuildRange(std::vector<uint32_t>& leaves, size_t begin, size_t end);
+
+    std::vector<Node> nodes {};
+    uint32_t root = NULL_NODE;
+    uint32_t free_list = NULL_NODE;
+    size_t proxy_count = 0;
+    uint32_t optimize_cursor = 0;
+    float margin = 0.1f;
+};
+
+namespace Tests
+{
+    void TestDynamicAABBTree();
+}
+
+}
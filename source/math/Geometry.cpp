@@ -1,8 +1,196 @@
 #include "Geometry.hpp"
 
+#include <code_utility.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KS_GEOMETRY_SSE 1
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KS_TARGET_AVX
+#else
+#define KS_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace
+{
+
+// Arvo's method: the center moves with the full transform, each extent is the sum of the other extents scaled by
+// the absolute 3x3 part. That is the box around the 8 transformed corners without transforming them.
+// The SIMD paths below do the same operations in the same order, keep them in sync.
+void TransformBox(const float* m, const float* center, const float* extents, float* out_center, float* out_extents)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        out_center[row] = m[0 + row] * center[0] + m[4 + row] * center[1] + m[8 + row] * center[2] + m[12 + row];
+        out_extents[row] = std::abs(m[0 + row]) * extents[0] + std::abs(m[4 + row]) * extents[1]
+            + std::abs(m[8 + row]) * extents[2];
+    }
+}
+
+void TransformBoxesScalar(const KS::BoundingBoxArray& local, const glm::mat4* transforms, KS::BoundingBoxArray& world,
+    size_t begin, size_t end)
+{
+    // Through plain pointers, stores into the vectors would make the compiler reload their data pointers every box
+    const float* in[6] { local.center_x.data(), local.center_y.data(), local.center_z.data(), local.extent_x.data(),
+        local.extent_y.data(), local.extent_z.data() };
+    float* out[6] { world.center_x.data(), world.center_y.data(), world.center_z.data(), world.extent_x.data(),
+        world.extent_y.data(), world.extent_z.data() };
+
+    for (size_t i = begin; i < end; i++)
+    {
+        float center[3] { in[0][i], in[1][i], in[2][i] };
+        float extents[3] { in[3][i], in[4][i], in[5][i] };
+        float out_center[3], out_extents[3];
+
+        TransformBox(&transforms[i][0][0], center, extents, out_center, out_extents);
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            out[axis][i] = out_center[axis];
+            out[3 + axis][i] = out_extents[axis];
+        }
+    }
+}
+
+#ifdef KS_GEOMETRY_SSE
+
+bool CPUHasAVX()
+{
+#if defined(_MSC_VER)
+    // AVX and OSXSAVE, then whether the OS saves the upper halves of the registers
+    int info[4] {};
+    __cpuid(info, 1);
+    bool supported = (info[2] & (1 << 28)) && (info[2] & (1 << 27));
+    return supported && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return __builtin_cpu_supports("avx");
+#endif
+}
+
+// Four boxes at a time from begin, returns where it stopped. The matrices are loaded a column at a time and transposed,
+// so each register holds one matrix element of all four boxes.
+size_t TransformBoxesSSE(const KS::BoundingBoxArray& local, const glm::mat4* transforms, KS::BoundingBoxArray& world,
+    size_t begin, size_t count)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    size_t i = begin;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 m[4][3];
+        for (int column = 0; column < 4; column++)
+        {
+            __m128 a = _mm_loadu_ps(&transforms[i + 0][column][0]);
+            __m128 b = _mm_loadu_ps(&transforms[i + 1][column][0]);
+            __m128 c = _mm_loadu_ps(&transforms[i + 2][column][0]);
+            __m128 d = _mm_loadu_ps(&transforms[i + 3][column][0]);
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+            m[column][0] = a;
+            m[column][1] = b;
+            m[column][2] = c;
+        }
+
+        __m128 cx = _mm_loadu_ps(&local.center_x[i]);
+        __m128 cy = _mm_loadu_ps(&local.center_y[i]);
+        __m128 cz = _mm_loadu_ps(&local.center_z[i]);
+        __m128 ex = _mm_loadu_ps(&local.extent_x[i]);
+        __m128 ey = _mm_loadu_ps(&local.extent_y[i]);
+        __m128 ez = _mm_loadu_ps(&local.extent_z[i]);
+
+        float* out_center[3] { &world.center_x[i], &world.center_y[i], &world.center_z[i] };
+        float* out_extents[3] { &world.extent_x[i], &world.extent_y[i], &world.extent_z[i] };
+
+        for (int row = 0; row < 3; row++)
+        {
+            __m128 center = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][row], cx), _mm_mul_ps(m[1][row], cy)),
+                _mm_mul_ps(m[2][row], cz)), m[3][row]);
+            __m128 extents = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign, m[0][row]), ex),
+                _mm_mul_ps(_mm_andnot_ps(sign, m[1][row]), ey)), _mm_mul_ps(_mm_andnot_ps(sign, m[2][row]), ez));
+
+            _mm_storeu_ps(out_center[row], center);
+            _mm_storeu_ps(out_extents[row], extents);
+        }
+    }
+
+    return i;
+}
+
+// A column of the box's matrix in the low half, the same column of the matrix four boxes later in the high half
+KS_TARGET_AVX inline __m256 LoadColumnPair(const glm::mat4* transforms, size_t box, int column)
+{
+    __m256 low = _mm256_castps128_ps256(_mm_loadu_ps(&transforms[box][column][0]));
+    return _mm256_insertf128_ps(low, _mm_loadu_ps(&transforms[box + 4][column][0]), 1);
+}
+
+// Eight boxes at a time, the same as the SSE path with boxes i to i + 3 in the low halves and i + 4 to i + 7 in the
+// high halves of the registers
+KS_TARGET_AVX size_t TransformBoxesAVX(const KS::BoundingBoxArray& local, const glm::mat4* transforms,
+    KS::BoundingBoxArray& world, size_t count)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 m[4][3];
+        for (int column = 0; column < 4; column++)
+        {
+            __m256 a = LoadColumnPair(transforms, i + 0, column);
+            __m256 b = LoadColumnPair(transforms, i + 1, column);
+            __m256 c = LoadColumnPair(transforms, i + 2, column);
+            __m256 d = LoadColumnPair(transforms, i + 3, column);
+
+            __m256 ab_low = _mm256_unpacklo_ps(a, b);
+            __m256 cd_low = _mm256_unpacklo_ps(c, d);
+            __m256 ab_high = _mm256_unpackhi_ps(a, b);
+            __m256 cd_high = _mm256_unpackhi_ps(c, d);
+
+            m[column][0] = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+            m[column][1] = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+            m[column][2] = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+        }
+
+        __m256 cx = _mm256_loadu_ps(&local.center_x[i]);
+        __m256 cy = _mm256_loadu_ps(&local.center_y[i]);
+        __m256 cz = _mm256_loadu_ps(&local.center_z[i]);
+        __m256 ex = _mm256_loadu_ps(&local.extent_x[i]);
+        __m256 ey = _mm256_loadu_ps(&local.extent_y[i]);
+        __m256 ez = _mm256_loadu_ps(&local.extent_z[i]);
+
+        float* out_center[3] { &world.center_x[i], &world.center_y[i], &world.center_z[i] };
+        float* out_extents[3] { &world.extent_x[i], &world.extent_y[i], &world.extent_z[i] };
+
+        for (int row = 0; row < 3; row++)
+        {
+            __m256 center = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0][row], cx),
+                _mm256_mul_ps(m[1][row], cy)), _mm256_mul_ps(m[2][row], cz)), m[3][row]);
+            __m256 extents = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(sign, m[0][row]), ex),
+                _mm256_mul_ps(_mm256_andnot_ps(sign, m[1][row]), ey)), _mm256_mul_ps(_mm256_andnot_ps(sign, m[2][row]), ez));
+
+            _mm256_storeu_ps(out_center[row], center);
+            _mm256_storeu_ps(out_extents[row], extents);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+}
+
 KS::BoundingBox::BoundingBox(const glm::vec3& m_center, const glm::vec3& m_extents)
     : m_center(m_center)
-    , m_extents(glm::vec3(std::fabsf(m_extents.x), std::fabsf(m_extents.y), std::fabsf(m_extents.z)))
+    , m_extents(glm::vec3(std::abs(m_extents.x), std::abs(m_extents.y), std::abs(m_extents.z)))
 {
 }
 
@@ -22,23 +210,56 @@ std::array<glm::vec3, 8> KS::BoundingBox::GetEdgePoints() const
 
 KS::BoundingBox KS::BoundingBox::ApplyTransform(const glm::mat4& transform) const
 {
-    // There might be a better way of calculating these transformed values
-    // https://learnopengl.com/Guest-Articles/2021/Scene/Frustum-Culling
+    glm::vec3 center {}, extents {};
+    TransformBox(&transform[0][0], &m_center[0], &m_extents[0], &center[0], &extents[0]);
+    return BoundingBox(center, extents);
+}
 
-    glm::vec3 center = transform * glm::vec4(m_center, 1.0f);
-    glm::vec3 min = center, max = center;
+void KS::BoundingBoxArray::Resize(size_t count)
+{
+    for (auto* values : { &center_x, &center_y, &center_z, &extent_x, &extent_y, &extent_z })
+        values->resize(count);
+}
 
-    auto edges = GetEdgePoints();
-    for (auto edge : edges)
-    {
-        glm::vec3 transformed = transform * glm::vec4(edge, 1.0f);
-        min = glm::min(transformed, min);
-        max = glm::max(transformed, max);
-    }
+void KS::BoundingBoxArray::Set(size_t index, const BoundingBox& box)
+{
+    glm::vec3 center = box.GetCenter(), extents = box.GetExtents();
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    extent_x[index] = extents.x;
+    extent_y[index] = extents.y;
+    extent_z[index] = extents.z;
+}
+
+KS::BoundingBox KS::BoundingBoxArray::Get(size_t index) const
+{
+    return BoundingBox(glm::vec3(center_x[index], center_y[index], center_z[index]),
+        glm::vec3(extent_x[index], extent_y[index], extent_z[index]));
+}
+
+void KS::TransformBoundingBoxes(const BoundingBoxArray& local, std::span<const glm::mat4> transforms, BoundingBoxArray& world,
+    SimdLevel level)
+{
+    ASSERT(transforms.size() == local.GetSize() && "Every box needs a transform");
+
+    size_t count = local.GetSize();
+    world.Resize(count);
 
-    auto extent = (max - min) * 0.5f;
+    // Whatever the wide paths leave over is done one box at a time
+    size_t done = 0;
 
-    return BoundingBox(min + extent, extent);
+#ifdef KS_GEOMETRY_SSE
+    static const bool has_avx = CPUHasAVX();
+
+    if ((level == SimdLevel::AVX || level == SimdLevel::BEST) && has_avx)
+        done = TransformBoxesAVX(local, transforms.data(), world, count);
+
+    if (level != SimdLevel::SCALAR)
+        done = TransformBoxesSSE(local, transforms.data(), world, done, count);
+#endif
+
+    TransformBoxesScalar(local, transforms.data(), world, done, count);
 }
 
 bool KS::BoundingBox::FrustumTest(const std::array<Plane, 6>& frustum) const
@@ -206,7 +427,7 @@ std::array<KS::Plane, 6> KS::Camera::GetFrustum() const
     if (type == CameraType::PERSPECTIVE)
     {
 
-        float halfVertical = farClip * std::tanf(fieldOfView * 0.5f);
+        float halfVertical = farClip * std::tan(fieldOfView * 0.5f);
         float halfHorizontal = halfVertical * aspectRatio;
 
         auto rightNormal = glm::cross(farVector - (right * halfHorizontal), up);
@@ -236,3 +457,81 @@ std::array<KS::Plane, 6> KS::Camera::GetFrustum() const
 
     return { nearPlane, farPlane, rightPlane, leftPlane, topPlane, bottomPlane };
 }
+
+void KS::Tests::TestBoundingBoxTransform()
+{
+    std::mt19937 random { 7 };
+    std::uniform_real_distribution<float> position { -100.0f, 100.0f };
+    std::uniform_real_distribution<float> size { 0.0f, 10.0f };
+    std::uniform_real_distribution<float> element { -3.0f, 3.0f };
+
+    // Not a multiple of eight, so every path leaves a tail for the next one
+    constexpr size_t COUNT = 1003;
+
+    BoundingBoxArray local {};
+    local.Resize(COUNT);
+    std::vector<glm::mat4> transforms(COUNT);
+
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        local.Set(i, BoundingBox(glm::vec3(position(random), position(random), position(random)),
+            glm::vec3(size(random), size(random), size(random))));
+
+        // Rotations, mirrors, shears and projective rows alike, only the affine part matters
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                transforms[i][column][row] = column == 3 && row < 3 ? position(random) : element(random);
+    }
+
+    for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE, SimdLevel::AVX, SimdLevel::BEST })
+    {
+        BoundingBoxArray world {};
+        TransformBoundingBoxes(local, transforms, world, level);
+
+        if (world.GetSize() != COUNT)
+        {
+            throw;
+        }
+
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            BoundingBox expected = local.Get(i).ApplyTransform(transforms[i]);
+            BoundingBox actual = world.Get(i);
+
+            glm::vec3 values[4] { expected.GetCenter(), expected.GetExtents(), actual.GetCenter(), actual.GetExtents() };
+            if (std::memcmp(&values[0], &values[2], sizeof(glm::vec3) * 2) != 0)
+            {
+                throw;
+            }
+        }
+    }
+
+    // The same box as the one around the eight transformed corners
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        BoundingBox box = local.Get(i);
+        BoundingBox transformed = box.ApplyTransform(transforms[i]);
+
+        glm::vec3 min(INFINITY), max(-INFINITY);
+        for (auto corner : box.GetEdgePoints())
+        {
+            glm::vec3 point = transforms[i] * glm::vec4(corner, 1.0f);
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        float tolerance = 1e-4f * (1.0f + glm::length(max - min) + glm::length(box.GetCenter()) * 3.0f);
+        if (glm::length(transformed.GetStart() - min) > tolerance || glm::length(transformed.GetEnd() - max) > tolerance)
+        {
+            throw;
+        }
+    }
+
+    // Translations are exact
+    BoundingBox box { glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.5f, 1.5f, 2.5f) };
+    BoundingBox moved = box.ApplyTransform(glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 20.0f, 30.0f)));
+    if (moved.GetCenter() != glm::vec3(11.0f, 22.0f, 33.0f) || moved.GetExtents() != box.GetExtents())
+    {
+        throw;
+    }
+}
@@ -3,6 +3,7 @@
 #include <array>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <span>
 #include <vector>
 
 namespace KS
@@ -34,6 +35,8 @@ public:
     glm::vec3 GetSize() const { return m_extents * 2.0f; }
 
     std::array<glm::vec3, 8> GetEdgePoints() const;
+
+    // Smallest axis aligned box around the transformed box, see TransformBoundingBoxes for many at once
     BoundingBox ApplyTransform(const glm::mat4& transform) const;
     bool FrustumTest(const std::array<Plane, 6>& frustum) const;
     glm::vec3 GetCenter() const { return m_center; }
@@ -45,6 +48,33 @@ private:
     glm::vec3 m_extents; // size / 2
 };
 
+// Many boxes in structure of arrays form, one array per component, so they are transformed a SIMD register at a time
+struct BoundingBoxArray
+{
+    std::vector<float> center_x {}, center_y {}, center_z {};
+    std::vector<float> extent_x {}, extent_y {}, extent_z {};
+
+    size_t GetSize() const { return center_x.size(); }
+    void Resize(size_t count);
+
+    void Set(size_t index, const BoundingBox& box);
+    BoundingBox Get(size_t index) const;
+};
+
+enum class SimdLevel
+{
+    SCALAR,
+    SSE,
+    AVX, // Used when the CPU and OS support it, checked at runtime
+    BEST
+};
+
+// Moves every box through the transform with the same index. Gives the same results as ApplyTransform on each box,
+// bit for bit on every level, as long as the compiler does not contract multiplies and adds into FMA.
+// Levels the build or CPU does not support fall back to the next lower one.
+void TransformBoundingBoxes(const BoundingBoxArray& local, std::span<const glm::mat4> transforms, BoundingBoxArray& world,
+    SimdLevel level = SimdLevel::BEST);
+
 // 3D plane
 class Plane
 {
@@ -121,4 +151,9 @@ private:
     float farClip {};
 };
 
+namespace Tests
+{
+    void TestBoundingBoxTransform();
+}
+
 } // namespace KS
\ No newline at end of file
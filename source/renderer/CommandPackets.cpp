@@ -0,0 +1,425 @@
+#include "CommandPackets.hpp"
+
+#include <renderer/StorageBuffer.hpp>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+
+constexpr uint32_t MAX_VERTEX_SLOTS = 8;
+
+// Sorted commands jump between streams, so their packets are fetched a few commands ahead
+constexpr size_t PREFETCH_DISTANCE = 4;
+
+// FNV-1a over whole words rather than bytes, the checksum runs once per translated packet
+void HashValue(uint64_t& hash, uint64_t value)
+{
+    hash = (hash ^ value) * 1099511628211ull;
+    hash ^= hash >> 32;
+}
+
+uint64_t Address(const void* pointer) { return reinterpret_cast<uintptr_t>(pointer); }
+
+void Prefetch([[maybe_unused]] const void* data, [[maybe_unused]] size_t size)
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+    const char* bytes = static_cast<const char*>(data);
+    for (size_t offset = 0; offset < size; offset += 64)
+        _mm_prefetch(bytes + offset, _MM_HINT_T0);
+#endif
+}
+
+}
+
+void KS::CommandStream::Begin(uint64_t sort_key)
+{
+    commands.emplace_back(Command { sort_key, static_cast<uint32_t>(packets.size()), 0 });
+}
+
+void KS::CommandStream::Clear()
+{
+    packets.clear();
+    commands.clear();
+}
+
+KS::CommandPacket& KS::CommandStream::Add(PacketType type)
+{
+    ASSERT(!commands.empty() && "Begin a command before recording packets");
+
+    commands.back().count++;
+    auto& packet = packets.emplace_back();
+    packet.type = type;
+    return packet;
+}
+
+void KS::NullCommandTranslator::Translate(const CommandPacket& packet)
+{
+    counts[static_cast<size_t>(packet.type)]++;
+    HashValue(hash, static_cast<uint64_t>(packet.type));
+
+    switch (packet.type)
+    {
+    case PacketType::BIND_PIPELINE:
+        pipeline = packet.pipeline.shader;
+        HashValue(hash, Address(pipeline));
+        break;
+
+    case PacketType::BIND_RENDER_TARGET:
+    case PacketType::CLEAR_RENDER_TARGET:
+    case PacketType::CLEAR_DEPTH_STENCIL:
+        HashValue(hash, Address(packet.target.render_target));
+        HashValue(hash, Address(packet.target.depth_stencil));
+        break;
+
+    case PacketType::BIND_INPUT:
+        HashValue(hash, Address(packet.input.input));
+        HashValue(hash, static_cast<uint64_t>(packet.input.desc.rootIndex));
+        HashValue(hash, packet.input.offset);
+        break;
+
+    case PacketType::BIND_INDEX_BUFFER:
+        index_buffer = true;
+        [[fallthrough]];
+
+    case PacketType::BIND_VERTEX_BUFFER:
+        HashValue(hash, Address(packet.buffer.buffer));
+        HashValue(hash, packet.buffer.slot);
+        break;
+
+    case PacketType::DRAW_INDEXED:
+        errors += (pipeline == nullptr || !index_buffer) ? 1 : 0;
+        indices += uint64_t(packet.draw.index_count) * packet.draw.instance_count;
+        HashValue(hash, packet.draw.index_count);
+        HashValue(hash, packet.draw.instance_count);
+        break;
+
+    case PacketType::DISPATCH:
+        errors += pipeline == nullptr ? 1 : 0;
+        HashValue(hash, packet.dispatch.x);
+        HashValue(hash, packet.dispatch.y);
+        HashValue(hash, packet.dispatch.z);
+        break;
+
+    case PacketType::BARRIER:
+        HashValue(hash, Address(packet.barrier.texture));
+        HashValue(hash, packet.barrier.writable);
+        break;
+
+    default:
+        errors++;
+        break;
+    }
+}
+
+KS::CommandRecorder::CommandRecorder(uint32_t worker_count)
+{
+    for (uint32_t i = 0; i < worker_count; i++)
+        workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+KS::CommandRecorder::~CommandRecorder()
+{
+    jobs.Close();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void KS::CommandRecorder::Record(uint32_t job_count, const RecordFunction& record)
+{
+    ASSERT(job_count <= MAX_JOBS && "Too many recording jobs for the job queue");
+
+    if (job_count == 0)
+        return;
+
+    // Every stream is created up front, workers only ever touch their own
+    first_stream = stream_count;
+    stream_count += job_count;
+    while (streams.size() < stream_count)
+        streams.emplace_back(std::make_unique<CommandStream>());
+
+    this->record = &record;
+    remaining.store(job_count, std::memory_order_release);
+
+    for (uint32_t job = 0; job < job_count; job++)
+        jobs.Push(job);
+
+    // The calling thread helps out, and does all the work when there are no workers
+    while (true)
+    {
+        uint32_t left = remaining.load(std::memory_order_acquire);
+        if (left == 0)
+            break;
+
+        if (auto job = jobs.TryPop())
+            RunJob(*job);
+        else
+            remaining.wait(left, std::memory_order_acquire);
+    }
+
+    this->record = nullptr;
+}
+
+KS::CommandStream& KS::CommandRecorder::AddStream()
+{
+    if (streams.size() <= stream_count)
+        streams.emplace_back(std::make_unique<CommandStream>());
+
+    return *streams[stream_count++];
+}
+
+KS::CommandRecorder::SubmitStats KS::CommandRecorder::Submit(CommandTranslator& translator)
+{
+    SubmitStats stats {};
+
+    order.clear();
+    for (uint32_t stream = 0; stream < stream_count; stream++)
+    {
+        const auto& commands = streams[stream]->commands;
+        for (uint32_t command = 0; command < commands.size(); command++)
+            order.emplace_back(SortEntry { commands[command].sort_key, stream, command });
+    }
+
+    // Ties are broken by stream and recording order, which do not depend on thread timing
+    std::sort(order.begin(), order.end(), [](const SortEntry& a, const SortEntry& b)
+    {
+        if (a.sort_key != b.sort_key) return a.sort_key < b.sort_key;
+        if (a.stream != b.stream) return a.stream < b.stream;
+        return a.command < b.command;
+    });
+
+    // State that is bound again right after being bound is dropped. Only state that nothing else in a submission
+    // can change is tracked, binding a buffer as a shader input changes its resource state so that forgets it.
+    const Shader* pipeline = nullptr;
+    StorageBuffer* vertex_buffers[MAX_VERTEX_SLOTS] {};
+    StorageBuffer* index_buffer = nullptr;
+
+    for (size_t e = 0; e < order.size(); e++)
+    {
+        if (e + PREFETCH_DISTANCE < order.size())
+        {
+            const auto& ahead = order[e + PREFETCH_DISTANCE];
+            const CommandStream& ahead_stream = *streams[ahead.stream];
+            const auto& ahead_command = ahead_stream.commands[ahead.command];
+            Prefetch(ahead_stream.packets.data() + ahead_command.first, ahead_command.count * sizeof(CommandPacket));
+        }
+
+        const auto& entry = order[e];
+        const CommandStream& stream = *streams[entry.stream];
+        const auto& command = stream.commands[entry.command];
+
+        for (uint32_t i = command.first; i < command.first + command.count; i++)
+        {
+            const CommandPacket& packet = stream.packets[i];
+            bool redundant = false;
+
+            switch (packet.type)
+            {
+            case PacketType::BIND_PIPELINE:
+                redundant = packet.pipeline.shader == pipeline;
+                pipeline = packet.pipeline.shader;
+                break;
+
+            case PacketType::BIND_VERTEX_BUFFER:
+                if (packet.buffer.slot < MAX_VERTEX_SLOTS && packet.buffer.offset == 0)
+                {
+                    redundant = vertex_buffers[packet.buffer.slot] == packet.buffer.buffer;
+                    vertex_buffers[packet.buffer.slot] = packet.buffer.buffer;
+                }
+                break;
+
+            case PacketType::BIND_INDEX_BUFFER:
+                redundant = packet.buffer.offset == 0 && index_buffer == packet.buffer.buffer;
+                index_buffer = packet.buffer.offset == 0 ? packet.buffer.buffer : nullptr;
+                break;
+
+            case PacketType::BIND_INPUT:
+                for (auto& buffer : vertex_buffers)
+                {
+                    if (static_cast<ShaderInput*>(buffer) == packet.input.input)
+                        buffer = nullptr;
+                }
+                if (static_cast<ShaderInput*>(index_buffer) == packet.input.input)
+                    index_buffer = nullptr;
+                break;
+
+            default:
+                break;
+            }
+
+            if (redundant)
+            {
+                stats.skipped++;
+                continue;
+            }
+
+            translator.Translate(packet);
+            stats.packets++;
+        }
+    }
+
+    stats.commands = static_cast<uint32_t>(order.size());
+
+    for (uint32_t stream = 0; stream < stream_count; stream++)
+        streams[stream]->Clear();
+    stream_count = 0;
+
+    return stats;
+}
+
+void KS::CommandRecorder::RunJob(uint32_t job)
+{
+    (*record)(job, *streams[first_stream + job]);
+
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+    remaining.notify_one();
+}
+
+void KS::CommandRecorder::WorkerLoop()
+{
+    while (auto job = jobs.Pop())
+        RunJob(*job);
+}
+
+namespace
+{
+
+// Stand ins for GPU objects, the packets only carry their addresses and the null translator never follows them
+template <typename T>
+T* Fake(uint32_t id)
+{
+    return reinterpret_cast<T*>(uintptr_t(0x10000) + uintptr_t(id) * 64);
+}
+
+constexpr uint32_t MESH_COUNT = 10;
+constexpr uint32_t DRAWS_PER_JOB = 250;
+constexpr uint32_t JOBS = 8;
+
+// A frame shaped like the model renderer's: pass setup first, then draws that bind their mesh and textures
+KS::CommandRecorder::SubmitStats RecordFrame(KS::CommandRecorder& recorder, KS::CommandTranslator& translator)
+{
+    KS::ShaderInputDesc model_index {};
+    model_index.rootIndex = 1;
+    KS::ShaderInputDesc base_tex {};
+    base_tex.rootIndex = 2;
+
+    auto& setup = recorder.AddStream();
+    setup.Begin(KS::MakeSortKey(0, 0, 0));
+    setup.BindRenderTarget(Fake<KS::RenderTarget>(1), Fake<KS::DepthStencil>(2));
+    setup.ClearRenderTarget(Fake<KS::RenderTarget>(1));
+    setup.ClearDepthStencil(Fake<KS::DepthStencil>(2));
+    setup.BindPipeline(Fake<KS::Shader>(3));
+
+    recorder.Record(JOBS, [&](uint32_t job, KS::CommandStream& stream)
+    {
+        for (uint32_t i = 0; i < DRAWS_PER_JOB; i++)
+        {
+            uint32_t draw = job * DRAWS_PER_JOB + i;
+            uint32_t mesh = (draw * 7) % MESH_COUNT;
+
+            stream.Begin(KS::MakeSortKey(1, mesh, draw));
+            stream.BindInput(Fake<KS::ShaderInput>(4), model_index, draw);
+            stream.BindVertexBuffer(Fake<KS::StorageBuffer>(100 + mesh * 2), 0);
+            stream.BindIndexBuffer(Fake<KS::StorageBuffer>(101 + mesh * 2));
+            stream.BindInput(Fake<KS::ShaderInput>(200 + mesh), base_tex);
+            stream.DrawIndexed(3 * (mesh + 1));
+        }
+    });
+
+    // Recorded last but sorted between the setup and the draws
+    auto& compute = recorder.AddStream();
+    compute.Begin(KS::MakeSortKey(2, 0, 0));
+    compute.Barrier(Fake<KS::Texture>(5), true);
+    compute.BindPipeline(Fake<KS::Shader>(6));
+    compute.Dispatch(8, 8, 1);
+
+    return recorder.Submit(translator);
+}
+
+// Remembers the order vertex buffers were bound in
+class OrderTranslator : public KS::CommandTranslator
+{
+public:
+    void Translate(const KS::CommandPacket& packet) override
+    {
+        if (packet.type == KS::PacketType::BIND_VERTEX_BUFFER)
+            vertex_buffers.emplace_back(packet.buffer.buffer);
+        types.emplace_back(packet.type);
+    }
+
+    std::vector<KS::StorageBuffer*> vertex_buffers {};
+    std::vector<KS::PacketType> types {};
+};
+
+}
+
+void KS::Tests::TestCommandPackets()
+{
+    constexpr uint32_t DRAWS = JOBS * DRAWS_PER_JOB;
+
+    // Serial and parallel recording submit exactly the same packets
+    CommandRecorder serial { 0 };
+    CommandRecorder parallel { 3 };
+
+    NullCommandTranslator serial_result {};
+    NullCommandTranslator parallel_result {};
+    auto serial_stats = RecordFrame(serial, serial_result);
+    auto parallel_stats = RecordFrame(parallel, parallel_result);
+
+    if (serial_result.GetHash() != parallel_result.GetHash() || serial_stats.packets != parallel_stats.packets
+        || serial_stats.commands != DRAWS + 2)
+    {
+        throw;
+    }
+
+    // Sorting by mesh leaves one vertex and index bind per mesh
+    if (parallel_result.GetErrorCount() != 0 || parallel_result.GetPacketCount(PacketType::DRAW_INDEXED) != DRAWS
+        || parallel_result.GetPacketCount(PacketType::BIND_VERTEX_BUFFER) != MESH_COUNT
+        || parallel_result.GetPacketCount(PacketType::BIND_INDEX_BUFFER) != MESH_COUNT
+        || parallel_stats.skipped != 2 * (DRAWS - MESH_COUNT) || parallel_result.GetPacketCount(PacketType::DISPATCH) != 1)
+    {
+        throw;
+    }
+
+    uint64_t expected_indices = 0;
+    for (uint32_t draw = 0; draw < DRAWS; draw++)
+        expected_indices += 3 * ((draw * 7) % MESH_COUNT + 1);
+
+    if (parallel_result.GetIndexCount() != expected_indices)
+    {
+        throw;
+    }
+
+    // Submission follows the sort keys: setup, draws grouped by mesh, then the compute pass
+    OrderTranslator order {};
+    RecordFrame(parallel, order);
+
+    if (order.types.front() != PacketType::BIND_RENDER_TARGET || order.types.back() != PacketType::DISPATCH
+        || !std::is_sorted(order.vertex_buffers.begin(), order.vertex_buffers.end()))
+    {
+        throw;
+    }
+
+    // Streams are cleared by Submit and the next frame gives the same result
+    NullCommandTranslator again {};
+    RecordFrame(parallel, again);
+    if (again.GetHash() != parallel_result.GetHash())
+    {
+        throw;
+    }
+
+    // The null translator catches draws without the state they need
+    CommandRecorder missing_state { 0 };
+    auto& stream = missing_state.AddStream();
+    stream.Begin(0);
+    stream.DrawIndexed(3);
+
+    NullCommandTranslator invalid {};
+    missing_state.Submit(invalid);
+    if (invalid.GetErrorCount() != 1)
+    {
+        throw;
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+#include <code_utility.hpp>
+#include <containers/BlockingQueue.hpp>
+#include <containers/MPMCQueue.hpp>
+#include <renderer/ShaderInputCollection.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace KS
+{
+class Device;
+class Shader;
+class RenderTarget;
+class DepthStencil;
+class ShaderInput;
+class StorageBuffer;
+class Texture;
+
+enum class PacketType : uint8_t
+{
+    BIND_PIPELINE,
+    BIND_RENDER_TARGET,
+    CLEAR_RENDER_TARGET,
+    CLEAR_DEPTH_STENCIL,
+    BIND_INPUT,
+    BIND_VERTEX_BUFFER,
+    BIND_INDEX_BUFFER,
+    DRAW_INDEXED,
+    DISPATCH,
+    BARRIER,
+    COUNT
+};
+
+// One recorded GPU command. Packets only point at engine objects, a CommandTranslator turns them into backend calls.
+struct CommandPacket
+{
+    struct Pipeline
+    {
+        const Shader* shader;
+    };
+
+    struct Target
+    {
+        RenderTarget* render_target;
+        DepthStencil* depth_stencil;
+    };
+
+    struct Input
+    {
+        ShaderInput* input;
+        ShaderInputDesc desc;
+        uint32_t offset;
+    };
+
+    struct Buffer
+    {
+        StorageBuffer* buffer;
+        uint32_t slot; // Vertex buffers only
+        uint32_t offset;
+    };
+
+    struct Draw
+    {
+        uint32_t index_count;
+        uint32_t instance_count;
+    };
+
+    struct Dispatch
+    {
+        uint32_t x, y, z;
+    };
+
+    struct Barrier
+    {
+        const Texture* texture;
+        bool writable;
+    };
+
+    PacketType type;
+    union
+    {
+        Pipeline pipeline;
+        Target target;
+        Input input;
+        Buffer buffer;
+        Draw draw;
+        Dispatch dispatch;
+        Barrier barrier;
+    };
+};
+
+// Commands are submitted in order of their sort key. From the highest bits down: the pass, the state the command
+// binds (so commands sharing a pipeline or mesh end up next to each other) and the order within that state.
+constexpr uint64_t MakeSortKey(uint8_t pass, uint32_t state, uint32_t order)
+{
+    return (uint64_t(pass) << 56) | (uint64_t(state & 0xFFFFFF) << 32) | order;
+}
+
+// Linear buffer of packets for one thread. Begin starts a command, the packets recorded after it stay together
+// and in order when commands are sorted.
+class CommandStream
+{
+public:
+    void Begin(uint64_t sort_key);
+
+    void BindPipeline(const Shader* shader) { Add(PacketType::BIND_PIPELINE).pipeline = { shader }; }
+    void BindRenderTarget(RenderTarget* target, DepthStencil* depth) { Add(PacketType::BIND_RENDER_TARGET).target = { target, depth }; }
+    void ClearRenderTarget(RenderTarget* target) { Add(PacketType::CLEAR_RENDER_TARGET).target = { target, nullptr }; }
+    void ClearDepthStencil(DepthStencil* depth) { Add(PacketType::CLEAR_DEPTH_STENCIL).target = { nullptr, depth }; }
+    void BindInput(ShaderInput* input, const ShaderInputDesc& desc, uint32_t offset = 0) { Add(PacketType::BIND_INPUT).input = { input, desc, offset }; }
+    void BindVertexBuffer(StorageBuffer* buffer, uint32_t slot) { Add(PacketType::BIND_VERTEX_BUFFER).buffer = { buffer, slot, 0 }; }
+    void BindIndexBuffer(StorageBuffer* buffer) { Add(PacketType::BIND_INDEX_BUFFER).buffer = { buffer, 0, 0 }; }
+    void DrawIndexed(uint32_t index_count, uint32_t instance_count = 1) { Add(PacketType::DRAW_INDEXED).draw = { index_count, instance_count }; }
+    void Dispatch(uint32_t x, uint32_t y, uint32_t z) { Add(PacketType::DISPATCH).dispatch = { x, y, z }; }
+    void Barrier(const Texture* texture, bool writable) { Add(PacketType::BARRIER).barrier = { texture, writable }; }
+
+    // Keeps the memory, so a stream that records the same amount every frame stops allocating
+    void Clear();
+
+    size_t GetPacketCount() const { return packets.size(); }
+    size_t GetCommandCount() const { return commands.size(); }
+
+private:
+    friend class CommandRecorder;
+
+    struct Command
+    {
+        uint64_t sort_key;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    CommandPacket& Add(PacketType type);
+
+    std::vector<CommandPacket> packets {};
+    std::vector<Command> commands {};
+};
+
+// Turns packets into calls on a backend, in submission order
+class CommandTranslator
+{
+public:
+    virtual ~CommandTranslator() = default;
+    virtual void Translate(const CommandPacket& packet) = 0;
+};
+
+// Records the work the packets describe in the device's command list
+class DeviceCommandTranslator : public CommandTranslator
+{
+public:
+    DeviceCommandTranslator(Device& device)
+        : device(device)
+    {
+    }
+
+    void Translate(const CommandPacket& packet) override;
+
+private:
+    Device& device;
+};
+
+// Executes nothing, counts what would have been submitted and catches draws without the state they need
+class NullCommandTranslator : public CommandTranslator
+{
+public:
+    void Translate(const CommandPacket& packet) override;
+
+    uint32_t GetPacketCount(PacketType type) const { return counts[static_cast<size_t>(type)]; }
+    uint64_t GetIndexCount() const { return indices; }
+
+    // Draws without a pipeline or index buffer, dispatches without a pipeline
+    uint32_t GetErrorCount() const { return errors; }
+
+    // Checksum over the translated packets in order, equal for equal submissions
+    uint64_t GetHash() const { return hash; }
+
+    void Reset() { *this = NullCommandTranslator {}; }
+
+private:
+    uint32_t counts[static_cast<size_t>(PacketType::COUNT)] {};
+    uint64_t indices = 0;
+    uint32_t errors = 0;
+    uint64_t hash = 14695981039346656037ull;
+    const Shader* pipeline = nullptr;
+    bool index_buffer = false;
+};
+
+// Records command streams on several threads, then merges them by sort key and translates them on the calling thread.
+// Equal keys keep the order of their streams, so submission is deterministic however the recording was scheduled.
+class CommandRecorder
+{
+public:
+    using RecordFunction = std::function<void(uint32_t job, CommandStream& stream)>;
+
+    struct SubmitStats
+    {
+        uint32_t commands = 0;
+        uint32_t packets = 0;
+        uint32_t skipped = 0; // Binds that repeated the state already bound
+    };
+
+    // The calling thread records too, so by default one worker less than there are hardware threads
+    explicit CommandRecorder(uint32_t worker_count = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    ~CommandRecorder();
+
+    NON_COPYABLE(CommandRecorder);
+    NON_MOVABLE(CommandRecorder);
+
+    // Calls record job_count times in parallel, each call with its own new stream. Returns once all are done.
+    void Record(uint32_t job_count, const RecordFunction& record);
+
+    // A new stream for recording on the calling thread, valid until Submit
+    CommandStream& AddStream();
+
+    // Translates everything recorded since the last submit, then clears the streams
+    SubmitStats Submit(CommandTranslator& translator);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+private:
+    struct SortEntry
+    {
+        uint64_t sort_key;
+        uint32_t stream;
+        uint32_t command;
+    };
+
+    void RunJob(uint32_t job);
+    void WorkerLoop();
+
+    // Streams are never freed, so their memory is reused frame after frame. Held by pointer so AddStream
+    // references stay valid while more streams are added.
+    std::vector<std::unique_ptr<CommandStream>> streams {};
+    uint32_t stream_count = 0;
+    std::vector<SortEntry> order {};
+
+    // State of the current Record call
+    const RecordFunction* record = nullptr;
+    uint32_t first_stream = 0;
+    std::atomic<uint32_t> remaining { 0 };
+
+    static constexpr size_t MAX_JOBS = 1024;
+    BlockingQueue<MPMCQueue<uint32_t>> jobs { MAX_JOBS };
+    std::vector<std::thread> workers {};
+};
+
+namespace Tests
+{
+    void TestCommandPackets();
+}
+
+}
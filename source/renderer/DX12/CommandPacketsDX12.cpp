@@ -0,0 +1,65 @@
+#include <renderer/CommandPackets.hpp>
+
+#include <device/Device.hpp>
+#include <renderer/DepthStencil.hpp>
+#include <renderer/DX12/Helpers/DXCommandList.hpp>
+#include <renderer/RenderTarget.hpp>
+#include <renderer/Shader.hpp>
+#include <renderer/ShaderInput.hpp>
+#include <renderer/StorageBuffer.hpp>
+#include <resources/Texture.hpp>
+
+void KS::DeviceCommandTranslator::Translate(const CommandPacket& packet)
+{
+    DXCommandList* commandList = reinterpret_cast<DXCommandList*>(device.GetCommandList());
+
+    switch (packet.type)
+    {
+    case PacketType::BIND_PIPELINE:
+        commandList->BindPipeline(reinterpret_cast<ID3D12PipelineState*>(packet.pipeline.shader->GetPipeline()));
+        break;
+
+    case PacketType::BIND_RENDER_TARGET:
+        packet.target.render_target->Bind(device, packet.target.depth_stencil);
+        break;
+
+    case PacketType::CLEAR_RENDER_TARGET:
+        packet.target.render_target->Clear(device);
+        break;
+
+    case PacketType::CLEAR_DEPTH_STENCIL:
+        packet.target.depth_stencil->Clear(device);
+        break;
+
+    case PacketType::BIND_INPUT:
+        packet.input.input->Bind(device, packet.input.desc, packet.input.offset);
+        break;
+
+    case PacketType::BIND_VERTEX_BUFFER:
+        packet.buffer.buffer->BindAsVertexData(device, packet.buffer.slot, packet.buffer.offset);
+        break;
+
+    case PacketType::BIND_INDEX_BUFFER:
+        packet.buffer.buffer->BindAsIndexData(device, packet.buffer.offset);
+        break;
+
+    case PacketType::DRAW_INDEXED:
+        commandList->DrawIndexed(packet.draw.index_count, packet.draw.instance_count);
+        break;
+
+    case PacketType::DISPATCH:
+        commandList->DispatchShader(packet.dispatch.x, packet.dispatch.y, packet.dispatch.z);
+        break;
+
+    case PacketType::BARRIER:
+        if (packet.barrier.writable)
+            packet.barrier.texture->TransitionToRW(device);
+        else
+            packet.barrier.texture->TransitionToRO(device);
+        break;
+
+    default:
+        LOG(Log::Severity::WARN, "Unknown command packet type {}, skipped", static_cast<int>(packet.type));
+        break;
+    }
+}
@@ -20,6 +20,17 @@ DXResource::DXResource(const ComPtr<ID3D12Device5>& device, const CD3DX12_HEAP_P
 
     device->GetCopyableFootprints(&descr, 0, 1, 0, nullptr, nullptr, nullptr, &mResourceSize);
 
+    // Committed resources reserve the aligned allocation size, which can be a lot more than the data
+    if (heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD)
+        mTrackedTag = KS::MemoryTag::GPU_UPLOAD;
+    else if (descr.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        mTrackedTag = KS::MemoryTag::GPU_BUFFER;
+    else
+        mTrackedTag = KS::MemoryTag::GPU_TEXTURE;
+
+    mTrackedSize = device->GetResourceAllocationInfo(0, 1, &descr).SizeInBytes;
+    KS::MemoryTracker::RecordAllocation(mTrackedTag, mTrackedSize);
+
     wchar_t wString[4096];
     MultiByteToWideChar(CP_ACP, 0, name, -1, wString, 4096);
     mResource->SetName(wString);
@@ -35,6 +46,9 @@ DXResource::DXResource(const ComPtr<ID3D12Device5>& device, ComPtr<ID3D12Resourc
 
 DXResource::~DXResource()
 {
+    if (mTrackedSize != 0)
+        KS::MemoryTracker::RecordFree(mTrackedTag, mTrackedSize);
+
     for (size_t i = 0; i < mUploadBuffers.size(); i++)
     {
         mUploadBuffers[i] = nullptr;
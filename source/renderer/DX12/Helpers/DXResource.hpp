@@ -1,5 +1,7 @@
 #pragma once
 #include "DXIncludes.hpp"
+#include <code_utility.hpp>
+#include <tools/MemoryTracker.hpp>
 #include <memory>
 #include <vector>
 
@@ -12,6 +14,8 @@ public:
     DXResource(const ComPtr<ID3D12Device5>& device, ComPtr<ID3D12Resource> res, D3D12_RESOURCE_STATES resState);
     ~DXResource();
 
+    NON_COPYABLE(DXResource);
+
     ComPtr<ID3D12Resource> GetResource() { return mResource; }
     ComPtr<ID3D12Resource> GetUploadResource(int subresource) { return mUploadBuffers[subresource]->GetResource(); }
     ID3D12Resource* Get() const { return mResource.Get(); }
@@ -31,5 +35,10 @@ private:
     CD3DX12_RESOURCE_DESC mDesc {};
     ComPtr<ID3D12Resource> mResource;
     size_t mResourceSize = 0;
+
+    // Resources created here are counted in the memory tracker, wrapped ones (swapchain buffers) are not
+    KS::MemoryTag mTrackedTag = KS::MemoryTag::GPU_BUFFER;
+    size_t mTrackedSize = 0;
+
     std::vector<std::unique_ptr<DXResource>> mUploadBuffers;
 };
@@ -3,6 +3,7 @@
 #include <device/Device.hpp>
 #include <glm/glm.hpp>
 
+#include <renderer/CommandPackets.hpp>
 #include <renderer/DX12/Helpers/DXCommandList.hpp>
 #include <renderer/DX12/Helpers/DXResource.hpp>
 #include <renderer/DepthStencil.hpp>
@@ -105,6 +106,7 @@ KS::Renderer::Renderer(Device& device)
     m_deferredRendererDepthStencil = std::make_shared<DepthStencil>(device, deferredRendererDepthTex);
     CameraMats cam{};
     m_camera_buffer = std::make_shared<UniformBuffer>(device, "CAMERA MATRIX BUFFER", cam, 1);
+    m_commandRecorder = std::make_shared<CommandRecorder>();
 
 
     int fullInputFlags = Shader::HAS_POSITIONS | Shader::HAS_NORMALS | Shader::HAS_UVS | Shader::HAS_TANGENTS;
@@ -168,12 +170,14 @@ KS::Renderer::Renderer(Device& device)
     defferedDesc.shader = mainShader;
     defferedDesc.renderTarget = m_renderTargets[DEFERRED_RENDER];
     defferedDesc.depthStencil = m_deferredRendererDepthStencil;
+    defferedDesc.commandRecorder = m_commandRecorder;
     m_subrenderers[DEFERRED_RENDER] = std::make_unique<ModelRenderer>(device, defferedDesc);
 
     SubRendererDesc occluderDesc;
     occluderDesc.shader = lightOccluderShader;
     occluderDesc.renderTarget = m_renderTargets[LIGHT_RENDER];
     occluderDesc.depthStencil = m_deferredRendererDepthStencil;
+    occluderDesc.commandRecorder = m_commandRecorder;
     m_subrenderers[OCCLUDER_RENDER] = std::make_unique<ModelRenderer>(device, occluderDesc);
 
     SubRendererDesc pbrDesc;
@@ -282,10 +286,11 @@ void KS::Renderer::Render(Device& device, Scene& scene, const RenderTickParams&
 
     //PBR RENDER
     auto upscaledTex = m_renderTargets[UPSCALING_RENDER]->GetTexture(device, 0);
+    constexpr const char* GBUFFER_INPUTS[] = {"GBuffer1", "GBuffer2", "GBuffer3", "GBuffer4"};
     for (int i = 0; i < 4; i++)
     {
     auto texture = m_renderTargets[DEFERRED_RENDER]->GetTexture(device, i);
-    m_inputs[PBR_RENDER][i] = std::pair<ShaderInput*, ShaderInputDesc>(texture.get(), m_mainInputs->GetInput("GBuffer" + std::to_string(i + 1)));
+    m_inputs[PBR_RENDER][i] = std::pair<ShaderInput*, ShaderInputDesc>(texture.get(), m_mainInputs->GetInput(GBUFFER_INPUTS[i]));
     }
     m_inputs[PBR_RENDER][4] = std::pair<ShaderInput*, ShaderInputDesc>(upscaledTex.get(), rootSignature->GetInput("base_tex"));
     m_inputs[PBR_RENDER][5] = std::pair<ShaderInput*, ShaderInputDesc>(scene.GetStorageBuffer(POINT_LIGHT_BUFFER), rootSignature->GetInput("point_lights"));
@@ -11,7 +11,7 @@ public:
     ComPtr<ID3D12RootSignature> m_signature;
 };
 
-KS::ShaderInputCollection::ShaderInputCollection(const Device& device, std::unordered_map<std::string, ShaderInputDesc>&& inputs, const std::vector<std::pair<ShaderInputVisibility, SamplerDesc>>& samplers, int totalDataCount, std::string name)
+KS::ShaderInputCollection::ShaderInputCollection(const Device& device, StringMap<ShaderInputDesc>&& inputs, const std::vector<std::pair<ShaderInputVisibility, SamplerDesc>>& samplers, int totalDataCount, std::string name)
 {
     m_impl = std::make_unique<Impl>();
     DXSignatureBuilder builder = DXSignatureBuilder(totalDataCount);
@@ -135,7 +135,7 @@ KS::ShaderInputCollection::ShaderInputCollection(const Device& device, std::unor
     m_impl->m_signature = builder.Build(reinterpret_cast<ID3D12Device5*>(device.GetDevice()), wString);
 }
 
-KS::ShaderInputCollection::ShaderInputCollection(const Device& device, std::unordered_map<std::string, ShaderInputDesc>&& inputs, void* signature, std::string name)
+KS::ShaderInputCollection::ShaderInputCollection(const Device& device, StringMap<ShaderInputDesc>&& inputs, void* signature, std::string name)
 {
     m_impl = std::make_unique<Impl>();
     m_descriptors = std::move(inputs);
@@ -152,7 +152,7 @@ void* KS::ShaderInputCollection::GetSignature() const
     return m_impl->m_signature.Get();
 }
 
-KS::ShaderInputDesc KS::ShaderInputCollection::GetInput(std::string key) const
+KS::ShaderInputDesc KS::ShaderInputCollection::GetInput(std::string_view key) const
 {
     auto res = m_descriptors.find(key);
     if (res == m_descriptors.end())
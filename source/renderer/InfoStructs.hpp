@@ -54,14 +54,6 @@ enum Formats
     R16_FLOAT,
 };
 
-struct DrawEntry
-{
-    ResourceHandle<Mesh> mesh {};
-    Material material {};
-    int modelIndex;
-    glm::mat4x4 modelMat;
-};
-
 struct ModelMat
 {
     glm::mat4 mModel = glm::mat4x4(1.f);
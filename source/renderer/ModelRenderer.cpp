@@ -0,0 +1,88 @@
+#include <renderer/ModelRenderer.hpp>
+#include <renderer/CommandPackets.hpp>
+#include <renderer/Shader.hpp>
+
+#include <resources/Mesh.hpp>
+#include <resources/Model.hpp>
+#include <resources/Texture.hpp>
+#include <renderer/StorageBuffer.hpp>
+#include <renderer/UniformBuffer.hpp>
+#include <scene/Scene.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+
+// Draws per recording job, below this splitting costs more than it saves
+constexpr size_t MIN_DRAWS_PER_JOB = 64;
+
+// Groups draws of the same mesh in the sort key, so its buffers are bound once. Made from the mesh's slot map key
+// rather than its address, so the submission order is the same on every run
+uint32_t MeshSortState(KS::SlotMap<KS::Mesh>::Key mesh)
+{
+    return static_cast<uint32_t>((mesh * 0x9E3779B97F4A7C15ull) >> 40);
+}
+
+// Vertex buffer slots in order, with the shader flag that enables each
+constexpr std::pair<int, KS::VertexAttribute> VERTEX_INPUTS[] = {
+    { KS::Shader::MeshInputFlags::HAS_POSITIONS, KS::VertexAttribute::POSITIONS },
+    { KS::Shader::MeshInputFlags::HAS_NORMALS, KS::VertexAttribute::NORMALS },
+    { KS::Shader::MeshInputFlags::HAS_UVS, KS::VertexAttribute::TEXTURE_UVS },
+    { KS::Shader::MeshInputFlags::HAS_TANGENTS, KS::VertexAttribute::TANGENTS },
+};
+
+}
+
+void KS::ModelRenderer::RecordDraws(CommandRecorder& recorder, Scene& scene, const DrawInputs& inputs)
+{
+    const std::vector<MeshSet>& drawSets = scene.GetDrawSets();
+    size_t jobCount = std::min<size_t>(recorder.GetWorkerCount() + 1, (drawSets.size() + MIN_DRAWS_PER_JOB - 1) / MIN_DRAWS_PER_JOB);
+
+    // Captured as one reference, so the job fits in std::function's small buffer and recording does not allocate
+    const struct
+    {
+        const std::vector<MeshSet>& drawSets;
+        const DrawInputs& inputs;
+        UniformBuffer* modelIndexBuffer;
+        size_t drawsPerJob;
+    } frame {
+        drawSets, inputs, scene.GetUniformBuffer(MODEL_INDEX_BUFFER), jobCount > 0 ? (drawSets.size() + jobCount - 1) / jobCount : 0,
+    };
+
+    recorder.Record(static_cast<uint32_t>(jobCount), [&frame](uint32_t job, CommandStream& stream)
+    {
+        const auto& [drawSets, inputs, modelIndexBuffer, drawsPerJob] = frame;
+        size_t end = std::min(drawSets.size(), (job + 1) * drawsPerJob);
+        for (size_t i = job * drawsPerJob; i < end; i++)
+        {
+            const MeshSet& meshSet = drawSets[i];
+            const Mesh* mesh = meshSet.mesh;
+            stream.Begin(MakeSortKey(1, MeshSortState(meshSet.meshKey), static_cast<uint32_t>(i)));
+
+            stream.BindInput(modelIndexBuffer, inputs.modelIndex, meshSet.modelIndex);
+
+            // Attributes the shader takes but the importer did not produce are left unbound
+            for (uint32_t slot = 0; slot < std::size(VERTEX_INPUTS); slot++)
+            {
+                StorageBuffer* buffer = mesh->GetAttribute(VERTEX_INPUTS[slot].second);
+                if ((inputs.meshInputFlags & VERTEX_INPUTS[slot].first) && buffer) stream.BindVertexBuffer(buffer, slot);
+            }
+
+            StorageBuffer* indices = mesh->GetAttribute(VertexAttribute::INDICES);
+            stream.BindIndexBuffer(indices);
+
+            Texture* textures[] = {
+                meshSet.baseTex.get(), meshSet.normalTex.get(), meshSet.emissiveTex.get(), meshSet.roughMetTex.get(), meshSet.occlusionTex.get(),
+            };
+            for (int t = 0; t < 5; t++)
+            {
+                if (textures[t]) stream.BindInput(textures[t], inputs.textures[t]);
+            }
+
+            stream.DrawIndexed(indices->GetElementCount());
+        }
+    });
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SubRenderer.hpp"
+#include "ShaderInputCollection.hpp"
 
 namespace KS
 {
@@ -10,12 +11,28 @@ class Scene;
 class ModelRenderer : public SubRenderer
 {
 public:
+    // What the model shader takes per draw, looked up once per frame so the recording threads only read it
+    struct DrawInputs
+    {
+        ShaderInputDesc modelIndex {};
+        ShaderInputDesc textures[5] {}; // Base, normal, emissive, roughness/metallic and occlusion
+        int meshInputFlags = 0; // Shader::MeshInputFlags, the vertex buffers bound per draw
+    };
+
     ModelRenderer(const Device& device, SubRendererDesc& desc);
 
     ~ModelRenderer();
 
+    // Draws are recorded as command packets on the recorder's threads, sorted by mesh and then submitted
     void Render(Device& device, Scene& scene, std::vector<std::pair<ShaderInput*, ShaderInputDesc>>& inputs,
                 bool clearRT = true) override;
+
+    // Records every draw of the scene as command packets, split over the recorder's threads and sorted by mesh.
+    // Backend independent, so the headless tools record the same packets as the renderer
+    static void RecordDraws(CommandRecorder& recorder, Scene& scene, const DrawInputs& inputs);
+
+private:
+    std::shared_ptr<CommandRecorder> m_commandRecorder;
 };
 }  // namespace KS
 
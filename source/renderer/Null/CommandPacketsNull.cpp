@@ -0,0 +1,56 @@
+#include <renderer/CommandPackets.hpp>
+
+#include <device/Device.hpp>
+#include <renderer/ShaderInput.hpp>
+#include <renderer/StorageBuffer.hpp>
+#include <resources/Texture.hpp>
+
+// Resources bind through their null implementations, which count on the device. Render targets and pipelines
+// have no null implementation, their binds are counted here.
+void KS::DeviceCommandTranslator::Translate(const CommandPacket& packet)
+{
+    auto& counters = device.GetCounters();
+
+    switch (packet.type)
+    {
+    case PacketType::BIND_PIPELINE:
+    case PacketType::BIND_RENDER_TARGET:
+        counters.binds++;
+        break;
+
+    case PacketType::CLEAR_RENDER_TARGET:
+    case PacketType::CLEAR_DEPTH_STENCIL:
+        break;
+
+    case PacketType::BIND_INPUT:
+        packet.input.input->Bind(device, packet.input.desc, packet.input.offset);
+        break;
+
+    case PacketType::BIND_VERTEX_BUFFER:
+        packet.buffer.buffer->BindAsVertexData(device, packet.buffer.slot, packet.buffer.offset);
+        break;
+
+    case PacketType::BIND_INDEX_BUFFER:
+        packet.buffer.buffer->BindAsIndexData(device, packet.buffer.offset);
+        break;
+
+    case PacketType::DRAW_INDEXED:
+        counters.draws++;
+        break;
+
+    case PacketType::DISPATCH:
+        counters.dispatches++;
+        break;
+
+    case PacketType::BARRIER:
+        if (packet.barrier.writable)
+            packet.barrier.texture->TransitionToRW(device);
+        else
+            packet.barrier.texture->TransitionToRO(device);
+        break;
+
+    default:
+        LOG(Log::Severity::WARN, "Unknown command packet type {}, skipped", static_cast<int>(packet.type));
+        break;
+    }
+}
@@ -0,0 +1,92 @@
+#include <device/Device.hpp>
+#include <renderer/ShaderInputCollection.hpp>
+#include <renderer/StorageBuffer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+class KS::StorageBuffer::Impl
+{
+public:
+    std::vector<uint8_t> m_data;
+};
+
+KS::StorageBuffer::StorageBuffer() { m_impl = new Impl(); }
+
+KS::StorageBuffer::~StorageBuffer() { delete m_impl; }
+
+void KS::StorageBuffer::CreateBuffer(const Device& device, const std::string& name, size_t dataSize, int numOfElements)
+{
+    m_impl = new Impl();
+    m_impl->m_data.resize(m_buffer_stride * m_num_elements);
+}
+
+void KS::StorageBuffer::UploadDataBuffer(const Device& device, const void* data, int numOfElements)
+{
+    if (!data)
+    {
+        LOG(Log::Severity::WARN,
+            "Data could not be uploaded into buffer {} because the data passed was nullptr. Command ignored.", m_name);
+        return;
+    }
+
+    size_t size = m_buffer_stride * std::min(numOfElements, m_num_elements);
+    std::memcpy(m_impl->m_data.data(), data, size);
+
+    auto& counters = device.GetCounters();
+    counters.uploads++;
+    counters.upload_bytes += size;
+}
+
+void KS::StorageBuffer::Resize(const Device& device, int newNumOfElements)
+{
+    if (m_num_elements == newNumOfElements)
+    {
+        LOG(Log::Severity::WARN, "Buffer {} was not resized, because it is already the size that was passed. Command ignored.",
+            m_name);
+        return;
+    }
+
+    m_num_elements = newNumOfElements;
+    m_total_buffer_size = m_buffer_stride * m_num_elements;
+    m_impl->m_data.resize(m_total_buffer_size);
+}
+
+void KS::StorageBuffer::Bind(Device& device, const ShaderInputDesc& desc, uint32_t offsetIndex)
+{
+    device.GetCounters().binds++;
+}
+
+void KS::StorageBuffer::BindAsVertexData(const Device& device, uint32_t inputSlot, uint32_t elementOffset)
+{
+    device.GetCounters().binds++;
+}
+
+void KS::StorageBuffer::BindAsIndexData(const Device& device, uint32_t elementOffset)
+{
+    device.GetCounters().binds++;
+}
+
+void KS::StorageBuffer::AllocateAsReadOnly(Device& device, int slot) {}
+
+void KS::StorageBuffer::AllocateAsReadWrite(Device& device, int slot)
+{
+    if (!m_read_write)
+    {
+        LOG(Log::Severity::WARN,
+            "Storage buffer cannot be allocated as read write because it was not created with that flag. Command ignored.");
+    }
+}
+
+// Addresses into the CPU copy, so they stay unique per buffer and element like GPU addresses
+size_t KS::StorageBuffer::GetGPUAddress(int elementIndex, int frameIndex) const
+{
+    return reinterpret_cast<size_t>(m_impl->m_data.data()) + (m_buffer_stride * elementIndex);
+}
+
+// Both return the buffer's contents, there is no resource object behind it
+void* KS::StorageBuffer::GetRawRealResource() const { return m_impl->m_data.data(); }
+
+void* KS::StorageBuffer::GetRawResource() const { return m_impl->m_data.data(); }
+
+int KS::StorageBuffer::GetAllocationIndex(bool readOnly) { return -1; }
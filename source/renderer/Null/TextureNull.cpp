@@ -0,0 +1,70 @@
+#include <device/Device.hpp>
+#include <renderer/ShaderInputCollection.hpp>
+#include <resources/Image.hpp>
+#include <resources/Texture.hpp>
+
+// Textures only keep their description, nothing samples them without a GPU
+class KS::Texture::Impl
+{
+};
+
+KS::Texture::Texture(Device& device, const Image& image, int flags)
+{
+    m_impl = new Impl();
+    m_width = image.GetWidth();
+    m_height = image.GetHeight();
+    m_mipLevels = m_width <= 5 ? 1 : 4;
+    m_format = R8G8B8A8_UNORM;
+    m_flag = flags;
+
+    auto& counters = device.GetCounters();
+    counters.uploads++;
+    counters.upload_bytes += image.GetData().GetSize();
+}
+
+KS::Texture::Texture(const Device& device, uint32_t width, uint32_t height, int flags, glm::vec4 clearColor, Formats format, int mipLevels)
+{
+    m_impl = new Impl();
+    m_width = width;
+    m_height = height;
+    m_mipLevels = mipLevels;
+    m_clearColor = clearColor;
+    m_format = format;
+    m_flag = flags;
+}
+
+KS::Texture::Texture(const Device& device, void* resource, glm::vec2 size, int flags)
+{
+    m_impl = new Impl();
+    m_width = static_cast<uint32_t>(size.x);
+    m_height = static_cast<uint32_t>(size.y);
+    m_format = R8G8B8A8_UNORM;
+    m_flag = flags;
+}
+
+KS::Texture::Texture(const Device& device, uint32_t width, uint32_t height, int flags, glm::vec4 clearColor, Formats format,
+                     int srvAllocationSlot, int uavAllocationSlot)
+    : Texture(device, width, height, flags, clearColor, format)
+{
+}
+
+KS::Texture::~Texture() { delete m_impl; }
+
+void KS::Texture::Bind(Device& device, const ShaderInputDesc& desc, uint32_t offsetIndex)
+{
+    if (desc.modifications == ShaderInputMod::READ_ONLY)
+        TransitionToRO(device);
+    else
+        TransitionToRW(device);
+
+    device.GetCounters().binds++;
+}
+
+void KS::Texture::TransitionToRO(const Device& device) const { device.GetCounters().barriers++; }
+
+void KS::Texture::TransitionToRW(const Device& device) const { device.GetCounters().barriers++; }
+
+size_t KS::Texture::GetGPUAddress(int elementIndex, int frameIndex) const { return 0; }
+
+// The DX12 backend generates all mips in one compute dispatch
+void KS::Texture::GenerateMipmaps(Device& device) { device.GetCounters().dispatches++; }
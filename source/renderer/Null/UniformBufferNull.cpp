@@ -0,0 +1,63 @@
+#include <device/Device.hpp>
+#include <renderer/ShaderInputCollection.hpp>
+#include <renderer/UniformBuffer.hpp>
+
+#include <cstring>
+
+class KS::UniformBuffer::Impl
+{
+public:
+    std::vector<uint8_t> mBuffers[2];
+
+    // Points the mapped addresses at the CPU copies again after they were reallocated
+    void Map(uint8_t* (&addresses)[2])
+    {
+        for (int i = 0; i < 2; i++) addresses[i] = mBuffers[i].empty() ? nullptr : mBuffers[i].data();
+    }
+};
+
+KS::UniformBuffer::UniformBuffer() { m_impl = new Impl(); }
+
+KS::UniformBuffer::~UniformBuffer() { delete m_impl; }
+
+void KS::UniformBuffer::CreateUniformBuffer(const Device& device)
+{
+    m_impl = new Impl();
+
+    m_impl->mBuffers[0].resize(m_total_buffer_size);
+    if (m_double_buffer) m_impl->mBuffers[1].resize(m_total_buffer_size);
+    m_impl->Map(m_buffer_GPU_Address);
+}
+
+void KS::UniformBuffer::Resize(const Device& device, int newNumOfElements)
+{
+    if (m_num_elements == newNumOfElements) return;
+
+    m_num_elements = newNumOfElements;
+    m_total_buffer_size = m_buffer_stride * m_num_elements;
+
+    // Unlike a new GPU buffer, the resized copies keep what was uploaded before
+    m_impl->mBuffers[0].resize(m_total_buffer_size);
+    if (m_double_buffer) m_impl->mBuffers[1].resize(m_total_buffer_size);
+    m_impl->Map(m_buffer_GPU_Address);
+}
+
+size_t KS::UniformBuffer::GetGPUAddress(int elementIndex, int frameIndex) const
+{
+    return reinterpret_cast<size_t>(m_buffer_GPU_Address[m_double_buffer ? frameIndex : 0]) + (m_buffer_stride * elementIndex);
+}
+
+void KS::UniformBuffer::Bind(Device& device, const ShaderInputDesc& desc, uint32_t offsetIndex)
+{
+    device.GetCounters().binds++;
+}
+
+void KS::UniformBuffer::Upload(const Device& device, const void* data, uint32_t offset)
+{
+    uint8_t* buffer = m_buffer_GPU_Address[m_double_buffer ? device.GetFrameIndex() : 0];
+    memcpy(buffer + (m_buffer_stride * offset), data, m_element_size);
+
+    auto& counters = device.GetCounters();
+    counters.uploads++;
+    counters.upload_bytes += m_element_size;
+}
@@ -14,6 +14,7 @@ class ShaderInputCollection;
 class ShaderInput;
 class UniformBuffer;
 class Scene;
+class CommandRecorder;
 struct ShaderInputDesc;
 
 struct RenderTickParams
@@ -40,6 +41,7 @@ private:
     std::vector<std::pair<ShaderInput*, ShaderInputDesc>> m_inputs[NUM_SUBRENDER];
     std::shared_ptr<DepthStencil> m_deferredRendererDepthStencil;
     std::shared_ptr<UniformBuffer> m_camera_buffer;
+    std::shared_ptr<CommandRecorder> m_commandRecorder;
 
     // std::shared_ptr<Texture> m_deferredRendererTex[2][4];E
     // std::shared_ptr<Texture> m_deferredRendererDepthTex;
@@ -1,8 +1,8 @@
 #pragma once
 #include "Sampler.hpp"
+#include <containers/StringHash.hpp>
 #include <memory>
 #include <string>
-#include <unordered_map>
 
 namespace KS
 {
@@ -41,15 +41,15 @@ class Device;
 class ShaderInputCollection
 {
 public:
-    ShaderInputCollection(const Device& device, std::unordered_map<std::string, ShaderInputDesc>&& inputs, const std::vector<std::pair<ShaderInputVisibility, SamplerDesc>>& samplers,  int totalDataTypeCount, std::string name);
-    ShaderInputCollection(const Device& device, std::unordered_map<std::string, ShaderInputDesc>&& inputs, void* signature, std::string name);
+    ShaderInputCollection(const Device& device, StringMap<ShaderInputDesc>&& inputs, const std::vector<std::pair<ShaderInputVisibility, SamplerDesc>>& samplers,  int totalDataTypeCount, std::string name);
+    ShaderInputCollection(const Device& device, StringMap<ShaderInputDesc>&& inputs, void* signature, std::string name);
     ~ShaderInputCollection();
     void* GetSignature() const;
-    ShaderInputDesc GetInput(std::string key) const;
+    ShaderInputDesc GetInput(std::string_view key) const;
 
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
-    std::unordered_map<std::string, ShaderInputDesc> m_descriptors;
+    StringMap<ShaderInputDesc> m_descriptors;
 };
 }
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include "ShaderInputCollection.hpp"
 #include <memory>
 #include <string>
-#include <unordered_map>
 
 namespace KS
 {
@@ -24,7 +23,7 @@ public:
 private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
-    std::unordered_map<std::string, ShaderInputDesc> m_descriptors;
+    StringMap<ShaderInputDesc> m_descriptors;
     std::vector<std::pair<ShaderInputVisibility, SamplerDesc>> m_sampler_inputs;
     int m_buffer_counter = 0;
     int m_ro_array_counter = 0;
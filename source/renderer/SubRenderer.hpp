@@ -12,6 +12,7 @@ class DepthStencil;
 class Texture;
 class Scene;
 class ShaderInput;
+class CommandRecorder;
 struct ShaderInputDesc;
 
 struct SubRendererDesc
@@ -19,6 +20,7 @@ struct SubRendererDesc
     std::shared_ptr<Shader> shader;
     std::shared_ptr<RenderTarget> renderTarget;
     std::shared_ptr<DepthStencil> depthStencil;
+    std::shared_ptr<CommandRecorder> commandRecorder; // Shared by the passes that record command packets
 };
 
 
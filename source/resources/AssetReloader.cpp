@@ -0,0 +1,124 @@
+#include "AssetReloader.hpp"
+
+#include <tools/Log.hpp>
+
+namespace
+{
+
+// Same form the file watcher reports paths in
+std::string MakeKey(const std::filesystem::path& path)
+{
+    std::error_code e {};
+    auto absolute = std::filesystem::absolute(path, e);
+    return (e ? path : absolute).lexically_normal().string();
+}
+
+}
+
+KS::AssetReloader::AssetReloader(const FileWatcherSettings& settings)
+    : watcher(settings)
+{
+}
+
+std::optional<KS::ResourceHandle<KS::Model>> KS::AssetReloader::ImportAndWatch(const FileIO::Path& source_model, uint32_t post_process_flags)
+{
+    auto model = ModelImporter::ImportFromFile(source_model, post_process_flags);
+    if (!model)
+        return std::nullopt;
+
+    if (sources.emplace(MakeKey(source_model), Source { source_model, post_process_flags }).second)
+        watcher.Watch(source_model);
+
+    TrackOutputs(model.value(), nullptr);
+    return model;
+}
+
+KS::ReloadedAssets KS::AssetReloader::Update()
+{
+    ReloadedAssets changes {};
+    std::vector<const Source*> reimport {};
+
+    for (const auto& path : watcher.PollChanges())
+    {
+        auto key = path.string();
+
+        if (auto it = sources.find(key); it != sources.end())
+        {
+            reimport.emplace_back(&it->second);
+        }
+        else if (auto it = outputs.find(key); it != outputs.end())
+        {
+            TrackOutput(it->second.type, it->second.handle_path, &changes);
+        }
+    }
+
+    for (const auto* source : reimport)
+    {
+        LOG(Log::Severity::INFO, "Reimporting changed model {}", source->path.string());
+
+        if (auto model = ModelImporter::ImportFromFile(source->path, source->post_process_flags))
+            TrackOutputs(model.value(), &changes);
+        else
+            LOG(Log::Severity::WARN, "Reimport of {} failed, keeping the previous version", source->path.string());
+    }
+
+    return changes;
+}
+
+void KS::AssetReloader::TrackOutputs(const ResourceHandle<Model>& model, ReloadedAssets* changes)
+{
+    TrackOutput(OutputType::MODEL, model.path, changes);
+
+    if (auto files = ModelImporter::ListImportedFiles(model))
+    {
+        for (const auto& mesh : files->meshes)
+        {
+            TrackOutput(OutputType::MESH, mesh.path, changes);
+        }
+
+        for (const auto& texture : files->textures)
+        {
+            TrackOutput(OutputType::TEXTURE, texture.path, changes);
+        }
+    }
+}
+
+void KS::AssetReloader::TrackOutput(OutputType type, const std::string& handle_path, ReloadedAssets* changes)
+{
+    auto hash = FileIO::HashFile(handle_path);
+    if (!hash)
+        return;
+
+    auto [it, inserted] = outputs.try_emplace(MakeKey(handle_path), Output { type, handle_path, hash.value() });
+
+    // New outputs are not loaded anywhere yet, so there is nothing to replace
+    if (inserted)
+    {
+        watcher.Watch(handle_path);
+        return;
+    }
+
+    // Also filters out the file events caused by our own imports, which rewrite identical files
+    if (it->second.hash == hash.value())
+        return;
+
+    it->second.hash = hash.value();
+
+    if (changes == nullptr)
+        return;
+
+    switch (type)
+    {
+    case OutputType::MODEL:
+        changes->models.emplace_back(ResourceHandle<Model> { handle_path });
+        break;
+
+    case OutputType::MESH:
+        changes->meshes.emplace_back(ResourceHandle<Mesh> { handle_path });
+        break;
+
+    case OutputType::TEXTURE:
+        changes->textures.emplace_back(ResourceHandle<Texture> { handle_path });
+        break;
+    }
+}
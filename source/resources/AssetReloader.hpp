@@ -0,0 +1,67 @@
+#pragma once
+#include "Model.hpp"
+
+#include <fileio/FileWatcher.hpp>
+#include <unordered_map>
+
+namespace KS
+{
+
+class Texture;
+
+// Resources whose files changed on disk, applied to the scene with Scene::ReloadAssets
+struct ReloadedAssets
+{
+    std::vector<ResourceHandle<Model>> models {};
+    std::vector<ResourceHandle<Mesh>> meshes {};
+    std::vector<ResourceHandle<Texture>> textures {};
+
+    bool Empty() const { return models.empty() && meshes.empty() && textures.empty(); }
+};
+
+// Watches imported source models and the files they produced.
+// A changed source is imported again, but only the outputs whose contents actually changed are reported.
+// Imported files that are edited by hand (a texture touched up in a paint program) are reported directly.
+class AssetReloader
+{
+public:
+    AssetReloader(const FileWatcherSettings& settings = {});
+
+    // Same as ModelImporter::ImportFromFile, but keeps track of the source and its outputs
+    std::optional<ResourceHandle<Model>>
+    ImportAndWatch(const FileIO::Path& source_model, uint32_t post_process_flags = ModelImporter::DEFAULT_POST_PROCESSING_FLAGS);
+
+    // Re-imports changed sources, meant to be called once per frame
+    ReloadedAssets Update();
+
+private:
+    enum class OutputType
+    {
+        MODEL,
+        MESH,
+        TEXTURE,
+    };
+
+    struct Output
+    {
+        OutputType type {};
+        std::string handle_path {};
+        uint64_t hash = 0;
+    };
+
+    struct Source
+    {
+        FileIO::Path path {};
+        uint32_t post_process_flags = 0;
+    };
+
+    // Records all outputs of an imported model, adding the ones that differ from the last import to changes
+    void TrackOutputs(const ResourceHandle<Model>& model, ReloadedAssets* changes);
+    void TrackOutput(OutputType type, const std::string& handle_path, ReloadedAssets* changes);
+
+    FileWatcher watcher;
+    std::unordered_map<std::string, Source> sources {};
+    std::unordered_map<std::string, Output> outputs {};
+};
+
+}
@@ -8,6 +8,16 @@
 
 #include <tools/Log.hpp>
 
+namespace
+{
+
+void FreeStbiResult(void* data, size_t, void*)
+{
+    STBI_FREE(data);
+}
+
+}
+
 std::optional<KS::Image> KS::LoadImageFileFromMemory(const void* filedata, size_t byte_length)
 {
     int height {}, width {}, comp {};
@@ -15,8 +25,8 @@ std::optional<KS::Image> KS::LoadImageFileFromMemory(const void* filedata, size_
 
     if (stbi_result != nullptr)
     {
-        ByteBuffer image_data { stbi_result, static_cast<uint32_t>(width * height * 4) };
-        STBI_FREE(stbi_result);
+        // The decoded pixels are kept as they are, stb frees them once the image is gone
+        auto image_data = ByteBuffer::Adopt(stbi_result, static_cast<size_t>(width * height * 4), &FreeStbiResult);
         return Image { std::move(image_data), static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
     }
     else
@@ -35,9 +45,7 @@ std::optional<KS::ByteBuffer> KS::SaveImageToPNG(const Image& image)
 
     if (stbi_result)
     {
-        ByteBuffer compressed_data { stbi_result, static_cast<size_t>(out_length) };
-        STBI_FREE(stbi_result);
-        return compressed_data;
+        return ByteBuffer::Adopt(stbi_result, static_cast<size_t>(out_length), &FreeStbiResult);
     }
     else
     {
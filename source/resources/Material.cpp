@@ -1,6 +1,209 @@
 #include "Material.hpp"
 
-void KS::Material::AddParameter(const std::string& key, const InputParameter& param)
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <tools/Log.hpp>
+
+namespace
+{
+
+// Parameters outside the schema are saved by ID, written as "#<id>" so they survive a round trip
+constexpr char UNKNOWN_NAME_PREFIX = '#';
+
+}
+
+std::optional<std::string_view> KS::MaterialConstants::FindParameterName(MaterialParameterID id)
+{
+    for (auto name : SCHEMA)
+    {
+        if (GetMaterialParameterID(name) == id)
+            return name;
+    }
+    return std::nullopt;
+}
+
+void KS::Material::AddParameter(MaterialParameterID id, const InputParameter& param)
+{
+    auto it = std::lower_bound(parameters.begin(), parameters.end(), id,
+        [](const Parameter& parameter, MaterialParameterID id) { return parameter.id < id; });
+
+    if (it == parameters.end() || it->id != id)
+        it = parameters.insert(it, Parameter { id });
+
+    std::visit(
+        [&](const auto& value)
+        {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, ResourceHandle<Texture>>)
+            {
+                // Replacing a texture reuses its slot
+                if (auto* slot = std::get_if<TextureSlot>(&it->value))
+                {
+                    textures[slot->index] = value;
+                }
+                else
+                {
+                    it->value = TextureSlot { static_cast<uint32_t>(textures.size()) };
+                    textures.emplace_back(value);
+                }
+            }
+            else
+            {
+                // A texture replaced by a value gives up its slot, the slots after it move down
+                if (auto* slot = std::get_if<TextureSlot>(&it->value))
+                {
+                    uint32_t removed = slot->index;
+                    textures.erase(textures.begin() + removed);
+
+                    for (auto& parameter : parameters)
+                    {
+                        auto* other = std::get_if<TextureSlot>(&parameter.value);
+                        if (other && other->index > removed)
+                            other->index--;
+                    }
+                }
+
+                it->value = value;
+            }
+        },
+        param);
+}
+
+const KS::Material::Parameter* KS::Material::Find(MaterialParameterID id) const
+{
+    auto it = std::lower_bound(parameters.begin(), parameters.end(), id,
+        [](const Parameter& parameter, MaterialParameterID id) { return parameter.id < id; });
+
+    return it != parameters.end() && it->id == id ? &*it : nullptr;
+}
+
+std::map<std::string, KS::Material::InputParameter> KS::Material::ToNamedParameters() const
+{
+    std::map<std::string, InputParameter> named {};
+
+    for (const auto& parameter : parameters)
+    {
+        std::string name {};
+        if (auto known = MaterialConstants::FindParameterName(parameter.id))
+            name = std::string(*known);
+        else
+            name = UNKNOWN_NAME_PREFIX + std::to_string(parameter.id);
+
+        std::visit(
+            [&](const auto& value)
+            {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, TextureSlot>)
+                    named.emplace(std::move(name), textures[value.index]);
+                else
+                    named.emplace(std::move(name), value);
+            },
+            parameter.value);
+    }
+
+    return named;
+}
+
+void KS::Material::FromNamedParameters(const std::map<std::string, InputParameter>& named)
+{
+    parameters.clear();
+    textures.clear();
+
+    for (const auto& [name, value] : named)
+    {
+        MaterialParameterID id = GetMaterialParameterID(name);
+
+        if (!name.empty() && name.front() == UNKNOWN_NAME_PREFIX)
+        {
+            auto result = std::from_chars(name.data() + 1, name.data() + name.size(), id);
+            if (result.ec != std::errc())
+            {
+                LOG(Log::Severity::WARN, "Material parameter {} has an invalid ID", name);
+                continue;
+            }
+        }
+
+        AddParameter(id, value);
+    }
+}
+
+void KS::Tests::TestMaterial()
 {
-    input_parameters.emplace(key, param);
-}
\ No newline at end of file
+    using namespace MaterialConstants;
+
+    Material material {};
+    material.AddParameter(ORM_FACTORS, glm::vec4(0.1f));
+    material.AddParameter(BASE_TEXTURE, ResourceHandle<Texture> { "base.ktx" });
+    material.AddParameter(DOUBLE_SIDED_FLAG, true);
+    material.AddParameter(GetMaterialParameterID("CUSTOM"), 3);
+
+    // Replacing keeps one parameter per ID
+    material.AddParameter(ORM_FACTORS, ORM_FACTORS_DEFAULT);
+    material.AddParameter(BASE_TEXTURE, ResourceHandle<Texture> { "other.ktx" });
+
+    if (material.GetParameterCount() != 4 || *material.GetParameter<glm::vec4>(ORM_FACTORS) != ORM_FACTORS_DEFAULT
+        || material.GetParameter<ResourceHandle<Texture>>(BASE_TEXTURE)->path != "other.ktx")
+    {
+        throw;
+    }
+
+    // Wrong type or missing parameter
+    if (material.GetParameter<float>(ORM_FACTORS) != nullptr || material.GetParameter<bool>(NORMAL_TEXTURE) != nullptr
+        || material.GetParameter<ResourceHandle<Texture>>(DOUBLE_SIDED_FLAG) != nullptr)
+    {
+        throw;
+    }
+
+    // A texture replaced by a value frees its slot without moving the other textures
+    {
+        Material textured {};
+        textured.AddParameter(BASE_TEXTURE, ResourceHandle<Texture> { "base.ktx" });
+        textured.AddParameter(NORMAL_TEXTURE, ResourceHandle<Texture> { "normal.ktx" });
+        textured.AddParameter(BASE_TEXTURE, glm::vec4(1.0f));
+        textured.AddParameter(EMISSIVE_TEXTURE, ResourceHandle<Texture> { "emissive.ktx" });
+
+        if (textured.GetParameter<ResourceHandle<Texture>>(BASE_TEXTURE) != nullptr
+            || textured.GetParameter<ResourceHandle<Texture>>(NORMAL_TEXTURE)->path != "normal.ktx"
+            || textured.GetParameter<ResourceHandle<Texture>>(EMISSIVE_TEXTURE)->path != "emissive.ktx")
+        {
+            throw;
+        }
+    }
+
+    // Instances share the base and only override what they set
+    auto shared = std::make_shared<const Material>(material);
+    MaterialInstance first { shared };
+    MaterialInstance second { shared };
+    second.Override(DOUBLE_SIDED_FLAG, false);
+
+    if (*first.GetParameter<bool>(DOUBLE_SIDED_FLAG) != true || *second.GetParameter<bool>(DOUBLE_SIDED_FLAG) != false
+        || second.GetParameter<ResourceHandle<Texture>>(BASE_TEXTURE) != shared->GetParameter<ResourceHandle<Texture>>(BASE_TEXTURE))
+    {
+        throw;
+    }
+
+    // Saved by name in the same layout as before, unknown parameters survive by ID
+    std::stringstream stream {};
+    {
+        JSONSaver json { stream };
+        json(material);
+    }
+
+    if (stream.str().find("\"ORM_FACTORS\"") == std::string::npos)
+    {
+        throw;
+    }
+
+    Material loaded {};
+    {
+        JSONLoader json { stream };
+        json(loaded);
+    }
+
+    if (loaded.GetParameterCount() != 4 || *loaded.GetParameter<int>(GetMaterialParameterID("CUSTOM")) != 3
+        || loaded.GetParameter<ResourceHandle<Texture>>(BASE_TEXTURE)->path != "other.ktx")
+    {
+        throw;
+    }
+}
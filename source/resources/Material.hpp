@@ -2,40 +2,85 @@
 #include <fileio/Serialization.hpp>
 
 #include <cereal/types/variant.hpp>
+#include <memory>
 #include <optional>
+#include <string_view>
 #include <variant>
 
 namespace KS
 {
 
+// Parameters are looked up by a hash of their name, so the lookup does not touch strings.
+using MaterialParameterID = uint32_t;
+
+// FNV-1a, constexpr so the IDs of known parameters are computed at compile time
+constexpr MaterialParameterID GetMaterialParameterID(std::string_view name)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 namespace MaterialConstants
 {
 
     // BASE COLOUR
-    const std::string BASE_COLOUR_FACTOR_NAME = "BASE_COLOUR";
+    constexpr std::string_view BASE_COLOUR_FACTOR_NAME = "BASE_COLOUR";
+    constexpr MaterialParameterID BASE_COLOUR_FACTOR = GetMaterialParameterID(BASE_COLOUR_FACTOR_NAME);
     constexpr glm::vec4 BASE_COLOUR_FACTOR_DEFAULT = { 1.0f, 1.0f, 1.0f, 1.0f };
 
     // NORMAL, EMISSIVE, ALPHA CUTOFF
-    const std::string NEA_FACTORS_NAME = "NEA_FACTOR";
+    constexpr std::string_view NEA_FACTORS_NAME = "NEA_FACTOR";
+    constexpr MaterialParameterID NEA_FACTORS = GetMaterialParameterID(NEA_FACTORS_NAME);
     constexpr glm::vec4 NEA_FACTORS_DEFAULT = { 1.0f, 1.0f, 0.0f, 0.0f };
 
     // OCCLUSION, ROUGHNESS, METALLIC
-    const std::string ORM_FACTORS_NAME = "ORM_FACTORS";
+    constexpr std::string_view ORM_FACTORS_NAME = "ORM_FACTORS";
+    constexpr MaterialParameterID ORM_FACTORS = GetMaterialParameterID(ORM_FACTORS_NAME);
     constexpr glm::vec4 ORM_FACTORS_DEFAULT = { 1.0f, 0.5f, 0.5f, 0.0f };
 
-    const std::string DOUBLE_SIDED_FLAG_NAME = "DOUBLE_SIDED";
+    constexpr std::string_view DOUBLE_SIDED_FLAG_NAME = "DOUBLE_SIDED";
+    constexpr MaterialParameterID DOUBLE_SIDED_FLAG = GetMaterialParameterID(DOUBLE_SIDED_FLAG_NAME);
     constexpr bool DOUBLE_SIDED_DEFAULT = false;
 
-    const std::string BASE_TEXTURE_NAME = "BASE_TEXTURE";
-    const std::string NORMAL_TEXTURE_NAME = "NORMAL_TEXTURE";
-    const std::string OCCLUSION_TEXTURE_NAME = "OCCLUSION_TEXTURE";
-    const std::string METALLIC_TEXTURE_NAME = "METALLIC_TEXTURE";
-    const std::string EMISSIVE_TEXTURE_NAME = "EMISSIVE_TEXTURE";
+    constexpr std::string_view BASE_TEXTURE_NAME = "BASE_TEXTURE";
+    constexpr std::string_view NORMAL_TEXTURE_NAME = "NORMAL_TEXTURE";
+    constexpr std::string_view OCCLUSION_TEXTURE_NAME = "OCCLUSION_TEXTURE";
+    constexpr std::string_view METALLIC_TEXTURE_NAME = "METALLIC_TEXTURE";
+    constexpr std::string_view EMISSIVE_TEXTURE_NAME = "EMISSIVE_TEXTURE";
+    constexpr MaterialParameterID BASE_TEXTURE = GetMaterialParameterID(BASE_TEXTURE_NAME);
+    constexpr MaterialParameterID NORMAL_TEXTURE = GetMaterialParameterID(NORMAL_TEXTURE_NAME);
+    constexpr MaterialParameterID OCCLUSION_TEXTURE = GetMaterialParameterID(OCCLUSION_TEXTURE_NAME);
+    constexpr MaterialParameterID METALLIC_TEXTURE = GetMaterialParameterID(METALLIC_TEXTURE_NAME);
+    constexpr MaterialParameterID EMISSIVE_TEXTURE = GetMaterialParameterID(EMISSIVE_TEXTURE_NAME);
+
+    constexpr MaterialParameterID TEXTURES[] = { BASE_TEXTURE, NORMAL_TEXTURE, OCCLUSION_TEXTURE, METALLIC_TEXTURE, EMISSIVE_TEXTURE };
+
+    // Every parameter the engine knows, material files store names so IDs are mapped back through this list
+    constexpr std::string_view SCHEMA[] = { BASE_COLOUR_FACTOR_NAME, NEA_FACTORS_NAME, ORM_FACTORS_NAME, DOUBLE_SIDED_FLAG_NAME,
+        BASE_TEXTURE_NAME, NORMAL_TEXTURE_NAME, OCCLUSION_TEXTURE_NAME, METALLIC_TEXTURE_NAME, EMISSIVE_TEXTURE_NAME };
+
+    constexpr bool SchemaIsUnique()
+    {
+        for (size_t i = 0; i < std::size(SCHEMA); i++)
+            for (size_t j = i + 1; j < std::size(SCHEMA); j++)
+                if (GetMaterialParameterID(SCHEMA[i]) == GetMaterialParameterID(SCHEMA[j]))
+                    return false;
+        return true;
+    }
+
+    static_assert(SchemaIsUnique(), "Two material parameter names hash to the same ID");
 
+    std::optional<std::string_view> FindParameterName(MaterialParameterID id);
 }
 
 class Texture;
 
+// Immutable once loaded, draw entries share it through MaterialInstance
 class Material
 {
 public:
@@ -44,20 +89,32 @@ public:
     Material() = default;
 
     // Input parameters can be flags (bool), integers, scalars (vec4 or floats) or paths to textures
-    void AddParameter(const std::string& key, const InputParameter& param);
+    // Adding a parameter that already exists replaces it
+    void AddParameter(MaterialParameterID id, const InputParameter& param);
 
     // Warning: can be null, check pointer before using
     template <typename T>
-    const T* GetParameter(const std::string& key) const
+    const T* GetParameter(MaterialParameterID id) const
     {
-        if (auto it = input_parameters.find(key); it != input_parameters.end())
+        const Parameter* parameter = Find(id);
+        if (parameter == nullptr)
+            return nullptr;
+
+        if constexpr (std::is_same_v<T, ResourceHandle<Texture>>)
         {
-            return std::get_if<T>(&it->second);
+            const auto* slot = std::get_if<TextureSlot>(&parameter->value);
+            return slot ? &textures[slot->index] : nullptr;
+        }
+        else
+        {
+            return std::get_if<T>(&parameter->value);
         }
-
-        return nullptr;
     }
 
+    bool HasParameter(MaterialParameterID id) const { return Find(id) != nullptr; }
+    size_t GetParameterCount() const { return parameters.size(); }
+    bool Empty() const { return parameters.empty(); }
+
 private:
     friend class cereal::access;
 
@@ -67,7 +124,61 @@ private:
     template <typename A>
     void load(A& ar, const uint32_t v);
 
-    std::map<std::string, InputParameter> input_parameters;
+    // Texture paths live next to the parameters, so the parameters themselves stay small and trivially copyable
+    struct TextureSlot
+    {
+        uint32_t index = 0;
+    };
+
+    struct Parameter
+    {
+        MaterialParameterID id {};
+        std::variant<bool, int, float, glm::vec4, TextureSlot> value {};
+    };
+
+    const Parameter* Find(MaterialParameterID id) const;
+
+    std::map<std::string, InputParameter> ToNamedParameters() const;
+    void FromNamedParameters(const std::map<std::string, InputParameter>& named);
+
+    // Sorted by ID, a material only has a handful of parameters so a binary search over one array is the fastest lookup
+    std::vector<Parameter> parameters {};
+    std::vector<ResourceHandle<Texture>> textures {};
+};
+
+// A shared material plus parameters that are overridden for one draw.
+// Overrides are checked first, anything not overridden comes from the shared material.
+class MaterialInstance
+{
+public:
+    MaterialInstance() = default;
+    MaterialInstance(std::shared_ptr<const Material> base)
+        : base(std::move(base))
+    {
+    }
+
+    void SetBase(std::shared_ptr<const Material> new_base) { base = std::move(new_base); }
+    const Material* GetBase() const { return base.get(); }
+
+    void Override(MaterialParameterID id, const Material::InputParameter& param) { overrides.AddParameter(id, param); }
+    void ClearOverrides() { overrides = {}; }
+
+    // Warning: can be null, check pointer before using
+    template <typename T>
+    const T* GetParameter(MaterialParameterID id) const
+    {
+        if (!overrides.Empty())
+        {
+            if (const T* value = overrides.GetParameter<T>(id))
+                return value;
+        }
+
+        return base ? base->GetParameter<T>(id) : nullptr;
+    }
+
+private:
+    std::shared_ptr<const Material> base {};
+    Material overrides {};
 };
 
 template <typename A>
@@ -76,7 +187,7 @@ inline void Material::save(A& ar, const uint32_t v) const
     switch (v)
     {
     case 0:
-        ar(cereal::make_nvp("Parameters", input_parameters));
+        ar(cereal::make_nvp("Parameters", ToNamedParameters()));
         break;
 
     default:
@@ -90,14 +201,23 @@ inline void Material::load(A& ar, const uint32_t v)
     switch (v)
     {
     case 0:
-        ar(cereal::make_nvp("Parameters", input_parameters));
+    {
+        std::map<std::string, InputParameter> named {};
+        ar(cereal::make_nvp("Parameters", named));
+        FromNamedParameters(named);
         break;
+    }
 
     default:
         break;
     }
 }
 
+namespace Tests
+{
+    void TestMaterial();
+}
+
 }
 
-CEREAL_CLASS_VERSION(KS::Material, 0);
\ No newline at end of file
+CEREAL_CLASS_VERSION(KS::Material, 0);
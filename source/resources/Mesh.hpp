@@ -1,44 +1,64 @@
 #pragma once
+#include <array>
 #include <cereal/types/map.hpp>
 #include <cereal/types/string.hpp>
 #include <containers/ByteBuffer.hpp>
 #include <map>
 #include <memory>
+#include <optional>
 #include <renderer/StorageBuffer.hpp>
+#include <string_view>
 
 namespace KS
 {
 
+// Every vertex stream a mesh can have, used to index the attribute arrays of MeshData and Mesh
+enum class VertexAttribute : uint8_t
+{
+    INDICES,
+    POSITIONS,
+    NORMALS,
+    TEXTURE_UVS,
+    TANGENTS,
+    BITANGENTS,
+    COUNT
+};
+
 namespace MeshConstants
 {
 
-    const std::string ATTRIBUTE_INDICES_NAME = "INDICES";
-    const std::string ATTRIBUTE_POSITIONS_NAME = "POSITIONS";
-    const std::string ATTRIBUTE_NORMALS_NAME = "NORMALS";
-    const std::string ATTRIBUTE_TEXTURE_UVS_NAME = "UVS";
-    const std::string ATTRIBUTE_TANGENTS_NAME = "TANGENTS";
-    const std::string ATTRIBUTE_BITANGENTS_NAME = "BITANGENTS";
-
-    const std::unordered_map<std::string, size_t> ATTRIBUTE_STRIDES {
-        { ATTRIBUTE_INDICES_NAME, sizeof(uint32_t) },
-        { ATTRIBUTE_POSITIONS_NAME, sizeof(float) * 3 },
-        { ATTRIBUTE_NORMALS_NAME, sizeof(float) * 3 },
-        { ATTRIBUTE_TEXTURE_UVS_NAME, sizeof(float) * 2 },
-        { ATTRIBUTE_TANGENTS_NAME, sizeof(float) * 3 },
-        { ATTRIBUTE_BITANGENTS_NAME, sizeof(float) * 3 }
+    constexpr size_t ATTRIBUTE_COUNT = static_cast<size_t>(VertexAttribute::COUNT);
+
+    // Names are only used by the file format, in the order of VertexAttribute
+    constexpr std::string_view ATTRIBUTE_NAMES[ATTRIBUTE_COUNT] = { "INDICES", "POSITIONS", "NORMALS", "UVS", "TANGENTS", "BITANGENTS" };
+
+    constexpr size_t ATTRIBUTE_STRIDES[ATTRIBUTE_COUNT] = {
+        sizeof(uint32_t),
+        sizeof(float) * 3,
+        sizeof(float) * 3,
+        sizeof(float) * 2,
+        sizeof(float) * 3,
+        sizeof(float) * 3
     };
 
+    constexpr std::string_view GetAttributeName(VertexAttribute attribute) { return ATTRIBUTE_NAMES[static_cast<size_t>(attribute)]; }
+    constexpr size_t GetAttributeStride(VertexAttribute attribute) { return ATTRIBUTE_STRIDES[static_cast<size_t>(attribute)]; }
+
+    std::optional<VertexAttribute> FindAttribute(std::string_view name);
+
 }
 
 class MeshData
 {
 public:
     MeshData() = default;
-    void AddAttribute(const std::string& name, ByteBuffer&& data);
-    const ByteBuffer* GetAttribute(const std::string& name) const;
 
-    auto begin() const { return attribute_data.begin(); }
-    auto end() const { return attribute_data.end(); }
+    // Replaces the attribute if the mesh already has it
+    void AddAttribute(VertexAttribute attribute, ByteBuffer&& data);
+
+    // Null if the mesh does not have the attribute
+    const ByteBuffer* GetAttribute(VertexAttribute attribute) const;
+    bool HasAttribute(VertexAttribute attribute) const { return GetAttribute(attribute) != nullptr; }
 
 private:
     friend class ::cereal::access;
@@ -49,29 +69,78 @@ private:
     template <typename A>
     void load(A& ar, const uint32_t v);
 
-    std::map<std::string, ByteBuffer> attribute_data;
+    // Empty buffers mark missing attributes
+    std::array<ByteBuffer, MeshConstants::ATTRIBUTE_COUNT> attribute_data {};
 };
+
+// Version 0 stored a map from name to data. Version 1 stores a list of named attributes in VertexAttribute order,
+// names stay in the file so reordering or extending the enum does not break existing files.
 template <typename A>
 inline void MeshData::save(A& ar, const uint32_t v) const
 {
     switch (v)
     {
-    case 0:
-        ar(cereal::make_nvp("Attributes", attribute_data));
+    case 1:
+    {
+        uint32_t count = 0;
+        for (const auto& data : attribute_data)
+            count += data.Empty() ? 0 : 1;
+
+        ar(cereal::make_nvp("AttributeCount", count));
+        for (size_t i = 0; i < MeshConstants::ATTRIBUTE_COUNT; i++)
+        {
+            if (attribute_data[i].Empty())
+                continue;
+
+            ar(cereal::make_nvp("Name", std::string(MeshConstants::ATTRIBUTE_NAMES[i])));
+            ar(cereal::make_nvp("Data", attribute_data[i]));
+        }
         break;
+    }
 
     default:
         break;
     }
 }
+
 template <typename A>
 inline void MeshData::load(A& ar, const uint32_t v)
 {
+    attribute_data = {};
+
     switch (v)
     {
     case 0:
-        ar(cereal::make_nvp("Attributes", attribute_data));
+    {
+        std::map<std::string, ByteBuffer> named {};
+        ar(cereal::make_nvp("Attributes", named));
+
+        for (auto& [name, data] : named)
+        {
+            if (auto attribute = MeshConstants::FindAttribute(name))
+                AddAttribute(*attribute, std::move(data));
+        }
+        break;
+    }
+
+    case 1:
+    {
+        uint32_t count = 0;
+        ar(cereal::make_nvp("AttributeCount", count));
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string name {};
+            ByteBuffer data {};
+            ar(cereal::make_nvp("Name", name));
+            ar(cereal::make_nvp("Data", data));
+
+            // Attributes this build does not know are skipped
+            if (auto attribute = MeshConstants::FindAttribute(name))
+                AddAttribute(*attribute, std::move(data));
+        }
         break;
+    }
 
     default:
         break;
@@ -82,11 +151,19 @@ class Mesh
 {
 public:
     Mesh(const Device& device, const MeshData& data);
-    std::shared_ptr<StorageBuffer> GetAttribute(const std::string& name) const;
+
+    // Null if the mesh does not have the attribute
+    StorageBuffer* GetAttribute(VertexAttribute attribute) const { return m_data[static_cast<size_t>(attribute)].get(); }
 
 private:
-    std::unordered_map<std::string, std::shared_ptr<StorageBuffer>> m_data;
+    std::array<std::shared_ptr<StorageBuffer>, MeshConstants::ATTRIBUTE_COUNT> m_data;
 };
+
+namespace Tests
+{
+    void TestMeshData();
+}
+
 }
 
-CEREAL_CLASS_VERSION(KS::MeshData, 0);
\ No newline at end of file
+CEREAL_CLASS_VERSION(KS::MeshData, 1);
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "Mesh.hpp"
+
+#include <fileio/Serialization.hpp>
+#include <sstream>
+
+std::optional<KS::VertexAttribute> KS::MeshConstants::FindAttribute(std::string_view name)
+{
+    for (size_t i = 0; i < ATTRIBUTE_COUNT; i++)
+    {
+        if (ATTRIBUTE_NAMES[i] == name)
+        {
+            return static_cast<VertexAttribute>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void KS::MeshData::AddAttribute(VertexAttribute attribute, ByteBuffer&& data)
+{
+    attribute_data[static_cast<size_t>(attribute)] = std::move(data);
+}
+
+namespace
+{
+
+// Layout of MeshData files before attributes became an enum
+struct LegacyMeshData
+{
+    std::map<std::string, KS::ByteBuffer> attributes {};
+
+    template <typename A>
+    void serialize(A& ar, const uint32_t)
+    {
+        ar(cereal::make_nvp("Attributes", attributes));
+    }
+};
+
+}
+
+CEREAL_CLASS_VERSION(LegacyMeshData, 0);
+
+const KS::ByteBuffer* KS::MeshData::GetAttribute(VertexAttribute attribute) const
+{
+    const auto& data = attribute_data[static_cast<size_t>(attribute)];
+    return data.Empty() ? nullptr : &data;
+}
+
+void KS::Tests::TestMeshData()
+{
+    using namespace MeshConstants;
+
+    for (size_t i = 0; i < ATTRIBUTE_COUNT; i++)
+    {
+        if (FindAttribute(ATTRIBUTE_NAMES[i]) != static_cast<VertexAttribute>(i))
+        {
+            throw;
+        }
+    }
+
+    if (FindAttribute("COLOURS").has_value() || GetAttributeStride(VertexAttribute::TEXTURE_UVS) != sizeof(float) * 2)
+    {
+        throw;
+    }
+
+    uint32_t indices[] = { 0, 1, 2 };
+    float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+
+    MeshData mesh {};
+    mesh.AddAttribute(VertexAttribute::INDICES, ByteBuffer(indices, std::size(indices)));
+    mesh.AddAttribute(VertexAttribute::POSITIONS, ByteBuffer(positions, std::size(positions)));
+
+    if (!mesh.HasAttribute(VertexAttribute::POSITIONS) || mesh.GetAttribute(VertexAttribute::NORMALS) != nullptr
+        || mesh.GetAttribute(VertexAttribute::INDICES)->GetSize() != sizeof(indices))
+    {
+        throw;
+    }
+
+    auto matches = [&](const MeshData& loaded)
+    {
+        const ByteBuffer* loaded_positions = loaded.GetAttribute(VertexAttribute::POSITIONS);
+        const ByteBuffer* loaded_indices = loaded.GetAttribute(VertexAttribute::INDICES);
+
+        return loaded_positions && loaded_indices && !loaded.HasAttribute(VertexAttribute::TANGENTS)
+            && loaded_positions->GetView<float>().begin()[3] == 1.0f && loaded_indices->GetView<uint32_t>().begin()[2] == 2;
+    };
+
+    // Current version round trip, binary and JSON
+    {
+        std::stringstream stream {};
+        {
+            BinarySaver archive { stream };
+            archive(mesh);
+        }
+
+        MeshData loaded {};
+        {
+            BinaryLoader archive { stream };
+            archive(loaded);
+        }
+
+        if (!matches(loaded))
+        {
+            throw;
+        }
+    }
+
+    {
+        std::stringstream stream {};
+        {
+            JSONSaver archive { stream };
+            archive(cereal::make_nvp("Mesh", mesh));
+        }
+
+        MeshData loaded {};
+        {
+            JSONLoader archive { stream };
+            archive(cereal::make_nvp("Mesh", loaded));
+        }
+
+        if (!matches(loaded))
+        {
+            throw;
+        }
+    }
+
+    // Version 0 files still load, names the engine no longer knows are dropped
+    {
+        LegacyMeshData legacy {};
+        legacy.attributes.emplace("INDICES", ByteBuffer(indices, std::size(indices)));
+        legacy.attributes.emplace("POSITIONS", ByteBuffer(positions, std::size(positions)));
+        legacy.attributes.emplace("COLOURS", ByteBuffer(positions, std::size(positions)));
+
+        std::stringstream stream {};
+        {
+            BinarySaver archive { stream };
+            archive(legacy);
+        }
+
+        MeshData loaded {};
+        {
+            BinaryLoader archive { stream };
+            archive(loaded);
+        }
+
+        if (!matches(loaded))
+        {
+            throw;
+        }
+    }
+}
@@ -1,8 +1,13 @@
 #include "Model.hpp"
 
 #include <fileio/FileIO.hpp>
+#include <fileio/MemoryStream.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <assimp/GltfMaterial.h>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -14,9 +19,79 @@
 namespace KS::detail
 {
 
+// Assimp opens the files a model references (.gltf buffers and images, .obj material libraries) through its IOSystem,
+// relative to the model. These go through FileIO::MapReadOnly, so they are mapped instead of copied
+class MappedIOStream : public Assimp::IOStream
+{
+public:
+    explicit MappedIOStream(MappedFile&& mapped)
+        : file(std::move(mapped))
+    {
+    }
+
+    size_t Read(void* buffer, size_t size, size_t count) override
+    {
+        if (size == 0)
+            return 0;
+
+        size_t available = (file.GetSize() - position) / size;
+        count = std::min(count, available);
+        std::memcpy(buffer, file.GetData() + position, size * count);
+        position += size * count;
+        return count;
+    }
+
+    size_t Write(const void*, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override
+    {
+        size_t target = offset;
+        if (origin == aiOrigin_CUR)
+            target = position + offset;
+        else if (origin == aiOrigin_END)
+            target = file.GetSize() - offset;
+
+        if (target > file.GetSize())
+            return aiReturn_FAILURE;
+
+        position = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return position; }
+    size_t FileSize() const override { return file.GetSize(); }
+    void Flush() override { }
+
+private:
+    MappedFile file {};
+    size_t position = 0;
+};
+
+class MappedIOSystem : public Assimp::IOSystem
+{
+public:
+    bool Exists(const char* path) const override { return FileIO::Exists(path); }
+    char getOsSeparator() const override { return static_cast<char>(std::filesystem::path::preferred_separator); }
+
+    Assimp::IOStream* Open(const char* path, const char* mode) override
+    {
+        // The importer only reads
+        if (std::string_view(mode).find_first_of("wa+") != std::string_view::npos)
+            return nullptr;
+
+        if (auto file = FileIO::MapReadOnly(path, AccessHint::SEQUENTIAL))
+            return new MappedIOStream(std::move(file.value()));
+
+        return nullptr;
+    }
+
+    void Close(Assimp::IOStream* stream) override { delete stream; }
+};
+
 MeshData ProcessMesh(const aiMesh* mesh)
 {
-    using namespace KS::MeshConstants;
+    // Imported data is written to disk and dropped, it is accounted separately from loaded assets
+    auto* memory = GetTrackedResource(MemoryTag::IMPORTER);
 
     // Build Mesh
     MeshData new_mesh {};
@@ -24,60 +99,65 @@ MeshData ProcessMesh(const aiMesh* mesh)
     // Indices
     if (mesh->HasFaces())
     {
-        std::vector<uint32_t> indices;
+        size_t triangle_count = std::count_if(mesh->mFaces, mesh->mFaces + mesh->mNumFaces,
+            [](const aiFace& face) { return face.mNumIndices == 3; });
+
+        // Written straight into the buffer, instead of going through a vector and a copy
+        auto buffer = ByteBuffer::Allocate(triangle_count * 3 * sizeof(uint32_t), ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        auto* indices = reinterpret_cast<uint32_t*>(buffer.GetMutableBytes().data());
 
         for (size_t i = 0; i < mesh->mNumFaces; i++)
         {
             auto& face = mesh->mFaces[i];
             if (face.mNumIndices == 3)
             {
-                indices.push_back(face.mIndices[0]);
-                indices.push_back(face.mIndices[1]);
-                indices.push_back(face.mIndices[2]);
+                *indices++ = face.mIndices[0];
+                *indices++ = face.mIndices[1];
+                *indices++ = face.mIndices[2];
             }
         }
 
-        auto buffer = ByteBuffer(indices.data(), indices.size());
-        new_mesh.AddAttribute(ATTRIBUTE_INDICES_NAME, std::move(buffer));
+        new_mesh.AddAttribute(VertexAttribute::INDICES, std::move(buffer));
     }
 
     // Positions
     if (mesh->HasPositions())
     {
-        auto buffer = ByteBuffer(mesh->mVertices, mesh->mNumVertices);
-        new_mesh.AddAttribute(ATTRIBUTE_POSITIONS_NAME, std::move(buffer));
+        auto buffer = ByteBuffer(mesh->mVertices, mesh->mNumVertices, ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        new_mesh.AddAttribute(VertexAttribute::POSITIONS, std::move(buffer));
     }
 
     // Normals
     if (mesh->HasNormals())
     {
-        auto buffer = ByteBuffer(mesh->mNormals, mesh->mNumVertices);
-        new_mesh.AddAttribute(ATTRIBUTE_NORMALS_NAME, std::move(buffer));
+        auto buffer = ByteBuffer(mesh->mNormals, mesh->mNumVertices, ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        new_mesh.AddAttribute(VertexAttribute::NORMALS, std::move(buffer));
     }
 
     // Tangents and Bitangents
     if (mesh->HasTangentsAndBitangents())
     {
-        auto buffer = ByteBuffer(mesh->mTangents, mesh->mNumVertices);
-        new_mesh.AddAttribute(ATTRIBUTE_TANGENTS_NAME, std::move(buffer));
+        auto buffer = ByteBuffer(mesh->mTangents, mesh->mNumVertices, ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        new_mesh.AddAttribute(VertexAttribute::TANGENTS, std::move(buffer));
 
-        auto buffer2 = ByteBuffer(mesh->mBitangents, mesh->mNumVertices);
-        new_mesh.AddAttribute(ATTRIBUTE_BITANGENTS_NAME, std::move(buffer2));
+        auto buffer2 = ByteBuffer(mesh->mBitangents, mesh->mNumVertices, ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        new_mesh.AddAttribute(VertexAttribute::BITANGENTS, std::move(buffer2));
     }
 
     // Texture UVS (only using the first)
     if (mesh->GetNumUVChannels())
     {
-        std::vector<glm::vec2> texture_uvs {};
+        auto buffer = ByteBuffer::Allocate(mesh->mNumVertices * sizeof(glm::vec2), ByteBuffer::DEFAULT_ALIGNMENT, memory);
+        auto* texture_uvs = reinterpret_cast<glm::vec2*>(buffer.GetMutableBytes().data());
+
         for (size_t i = 0; i < mesh->mNumVertices; i++)
         {
-            texture_uvs.emplace_back(
+            texture_uvs[i] = glm::vec2(
                 mesh->mTextureCoords[0][i].x,
                 mesh->mTextureCoords[0][i].y);
         }
 
-        auto buffer = ByteBuffer(texture_uvs.data(), texture_uvs.size());
-        new_mesh.AddAttribute(ATTRIBUTE_TEXTURE_UVS_NAME, std::move(buffer));
+        new_mesh.AddAttribute(VertexAttribute::TEXTURE_UVS, std::move(buffer));
     }
 
     return new_mesh;
@@ -89,7 +169,7 @@ Image ProcessImage(const aiTexture* texture)
     {
         if (auto image_load = LoadImageFileFromMemory(texture->pcData, texture->mWidth))
         {
-            return image_load.value();
+            return std::move(image_load.value());
         }
         else
         {
@@ -99,16 +179,21 @@ Image ProcessImage(const aiTexture* texture)
     }
     else
     {
-        std::vector<aiTexel> reordered_data;
-        reordered_data.resize(texture->mWidth * texture->mHeight);
+        size_t texel_count = size_t(texture->mWidth) * texture->mHeight;
+        auto buffer = ByteBuffer::Allocate(texel_count * 4, ByteBuffer::DEFAULT_ALIGNMENT, GetTrackedResource(MemoryTag::IMPORTER));
+        auto* reordered_data = reinterpret_cast<uint8_t*>(buffer.GetMutableBytes().data());
 
-        for (size_t i = 0; i < reordered_data.size(); i++)
+        // aiTexel is stored as BGRA
+        for (size_t i = 0; i < texel_count; i++)
         {
             auto& texel = texture->pcData[i];
-            reordered_data.at(i) = { texel.r, texel.g, texel.b, texel.a };
+            reordered_data[i * 4 + 0] = texel.r;
+            reordered_data[i * 4 + 1] = texel.g;
+            reordered_data[i * 4 + 2] = texel.b;
+            reordered_data[i * 4 + 3] = texel.a;
         }
 
-        return Image { ByteBuffer(reordered_data.data(), reordered_data.size()), texture->mWidth, texture->mHeight };
+        return Image { std::move(buffer), texture->mWidth, texture->mHeight };
     }
 }
 
@@ -140,11 +225,11 @@ Material ProcessMaterial(const std::vector<std::string>& image_paths, const aiMa
     // Base colour factor
     if (aiColor4D t {}; material->Get(AI_MATKEY_BASE_COLOR, t) == aiReturn_SUCCESS)
     {
-        out.AddParameter(BASE_COLOUR_FACTOR_NAME, glm::vec4 { t.r, t.g, t.b, t.a });
+        out.AddParameter(BASE_COLOUR_FACTOR, glm::vec4 { t.r, t.g, t.b, t.a });
     }
     else
     {
-        out.AddParameter(BASE_COLOUR_FACTOR_NAME, glm::vec4 { t.r, t.g, t.b, t.a });
+        out.AddParameter(BASE_COLOUR_FACTOR, glm::vec4 { t.r, t.g, t.b, t.a });
     }
 
     // Occlusion Roughness Metallic
@@ -153,7 +238,7 @@ Material ProcessMaterial(const std::vector<std::string>& image_paths, const aiMa
         material->Get(AI_MATKEY_GLTF_TEXTURE_STRENGTH(aiTextureType_AMBIENT_OCCLUSION, 0), orm.x);
         material->Get(AI_MATKEY_ROUGHNESS_FACTOR, orm.y);
         material->Get(AI_MATKEY_METALLIC_FACTOR, orm.z);
-        out.AddParameter(ORM_FACTORS_NAME, orm);
+        out.AddParameter(ORM_FACTORS, orm);
     }
 
     // Normal Emissive Alpha Cutoff
@@ -162,14 +247,14 @@ Material ProcessMaterial(const std::vector<std::string>& image_paths, const aiMa
         material->Get(AI_MATKEY_GLTF_TEXTURE_SCALE(aiTextureType_NORMALS, 0), nea.x);
         material->Get(AI_MATKEY_EMISSIVE_INTENSITY, nea.y);
         material->Get(AI_MATKEY_GLTF_ALPHACUTOFF, nea.z);
-        out.AddParameter(NEA_FACTORS_NAME, nea);
+        out.AddParameter(NEA_FACTORS, nea);
     }
 
     // Double Sided
     {
         int d = DOUBLE_SIDED_DEFAULT;
         material->Get(AI_MATKEY_TWOSIDED, d);
-        out.AddParameter(DOUBLE_SIDED_FLAG_NAME, static_cast<bool>(d));
+        out.AddParameter(DOUBLE_SIDED_FLAG, static_cast<bool>(d));
     }
 
     auto GetTexture = [&](aiTextureType type) -> std::optional<std::string>
@@ -193,51 +278,51 @@ Material ProcessMaterial(const std::vector<std::string>& image_paths, const aiMa
 
     if (auto path = GetTexture(aiTextureType_BASE_COLOR))
     {
-        out.AddParameter(BASE_TEXTURE_NAME, ResourceHandle<Texture> { path.value() });
+        out.AddParameter(BASE_TEXTURE, ResourceHandle<Texture> { path.value() });
     }
 
     if (auto path = GetTexture(aiTextureType_NORMALS))
     {
-        out.AddParameter(NORMAL_TEXTURE_NAME, ResourceHandle<Texture> { path.value() });
+        out.AddParameter(NORMAL_TEXTURE, ResourceHandle<Texture> { path.value() });
     }
 
     if (auto path = GetTexture(aiTextureType_LIGHTMAP))
     {
-        out.AddParameter(OCCLUSION_TEXTURE_NAME, ResourceHandle<Texture> { path.value() });
+        out.AddParameter(OCCLUSION_TEXTURE, ResourceHandle<Texture> { path.value() });
     }
 
     if (auto path = GetTexture(aiTextureType_METALNESS))
     {
-        out.AddParameter(METALLIC_TEXTURE_NAME, ResourceHandle<Texture> { path.value() });
+        out.AddParameter(METALLIC_TEXTURE, ResourceHandle<Texture> { path.value() });
     }
 
     if (auto path = GetTexture(aiTextureType_EMISSIVE))
     {
-        out.AddParameter(EMISSIVE_TEXTURE_NAME, ResourceHandle<Texture> { path.value() });
+        out.AddParameter(EMISSIVE_TEXTURE, ResourceHandle<Texture> { path.value() });
     }
 
     return out;
 }
 }
 
-std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(const FileIO::Path& source_model, uint32_t post_processing_flags)
+std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(
+    const FileIO::Path& source_model, uint32_t post_processing_flags, const FileIO::Path& output_directory)
 {
     Assimp::Importer importer;
     const aiScene* scene = nullptr;
 
-    // Read Scene File
+    // Read Scene File, by path so the files it references can be found
     {
-        if (auto file_data = FileIO::OpenReadStream(source_model, std::ios::binary))
-        {
-            auto dump = FileIO::DumpFullStream(file_data.value());
-            scene = importer.ReadFileFromMemory(dump.data(), dump.size(), post_processing_flags);
-        }
-        else
+        if (!FileIO::Exists(source_model))
         {
             LOG(Log::Severity::WARN, "Could not open file: {}", source_model.string());
             return {};
         }
 
+        // The importer owns and deletes the IO handler
+        importer.SetIOHandler(new detail::MappedIOSystem {});
+        scene = importer.ReadFile(source_model.string(), post_processing_flags);
+
         if (scene == nullptr)
         {
             LOG(Log::Severity::WARN, "Could not import model: {}", importer.GetErrorString());
@@ -254,7 +339,7 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
     auto source = source_model;
 
     auto base_dir = source.make_preferred().parent_path();
-    auto out_dir = base_dir / source.stem();
+    auto out_dir = output_directory.empty() ? base_dir / source.stem() : output_directory;
 
     FileIO::MakeDirectory(out_dir.string());
 
@@ -281,12 +366,13 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
 
             auto output_path = (mesh_out / (mesh_name + ".bin")).string();
 
-            if (auto out = FileIO::OpenWriteStream(output_path))
+            auto write_mesh = [&](std::ostream& out)
             {
-                BinarySaver ar { out.value() };
+                BinarySaver ar { out };
                 ar(mesh);
-            }
-            else
+            };
+
+            if (!FileIO::WriteFileAtomic(output_path, write_mesh))
             {
                 LOG(Log::Severity::WARN, "Failed to write output mesh file {}", output_path);
             }
@@ -321,18 +407,17 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
 
             auto output_path = (images_out / (image_name + ".png")).string();
 
-            auto output_file = FileIO::OpenWriteStream(output_path);
             auto compressed_data = SaveImageToPNG(image);
 
-            if (output_file && compressed_data)
+            auto write_image = [&](std::ostream& out)
             {
                 auto ptr = compressed_data.value().GetView<char>().begin();
                 auto size = compressed_data.value().GetView<char>().count();
 
-                output_file.value()
-                    .write(ptr, size);
-            }
-            else
+                out.write(ptr, size);
+            };
+
+            if (!compressed_data || !FileIO::WriteFileAtomic(output_path, write_image))
             {
                 LOG(Log::Severity::WARN, "Failed to write output texture file {}", output_path);
             }
@@ -341,16 +426,14 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
         }
     }
 
-    std::vector<Material> materials;
+    std::vector<std::shared_ptr<const Material>> materials;
 
     // Process Materials
     {
         for (size_t i = 0; i < scene->mNumMaterials; i++)
         {
             auto m = scene->mMaterials[i];
-            auto material = detail::ProcessMaterial(image_paths, m);
-
-            materials.emplace_back(material);
+            materials.emplace_back(std::make_shared<const Material>(detail::ProcessMaterial(image_paths, m)));
         }
     }
 
@@ -363,17 +446,20 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
 
     auto out_model_file = out_dir / (source.filename().replace_extension().string() + ".json");
 
-    if (auto out = FileIO::OpenWriteStream(out_model_file.string(), std::ios::trunc))
-    {
-        JSONSaver json { out.value() };
-
-        Model imported {
-            .nodes = std::move(nodes),
-            .meshes = std::move(mesh_paths),
-            .materials = std::move(materials)
-        };
+    Model imported {
+        .nodes = std::move(nodes),
+        .meshes = std::move(mesh_paths),
+        .materials = std::move(materials)
+    };
 
+    auto write_model = [&](std::ostream& out)
+    {
+        JSONSaver json { out };
         json(imported);
+    };
+
+    if (FileIO::WriteFileAtomic(out_model_file.string(), write_model, std::ios::trunc))
+    {
         LOG(Log::Severity::INFO, "Successfully imported model from {}", source_model.string());
         return ResourceHandle<Model> { out_model_file.string() };
     }
@@ -384,4 +470,45 @@ std::optional<KS::ResourceHandle<KS::Model>> KS::ModelImporter::ImportFromFile(c
     }
 
     return ResourceHandle<Model> { out_model_file.string() };
-}
\ No newline at end of file
+}
+
+std::optional<KS::ModelImporter::ImportedFiles> KS::ModelImporter::ListImportedFiles(const ResourceHandle<Model>& model)
+{
+    Model loaded {};
+
+    if (auto fileread = FileIO::ReadFile(model.path))
+    {
+        try
+        {
+            MemoryReadStream stream { fileread->GetBytes() };
+            JSONLoader json { stream };
+            json(loaded);
+        }
+        catch (const cereal::Exception& e)
+        {
+            LOG(Log::Severity::WARN, "Could not read imported model {}: {}", model.path, e.what());
+            return std::nullopt;
+        }
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    ImportedFiles out {};
+    out.model = model;
+    out.meshes = std::move(loaded.meshes);
+
+    using namespace MaterialConstants;
+    for (const auto& material : loaded.materials)
+    {
+        for (auto id : TEXTURES)
+        {
+            const auto* texture = material->GetParameter<ResourceHandle<Texture>>(id);
+            if (texture && std::find(out.textures.begin(), out.textures.end(), *texture) == out.textures.end())
+                out.textures.emplace_back(*texture);
+        }
+    }
+
+    return out;
+}
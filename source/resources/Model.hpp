@@ -24,7 +24,8 @@ public:
 
     std::vector<Node> nodes;
     std::vector<ResourceHandle<Mesh>> meshes;
-    std::vector<Material> materials;
+    // Shared with the draw entries that use them
+    std::vector<std::shared_ptr<const Material>> materials;
 
 private:
     friend class cereal::access;
@@ -49,10 +50,18 @@ inline void Model::save(A& ar, const uint32_t v) const
     switch (v)
     {
     case 0:
+    {
         ar(cereal::make_nvp("Nodes", nodes));
         ar(cereal::make_nvp("Meshes", meshes));
-        ar(cereal::make_nvp("Materials", materials));
+
+        std::vector<Material> values {};
+        values.reserve(materials.size());
+        for (const auto& material : materials)
+            values.emplace_back(material ? *material : Material {});
+
+        ar(cereal::make_nvp("Materials", values));
         break;
+    }
 
     default:
         break;
@@ -65,10 +74,18 @@ inline void Model::load(A& ar, const uint32_t v)
     switch (v)
     {
     case 0:
+    {
         ar(cereal::make_nvp("Nodes", nodes));
         ar(cereal::make_nvp("Meshes", meshes));
-        ar(cereal::make_nvp("Materials", materials));
+
+        std::vector<Material> values {};
+        ar(cereal::make_nvp("Materials", values));
+
+        materials.clear();
+        for (auto& material : values)
+            materials.emplace_back(std::make_shared<const Material>(std::move(material)));
         break;
+    }
 
     default:
         break;
@@ -81,9 +98,22 @@ namespace ModelImporter
     constexpr uint32_t DEFAULT_POST_PROCESSING_FLAGS = aiProcess_Triangulate | aiProcess_CalcTangentSpace | aiProcess_EmbedTextures | aiProcess_FlipUVs;
 
     // Converts a model file into a .json file for the engine to use
+    // Outputs go to output_directory, by default a folder named after the model next to it
     // Return value is the newly imported model file
     std::optional<ResourceHandle<Model>>
-    ImportFromFile(const FileIO::Path& source_model, uint32_t post_process_flags = DEFAULT_POST_PROCESSING_FLAGS);
+    ImportFromFile(const FileIO::Path& source_model, uint32_t post_process_flags = DEFAULT_POST_PROCESSING_FLAGS,
+        const FileIO::Path& output_directory = {});
+
+    // Everything an import produced: the model (which holds the materials), its meshes and the textures it uses
+    struct ImportedFiles
+    {
+        ResourceHandle<Model> model {};
+        std::vector<ResourceHandle<Mesh>> meshes {};
+        std::vector<ResourceHandle<Texture>> textures {};
+    };
+
+    // Reads back an imported model to find the files it depends on
+    std::optional<ImportedFiles> ListImportedFiles(const ResourceHandle<Model>& model);
 }
 }
 
@@ -0,0 +1,240 @@
+#include <scene/Scene.hpp>
+
+#include <device/Device.hpp>
+#include <renderer/Shader.hpp>
+#include <renderer/ShaderInputCollection.hpp>
+#include <renderer/StorageBuffer.hpp>
+#include <renderer/DX12/Helpers/DXResource.hpp>
+#include <renderer/DX12/Helpers/DXCommandList.hpp>
+#include <renderer/DX12/Helpers/DX12Conversion.hpp>
+#include <resources/Mesh.hpp>
+
+#include <DXR/DXRHelper.h>
+#include <DXR/nv_helpers_dx12/TopLevelASGenerator.h>
+#include <DXR/nv_helpers_dx12/BottomLevelASGenerator.h>
+#include <DXR/nv_helpers_dx12/RaytracingPipelineGenerator.h>
+#include <DXR/nv_helpers_dx12/RootSignatureGenerator.h>
+#include <DXR/nv_helpers_dx12/ShaderBindingTableGenerator.h>
+
+namespace KS
+{
+struct Scene::Impl
+{
+public:
+    Impl();
+    ~Impl();
+    struct ASBuffers
+    {
+        std::shared_ptr<DXResource> pScratch[2] = {nullptr, nullptr};
+        std::shared_ptr<DXResource> pResult[2] = {nullptr, nullptr};
+        std::shared_ptr<DXResource> pInstanceDesc[2] = {nullptr, nullptr};
+    };
+
+    ASBuffers m_BLBuffers[200];
+    std::pair<std::shared_ptr<DXResource>, DirectX::XMMATRIX> m_instances[200];
+    ASBuffers m_topLevelASBuffers;
+    int m_BLCount = 0;
+    DXHeapHandle m_BHVHandle[2];
+    bool m_updateBVH = false;
+
+    ComPtr<ID3D12RootSignature> m_raytracingSignature;
+
+    nv_helpers_dx12::TopLevelASGenerator m_topLevelASGenerator;
+    nv_helpers_dx12::ShaderBindingTableGenerator m_sbtHelper[2];
+};
+}  // namespace KS
+
+void KS::Scene::CreateAccelerationStructures(const Device& device) { m_impl = new Impl(); }
+
+void KS::Scene::DestroyAccelerationStructures() { delete m_impl; }
+
+void KS::Scene::UpdateAccelerationStructures(Device& device)
+{
+    if (!m_impl->m_updateBVH)
+    {
+        memset(m_impl->m_BLBuffers, 0, 200 * sizeof(Impl::ASBuffers));
+        m_impl->m_BLCount = 0;
+    }
+
+    auto cpuFrameIndex = device.GetCPUFrameIndex();
+    for (const auto& meshSet : m_drawSets)
+    {
+        CreateBVHBotomLevelInstance(device, meshSet.mesh, m_modelMatrices[meshSet.modelIndex].mModel, m_impl->m_updateBVH,
+                                    meshSet.modelIndex, cpuFrameIndex);
+    }
+    CreateTopLevelAS(device, m_impl->m_updateBVH, cpuFrameIndex);
+}
+
+void KS::Scene::CreateBottomLevelAS(const Device& device, const Mesh* mesh, int cpuFrame)
+{
+    nv_helpers_dx12::BottomLevelASGenerator bottomLevelASGen;
+    DXCommandList* commandList = reinterpret_cast<DXCommandList*>(device.GetCommandList());
+    ID3D12Device5* engineDevice = static_cast<ID3D12Device5*>(device.GetDevice());
+
+    auto positions = mesh->GetAttribute(VertexAttribute::POSITIONS);
+    auto positionsResource = reinterpret_cast<DXResource*>(positions->GetRawResource());
+    auto indices = mesh->GetAttribute(VertexAttribute::INDICES);
+    auto indicesResource = reinterpret_cast<DXResource*>(indices->GetRawResource());
+
+    commandList->ResourceBarrier(*positionsResource->Get(), positionsResource->GetState(),
+                                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    positionsResource->ChangeState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    commandList->ResourceBarrier(*indicesResource->Get(), indicesResource->GetState(),
+                                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    indicesResource->ChangeState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+
+    DXGI_FORMAT indexFormat;
+    switch (indices->GetBufferStride())
+    {
+        case sizeof(unsigned char):
+            indexFormat = DXGI_FORMAT_R8_UINT;
+            break;
+        case sizeof(unsigned short):
+            indexFormat = DXGI_FORMAT_R16_UINT;
+            break;
+        case sizeof(unsigned int):
+            indexFormat = DXGI_FORMAT_R32_UINT;
+            break;
+        default:
+            indexFormat = DXGI_FORMAT_R16_UINT;
+            break;
+    }
+
+    bottomLevelASGen.AddVertexBuffer(positionsResource->Get(), 0, static_cast<uint32_t>(positions->GetElementCount()),
+                                     sizeof(glm::vec3), indicesResource->Get(), 0,
+                                     static_cast<uint32_t>(indices->GetElementCount()), indexFormat, nullptr, 0, true);
+
+    // The AS build requires some scratch space to store temporary information.
+    // The amount of scratch memory is dependent on the scene complexity.
+    UINT64 scratchSizeInBytes = 0;
+    // The final AS also needs to be stored in addition to the existing vertex
+    // buffers. It size is also dependent on the scene complexity.
+    UINT64 resultSizeInBytes = 0;
+
+    bottomLevelASGen.ComputeASBufferSizes(engineDevice, false, &scratchSizeInBytes, &resultSizeInBytes);
+
+    auto bufDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    heapProps.CreationNodeMask = 0;
+    heapProps.VisibleNodeMask = 0;
+
+    m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame] =
+        std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "SCRATCH  BUFFER");
+
+    bufDesc.Width = resultSizeInBytes;
+    m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame] = std::make_shared<DXResource>(
+        engineDevice, heapProps, bufDesc, nullptr, "RESULT  BUFFER", D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+
+    bottomLevelASGen.Generate(commandList->GetCommandList().Get(),
+                              m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame]->Get(),
+                              m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame]->Get(), false, nullptr);
+
+    commandList->TrackResource(m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame]->GetResource());
+    commandList->TrackResource(m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame]->GetResource());
+}
+
+void KS::Scene::CreateBVHBotomLevelInstance(const Device& device, const Mesh* mesh, const glm::mat4& transform, bool updateOnly,
+                                            int entryIndex, int cpuFrame)
+{
+    if (!updateOnly)
+    {
+        CreateBottomLevelAS(device, mesh, cpuFrame);
+
+        m_impl->m_instances[m_impl->m_BLCount].first = m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame];
+        m_impl->m_instances[m_impl->m_BLCount].second = Conversion::GLMToXMMATRIX(transform);
+
+        m_impl->m_topLevelASGenerator.AddInstance(m_impl->m_instances[m_impl->m_BLCount].first->Get(),
+                                                  m_impl->m_instances[m_impl->m_BLCount].second,
+                                                  static_cast<uint32_t>(m_impl->m_BLCount), static_cast<uint32_t>(0));
+
+        m_impl->m_BLCount++;
+    }
+    else
+    {
+        m_impl->m_instances[entryIndex].second = Conversion::GLMToXMMATRIX(transform);
+    }
+}
+
+void KS::Scene::CreateTopLevelAS(const Device& device, bool updateOnly, int cpuFrame)
+{
+    ID3D12Device5* engineDevice = static_cast<ID3D12Device5*>(device.GetDevice());
+    DXCommandList* commandList = reinterpret_cast<DXCommandList*>(device.GetCommandList());
+
+    if (!updateOnly)
+    {
+        // As for the bottom-level AS, the building the AS requires some scratch space
+        // to store temporary data in addition to the actual AS. In the case of the
+        // top-level AS, the instance descriptors also need to be stored in GPU
+        // memory. This call outputs the memory requirements for each (scratch,
+        // results, instance descriptors) so that the application can allocate the
+        // corresponding memory
+        UINT64 scratchSize, resultSize, instanceDescsSize;
+
+        m_impl->m_topLevelASGenerator.ComputeASBufferSizes(engineDevice, true, &scratchSize, &resultSize, &instanceDescsSize);
+
+        //// Create the scratch and result buffers. Since the build is all done on GPU,
+        //// those can be allocated on the default heap
+
+        auto bufDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+        auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heapProps.CreationNodeMask = 0;
+        heapProps.VisibleNodeMask = 0;
+
+        m_impl->m_topLevelASBuffers.pScratch[cpuFrame] =
+            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH SCRATCH");
+        bufDesc.Width = resultSize;
+        m_impl->m_topLevelASBuffers.pResult[cpuFrame] =
+            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH RESULT",
+                                         D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+
+        // The buffer describing the instances: ID, shader binding information,
+        // matrices ... Those will be copied into the buffer by the helper through
+        // mapping, so the buffer has to be allocated on the upload heap.
+        bufDesc.Width = instanceDescsSize;
+        bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+        heapProps.CreationNodeMask = 0;
+        heapProps.VisibleNodeMask = 0;
+        m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame] =
+            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH DESC");
+
+        commandList->ResourceBarrier(*m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->Get(),
+                                     m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->GetState(),
+                                     D3D12_RESOURCE_STATE_GENERIC_READ);
+        m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->ChangeState(D3D12_RESOURCE_STATE_GENERIC_READ);
+    }
+
+    // After all the buffers are allocated, or if only an update is required, we
+    // can build the acceleration structure. Note that in the case of the update
+    // we also pass the existing AS as the 'previous' AS, so that it can be
+    // refitted in place.
+    m_impl->m_topLevelASGenerator.Generate(
+        commandList->GetCommandList().Get(), m_impl->m_topLevelASBuffers.pScratch[cpuFrame]->Get(),
+        m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get(), m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->Get(),
+        updateOnly, m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get());
+
+    if (!updateOnly)
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_RAYTRACING_ACCELERATION_STRUCTURE;
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.RaytracingAccelerationStructure.Location =
+            m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get()->GetGPUVirtualAddress();
+
+        m_impl->m_BHVHandle[cpuFrame] =
+            reinterpret_cast<DXDescHeap*>(device.GetResourceHeap())
+                ->AllocateResource(m_impl->m_topLevelASBuffers.pResult[cpuFrame].get(), &srvDesc, BVH_SLOT + cpuFrame);
+    }
+
+    commandList->TrackResource(m_impl->m_topLevelASBuffers.pScratch[cpuFrame]->GetResource());
+    commandList->TrackResource(m_impl->m_topLevelASBuffers.pResult[cpuFrame]->GetResource());
+    commandList->TrackResource(m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->GetResource());
+}
+
+KS::Scene::Impl::Impl() {}
+
+KS::Scene::Impl::~Impl() {}
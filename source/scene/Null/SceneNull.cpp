@@ -0,0 +1,372 @@
+#include <scene/Scene.hpp>
+
+#include <components/ComponentWorldTransform.hpp>
+#include <device/Device.hpp>
+#include <ecs/EntityComponentSystem.hpp>
+#include <fileio/FileIO.hpp>
+#include <fileio/FileWatcher.hpp>
+#include <fileio/Serialization.hpp>
+#include <renderer/CommandPackets.hpp>
+#include <renderer/ModelRenderer.hpp>
+#include <renderer/Shader.hpp>
+#include <renderer/StorageBuffer.hpp>
+#include <renderer/UniformBuffer.hpp>
+#include <resources/AssetReloader.hpp>
+#include <resources/Image.hpp>
+#include <resources/Mesh.hpp>
+#include <resources/Model.hpp>
+#include <resources/Texture.hpp>
+#include <tools/AllocationCounter.hpp>
+#include <tools/FrameCapture.hpp>
+#include <tools/Log.hpp>
+
+#include <ostream>
+#include <streambuf>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Headless scenes have no ray traced passes, so there are no acceleration structures to build and m_impl stays null
+void KS::Scene::CreateAccelerationStructures(const Device& device) {}
+
+void KS::Scene::DestroyAccelerationStructures() {}
+
+void KS::Scene::UpdateAccelerationStructures(Device& device) {}
+
+namespace
+{
+
+// A model of one or more triangle meshes with a textured material, written the way ModelImporter writes its output
+KS::ResourceHandle<KS::Model> WriteTriangleModel(const std::filesystem::path& directory, uint32_t mesh_count = 1)
+{
+    using namespace KS;
+    std::filesystem::create_directories(directory);
+
+    ResourceHandle<Texture> texture_handle { (directory / "texture.png").string() };
+    ResourceHandle<Model> model_handle { (directory / "model.json").string() };
+
+    uint32_t indices[] = { 0, 1, 2 };
+    float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+
+    MeshData mesh {};
+    mesh.AddAttribute(VertexAttribute::INDICES, ByteBuffer(indices, std::size(indices)));
+    mesh.AddAttribute(VertexAttribute::POSITIONS, ByteBuffer(positions, std::size(positions)));
+
+    uint8_t pixels[2 * 2 * 4] {};
+    auto png = SaveImageToPNG(Image(ByteBuffer(pixels, std::size(pixels)), 2, 2));
+
+    Material material {};
+    material.AddParameter(MaterialConstants::BASE_TEXTURE, texture_handle);
+
+    Model model {};
+    model.nodes.emplace_back(Model::Node { glm::mat4(1.0f), {} });
+    model.materials.emplace_back(std::make_shared<const Material>(material));
+
+    bool written = true;
+    for (uint32_t i = 0; i < mesh_count; i++)
+    {
+        // The first is triangle.bin, so tests can find it
+        auto name = i == 0 ? std::string("triangle.bin") : "triangle" + std::to_string(i) + ".bin";
+        ResourceHandle<Mesh> mesh_handle { (directory / name).string() };
+        model.nodes[0].mesh_material_indices.emplace_back(i, 0);
+        model.meshes.emplace_back(mesh_handle);
+        written &= FileIO::WriteFileAtomic(mesh_handle.path, [&](std::ostream& out) { BinarySaver { out }(mesh); });
+    }
+
+    written &= png.has_value();
+    written &= FileIO::WriteFileAtomic(texture_handle.path, [&](std::ostream& out)
+        { out.write(png->GetView<char>().begin(), png->GetView<char>().count()); });
+    written &= FileIO::WriteFileAtomic(model_handle.path, [&](std::ostream& out) { JSONSaver { out }(model); });
+
+    if (!written)
+    {
+        throw;
+    }
+
+    return model_handle;
+}
+
+// Stream that throws everything away, so logging can be measured without a console
+class NullBuffer : public std::streambuf
+{
+protected:
+    int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+}
+
+void KS::Tests::TestHeadlessScene()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSHeadlessScene";
+    ResourceHandle<Model> model_handle = WriteTriangleModel(directory);
+    ResourceHandle<Mesh> mesh_handle { (directory / "triangle.bin").string() };
+
+    Device device { DeviceInitParams {} };
+    entt::registry world {};
+    Scene scene { device, world };
+
+    std::vector<entt::entity> entities {};
+    for (int i = 0; i < 3; i++)
+    {
+        auto spawned = scene.SpawnModel(model_handle, glm::translate(glm::mat4(1.0f), glm::vec3(float(i), 0.0f, 0.0f)), "Triangle");
+        entities.insert(entities.end(), spawned.begin(), spawned.end());
+    }
+
+    if (entities.size() != 3)
+    {
+        throw;
+    }
+
+    // First frame loads the mesh and texture once for all three draws
+    RenderSnapshot snapshot {};
+    device.GetCounters().Reset();
+    device.NewFrame();
+    scene.ExtractSnapshot(snapshot, 1.0f);
+    scene.Tick(device, snapshot);
+
+    const auto& draw_sets = scene.GetDrawSets();
+    if (scene.GetModelCount() != 3 || draw_sets.size() != 3 || draw_sets[0].mesh != draw_sets[2].mesh
+        || draw_sets[0].baseTex != draw_sets[2].baseTex || draw_sets[0].baseTex->GetWidth() != 2)
+    {
+        throw;
+    }
+
+    const auto* matrices = static_cast<const ModelMat*>(scene.GetStorageBuffer(MODEL_MAT_BUFFER)->GetRawResource());
+    for (size_t i = 0; i < snapshot.draws.size(); i++)
+    {
+        if (matrices[i].mModel != snapshot.draws[i].transform)
+        {
+            throw;
+        }
+    }
+
+    // Mesh attributes, texture, draw data and lights
+    if (device.GetCounters().uploads != 2 + 1 + 2 + 3 || device.GetCounters().frames != 1)
+    {
+        throw;
+    }
+
+    // The model renderer's draws, through the translator the renderer submits with
+    CommandRecorder recorder { 1 };
+    ModelRenderer::DrawInputs draw_inputs {};
+    draw_inputs.meshInputFlags = Shader::HAS_POSITIONS | Shader::HAS_NORMALS | Shader::HAS_UVS | Shader::HAS_TANGENTS;
+    ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+
+    device.GetCounters().Reset();
+    DeviceCommandTranslator translator { device };
+    auto stats = recorder.Submit(translator);
+
+    // The shared vertex and index buffers are bound once, the attributes and textures the mesh lacks not at all
+    if (stats.skipped != 4 || device.GetCounters().draws != 3 || device.GetCounters().binds != 3 + 2 + 3
+        || device.GetCounters().barriers != 3)
+    {
+        throw;
+    }
+
+    // Later frames only upload the draw data, moved entities included
+    world.get<ComponentWorldTransform>(entities[1]).matrix[3].y = 5.0f;
+
+    device.GetCounters().Reset();
+    device.NewFrame();
+    scene.ExtractSnapshot(snapshot, 1.0f);
+    scene.Tick(device, snapshot);
+
+    bool moved = false;
+    for (size_t i = 0; i < snapshot.draws.size(); i++)
+    {
+        moved |= matrices[i].mModel[3].y == 5.0f;
+    }
+
+    if (!moved || device.GetCounters().uploads != 2)
+    {
+        throw;
+    }
+
+    // Calls made while capturing build the same scene again when replayed
+    FrameCapture capture {};
+    scene.SetCapture(&capture);
+    scene.SpawnModel(model_handle, glm::mat4(1.0f), "Captured");
+    scene.QueuePointLight(glm::vec3(1.0f), glm::vec3(1.0f), 2.0f, 4.0f);
+    scene.SetCapture(nullptr);
+
+    entt::registry replay_world {};
+    Scene replay_scene { device, replay_world };
+    replay_scene.Replay(device, capture.GetFrames()[0]);
+
+    if (capture.GetFrames()[0].calls.size() != 2 || replay_world.view<ComponentWorldTransform>().size() != 1)
+    {
+        throw;
+    }
+
+    // Broken files are skipped on reload, the scene keeps drawing what it had
+    std::string mesh_bytes {};
+    if (auto file = FileIO::ReadFile(mesh_handle.path))
+        mesh_bytes.assign(reinterpret_cast<const char*>(file->GetData()), file->GetSize() / 2);
+
+    FileIO::WriteFileAtomic(mesh_handle.path, [&](std::ostream& out) { out << mesh_bytes; });
+    FileIO::WriteFileAtomic(model_handle.path, [](std::ostream& out) { out << "{ \"broken\""; });
+    scene.ReloadAssets(device, ReloadedAssets { { model_handle }, { mesh_handle }, {} });
+
+    device.NewFrame();
+    scene.ExtractSnapshot(snapshot, 1.0f);
+    scene.Tick(device, snapshot);
+
+    // The three triangles and the captured one
+    if (scene.GetModelCount() != 4 || scene.GetDrawSets()[0].mesh->GetAttribute(VertexAttribute::INDICES) == nullptr)
+    {
+        throw;
+    }
+
+    // Every mesh that loads moves the ones loaded before it, the draw sets of a model with several still point at live ones
+    {
+        entt::registry multi_world {};
+        Scene multi_scene { device, multi_world };
+        multi_scene.SpawnModel(WriteTriangleModel(directory / "multi", 5), glm::mat4(1.0f), "Multi");
+
+        device.NewFrame();
+        multi_scene.ExtractSnapshot(snapshot, 1.0f);
+        multi_scene.Tick(device, snapshot);
+
+        const auto& multi_sets = multi_scene.GetDrawSets();
+        if (multi_sets.size() != 5)
+        {
+            throw;
+        }
+
+        for (size_t i = 0; i < multi_sets.size(); i++)
+        {
+            const StorageBuffer* indices = multi_sets[i].mesh->GetAttribute(VertexAttribute::INDICES);
+            if (indices == nullptr || indices->GetElementCount() != 3 || (i > 0 && multi_sets[i].mesh == multi_sets[i - 1].mesh))
+            {
+                throw;
+            }
+        }
+
+        device.GetCounters().Reset();
+        ModelRenderer::RecordDraws(recorder, multi_scene, draw_inputs);
+        recorder.Submit(translator);
+        if (device.GetCounters().draws != 5)
+        {
+            throw;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+void KS::Tests::TestAllocationCounter()
+{
+    // The compiler may drop a new and delete pair that nothing observes
+    static void* volatile escape = nullptr;
+
+    AllocationScope scope {};
+
+    auto* value = new int(5);
+    auto* aligned = new glm::vec4[4];
+    escape = value;
+    escape = aligned;
+    delete value;
+    delete[] aligned;
+
+    struct alignas(64) CacheLine
+    {
+        char data[64];
+    };
+
+    auto* line = new CacheLine();
+    escape = line;
+    if (reinterpret_cast<uintptr_t>(line) % 64 != 0)
+    {
+        throw;
+    }
+    delete line;
+
+    auto stats = scope.GetStats();
+    if (escape != line || stats.allocations != 3 || stats.frees != 3 || stats.bytes < sizeof(int) + sizeof(glm::vec4) * 4 + 64)
+    {
+        throw;
+    }
+}
+
+void KS::Tests::TestSteadyStateFrame()
+{
+    // Setup may allocate as much as it wants
+    auto directory = std::filesystem::temp_directory_path() / "KSSteadyStateFrame";
+    ResourceHandle<Model> model_handle = WriteTriangleModel(directory);
+
+    Device device { DeviceInitParams {} };
+    EntityComponentSystem ecs {};
+    Scene scene { device, ecs.GetWorld() };
+    CommandRecorder recorder { 0 };
+    DeviceCommandTranslator translator { device };
+    RenderSnapshot snapshot {};
+
+    ModelRenderer::DrawInputs draw_inputs {};
+    draw_inputs.meshInputFlags = Shader::HAS_POSITIONS | Shader::HAS_NORMALS | Shader::HAS_UVS | Shader::HAS_TANGENTS;
+
+    for (int i = 0; i < 16; i++)
+    {
+        scene.SpawnModel(model_handle, glm::translate(glm::mat4(1.0f), glm::vec3(float(i), 0.0f, 0.0f)), "Triangle");
+    }
+
+    // Moves every model each step, the way game systems do
+    ecs.AddSystem("Bob", SystemAccess {}.Write<ComponentWorldTransform>(), [](entt::registry& registry, float dt)
+    {
+        for (auto [entity, transform] : registry.view<ComponentWorldTransform>().each())
+            transform.matrix[3].y += dt * 0.001f;
+    });
+
+    FileWatcherSettings watcher_settings {};
+    watcher_settings.poll_interval = std::chrono::hours(1);
+    FileWatcher watcher { watcher_settings };
+    watcher.Watch(directory);
+
+    NullBuffer null_buffer {};
+    std::ostream null_stream { &null_buffer };
+    auto* previous_output = Log::detail::output;
+    Log::detail::output = &null_stream;
+
+    // The application's frame on the null device: reloads, fixed steps, extraction, upload, recording and submission
+    auto Frame = [&](uint32_t frame_index)
+    {
+        device.NewFrame();
+        watcher.PollChanges();
+
+        float alpha = ecs.Update(16.0f);
+        scene.ExtractSnapshot(snapshot, alpha);
+        scene.Tick(device, snapshot);
+
+        ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+        auto stats = recorder.Submit(translator);
+        device.EndFrame();
+
+        LOG(Log::Severity::INFO, "Frame {} submitted {} packets", frame_index, stats.packets);
+    };
+
+    // Warm up, caches and arenas grow to their steady state size
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        Frame(i);
+    }
+
+    AllocationScope scope {};
+    for (uint32_t i = 4; i < 104; i++)
+    {
+        Frame(i);
+    }
+    auto stats = scope.GetStats();
+
+    Log::detail::output = previous_output;
+    std::filesystem::remove_all(directory);
+
+    if (scene.GetModelCount() != 16 || device.GetCounters().draws == 0)
+    {
+        throw;
+    }
+
+    if (stats.allocations != 0)
+    {
+        LOG(Log::Severity::WARN, "Steady state frames made {} allocations ({} bytes)", stats.allocations, stats.bytes);
+        throw;
+    }
+}
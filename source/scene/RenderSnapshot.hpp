@@ -0,0 +1,27 @@
+#pragma once
+#include <fileio/ResourceHandle.hpp>
+#include <resources/Material.hpp>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace KS
+{
+
+class Mesh;
+
+// Everything the renderer needs from the world for one frame, copied out so the world can move on while the frame
+// is recorded. Snapshots are reused between frames, so the vectors keep their capacity.
+struct RenderSnapshot
+{
+    struct Draw
+    {
+        ResourceHandle<Mesh> mesh {};
+        MaterialInstance material {};
+        glm::mat4 transform = glm::mat4(1.0f); // Already interpolated
+    };
+
+    std::vector<Draw> draws {};
+};
+
+}
@@ -1,58 +1,88 @@
 #include <scene/Scene.hpp>
 
-#include <renderer/Shader.hpp>
-#include <renderer/ShaderInputCollection.hpp>
-#include <renderer/DX12/Helpers/DXResource.hpp>
-#include <renderer/DX12/Helpers/DXCommandList.hpp>
-#include <renderer/DX12/Helpers/DX12Conversion.hpp>
-
-#include <DXR/DXRHelper.h>
-#include <DXR/nv_helpers_dx12/TopLevelASGenerator.h>
-#include <DXR/nv_helpers_dx12/BottomLevelASGenerator.h>
-#include <DXR/nv_helpers_dx12/RaytracingPipelineGenerator.h>
-#include <DXR/nv_helpers_dx12/RootSignatureGenerator.h>
-#include <DXR/nv_helpers_dx12/ShaderBindingTableGenerator.h>
-
+#include <components/ComponentMeshRenderer.hpp>
+#include <components/ComponentName.hpp>
+#include <components/ComponentWorldTransform.hpp>
+#include <containers/LinearArena.hpp>
 #include <device/Device.hpp>
+#include <ecs/FixedTimestep.hpp>
+#include <fileio/FileIO.hpp>
+#include <fileio/MemoryStream.hpp>
 #include <renderer/StorageBuffer.hpp>
 #include <renderer/UniformBuffer.hpp>
+#include <resources/AssetReloader.hpp>
 #include <resources/Model.hpp>
+#include <tools/FrameCapture.hpp>
 #include <resources/Texture.hpp>
 #include <resources/Image.hpp>
 #include <resources/Mesh.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-namespace KS
+#include <algorithm>
+
+namespace
+{
+
+// Malformed files (a hot reload can catch one half written) are logged and skipped, callers keep what they had
+std::optional<KS::MeshData> ReadMeshData(const std::string& path)
+{
+    if (auto fileread = KS::FileIO::ReadFile(path))
+    {
+        try
+        {
+            KS::MemoryReadStream stream{fileread->GetBytes()};
+            KS::BinaryLoader bin{stream};
+            KS::MeshData data{};
+
+            bin(data);
+            return data;
+        }
+        catch (const cereal::Exception& e)
+        {
+            LOG(Log::Severity::WARN, "Could not parse mesh {}: {}", path, e.what());
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<KS::Model> ReadModel(const std::string& path)
 {
-struct Scene::Impl
+    if (auto fileread = KS::FileIO::ReadFile(path))
+    {
+        try
+        {
+            KS::MemoryReadStream stream{fileread->GetBytes()};
+            KS::JSONLoader json{stream};
+            KS::Model model{};
+
+            json(model);
+            return model;
+        }
+        catch (const cereal::Exception& e)
+        {
+            LOG(Log::Severity::WARN, "Could not parse model {}: {}", path, e.what());
+        }
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<KS::Texture> ReadTexture(KS::Device& device, const std::string& path)
 {
-public:
-    Impl();
-    ~Impl();
-    struct ASBuffers
+    if (auto fileread = KS::FileIO::ReadFile(path))
     {
-        std::shared_ptr<DXResource> pScratch[2] = {nullptr, nullptr};
-        std::shared_ptr<DXResource> pResult[2] = {nullptr, nullptr};
-        std::shared_ptr<DXResource> pInstanceDesc[2] = {nullptr, nullptr};
-    };
-
-    ASBuffers m_BLBuffers[200];
-    std::pair<std::shared_ptr<DXResource>, DirectX::XMMATRIX> m_instances[200];
-    ASBuffers m_topLevelASBuffers;
-    int m_BLCount = 0;
-    DXHeapHandle m_BHVHandle[2];
-    bool m_updateBVH = false;
-
-    ComPtr<ID3D12RootSignature> m_raytracingSignature;
-
-    nv_helpers_dx12::TopLevelASGenerator m_topLevelASGenerator;
-    nv_helpers_dx12::ShaderBindingTableGenerator m_sbtHelper[2];
-};
-}  // namespace KS
-
-KS::Scene::Scene(const Device& device)
+        if (auto img = KS::LoadImageFileFromMemory(fileread->GetData(), fileread->GetSize()))
+        {
+            return std::make_shared<KS::Texture>(device, img.value());
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+KS::Scene::Scene(const Device& device, entt::registry& world)
+    : m_world(world)
 {
-    m_impl = std::make_unique<Impl>();
     m_pointLights = std::vector<PointLightInfo>(100);
     m_directionalLights = std::vector<DirLightInfo>(100);
 
@@ -62,6 +92,13 @@ KS::Scene::Scene(const Device& device)
         device, "MATERIAL INFO RESOURCE", &m_materialInstances[0], sizeof(MaterialInfo), 200, false);
     mUniformBuffers[MODEL_INDEX_BUFFER] = std::make_unique<UniformBuffer>(device, "MODEL INDEX BUFFER", m_modelCount, 200, false);
 
+    // Draws are numbered in extraction order, so slot i always holds index i
+    for (int32_t i = 0; i < MAX_DRAWS; i++) mUniformBuffers[MODEL_INDEX_BUFFER]->Update(device, i, i);
+
+    // Owning both component pools packs the drawn entities at the front of each, in the same order,
+    // so extraction walks two plain arrays
+    m_world.group<ComponentWorldTransform, ComponentMeshRenderer>();
+
     m_fogInfo.fogColor = glm::vec3(1.f, 1.f, 1.f);
     m_fogInfo.fogDensity = 0.6f;
     m_fogInfo.exposure = 0.15f;
@@ -77,156 +114,208 @@ KS::Scene::Scene(const Device& device)
     mStorageBuffers[KS::POINT_LIGHT_BUFFER] =
         std::make_unique<StorageBuffer>(device, "POINT LIGHT BUFFER", m_pointLights, false);
 
+    CreateAccelerationStructures(device);
 }
 
-KS::Scene::~Scene() {}
+KS::Scene::~Scene() { DestroyAccelerationStructures(); }
 
-void KS::Scene::QueueModel(Device& device, ResourceHandle<Model> model, const glm::mat4& transform, std::string name)
+std::vector<entt::entity> KS::Scene::SpawnModel(const ResourceHandle<Model>& model, const glm::mat4& transform,
+                                                std::string_view name)
 {
-    if (auto* ptr = GetModel(model))
+    if (m_capture) m_capture->Record(SpawnModelCall{model, transform, std::string(name)});
+
+    std::vector<entt::entity> entities{};
+
+    auto* ptr = GetModel(model);
+    if (ptr == nullptr)
     {
-        for (auto node : ptr->nodes)
-        {
-            auto scene_transform = transform * node.transform;
+        LOG(Log::Severity::WARN, "Could not load model {}", model.path);
+        return entities;
+    }
 
-            for (auto [mesh, material] : node.mesh_material_indices)
-            {
-                if (m_modelCount >= 200)
-                {
-                    LOG(Log::Severity::WARN, "Maximum number of meshes {} has been reached. Command ignored.", 200);
-                    return;
-                }
-
-                draw_queue[name] = KS::DrawEntry(ptr->meshes[mesh], ptr->materials[material], m_modelCount, scene_transform);
-
-                auto mat = ptr->materials[material];
-                auto meshHandle = ptr->meshes[mesh];
-
-                ModelMat modelMat;
-                modelMat.mModel = scene_transform;
-                modelMat.mTransposed = glm::transpose(modelMat.mModel);
-                m_modelMatrices[m_modelCount] = modelMat;
-
-                MaterialInfo matInfo = GetMaterialInfo(ptr->materials[material]);
-                auto baseTex =
-                    GetTexture(device, *mat.GetParameter<ResourceHandle<Texture>>(MaterialConstants::BASE_TEXTURE_NAME));
-                auto normalTex =
-                    GetTexture(device, *mat.GetParameter<ResourceHandle<Texture>>(MaterialConstants::NORMAL_TEXTURE_NAME));
-                auto emissiveTex =
-                    GetTexture(device, *mat.GetParameter<ResourceHandle<Texture>>(MaterialConstants::EMISSIVE_TEXTURE_NAME));
-                auto roughMetTex =
-                    GetTexture(device, *mat.GetParameter<ResourceHandle<Texture>>(MaterialConstants::METALLIC_TEXTURE_NAME));
-                auto occlusionTex =
-                    GetTexture(device, *mat.GetParameter<ResourceHandle<Texture>>(MaterialConstants::OCCLUSION_TEXTURE_NAME));
-
-                matInfo.useColorTex = baseTex != nullptr;
-                matInfo.useEmissiveTex = emissiveTex != nullptr;
-                matInfo.useNormalTex = normalTex != nullptr;
-                matInfo.useOcclusionTex = occlusionTex != nullptr;
-                matInfo.useMetallicRoughnessTex = roughMetTex != nullptr;
-
-                mUniformBuffers[MODEL_INDEX_BUFFER]->Update(device, m_modelCount, m_modelCount);
-
-                m_materialInstances[m_modelCount] = matInfo;
-                m_modelCount++;
-            }
+    for (const auto& node : ptr->nodes)
+    {
+        for (auto [mesh, material] : node.mesh_material_indices)
+        {
+            auto entity = m_world.create();
+            auto world_transform = transform * node.transform;
+            m_world.emplace<ComponentWorldTransform>(entity, world_transform, world_transform);
+            m_world.emplace<ComponentMeshRenderer>(entity, ptr->meshes[mesh], MaterialInstance{ptr->materials[material]});
+            m_world.emplace<ComponentName>(entity, std::string(name));
+            entities.emplace_back(entity);
         }
     }
 
-    mStorageBuffers[MODEL_MAT_BUFFER]->Update(device, &m_modelMatrices[0], m_modelCount);
-    mStorageBuffers[MATERIAL_INFO_BUFFER]->Update(device, &m_materialInstances[0], m_modelCount);
-    mUniformBuffers[LIGHT_INFO_BUFFER]->Update(device, m_lightInfo);
-    mStorageBuffers[DIR_LIGHT_BUFFER]->Update(device, m_directionalLights);
-    mStorageBuffers[POINT_LIGHT_BUFFER]->Update(device, m_pointLights);
-}
-
-void KS::Scene::ApplyModelTransform(Device& device, std::string name, const glm::mat4& transfrom)
-{ 
-    auto& entry = draw_queue[name];
-    ModelMat modelMat;
-    modelMat.mModel = m_modelMatrices[entry.modelIndex].mModel * transfrom;
-    modelMat.mTransposed = glm::transpose(modelMat.mModel);
-    m_modelMatrices[entry.modelIndex] = modelMat;
+    return entities;
 }
 
 void KS::Scene::QueuePointLight(glm::vec3 position, glm::vec3 color, float intensity, float radius)
 {
+    if (m_capture) m_capture->Record(PointLightCall{position, color, intensity, radius});
+
     PointLightInfo pLight;
     pLight.mColorAndIntensity = glm::vec4(color, intensity);
     pLight.mPosition = glm::vec4(position, 0.f);
     pLight.mRadius = radius;
     m_pointLights[m_lightInfo.numPointLights] = pLight;
     m_lightInfo.numPointLights++;
-    
+    m_lightsChanged = true;
 }
 void KS::Scene::QueueDirectionalLight(glm::vec3 direction, glm::vec3 color, float intensity)
 {
+    if (m_capture) m_capture->Record(DirectionalLightCall{direction, color, intensity});
+
     DirLightInfo dLight;
     dLight.mDir = glm::vec4(direction, 0.f);
     dLight.mColorAndIntensity = glm::vec4(color, intensity);
     m_directionalLights[m_lightInfo.numDirLights] = dLight;
     m_lightInfo.numDirLights++;
+    m_lightsChanged = true;
 }
 
 void KS::Scene::SetAmbientLight(glm::vec3 color, float intensity)
 {
+    if (m_capture) m_capture->Record(AmbientLightCall{color, intensity});
+
     m_lightInfo.mAmbientAndIntensity = glm::vec4(color, intensity);
+    m_lightsChanged = true;
 }
 
 void KS::Scene::SetFogValues(Device& device, const FogInfo& newFogInfo)
 { 
+    if (m_capture) m_capture->Record(FogCall{newFogInfo});
+
     m_fogInfo = newFogInfo;
     mUniformBuffers[KS::FOG_INFO_BUFFER]->Update(device, m_fogInfo);
 }
 
-void KS::Scene::Tick(Device& device)
+void KS::Scene::Replay(Device& device, const CapturedFrame& frame)
+{
+    for (const SceneCall& call : frame.calls)
+    {
+        if (auto* spawn = std::get_if<SpawnModelCall>(&call))
+            SpawnModel(spawn->model, spawn->transform, spawn->name);
+        else if (auto* point = std::get_if<PointLightCall>(&call))
+            QueuePointLight(point->position, point->color, point->intensity, point->radius);
+        else if (auto* directional = std::get_if<DirectionalLightCall>(&call))
+            QueueDirectionalLight(directional->direction, directional->color, directional->intensity);
+        else if (auto* ambient = std::get_if<AmbientLightCall>(&call))
+            SetAmbientLight(ambient->color, ambient->intensity);
+        else if (auto* fog = std::get_if<FogCall>(&call))
+            SetFogValues(device, fog->fog);
+    }
+}
+
+void KS::Scene::ExtractSnapshot(RenderSnapshot& snapshot, float alpha) const
 {
-    if (!m_impl->m_updateBVH)
+    // One pass over the packed pools, nothing is resolved here since that needs the device
+    auto group = m_world.group<ComponentWorldTransform, ComponentMeshRenderer>();
+    snapshot.draws.resize(group.size());
+
+    size_t i = 0;
+    for (auto [entity, transform, renderer] : group.each())
     {
-        memset(m_impl->m_BLBuffers, 0, 200 * sizeof(Impl::ASBuffers));
-        m_impl->m_BLCount = 0;
+        auto& draw = snapshot.draws[i++];
+        draw.mesh = renderer.mesh;
+        draw.material = renderer.material;
+
+        // Most entities did not move during the last step, those skip the blend
+        if (alpha < 1.0f && transform.previous != transform.matrix)
+            draw.transform = InterpolateTransform(transform.previous, transform.matrix, alpha);
+        else
+            draw.transform = transform.matrix;
     }
+}
+
+void KS::Scene::Tick(Device& device, const RenderSnapshot& snapshot)
+{
+    UploadDrawData(device, snapshot);
+    if (m_lightsChanged) UploadLights(device);
+    UpdateAccelerationStructures(device);
+}
 
-    int i =0;
-    auto cpuFrameIndex = device.GetCPUFrameIndex();
-    for (const auto& draw_entry : draw_queue)
+void KS::Scene::UploadDrawData(Device& device, const RenderSnapshot& snapshot)
+{
+    m_drawSets.clear();
+    m_modelCount = 0;
+
+    if (snapshot.draws.size() > MAX_DRAWS)
     {
-        const Mesh* mesh = GetMesh(device, draw_entry.second.mesh);
-        auto baseTex = GetTexture(
-            device, *draw_entry.second.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::BASE_TEXTURE_NAME));
+        LOG(Log::Severity::WARN, "Maximum number of meshes {} has been reached, {} are not drawn.", MAX_DRAWS,
+            snapshot.draws.size() - MAX_DRAWS);
+    }
 
-        if (mesh == nullptr || baseTex == nullptr) continue;
+    // Meshes live densely in a slot map that moves them when it grows, so every mesh of the frame is loaded
+    // before the draw sets take pointers to them
+    size_t drawCount = std::min<size_t>(snapshot.draws.size(), MAX_DRAWS);
+    m_drawMeshKeys.resize(drawCount);
+    for (size_t i = 0; i < drawCount; i++)
+    {
+        m_drawMeshKeys[i] = LoadMesh(device, snapshot.draws[i].mesh);
+    }
 
-        CreateBVHBotomLevelInstance(device, draw_entry.second, m_impl->m_updateBVH, i, cpuFrameIndex);
-        i++;
+    // Everything the renderer and the BVH need this frame is resolved here
+    for (size_t i = 0; i < drawCount; i++)
+    {
+        const auto& draw = snapshot.draws[i];
+
+        MeshSet meshSet;
+        meshSet.mesh = meshes.Get(m_drawMeshKeys[i]);
+        meshSet.meshKey = m_drawMeshKeys[i];
+        meshSet.baseTex = GetTexture(device, draw.material, MaterialConstants::BASE_TEXTURE);
+        if (meshSet.mesh == nullptr || meshSet.baseTex == nullptr) continue;
+
+        meshSet.normalTex = GetTexture(device, draw.material, MaterialConstants::NORMAL_TEXTURE);
+        meshSet.emissiveTex = GetTexture(device, draw.material, MaterialConstants::EMISSIVE_TEXTURE);
+        meshSet.roughMetTex = GetTexture(device, draw.material, MaterialConstants::METALLIC_TEXTURE);
+        meshSet.occlusionTex = GetTexture(device, draw.material, MaterialConstants::OCCLUSION_TEXTURE);
+        meshSet.modelIndex = m_modelCount;
+
+        MaterialInfo matInfo = GetMaterialInfo(draw.material);
+        matInfo.useColorTex = true;
+        matInfo.useEmissiveTex = meshSet.emissiveTex != nullptr;
+        matInfo.useNormalTex = meshSet.normalTex != nullptr;
+        matInfo.useOcclusionTex = meshSet.occlusionTex != nullptr;
+        matInfo.useMetallicRoughnessTex = meshSet.roughMetTex != nullptr;
+
+        m_modelMatrices[m_modelCount] = ModelMat{draw.transform, glm::transpose(draw.transform)};
+        m_materialInstances[m_modelCount] = matInfo;
+        m_drawSets.emplace_back(std::move(meshSet));
+        m_modelCount++;
     }
-    CreateTopLevelAS(device, m_impl->m_updateBVH, cpuFrameIndex);
+
+    if (m_modelCount == 0) return;
 
     mStorageBuffers[MODEL_MAT_BUFFER]->Update(device, &m_modelMatrices[0], m_modelCount);
+    mStorageBuffers[MATERIAL_INFO_BUFFER]->Update(device, &m_materialInstances[0], m_modelCount);
+}
+
+void KS::Scene::UploadLights(Device& device)
+{
+    mUniformBuffers[LIGHT_INFO_BUFFER]->Update(device, m_lightInfo);
+    mStorageBuffers[DIR_LIGHT_BUFFER]->Update(device, m_directionalLights);
+    mStorageBuffers[POINT_LIGHT_BUFFER]->Update(device, m_pointLights);
+    m_lightsChanged = false;
 }
 
-const KS::Mesh* KS::Scene::GetMesh(const Device& device, ResourceHandle<Mesh> mesh)
+KS::SlotMap<KS::Mesh>::Key KS::Scene::LoadMesh(const Device& device, const ResourceHandle<Mesh>& mesh)
 {  // Cached result
-    if (auto it = mesh_cache.find(mesh); it != mesh_cache.end())
+    if (auto it = mesh_keys.find(mesh); it != mesh_keys.end())
     {
-        return &it->second;
+        return it->second;
     }
 
     // Load result
-    else if (auto fileread = FileIO::OpenReadStream(mesh.path))
+    else if (auto data = ReadMeshData(mesh.path))
     {
-        BinaryLoader bin{fileread.value()};
-        MeshData data{};
-
-        bin(data);
-
-        auto [it, success] = mesh_cache.emplace(mesh, Mesh(device, data));
-        return &it->second;
+        auto key = meshes.Emplace(device, data.value());
+        mesh_keys.emplace(mesh, key);
+        return key;
     }
-    return nullptr;
+    return SlotMap<Mesh>::NULL_KEY;
 }
 
-const KS::Model* KS::Scene::GetModel(ResourceHandle<Model> model)
+const KS::Model* KS::Scene::GetModel(const ResourceHandle<Model>& model)
 {
     // Cached result
     if (auto it = model_cache.find(model); it != model_cache.end())
@@ -235,258 +324,128 @@ const KS::Model* KS::Scene::GetModel(ResourceHandle<Model> model)
     }
 
     // Load result
-    else if (auto fileread = FileIO::OpenReadStream(model.path))
+    else if (auto new_model = ReadModel(model.path))
     {
-        JSONLoader json{fileread.value()};
-        Model new_model{};
-
-        json(new_model);
-
-        auto [it, success] = model_cache.emplace(model, std::move(new_model));
+        auto [it, success] = model_cache.emplace(model, std::move(new_model.value()));
         return &it->second;
     }
     return nullptr;
 }
 
-std::shared_ptr<KS::Texture> KS::Scene::GetTexture(Device& device, ResourceHandle<Texture> imgPath)
+std::shared_ptr<KS::Texture> KS::Scene::GetTexture(Device& device, const ResourceHandle<Texture>& imgPath)
 {
     // Cached result
-    if (auto it = tex_cache.find(imgPath); it != tex_cache.end())
+    if (auto it = texture_keys.find(imgPath); it != texture_keys.end())
     {
-        return it->second;
+        return *textures.Get(it->second);
     }
 
     // Load result
-    else if (auto fileread = FileIO::OpenReadStream(imgPath.path))
+    else if (auto new_tex = ReadTexture(device, imgPath.path))
     {
-        auto imageContents = FileIO::DumpFullStream(fileread.value());
-
-        if (auto img = LoadImageFileFromMemory(imageContents.data(), imageContents.size()))
-        {
-            auto new_tex = std::make_shared<Texture>(device, img.value());
-            auto [it, success] = tex_cache.emplace(imgPath, std::move(new_tex));
-            return it->second;
-        }
+        texture_keys.emplace(imgPath, textures.Insert(new_tex));
+        return new_tex;
     }
     return nullptr;
 }
 
-KS::MaterialInfo KS::Scene::GetMaterialInfo(const Material& material) const
-{
-    MaterialInfo info{};
-    info.colorFactor = material.GetParameter<glm::vec4>(MaterialConstants::BASE_COLOUR_FACTOR_NAME)
-                           ? *material.GetParameter<glm::vec4>(MaterialConstants::BASE_COLOUR_FACTOR_NAME)
-                           : MaterialConstants::BASE_COLOUR_FACTOR_DEFAULT;
-    glm::vec4 NEAFactor = material.GetParameter<glm::vec4>(MaterialConstants::NEA_FACTORS_NAME)
-                              ? *material.GetParameter<glm::vec4>(MaterialConstants::NEA_FACTORS_NAME)
-                              : MaterialConstants::NEA_FACTORS_DEFAULT;
-    glm::vec4 ORMFactor = material.GetParameter<glm::vec4>(MaterialConstants::ORM_FACTORS_NAME)
-                              ? *material.GetParameter<glm::vec4>(MaterialConstants::ORM_FACTORS_NAME)
-                              : MaterialConstants::ORM_FACTORS_DEFAULT;
-
-    info.emissiveFactor = glm::vec4(NEAFactor.y, NEAFactor.y, NEAFactor.y, 1.f);
-    info.normalScale = NEAFactor.x;
-    info.metallicFactor = ORMFactor.z;
-    info.normalScale = NEAFactor.x;
-    info.roughnessFactor = ORMFactor.y;
-    return info;
-}
-
-KS::MeshSet KS::Scene::GetMeshSet(Device& device, int index)
+std::shared_ptr<KS::Texture> KS::Scene::GetTexture(Device& device, const MaterialInstance& material, MaterialParameterID texture)
 {
-    auto draw_entry = (*std::next(draw_queue.begin(), index)).second;
-
-    MeshSet meshSet;
-    meshSet.mesh = GetMesh(device, draw_entry.mesh);
-    meshSet.baseTex = GetTexture(
-        device, *draw_entry.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::BASE_TEXTURE_NAME));
-    meshSet.normalTex = GetTexture(
-        device, *draw_entry.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::NORMAL_TEXTURE_NAME));
-    meshSet.emissiveTex = GetTexture(
-        device, *draw_entry.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::EMISSIVE_TEXTURE_NAME));
-    meshSet.roughMetTex = GetTexture(
-        device, *draw_entry.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::METALLIC_TEXTURE_NAME));
-    meshSet.occlusionTex = GetTexture(
-        device, *draw_entry.material.GetParameter<ResourceHandle<Texture>>(MaterialConstants::OCCLUSION_TEXTURE_NAME));
-    meshSet.modelIndex = draw_entry.modelIndex;
-
-    return meshSet;
+    auto* handle = material.GetParameter<ResourceHandle<Texture>>(texture);
+    return handle ? GetTexture(device, *handle) : nullptr;
 }
 
-void KS::Scene::CreateBottomLevelAS(const Device& device, const Mesh* mesh, int cpuFrame)
+void KS::Scene::ReloadAssets(Device& device, const ReloadedAssets& assets)
 {
-    nv_helpers_dx12::BottomLevelASGenerator bottomLevelASGen;
-    DXCommandList* commandList = reinterpret_cast<DXCommandList*>(device.GetCommandList());
-    ID3D12Device5* engineDevice = static_cast<ID3D12Device5*>(device.GetDevice());
-
-    using namespace MeshConstants;
-    auto positions = mesh->GetAttribute(ATTRIBUTE_POSITIONS_NAME);
-    auto positionsResource = reinterpret_cast<DXResource*>(positions->GetRawResource());
-    auto indices = mesh->GetAttribute(ATTRIBUTE_INDICES_NAME);
-    auto indicesResource = reinterpret_cast<DXResource*>(indices->GetRawResource());
-
-    commandList->ResourceBarrier(*positionsResource->Get(), positionsResource->GetState(),
-                                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-    positionsResource->ChangeState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-    commandList->ResourceBarrier(*indicesResource->Get(), indicesResource->GetState(),
-                                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-    indicesResource->ChangeState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-
-    DXGI_FORMAT indexFormat;
-    switch (indices->GetBufferStride())
-    {
-        case sizeof(unsigned char):
-            indexFormat = DXGI_FORMAT_R8_UINT;
-            break;
-        case sizeof(unsigned short):
-            indexFormat = DXGI_FORMAT_R16_UINT;
-            break;
-        case sizeof(unsigned int):
-            indexFormat = DXGI_FORMAT_R32_UINT;
-            break;
-        default:
-            indexFormat = DXGI_FORMAT_R16_UINT;
-            break;
-    }
-
-    bottomLevelASGen.AddVertexBuffer(positionsResource->Get(), 0, static_cast<uint32_t>(positions->GetElementCount()),
-                                     sizeof(glm::vec3), indicesResource->Get(), 0,
-                                     static_cast<uint32_t>(indices->GetElementCount()), indexFormat, nullptr, 0, true);
-
-    // The AS build requires some scratch space to store temporary information.
-    // The amount of scratch memory is dependent on the scene complexity.
-    UINT64 scratchSizeInBytes = 0;
-    // The final AS also needs to be stored in addition to the existing vertex
-    // buffers. It size is also dependent on the scene complexity.
-    UINT64 resultSizeInBytes = 0;
+    // Only resources that are already loaded need replacing, everything else is loaded on first use
+    bool affects_scene = false;
+    for (const auto& model : assets.models) affects_scene |= model_cache.contains(model);
+    for (const auto& mesh : assets.meshes) affects_scene |= mesh_keys.contains(mesh);
+    for (const auto& texture : assets.textures) affects_scene |= texture_keys.contains(texture);
 
-    bottomLevelASGen.ComputeASBufferSizes(engineDevice, false, &scratchSizeInBytes, &resultSizeInBytes);
+    if (!affects_scene) return;
 
-    auto bufDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    // Frames in flight may still reference the old buffers and textures
+    device.Flush();
 
-    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-    heapProps.CreationNodeMask = 0;
-    heapProps.VisibleNodeMask = 0;
-
-    m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame] =
-        std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "SCRATCH  BUFFER");
-
-    bufDesc.Width = resultSizeInBytes;
-    m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame] = std::make_shared<DXResource>(
-        engineDevice, heapProps, bufDesc, nullptr, "RESULT  BUFFER", D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
-
-    bottomLevelASGen.Generate(commandList->GetCommandList().Get(),
-                              m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame]->Get(),
-                              m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame]->Get(), false, nullptr);
+    // Resources are loaded before replacing the cached ones, so a broken file keeps the previous version
+    for (const auto& texture : assets.textures)
+    {
+        if (auto it = texture_keys.find(texture); it != texture_keys.end())
+        {
+            if (auto new_tex = ReadTexture(device, texture.path))
+                *textures.Get(it->second) = std::move(new_tex);
+            else
+                LOG(Log::Severity::WARN, "Could not reload texture {}", texture.path);
+        }
+    }
 
-    commandList->TrackResource(m_impl->m_BLBuffers[m_impl->m_BLCount].pScratch[cpuFrame]->GetResource());
-    commandList->TrackResource(m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame]->GetResource());
-}
+    for (const auto& mesh : assets.meshes)
+    {
+        if (auto it = mesh_keys.find(mesh); it != mesh_keys.end())
+        {
+            if (auto data = ReadMeshData(mesh.path))
+                *meshes.Get(it->second) = Mesh(device, data.value());
+            else
+                LOG(Log::Severity::WARN, "Could not reload mesh {}", mesh.path);
+        }
+    }
 
-void KS::Scene::CreateBVHBotomLevelInstance(const Device& device, const DrawEntry& draw_entry, bool updateOnly, int entryIndex,
-                                            int cpuFrame)
-{
-    if (!updateOnly)
+    for (const auto& model : assets.models)
     {
-        const Mesh* mesh = GetMesh(device, draw_entry.mesh);
-        if (!mesh) return;
+        auto it = model_cache.find(model);
+        if (it == model_cache.end()) continue;
 
-        CreateBottomLevelAS(device, mesh, cpuFrame);
+        auto new_model = ReadModel(model.path);
+        if (!new_model)
+        {
+            LOG(Log::Severity::WARN, "Could not reload model {}", model.path);
+            continue;
+        }
 
-        m_impl->m_instances[m_impl->m_BLCount].first = m_impl->m_BLBuffers[m_impl->m_BLCount].pResult[cpuFrame];
-        m_impl->m_instances[m_impl->m_BLCount].second = Conversion::GLMToXMMATRIX(draw_entry.modelMat);
+        it->second = std::move(new_model.value());
 
-        m_impl->m_topLevelASGenerator.AddInstance(m_impl->m_instances[m_impl->m_BLCount].first->Get(),
-                                                  m_impl->m_instances[m_impl->m_BLCount].second,
-                                                  static_cast<uint32_t>(m_impl->m_BLCount), static_cast<uint32_t>(0));
+        // Mesh renderers share the model's materials, point the ones that come from this model at the new ones
+        ScratchScope scratch{};
+        using MeshMaterialPair = std::pair<const ResourceHandle<Mesh>, size_t>;
+        FlatHashMap<ResourceHandle<Mesh>, size_t, std::hash<ResourceHandle<Mesh>>, std::equal_to<ResourceHandle<Mesh>>,
+                    ArenaAllocator<MeshMaterialPair>>
+            mesh_materials{scratch.GetAllocator<MeshMaterialPair>()};
+        for (const auto& node : it->second.nodes)
+        {
+            for (auto [mesh, material] : node.mesh_material_indices)
+            {
+                mesh_materials[it->second.meshes[mesh]] = material;
+            }
+        }
 
-        m_impl->m_BLCount++;
-    }
-    else
-    {
-        m_impl->m_instances[entryIndex].second = Conversion::GLMToXMMATRIX(draw_entry.modelMat);
+        for (auto [entity, renderer] : m_world.view<ComponentMeshRenderer>().each())
+        {
+            if (auto material = mesh_materials.find(renderer.mesh); material != mesh_materials.end())
+            {
+                renderer.material.SetBase(it->second.materials[material->second]);
+            }
+        }
     }
 }
 
-void KS::Scene::CreateTopLevelAS(const Device& device, bool updateOnly, int cpuFrame)
+KS::MaterialInfo KS::Scene::GetMaterialInfo(const MaterialInstance& material) const
 {
-    ID3D12Device5* engineDevice = static_cast<ID3D12Device5*>(device.GetDevice());
-    DXCommandList* commandList = reinterpret_cast<DXCommandList*>(device.GetCommandList());
+    using namespace MaterialConstants;
 
-    if (!updateOnly)
-    {
-        // As for the bottom-level AS, the building the AS requires some scratch space
-        // to store temporary data in addition to the actual AS. In the case of the
-        // top-level AS, the instance descriptors also need to be stored in GPU
-        // memory. This call outputs the memory requirements for each (scratch,
-        // results, instance descriptors) so that the application can allocate the
-        // corresponding memory
-        UINT64 scratchSize, resultSize, instanceDescsSize;
-
-        m_impl->m_topLevelASGenerator.ComputeASBufferSizes(engineDevice, true, &scratchSize, &resultSize, &instanceDescsSize);
-
-        //// Create the scratch and result buffers. Since the build is all done on GPU,
-        //// those can be allocated on the default heap
-
-        auto bufDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
-
-        auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-        heapProps.CreationNodeMask = 0;
-        heapProps.VisibleNodeMask = 0;
-
-        m_impl->m_topLevelASBuffers.pScratch[cpuFrame] =
-            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH SCRATCH");
-        bufDesc.Width = resultSize;
-        m_impl->m_topLevelASBuffers.pResult[cpuFrame] =
-            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH RESULT",
-                                         D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
-
-        // The buffer describing the instances: ID, shader binding information,
-        // matrices ... Those will be copied into the buffer by the helper through
-        // mapping, so the buffer has to be allocated on the upload heap.
-        bufDesc.Width = instanceDescsSize;
-        bufDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-        heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-        heapProps.CreationNodeMask = 0;
-        heapProps.VisibleNodeMask = 0;
-        m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame] =
-            std::make_shared<DXResource>(engineDevice, heapProps, bufDesc, nullptr, "TOP LEVEL BVH DESC");
-
-        commandList->ResourceBarrier(*m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->Get(),
-                                     m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->GetState(),
-                                     D3D12_RESOURCE_STATE_GENERIC_READ);
-        m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->ChangeState(D3D12_RESOURCE_STATE_GENERIC_READ);
-    }
-
-    // After all the buffers are allocated, or if only an update is required, we
-    // can build the acceleration structure. Note that in the case of the update
-    // we also pass the existing AS as the 'previous' AS, so that it can be
-    // refitted in place.
-    m_impl->m_topLevelASGenerator.Generate(
-        commandList->GetCommandList().Get(), m_impl->m_topLevelASBuffers.pScratch[cpuFrame]->Get(),
-        m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get(), m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->Get(),
-        updateOnly, m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get());
+    auto* colour = material.GetParameter<glm::vec4>(BASE_COLOUR_FACTOR);
+    auto* nea = material.GetParameter<glm::vec4>(NEA_FACTORS);
+    auto* orm = material.GetParameter<glm::vec4>(ORM_FACTORS);
 
-    if (!updateOnly)
-    {
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_RAYTRACING_ACCELERATION_STRUCTURE;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.RaytracingAccelerationStructure.Location =
-            m_impl->m_topLevelASBuffers.pResult[cpuFrame]->Get()->GetGPUVirtualAddress();
-
-        m_impl->m_BHVHandle[cpuFrame] =
-            reinterpret_cast<DXDescHeap*>(device.GetResourceHeap())
-                ->AllocateResource(m_impl->m_topLevelASBuffers.pResult[cpuFrame].get(), &srvDesc, BVH_SLOT + cpuFrame);
-    }
+    MaterialInfo info{};
+    info.colorFactor = colour ? *colour : BASE_COLOUR_FACTOR_DEFAULT;
+    glm::vec4 NEAFactor = nea ? *nea : NEA_FACTORS_DEFAULT;
+    glm::vec4 ORMFactor = orm ? *orm : ORM_FACTORS_DEFAULT;
 
-    commandList->TrackResource(m_impl->m_topLevelASBuffers.pScratch[cpuFrame]->GetResource());
-    commandList->TrackResource(m_impl->m_topLevelASBuffers.pResult[cpuFrame]->GetResource());
-    commandList->TrackResource(m_impl->m_topLevelASBuffers.pInstanceDesc[cpuFrame]->GetResource());
+    info.emissiveFactor = glm::vec4(NEAFactor.y, NEAFactor.y, NEAFactor.y, 1.f);
+    info.normalScale = NEAFactor.x;
+    info.metallicFactor = ORMFactor.z;
+    info.normalScale = NEAFactor.x;
+    info.roughnessFactor = ORMFactor.y;
+    return info;
 }
-
-KS::Scene::Impl::Impl() {}
-
-KS::Scene::Impl::~Impl() {}
@@ -1,10 +1,16 @@
 #pragma once
+#include <code_utility.hpp>
+#include <containers/FlatHashMap.hpp>
+#include <containers/SlotMap.hpp>
+#include <entt/entity/registry.hpp>
 #include <fileio/ResourceHandle.hpp>
 #include <renderer/InfoStructs.hpp>
+#include <scene/RenderSnapshot.hpp>
+
+#include <vector>
 
 namespace KS
 {
-struct DrawEntry;
 class Device;
 class UniformBuffer;
 class StorageBuffer;
@@ -12,6 +18,9 @@ class Texture;
 class Model;
 class Mesh;
 class Image;
+struct ReloadedAssets;
+class FrameCapture;
+struct CapturedFrame;
 
 struct SBTInfo
 {
@@ -27,6 +36,7 @@ struct SBTInfo
 struct MeshSet
 {
     const Mesh* mesh;
+    SlotMap<Mesh>::Key meshKey; // Stable for the scene's lifetime, unlike the address of mesh
     std::shared_ptr<Texture> baseTex;
     std::shared_ptr<Texture> normalTex;
     std::shared_ptr<Texture> emissiveTex;
@@ -38,54 +48,102 @@ struct MeshSet
 class Scene
 {
 public:
-    Scene(const Device& device);
+    static constexpr int32_t MAX_DRAWS = 200;
+
+    // Drawn objects live in the world as entities with ComponentWorldTransform and ComponentMeshRenderer
+    Scene(const Device& device, entt::registry& world);
     ~Scene();
 
-    void QueueModel(Device& device, ResourceHandle<Model> model, const glm::mat4& transform, std::string name);
-    void ApplyModelTransform(Device& device, std::string name, const glm::mat4& transfrom);
+    NON_COPYABLE(Scene);
+    NON_MOVABLE(Scene);
+
+    // Creates one entity per mesh of the model, returns them so they can be moved or removed later
+    std::vector<entt::entity> SpawnModel(const ResourceHandle<Model>& model, const glm::mat4& transform, std::string_view name);
     void QueuePointLight(glm::vec3 position, glm::vec3 color, float intensity, float radius);
     void QueueDirectionalLight(glm::vec3 direction, glm::vec3 color, float intensity);
     void SetAmbientLight(glm::vec3 color, float intensity);
     void SetFogValues(Device& device, const FogInfo& newFogInfo);
 
-    void Tick(Device& device);
+    // Records the calls above into the capture's current frame until it is set back to null
+    void SetCapture(FrameCapture* capture) { m_capture = capture; }
+
+    // Makes the calls a captured frame recorded, in the order they were made
+    void Replay(Device& device, const CapturedFrame& frame);
+
+    // Copies the draw data out of the world. Only reads the world, so it can run on another thread while
+    // the previous snapshot is drawn, see FramePipeline. Transforms are blended by alpha between their previous
+    // and current matrix, see EntityComponentSystem::Update.
+    void ExtractSnapshot(RenderSnapshot& snapshot, float alpha) const;
+
+    // Resolves the snapshot's resources and uploads its draw data, then builds the BVH
+    void Tick(Device& device, const RenderSnapshot& snapshot);
+
+    // Swaps changed resources into the caches, call between frames (waits for the GPU if anything changed)
+    void ReloadAssets(Device& device, const ReloadedAssets& assets);
 
     int32_t GetModelCount() const { return m_modelCount; }
-    MaterialInfo GetMaterialInfo(const Material& material) const;
-    MeshSet GetMeshSet(Device& device, int index);
+    MaterialInfo GetMaterialInfo(const MaterialInstance& material) const;
     FogInfo GetFogValues() const { return m_fogInfo; }
     StorageBuffer* GetStorageBuffer(StorageBuffers buffer) { return mStorageBuffers[buffer].get(); }
     UniformBuffer* GetUniformBuffer(UniformBuffers buffer) { return mUniformBuffers[buffer].get(); }
-    size_t GetDrawQueueSize() { return draw_queue.size(); }
-    std::unordered_map<std::string, DrawEntry>& GetQueue() { return draw_queue; }
+    entt::registry& GetWorld() { return m_world; }
+
+    // What Tick resolved, indexed by model index
+    const std::vector<MeshSet>& GetDrawSets() const { return m_drawSets; }
 
 private:
+    void UploadDrawData(Device& device, const RenderSnapshot& snapshot);
+    void UploadLights(Device& device);
+
+    // The ray traced passes need every drawn mesh in an acceleration structure. These live with the backend,
+    // see scene/DX12/SceneDX12.cpp, and own m_impl.
+    void CreateAccelerationStructures(const Device& device);
+    void DestroyAccelerationStructures();
+    void UpdateAccelerationStructures(Device& device);
+
     void CreateBottomLevelAS(const Device& device, const Mesh* mesh, int cpuFrame);
-    void CreateBVHBotomLevelInstance(const Device& device, const DrawEntry& draw_entry, bool updateOnly, int entryIndex,
-                                     int cpuFrame);
+    void CreateBVHBotomLevelInstance(const Device& device, const Mesh* mesh, const glm::mat4& transform, bool updateOnly,
+                                     int entryIndex, int cpuFrame);
     void CreateTopLevelAS(const Device& device, bool updateOnly, int cpuFrame);
 
-    const Mesh* GetMesh(const Device& device, ResourceHandle<Mesh> mesh);
-    const Model* GetModel(ResourceHandle<Model> model);
-    std::shared_ptr<Texture> GetTexture(Device& device, ResourceHandle<Texture> imgPath);
+    // NULL_KEY when the mesh could not be loaded. Loading moves the meshes that were already loaded, see UploadDrawData
+    SlotMap<Mesh>::Key LoadMesh(const Device& device, const ResourceHandle<Mesh>& mesh);
+    const Model* GetModel(const ResourceHandle<Model>& model);
+    std::shared_ptr<Texture> GetTexture(Device& device, const ResourceHandle<Texture>& imgPath);
+    std::shared_ptr<Texture> GetTexture(Device& device, const MaterialInstance& material, MaterialParameterID texture);
 
     struct Impl;
-    std::unique_ptr<Impl> m_impl;
+    Impl* m_impl = nullptr;
 
-    std::unordered_map<std::string, DrawEntry> draw_queue{};
+    entt::registry& m_world;
+    FrameCapture* m_capture = nullptr;
+    std::vector<MeshSet> m_drawSets{};
+    std::vector<SlotMap<Mesh>::Key> m_drawMeshKeys{}; // Per snapshot draw, kept to reuse its memory
 
-    std::unordered_map<ResourceHandle<Model>, Model> model_cache{};
-    std::unordered_map<ResourceHandle<Mesh>, Mesh> mesh_cache{};
-    std::unordered_map<ResourceHandle<Texture>, std::shared_ptr<Texture>> tex_cache{};
+    // GPU resources are stored densely, the maps only translate handles to slot map keys
+    // Models move when the cache grows, pointers from GetModel are only valid until the next model is loaded
+    FlatHashMap<ResourceHandle<Model>, Model> model_cache{};
+    SlotMap<Mesh> meshes{};
+    FlatHashMap<ResourceHandle<Mesh>, SlotMap<Mesh>::Key> mesh_keys{};
+    SlotMap<std::shared_ptr<Texture>> textures{};
+    FlatHashMap<ResourceHandle<Texture>, SlotMap<std::shared_ptr<Texture>>::Key> texture_keys{};
     std::shared_ptr<StorageBuffer> mStorageBuffers[KS::NUM_SBUFFER];
     std::shared_ptr<UniformBuffer> mUniformBuffers[KS::NUM_UBUFFER];
     std::vector<DirLightInfo> m_directionalLights;
     std::vector<PointLightInfo> m_pointLights;
 
-    ModelMat m_modelMatrices[200]{};
-    MaterialInfo m_materialInstances[200]{};
+    // Staging for the model and material buffers, filled in draw order by UploadDrawData
+    ModelMat m_modelMatrices[MAX_DRAWS]{};
+    MaterialInfo m_materialInstances[MAX_DRAWS]{};
     int32_t m_modelCount = 0;
     LightInfo m_lightInfo{};
     FogInfo m_fogInfo{};
+    bool m_lightsChanged = true;
 };
+
+namespace Tests
+{
+    // Runs on the null backend, see scene/Null/SceneNull.cpp
+    void TestHeadlessScene();
+}
 }  // namespace KS
@@ -0,0 +1,136 @@
+#include "AllocationCounter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+// Plain thread_local data has no constructor, so it is safe to touch from inside operator new
+thread_local KS::AllocationStats thread_stats {};
+
+std::atomic<uint64_t> total_allocations {};
+std::atomic<uint64_t> total_frees {};
+std::atomic<uint64_t> total_bytes {};
+
+void CountAllocation(size_t size)
+{
+    thread_stats.allocations++;
+    thread_stats.bytes += size;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+    total_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void CountFree(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    thread_stats.frees++;
+    total_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* Allocate(size_t size)
+{
+    CountAllocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* AllocateAligned(size_t size, size_t alignment)
+{
+    CountAllocation(size);
+
+#if defined(_WIN32)
+    return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    void* ptr = nullptr;
+    return ::posix_memalign(&ptr, std::max(alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void Free(void* ptr)
+{
+    CountFree(ptr);
+    std::free(ptr);
+}
+
+void FreeAligned(void* ptr)
+{
+    CountFree(ptr);
+
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+}
+
+KS::AllocationStats KS::AllocationCounter::GetThreadStats()
+{
+    return thread_stats;
+}
+
+KS::AllocationStats KS::AllocationCounter::GetTotalStats()
+{
+    return { total_allocations.load(std::memory_order_relaxed), total_frees.load(std::memory_order_relaxed),
+        total_bytes.load(std::memory_order_relaxed) };
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = Allocate(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* ptr = Allocate(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = AllocateAligned(size, static_cast<size_t>(alignment)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = AllocateAligned(size, static_cast<size_t>(alignment)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete[](void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(ptr); }
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+
+namespace KS
+{
+
+struct AllocationStats
+{
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0; // Requested by allocations, frees are not subtracted
+};
+
+// Counts calls to the global operator new and delete, which are replaced in AllocationCounter.cpp.
+// Counting is always on, it costs an increment per allocation.
+// Allocations that bypass operator new (malloc, ImGui, D3D12 internals) are not seen.
+namespace AllocationCounter
+{
+    // Only the calling thread, background threads (file watchers, IO workers) do not show up
+    AllocationStats GetThreadStats();
+
+    // All threads together
+    AllocationStats GetTotalStats();
+}
+
+// Allocations made by the calling thread while the scope is alive
+class AllocationScope
+{
+public:
+    AllocationScope()
+        : start(AllocationCounter::GetThreadStats())
+    {
+    }
+
+    AllocationStats GetStats() const
+    {
+        auto now = AllocationCounter::GetThreadStats();
+        return { now.allocations - start.allocations, now.frees - start.frees, now.bytes - start.bytes };
+    }
+
+private:
+    AllocationStats start;
+};
+
+namespace Tests
+{
+    // Both run on the null backend, see scene/Null/SceneNull.cpp. Outside this file, so the compiler cannot
+    // inline the replaced operators into the tests and pair a new it sees with the free behind delete.
+    void TestAllocationCounter();
+
+    // Runs a headless frame and fails if a steady state frame allocates
+    void TestSteadyStateFrame();
+}
+
+}
@@ -0,0 +1,230 @@
+#include "FrameCapture.hpp"
+
+#include <fileio/FileIO.hpp>
+#include <fileio/MemoryStream.hpp>
+#include <tools/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace
+{
+
+constexpr uint32_t CAPTURE_MAGIC = 0x5043534B; // "KSCP"
+constexpr uint32_t CAPTURE_VERSION = 0;
+
+// Nearest rank, samples must be sorted
+float Percentile(const std::vector<float>& sorted, float percentile)
+{
+    size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<float>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}
+
+KS::CapturedFrame& KS::FrameCapture::BeginFrame(float dt)
+{
+    auto& frame = frames.emplace_back();
+    frame.dt = dt;
+    return frame;
+}
+
+bool KS::FrameCapture::Save(const std::string& path) const
+{
+    return FileIO::WriteFileAtomic(path, [&](std::ostream& out)
+    {
+        BinarySaver archive { out };
+        archive(CAPTURE_MAGIC, CAPTURE_VERSION, frames);
+    });
+}
+
+std::optional<KS::FrameCapture> KS::FrameCapture::Load(const std::string& path)
+{
+    auto file = FileIO::ReadFile(path);
+    if (!file)
+    {
+        LOG(Log::Severity::WARN, "Could not read frame capture {}", path);
+        return std::nullopt;
+    }
+
+    FrameCapture capture {};
+    uint32_t magic = 0, version = 0;
+
+    try
+    {
+        MemoryReadStream stream { file->GetBytes() };
+        BinaryLoader archive { stream };
+        archive(magic, version);
+
+        if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION)
+        {
+            LOG(Log::Severity::WARN, "{} is not a frame capture of this version", path);
+            return std::nullopt;
+        }
+
+        archive(capture.frames);
+    }
+    catch (const cereal::Exception& e)
+    {
+        LOG(Log::Severity::WARN, "Frame capture {} is truncated: {}", path, e.what());
+        return std::nullopt;
+    }
+
+    if (capture.frames.empty())
+        capture.frames.emplace_back();
+
+    return capture;
+}
+
+void KS::StageTimings::Add(std::string_view stage, float milliseconds)
+{
+    auto it = std::find_if(stages.begin(), stages.end(), [&](const auto& entry) { return entry.first == stage; });
+    if (it == stages.end())
+        it = stages.insert(stages.end(), { std::string(stage), {} });
+
+    it->second.emplace_back(milliseconds);
+}
+
+KS::StageTimings::Summary KS::StageTimings::Summarize(std::string_view stage) const
+{
+    auto it = std::find_if(stages.begin(), stages.end(), [&](const auto& entry) { return entry.first == stage; });
+    if (it == stages.end() || it->second.empty())
+        return {};
+
+    std::vector<float> sorted = it->second;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (float sample : sorted)
+        total += sample;
+
+    Summary summary {};
+    summary.samples = static_cast<uint32_t>(sorted.size());
+    summary.mean = static_cast<float>(total / static_cast<double>(sorted.size()));
+    summary.p50 = Percentile(sorted, 0.50f);
+    summary.p90 = Percentile(sorted, 0.90f);
+    summary.p99 = Percentile(sorted, 0.99f);
+    summary.max = sorted.back();
+    return summary;
+}
+
+bool KS::StageTimings::WriteJSON(const std::string& path) const
+{
+    return FileIO::WriteFileAtomic(path, [&](std::ostream& out)
+    {
+        JSONSaver json { out };
+        json.setNextName("Stages");
+        json.startNode();
+        for (const auto& [stage, samples] : stages)
+            json(cereal::make_nvp(stage, Summarize(stage)));
+        json.finishNode();
+    });
+}
+
+void KS::Tests::TestFrameCapture()
+{
+    auto directory = std::filesystem::temp_directory_path() / "KSFrameCapture";
+    std::filesystem::create_directories(directory);
+    auto capture_path = (directory / "capture.kscap").string();
+
+    FrameCapture capture {};
+    capture.Record(SpawnModelCall { { "assets/models/Gears.json" }, glm::mat4(2.0f), "Gear" });
+    capture.Record(PointLightCall { glm::vec3(1.0f), glm::vec3(0.5f), 5.0f, 10.0f });
+
+    for (int i = 1; i <= 3; i++)
+    {
+        auto& frame = capture.BeginFrame(16.0f + static_cast<float>(i));
+        frame.mouse_position = glm::vec2(static_cast<float>(i), 2.0f);
+        frame.input.emplace_back(InputChange { 87, 0, 2 });
+    }
+
+    FogInfo fog {};
+    fog.fogDensity = 0.25f;
+    fog.lightShaftNumberSamples = 40;
+    capture.Record(FogCall { fog });
+
+    if (!capture.Save(capture_path))
+    {
+        throw;
+    }
+
+    auto loaded = FrameCapture::Load(capture_path);
+    if (!loaded || loaded->GetFrames().size() != 4)
+    {
+        throw;
+    }
+
+    const auto& setup = loaded->GetFrames()[0];
+    const auto* spawn = setup.calls.size() == 2 ? std::get_if<SpawnModelCall>(&setup.calls[0]) : nullptr;
+    const auto* light = setup.calls.size() == 2 ? std::get_if<PointLightCall>(&setup.calls[1]) : nullptr;
+    if (setup.dt != 0.0f || !spawn || spawn->model.path != "assets/models/Gears.json" || spawn->transform != glm::mat4(2.0f)
+        || spawn->name != "Gear" || !light || light->radius != 10.0f)
+    {
+        throw;
+    }
+
+    const auto& last = loaded->GetFrames()[3];
+    const auto* fog_call = last.calls.size() == 1 ? std::get_if<FogCall>(&last.calls[0]) : nullptr;
+    if (last.dt != 19.0f || last.mouse_position.x != 3.0f || last.input.size() != 1 || last.input[0].code != 87
+        || !fog_call || fog_call->fog.fogDensity != 0.25f || fog_call->fog.lightShaftNumberSamples != 40)
+    {
+        throw;
+    }
+
+    // Files that are not captures, or are cut short, are rejected
+    auto other_path = (directory / "other.kscap").string();
+    FileIO::WriteFileAtomic(other_path, [](std::ostream& out) { out << "not a capture"; });
+    if (FrameCapture::Load(other_path) || FrameCapture::Load((directory / "missing.kscap").string()))
+    {
+        throw;
+    }
+
+    auto bytes = FileIO::ReadFile(capture_path);
+    FileIO::WriteFileAtomic(other_path, [&](std::ostream& out)
+        { out.write(reinterpret_cast<const char*>(bytes->GetData()), static_cast<std::streamsize>(bytes->GetSize() / 2)); });
+    if (FrameCapture::Load(other_path))
+    {
+        throw;
+    }
+
+    // Nearest rank percentiles of 1 to 100
+    StageTimings timings {};
+    for (int i = 100; i >= 1; i--)
+    {
+        timings.Add("tick", static_cast<float>(i));
+        timings.Add("submit", 1.0f);
+    }
+
+    auto tick = timings.Summarize("tick");
+    if (tick.samples != 100 || tick.mean != 50.5f || tick.p50 != 50.0f || tick.p90 != 90.0f || tick.p99 != 99.0f
+        || tick.max != 100.0f || timings.Summarize("submit").p99 != 1.0f || timings.Summarize("missing").samples != 0)
+    {
+        throw;
+    }
+
+    auto timings_path = (directory / "timings.json").string();
+    if (!timings.WriteJSON(timings_path))
+    {
+        throw;
+    }
+
+    {
+        auto file = FileIO::ReadFile(timings_path);
+        MemoryReadStream stream { file->GetBytes() };
+        JSONLoader json { stream };
+
+        StageTimings::Summary read {};
+        json.setNextName("Stages");
+        json.startNode();
+        json(cereal::make_nvp("tick", read));
+        json.finishNode();
+
+        if (read.p90 != 90.0f || read.samples != 100)
+        {
+            throw;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <fileio/ResourceHandle.hpp>
+#include <fileio/Serialization.hpp>
+#include <renderer/InfoStructs.hpp>
+
+#include <cereal/types/variant.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace KS
+{
+class Model;
+
+// Scene calls as they were made, see Scene::SetCapture and Scene::Replay
+struct SpawnModelCall
+{
+    ResourceHandle<Model> model {};
+    glm::mat4 transform { 1.0f };
+    std::string name {};
+
+    template <typename A>
+    void serialize(A& ar) { ar(model, transform, name); }
+};
+
+struct PointLightCall
+{
+    glm::vec3 position {};
+    glm::vec3 color {};
+    float intensity = 0.0f;
+    float radius = 0.0f;
+
+    template <typename A>
+    void serialize(A& ar) { ar(position, color, intensity, radius); }
+};
+
+struct DirectionalLightCall
+{
+    glm::vec3 direction {};
+    glm::vec3 color {};
+    float intensity = 0.0f;
+
+    template <typename A>
+    void serialize(A& ar) { ar(direction, color, intensity); }
+};
+
+struct AmbientLightCall
+{
+    glm::vec3 color {};
+    float intensity = 0.0f;
+
+    template <typename A>
+    void serialize(A& ar) { ar(color, intensity); }
+};
+
+struct FogCall
+{
+    FogInfo fog {};
+
+    template <typename A>
+    void serialize(A& ar)
+    {
+        ar(fog.fogColor, fog.fogDensity, fog.lightShaftNumberSamples, fog.sourceMipNumber, fog.exposure, fog.weight, fog.decay);
+    }
+};
+
+using SceneCall = std::variant<SpawnModelCall, PointLightCall, DirectionalLightCall, AmbientLightCall, FogCall>;
+
+// A key or mouse button that went down or up during a frame. Held keys are not repeated, RawInput::Replay
+// ages the states the same way ProcessInput does.
+struct InputChange
+{
+    uint16_t code = 0; // KeyboardKey or MouseButton
+    uint8_t mouse = 0;
+    uint8_t state = 0; // InputState, Down or Release
+
+    template <typename A>
+    void serialize(A& ar) { ar(code, mouse, state); }
+};
+
+struct CapturedFrame
+{
+    float dt = 0.0f; // Milliseconds, what the frame timer returned
+
+    // Deltas are not stored, they follow from the position of the previous frame
+    glm::vec2 mouse_position {};
+    std::vector<InputChange> input {};
+    std::vector<SceneCall> calls {};
+
+    template <typename A>
+    void serialize(A& ar) { ar(dt, mouse_position, input, calls); }
+};
+
+// Everything that makes one run of the application differ from the next: frame times, input and the scene calls
+// made in response to them. Replaying a capture gives every build the same workload.
+// The first frame holds what happened before the first BeginFrame, the scene setup, and has no dt.
+class FrameCapture
+{
+public:
+    FrameCapture() { frames.emplace_back(); }
+
+    // Input and calls recorded from here on belong to the new frame
+    CapturedFrame& BeginFrame(float dt);
+    CapturedFrame& GetCurrentFrame() { return frames.back(); }
+
+    void Record(SceneCall call) { frames.back().calls.emplace_back(std::move(call)); }
+
+    const std::vector<CapturedFrame>& GetFrames() const { return frames; }
+
+    bool Save(const std::string& path) const;
+
+    // Nullopt if the file is missing, not a capture or from an older format
+    static std::optional<FrameCapture> Load(const std::string& path);
+
+private:
+    std::vector<CapturedFrame> frames {};
+};
+
+// Milliseconds spent per stage of every replayed frame, summarized as percentiles so runs can be compared
+class StageTimings
+{
+public:
+    struct Summary
+    {
+        uint32_t samples = 0;
+        float mean = 0.0f;
+        float p50 = 0.0f;
+        float p90 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+
+        template <typename A>
+        void serialize(A& ar)
+        {
+            ar(cereal::make_nvp("Samples", samples), cereal::make_nvp("Mean", mean), cereal::make_nvp("P50", p50),
+                cereal::make_nvp("P90", p90), cereal::make_nvp("P99", p99), cereal::make_nvp("Max", max));
+        }
+    };
+
+    // Stages are written in the order they were first added
+    void Add(std::string_view stage, float milliseconds);
+
+    Summary Summarize(std::string_view stage) const;
+    bool WriteJSON(const std::string& path) const;
+
+private:
+    std::vector<std::pair<std::string, std::vector<float>>> stages {};
+};
+
+namespace Tests
+{
+    void TestFrameCapture();
+}
+
+}
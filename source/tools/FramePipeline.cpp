@@ -0,0 +1,109 @@
+#include "FramePipeline.hpp"
+
+#include <vector>
+
+namespace
+{
+
+struct TestSnapshot
+{
+    int frame = 0;
+    std::vector<int> values {};
+};
+
+}
+
+void KS::Tests::TestFramePipeline()
+{
+    // Snapshots arrive in order, and the one being read is never the one being written
+    {
+        int next_frame = 0;
+        FramePipeline<TestSnapshot> pipeline { [&](TestSnapshot& snapshot)
+        {
+            snapshot.frame = next_frame++;
+            snapshot.values.assign(1000, snapshot.frame);
+        } };
+
+        pipeline.Kick();
+        for (int frame = 0; frame < 100; frame++)
+        {
+            const auto& snapshot = pipeline.Wait();
+            pipeline.Kick();
+
+            // The worker is filling the other snapshot while this one is checked
+            for (int value : snapshot.values)
+            {
+                if (value != frame || snapshot.frame != frame)
+                {
+                    throw;
+                }
+            }
+        }
+
+        const auto& last = pipeline.Wait();
+        if (last.frame != 100 || &last != &pipeline.GetCurrent())
+        {
+            throw;
+        }
+    }
+
+    // Producing the next snapshot overlaps consuming the current one. Checked on recorded intervals instead of the
+    // total time, which depends on how busy the machine is
+    {
+        using namespace std::chrono_literals;
+        using Clock = std::chrono::steady_clock;
+        constexpr int FRAMES = 10;
+
+        // Only written by the worker, and read once Wait has synchronized with it
+        std::vector<Clock::time_point> produce_start(FRAMES + 1), produce_end(FRAMES + 1);
+        std::vector<Clock::time_point> consume_start(FRAMES), consume_end(FRAMES);
+        int produced = 0;
+
+        FramePipeline<TestSnapshot> pipeline { [&](TestSnapshot& snapshot)
+        {
+            produce_start[produced] = Clock::now();
+            std::this_thread::sleep_for(10ms);
+            snapshot.frame++;
+            produce_end[produced++] = Clock::now();
+        } };
+
+        pipeline.Kick();
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            pipeline.Wait();
+            pipeline.Kick();
+            consume_start[frame] = Clock::now();
+            std::this_thread::sleep_for(10ms);
+            consume_end[frame] = Clock::now();
+        }
+        pipeline.Wait();
+
+        // Producing inside Kick would end before consuming starts, producing inside Wait would start after it ended
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            if (produce_start[frame + 1] >= consume_end[frame] || produce_end[frame + 1] <= consume_start[frame])
+            {
+                throw;
+            }
+        }
+
+        if (produced != FRAMES + 1 || pipeline.GetProduceMilliseconds() < 9.0f)
+        {
+            throw;
+        }
+    }
+
+    // Destroying with a snapshot in flight waits for it
+    {
+        bool produced = false;
+        {
+            FramePipeline<TestSnapshot> pipeline { [&](TestSnapshot&) { produced = true; } };
+            pipeline.Kick();
+        }
+
+        if (!produced)
+        {
+            throw;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <code_utility.hpp>
+
+#include <chrono>
+#include <functional>
+#include <semaphore>
+#include <thread>
+
+namespace KS
+{
+
+// Produces the data for the next frame on a worker thread while the calling thread consumes the current one.
+// Two snapshots are kept: the worker only writes the one being produced, the caller only reads the one Wait returned,
+// so neither needs locking. The frame then costs about the longer of the two instead of their sum.
+//
+// Every Kick must be matched by a Wait before the next Kick. Between Wait and Kick the worker is idle,
+// which is the window for the caller to touch anything the producer also uses.
+template <typename T>
+class FramePipeline
+{
+public:
+    using ProduceFunction = std::function<void(T& snapshot)>;
+
+    explicit FramePipeline(ProduceFunction produce)
+        : produce(std::move(produce))
+        , worker([this]() { WorkerLoop(); })
+    {
+    }
+
+    ~FramePipeline()
+    {
+        if (in_flight) Wait();
+
+        stopping = true;
+        start.release();
+        worker.join();
+    }
+
+    NON_COPYABLE(FramePipeline);
+    NON_MOVABLE(FramePipeline);
+
+    // Starts producing the next snapshot
+    void Kick()
+    {
+        ASSERT(!in_flight && "Kick called twice without a Wait");
+        in_flight = true;
+        start.release();
+    }
+
+    // Blocks until the kicked snapshot is done and returns it. It stays valid and unchanged until the next Wait.
+    const T& Wait()
+    {
+        ASSERT(in_flight && "Wait called without a Kick");
+
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        done.acquire();
+        wait_milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - wait_start).count();
+
+        in_flight = false;
+        current = 1 - current;
+        return snapshots[current];
+    }
+
+    const T& GetCurrent() const { return snapshots[current]; }
+
+    // How long the last Wait blocked, close to zero when producing is faster than consuming
+    float GetWaitMilliseconds() const { return wait_milliseconds; }
+
+    // How long producing the last snapshot took on the worker
+    float GetProduceMilliseconds() const { return produce_milliseconds; }
+
+private:
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            start.acquire();
+            if (stopping) return;
+
+            // The caller reads snapshots[current] until the next Wait, which flips current after this finishes
+            auto produce_start = std::chrono::high_resolution_clock::now();
+            produce(snapshots[1 - current]);
+            produce_milliseconds =
+                std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - produce_start).count();
+
+            done.release();
+        }
+    }
+
+    ProduceFunction produce;
+    T snapshots[2] {};
+    int current = 0;
+    bool in_flight = false;
+    bool stopping = false;
+    float wait_milliseconds = 0.0f;
+    float produce_milliseconds = 0.0f;
+
+    // Semaphores order everything written before a release with everything read after the matching acquire
+    std::binary_semaphore start { 0 };
+    std::binary_semaphore done { 0 };
+    std::thread worker;
+};
+
+namespace Tests
+{
+    void TestFramePipeline();
+}
+
+}
@@ -1,7 +1,14 @@
 #pragma once
-#include <format>
 #include <iostream>
+#include <iterator>
 #include <math/Algebra.hpp>
+#include <string>
+#include <string_view>
+#include <version>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
 
 namespace Log
 {
@@ -47,20 +54,84 @@ namespace detail
         }
     }
 
-    inline std::string reduce_path(const std::string& in_path)
+    inline constexpr std::string_view reduce_path(std::string_view in_path)
     {
-        return in_path.substr(in_path.find("KSEngine"));
+        auto root = in_path.find("KSEngine");
+        return root == std::string_view::npos ? in_path : in_path.substr(root);
     }
 
 } // namespace detail
 
+#if defined(__cpp_lib_format)
+
+// Formats straight into the output stream, no intermediate string is allocated
 template <typename FormatString, typename... Args>
 inline void Message(Severity type, FormatString&& fmt, Args&&... args)
 {
-    *detail::output << detail::format_message_type(type)
-                    << std::vformat(std::forward<FormatString>(fmt), std::make_format_args(args...));
+    *detail::output << detail::format_message_type(type);
+    std::vformat_to(std::ostreambuf_iterator<char>(*detail::output), std::string_view(fmt), std::make_format_args(args...));
 }
 
+#else
+
+// Fallback for standard libraries without <format> (headless tools built with older GCC)
+// Every {} replacement field is substituted with the next argument, format specs are ignored
+namespace detail
+{
+    template <typename T>
+    inline void format_argument(std::ostream& out, const T& arg)
+    {
+        if constexpr (requires { out << arg; })
+            out << arg;
+        else if constexpr (requires { arg.length(); arg[0]; })
+        {
+            out << "[";
+            for (int i = 0; i < arg.length(); i++)
+            {
+                format_argument(out, arg[i]);
+                out << (i + 1 < arg.length() ? ", " : "]");
+            }
+        }
+        else
+            out << "?";
+    }
+
+    template <typename... Args>
+    inline void format_fallback(std::ostream& out, std::string_view fmt, const Args&... args)
+    {
+        auto print_next = [&, index = size_t(0)]() mutable
+        {
+            size_t current = 0;
+            ((current++ == index ? format_argument(out, args) : void()), ...);
+            index++;
+        };
+
+        for (size_t i = 0; i < fmt.size(); i++)
+        {
+            if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '{')
+                out << fmt[i++];
+            else if (fmt[i] == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}')
+                out << fmt[i++];
+            else if (fmt[i] == '{')
+            {
+                i = std::min(fmt.find('}', i), fmt.size());
+                print_next();
+            }
+            else
+                out << fmt[i];
+        }
+    }
+}
+
+template <typename FormatString, typename... Args>
+inline void Message(Severity type, FormatString&& fmt, Args&&... args)
+{
+    *detail::output << detail::format_message_type(type);
+    detail::format_fallback(*detail::output, fmt, args...);
+}
+
+#endif
+
 inline void Break() { *detail::output << "\n"; }
 
 } // namespace Log
@@ -70,10 +141,12 @@ inline void Break() { *detail::output << "\n"; }
         Log::Message(severity,                                     \
             "{} at Line {}: ", Log::detail::reduce_path(__FILE__), \
             __LINE__);                                             \
-        Log::Message(Log::Severity::NONE, message, __VA_ARGS__);   \
+        Log::Message(Log::Severity::NONE, message, ##__VA_ARGS__); \
         Log::Break();                                              \
     }
 
+#if defined(__cpp_lib_format)
+
 namespace std
 {
 
@@ -131,4 +204,6 @@ struct formatter<glm::quat> : std::formatter<std::string>
             std::format("[{}, {}, {}, {}]", p.x, p.y, p.z, p.w), ctx);
     }
 };
-}
\ No newline at end of file
+}
+
+#endif
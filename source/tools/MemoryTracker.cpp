@@ -0,0 +1,212 @@
+#include "MemoryTracker.hpp"
+
+#include <atomic>
+#include <fileio/FileIO.hpp>
+#include <new>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t TAG_COUNT = static_cast<size_t>(KS::MemoryTag::COUNT);
+
+struct AtomicTagStats
+{
+    std::atomic<int64_t> current {};
+    std::atomic<int64_t> peak {};
+    std::atomic<int64_t> count {};
+    std::atomic<uint64_t> allocations {};
+};
+
+// Constant initialized, so memory released during static destruction is still recorded safely
+AtomicTagStats tag_stats[TAG_COUNT] {};
+
+KS::MemorySnapshot last_frame {};
+KS::MemorySnapshot frame_delta {};
+
+}
+
+const char* KS::GetMemoryTagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+    case MemoryTag::GENERAL:
+        return "General";
+    case MemoryTag::BYTE_BUFFER:
+        return "ByteBuffer";
+    case MemoryTag::FRAME_ARENA:
+        return "FrameArena";
+    case MemoryTag::SCRATCH:
+        return "Scratch";
+    case MemoryTag::IMPORTER:
+        return "Importer";
+    case MemoryTag::GPU_BUFFER:
+        return "GPUBuffer";
+    case MemoryTag::GPU_TEXTURE:
+        return "GPUTexture";
+    case MemoryTag::GPU_UPLOAD:
+        return "GPUUpload";
+    default:
+        return "Unknown";
+    }
+}
+
+int64_t KS::MemorySnapshot::GetTotalCurrent() const
+{
+    int64_t total = 0;
+    for (const auto& tag : tags)
+        total += tag.current;
+    return total;
+}
+
+void KS::MemoryTracker::RecordAllocation(MemoryTag tag, size_t byte_count)
+{
+    auto& stats = tag_stats[static_cast<size_t>(tag)];
+
+    int64_t current = stats.current.fetch_add(static_cast<int64_t>(byte_count), std::memory_order_relaxed) + byte_count;
+    stats.count.fetch_add(1, std::memory_order_relaxed);
+    stats.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t peak = stats.peak.load(std::memory_order_relaxed);
+    while (current > peak && !stats.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+void KS::MemoryTracker::RecordFree(MemoryTag tag, size_t byte_count)
+{
+    auto& stats = tag_stats[static_cast<size_t>(tag)];
+    stats.current.fetch_sub(static_cast<int64_t>(byte_count), std::memory_order_relaxed);
+    stats.count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+KS::MemorySnapshot KS::MemoryTracker::TakeSnapshot()
+{
+    MemorySnapshot snapshot {};
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+        snapshot.tags[i].current = tag_stats[i].current.load(std::memory_order_relaxed);
+        snapshot.tags[i].peak = tag_stats[i].peak.load(std::memory_order_relaxed);
+        snapshot.tags[i].count = tag_stats[i].count.load(std::memory_order_relaxed);
+        snapshot.tags[i].allocations = tag_stats[i].allocations.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+KS::MemorySnapshot KS::MemoryTracker::Diff(const MemorySnapshot& before, const MemorySnapshot& after)
+{
+    MemorySnapshot diff {};
+    for (size_t i = 0; i < TAG_COUNT; i++)
+    {
+        diff.tags[i].current = after.tags[i].current - before.tags[i].current;
+        diff.tags[i].peak = after.tags[i].peak;
+        diff.tags[i].count = after.tags[i].count - before.tags[i].count;
+        diff.tags[i].allocations = after.tags[i].allocations - before.tags[i].allocations;
+    }
+    return diff;
+}
+
+void KS::MemoryTracker::EndFrame()
+{
+    auto now = TakeSnapshot();
+    frame_delta = Diff(last_frame, now);
+    last_frame = now;
+}
+
+const KS::MemorySnapshot& KS::MemoryTracker::GetFrameDelta()
+{
+    return frame_delta;
+}
+
+bool KS::MemoryTracker::WriteJSON(const std::string& path, const MemorySnapshot& snapshot)
+{
+    return FileIO::WriteFileAtomic(path, [&](std::ostream& out)
+    {
+        JSONSaver json { out };
+        json(cereal::make_nvp("Memory", snapshot));
+    });
+}
+
+void* KS::TrackedMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    void* ptr = upstream->allocate(bytes, alignment);
+    MemoryTracker::RecordAllocation(tag, bytes);
+    return ptr;
+}
+
+void KS::TrackedMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    MemoryTracker::RecordFree(tag, bytes);
+    upstream->deallocate(ptr, bytes, alignment);
+}
+
+KS::TrackedMemoryResource* KS::GetTrackedResource(MemoryTag tag)
+{
+    // Never destroyed, buffers in static objects may give their memory back after main returns
+    alignas(TrackedMemoryResource) static std::byte storage[sizeof(TrackedMemoryResource) * TAG_COUNT];
+    static auto* resources = []()
+    {
+        auto* first = reinterpret_cast<TrackedMemoryResource*>(storage);
+        for (size_t i = 0; i < TAG_COUNT; i++)
+            new (first + i) TrackedMemoryResource(static_cast<MemoryTag>(i), std::pmr::new_delete_resource());
+        return first;
+    }();
+
+    return resources + static_cast<size_t>(tag);
+}
+
+void KS::Tests::TestMemoryTracker()
+{
+    auto before = MemoryTracker::TakeSnapshot();
+
+    {
+        auto* resource = GetTrackedResource(MemoryTag::IMPORTER);
+        std::pmr::vector<int> numbers { resource };
+        numbers.resize(1000);
+
+        auto during = MemoryTracker::Diff(before, MemoryTracker::TakeSnapshot());
+        if (during[MemoryTag::IMPORTER].current < static_cast<int64_t>(sizeof(int) * 1000)
+            || during[MemoryTag::IMPORTER].count != 1 || during[MemoryTag::SCRATCH].current != 0)
+        {
+            throw;
+        }
+    }
+
+    // Everything was given back, the high-water mark stays
+    auto after = MemoryTracker::Diff(before, MemoryTracker::TakeSnapshot());
+    if (after[MemoryTag::IMPORTER].current != 0 || after[MemoryTag::IMPORTER].count != 0
+        || after[MemoryTag::IMPORTER].allocations != 1 || after[MemoryTag::IMPORTER].peak < static_cast<int64_t>(sizeof(int) * 1000))
+    {
+        throw;
+    }
+
+    // Frame deltas only cover what happened since the last frame ended
+    MemoryTracker::EndFrame();
+    MemoryTracker::RecordAllocation(MemoryTag::GPU_TEXTURE, 4096);
+    MemoryTracker::EndFrame();
+
+    if (MemoryTracker::GetFrameDelta()[MemoryTag::GPU_TEXTURE].current != 4096)
+    {
+        throw;
+    }
+
+    MemoryTracker::RecordFree(MemoryTag::GPU_TEXTURE, 4096);
+    MemoryTracker::EndFrame();
+
+    if (MemoryTracker::GetFrameDelta()[MemoryTag::GPU_TEXTURE].current != -4096)
+    {
+        throw;
+    }
+
+    std::stringstream stream {};
+    {
+        JSONSaver json { stream };
+        json(cereal::make_nvp("Memory", MemoryTracker::TakeSnapshot()));
+    }
+
+    if (stream.str().find("\"GPUTexture\"") == std::string::npos)
+    {
+        throw;
+    }
+}
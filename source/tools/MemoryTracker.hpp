@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <fileio/Serialization.hpp>
+#include <memory_resource>
+#include <string>
+
+namespace KS
+{
+
+// Subsystems that memory is accounted to. GPU tags count the size the driver reserves for a resource.
+enum class MemoryTag : uint8_t
+{
+    GENERAL = 0,
+    BYTE_BUFFER, // Loaded files, decoded images and mesh attributes
+    FRAME_ARENA,
+    SCRATCH,
+    IMPORTER,
+    GPU_BUFFER,
+    GPU_TEXTURE,
+    GPU_UPLOAD,
+    COUNT
+};
+
+const char* GetMemoryTagName(MemoryTag tag);
+
+struct MemoryTagStats
+{
+    int64_t current = 0; // Bytes in use
+    int64_t peak = 0; // Most bytes in use at once
+    int64_t count = 0; // Live allocations
+    uint64_t allocations = 0; // Allocations made in total
+
+    template <typename A>
+    void serialize(A& ar)
+    {
+        ar(cereal::make_nvp("Current", current), cereal::make_nvp("Peak", peak), cereal::make_nvp("Count", count),
+            cereal::make_nvp("Allocations", allocations));
+    }
+};
+
+struct MemorySnapshot
+{
+    std::array<MemoryTagStats, static_cast<size_t>(MemoryTag::COUNT)> tags {};
+
+    const MemoryTagStats& operator[](MemoryTag tag) const { return tags[static_cast<size_t>(tag)]; }
+
+    int64_t GetTotalCurrent() const;
+
+    template <typename A>
+    void save(A& ar) const
+    {
+        for (size_t i = 0; i < tags.size(); i++)
+            ar(cereal::make_nvp(GetMemoryTagName(static_cast<MemoryTag>(i)), tags[i]));
+    }
+};
+
+// Counts memory per tag, for everything that goes through the engine allocators (tracked memory resources,
+// ByteBuffer) and every D3D12 resource. Plain new/delete and third party allocations are not tagged.
+// Recording is thread safe, the frame functions are meant for the main thread.
+namespace MemoryTracker
+{
+    void RecordAllocation(MemoryTag tag, size_t byte_count);
+    void RecordFree(MemoryTag tag, size_t byte_count);
+
+    MemorySnapshot TakeSnapshot();
+
+    // Change from before to after. Peaks are not differences, they are the high-water mark of after.
+    MemorySnapshot Diff(const MemorySnapshot& before, const MemorySnapshot& after);
+
+    // Marks the end of a frame, the change since the previous call becomes the frame delta
+    void EndFrame();
+    const MemorySnapshot& GetFrameDelta();
+
+    bool WriteJSON(const std::string& path, const MemorySnapshot& snapshot = TakeSnapshot());
+}
+
+// Forwards to an upstream resource and records everything under one tag
+class TrackedMemoryResource : public std::pmr::memory_resource
+{
+public:
+    TrackedMemoryResource(MemoryTag tag, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : tag(tag)
+        , upstream(upstream)
+    {
+    }
+
+    MemoryTag GetTag() const { return tag; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    MemoryTag tag {};
+    std::pmr::memory_resource* upstream {};
+};
+
+// Heap resource for a tag, lives for the whole program
+TrackedMemoryResource* GetTrackedResource(MemoryTag tag);
+
+namespace Tests
+{
+    void TestMemoryTracker();
+}
+
+}
@@ -0,0 +1,122 @@
+// Packs loose asset files into a single .kspak archive
+//
+// Usage: KSArchiveBuilder <output.kspak> <file or directory>... [options]
+//   --align <bytes>      Alignment of every entry (power of two, default 16)
+//   --compress           Block compress entries that shrink enough
+//   --store <extension>  Never compress files with this extension (e.g. .png), can be repeated
+//   --block-size <bytes> Size of independently compressed blocks (default 65536)
+
+#include <fileio/AssetArchive.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+void PrintUsage()
+{
+    std::cerr << "Usage: KSArchiveBuilder <output.kspak> <file or directory>... "
+                 "[--align <bytes>] [--compress] [--store <extension>] [--block-size <bytes>]\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    KS::AssetArchiveWriteSettings settings {};
+    std::filesystem::path output {};
+    std::vector<std::filesystem::path> inputs {};
+    std::vector<std::string> stored_extensions {};
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--align" && i + 1 < argc)
+            settings.alignment = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--block-size" && i + 1 < argc)
+            settings.block_size = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--store" && i + 1 < argc)
+            stored_extensions.emplace_back(argv[++i]);
+        else if (arg == "--compress")
+            settings.compress = true;
+        else if (arg.starts_with("--"))
+        {
+            PrintUsage();
+            return 1;
+        }
+        else if (output.empty())
+            output = arg;
+        else
+            inputs.emplace_back(arg);
+    }
+
+    if (settings.alignment == 0 || (settings.alignment & (settings.alignment - 1)) != 0 || settings.block_size == 0 || inputs.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    KS::AssetArchiveWriter writer { settings };
+
+    auto AddFile = [&](const std::filesystem::path& file)
+    {
+        KS::AssetArchiveFileOptions options {};
+        auto extension = file.extension().string();
+
+        if (std::find(stored_extensions.begin(), stored_extensions.end(), extension) != stored_extensions.end())
+            options.compress = false;
+
+        if (!writer.AddFile(file, {}, options))
+            std::cerr << "Skipped " << file.string() << "\n";
+    };
+
+    for (const auto& input : inputs)
+    {
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto& it : std::filesystem::recursive_directory_iterator(input))
+            {
+                if (it.is_regular_file())
+                    AddFile(it.path());
+            }
+        }
+        else
+        {
+            AddFile(input);
+        }
+    }
+
+    if (!writer.Write(output))
+    {
+        std::cerr << "Failed to write archive " << output.string() << "\n";
+        return 1;
+    }
+
+    // Report what ended up in the archive
+    if (auto archive = KS::AssetArchive::Open(output))
+    {
+        uint64_t original = 0, stored = 0;
+        for (const auto& entry : archive->GetEntries())
+        {
+            original += entry.original_size;
+            stored += entry.stored_size;
+        }
+
+        std::cout << "Packed " << archive->GetEntries().size() << " files into " << output.string() << " ("
+                  << original << " bytes -> " << stored << " bytes)\n";
+        return 0;
+    }
+
+    std::cerr << "Written archive " << output.string() << " failed validation\n";
+    return 1;
+}
@@ -0,0 +1,490 @@
+// Headless asset cooker, imports every source model in a tree that changed since the last cook
+//
+// Usage: KSAssetCooker <source directory> [options]
+//   --jobs <count>       Models imported in parallel (default: hardware threads)
+//   --force              Cook everything, ignoring the manifest
+//   --dry-run            Only report what is stale
+//   --graph              Print the dependency graph
+//   --manifest <path>    Cook state (default: <source directory>/.kscook.json)
+//   --report <path>      Write per asset build times and memory use as JSON
+//
+// Every source model is a node in the graph. Its inputs are the source file and the files it references
+// (.gltf buffers and images, .obj material libraries and their maps). Its outputs are the imported model
+// (which holds the materials), the meshes and the textures. A node is stale if any input or output
+// changed since it was last cooked, or if the import settings changed.
+//
+// Outputs go to a folder named after the source next to it. Sources in one directory that only differ in their
+// extension get the extension in their folder name as well, so parallel cooks don't write over each other.
+
+#include <fileio/FileIO.hpp>
+#include <resources/Model.hpp>
+#include <tools/MemoryTracker.hpp>
+#include <tools/Timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+
+// Bump whenever the importer output changes, so everything is cooked again
+constexpr uint32_t IMPORTER_VERSION = 1;
+
+const std::vector<std::string> MODEL_EXTENSIONS = { ".glb", ".gltf", ".fbx", ".obj" };
+
+struct FileStamp
+{
+    std::string path {};
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t hash = 0;
+
+    template <typename A>
+    void serialize(A& ar)
+    {
+        ar(cereal::make_nvp("Path", path));
+        ar(cereal::make_nvp("Size", size));
+        ar(cereal::make_nvp("Time", time));
+        ar(cereal::make_nvp("Hash", hash));
+    }
+};
+
+struct CookRecord
+{
+    std::vector<FileStamp> inputs {};
+    std::vector<FileStamp> outputs {};
+    uint32_t post_process_flags = 0;
+    uint32_t importer_version = 0;
+    float milliseconds = 0.0f;
+
+    template <typename A>
+    void serialize(A& ar)
+    {
+        ar(cereal::make_nvp("Inputs", inputs));
+        ar(cereal::make_nvp("Outputs", outputs));
+        ar(cereal::make_nvp("PostProcessFlags", post_process_flags));
+        ar(cereal::make_nvp("ImporterVersion", importer_version));
+        ar(cereal::make_nvp("Milliseconds", milliseconds));
+    }
+};
+
+using Manifest = std::map<std::string, CookRecord>;
+
+struct CookNode
+{
+    std::filesystem::path source {};
+    std::filesystem::path output_dir {};
+    std::vector<std::filesystem::path> inputs {};
+    const CookRecord* previous {};
+    std::string stale_reason {};
+
+    CookRecord result {};
+    bool failed = false;
+};
+
+struct Options
+{
+    std::filesystem::path source_dir {};
+    std::filesystem::path manifest {};
+    std::filesystem::path report {};
+    uint32_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    bool force = false;
+    bool dry_run = false;
+    bool print_graph = false;
+};
+
+std::string Key(const std::filesystem::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+// Size and modification time are checked first, the hash is only computed when those differ
+std::optional<FileStamp> MakeStamp(const std::filesystem::path& path, const FileStamp* previous = nullptr)
+{
+    std::error_code e {};
+    FileStamp stamp {};
+    stamp.path = Key(path);
+    stamp.size = std::filesystem::file_size(path, e);
+    stamp.time = std::filesystem::last_write_time(path, e).time_since_epoch().count();
+
+    if (e)
+        return std::nullopt;
+
+    if (previous && previous->size == stamp.size && previous->time == stamp.time)
+    {
+        stamp.hash = previous->hash;
+        return stamp;
+    }
+
+    if (auto hash = KS::FileIO::HashFile(path))
+    {
+        stamp.hash = hash.value();
+        return stamp;
+    }
+    return std::nullopt;
+}
+
+bool IsUnchanged(const FileStamp& previous)
+{
+    auto current = MakeStamp(previous.path, &previous);
+    return current && current->hash == previous.hash;
+}
+
+// Files a source model references, which have to be tracked as well
+std::vector<std::filesystem::path> FindInputs(const std::filesystem::path& source)
+{
+    std::vector<std::filesystem::path> inputs { source };
+    auto directory = source.parent_path();
+    auto extension = source.extension().string();
+
+    auto ReadText = [](const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        std::stringstream text {};
+        text << file.rdbuf();
+        return text.str();
+    };
+
+    if (extension == ".gltf")
+    {
+        static const std::regex uri_pattern { R"re("uri"\s*:\s*"([^"]+)")re" };
+        auto text = ReadText(source);
+
+        for (auto it = std::sregex_iterator(text.begin(), text.end(), uri_pattern); it != std::sregex_iterator(); ++it)
+        {
+            auto uri = (*it)[1].str();
+            if (!uri.starts_with("data:"))
+                inputs.emplace_back(directory / uri);
+        }
+    }
+    else if (extension == ".obj")
+    {
+        std::istringstream lines { ReadText(source) };
+        std::string line {};
+
+        while (std::getline(lines, line))
+        {
+            if (!line.starts_with("mtllib "))
+                continue;
+
+            auto library = directory / line.substr(7);
+            inputs.emplace_back(library);
+
+            // Texture maps are the last token of map_ lines
+            std::istringstream material_lines { ReadText(library) };
+            std::string material_line {};
+
+            while (std::getline(material_lines, material_line))
+            {
+                if (material_line.starts_with("map_") || material_line.starts_with("bump ") || material_line.starts_with("norm "))
+                    inputs.emplace_back(directory / material_line.substr(material_line.find_last_of(' ') + 1));
+            }
+        }
+    }
+
+    return inputs;
+}
+
+std::string FindStaleReason(const CookNode& node, uint32_t post_process_flags)
+{
+    const auto* previous = node.previous;
+
+    if (!previous)
+        return "never cooked";
+
+    if (previous->importer_version != IMPORTER_VERSION || previous->post_process_flags != post_process_flags)
+        return "import settings changed";
+
+    // The imported model is always the first output
+    auto model_output = Key(node.output_dir / (node.source.stem().string() + ".json"));
+    if (previous->outputs.empty() || previous->outputs.front().path != model_output)
+        return "output folder changed";
+
+    if (previous->inputs.size() != node.inputs.size())
+        return "inputs changed";
+
+    for (size_t i = 0; i < node.inputs.size(); i++)
+    {
+        if (previous->inputs[i].path != Key(node.inputs[i]) || !IsUnchanged(previous->inputs[i]))
+            return "input changed: " + Key(node.inputs[i]);
+    }
+
+    for (const auto& output : previous->outputs)
+    {
+        if (!IsUnchanged(output))
+            return "output changed or missing: " + output.path;
+    }
+
+    return {};
+}
+
+void Cook(CookNode& node, uint32_t post_process_flags)
+{
+    KS::Timer timer {};
+
+    auto model = KS::ModelImporter::ImportFromFile(node.source, post_process_flags, node.output_dir);
+    auto files = model ? KS::ModelImporter::ListImportedFiles(model.value()) : std::nullopt;
+
+    if (!files)
+    {
+        node.failed = true;
+        return;
+    }
+
+    std::vector<std::string> outputs { files->model.path };
+    for (const auto& mesh : files->meshes)
+        outputs.emplace_back(mesh.path);
+    for (const auto& texture : files->textures)
+        outputs.emplace_back(texture.path);
+
+    for (const auto& output : outputs)
+    {
+        if (auto stamp = MakeStamp(output))
+            node.result.outputs.emplace_back(stamp.value());
+    }
+
+    for (const auto& input : node.inputs)
+    {
+        if (auto stamp = MakeStamp(input))
+            node.result.inputs.emplace_back(stamp.value());
+    }
+
+    // A missing input makes the node stale every time, which is what should happen
+    node.failed = node.result.inputs.size() != node.inputs.size();
+    node.result.post_process_flags = post_process_flags;
+    node.result.importer_version = IMPORTER_VERSION;
+    node.result.milliseconds = timer.TimePassed().count();
+}
+
+// Longest jobs (by their previous cook time) go first, so one slow model does not end up last
+void CookParallel(std::vector<CookNode*>& stale, uint32_t jobs, uint32_t post_process_flags)
+{
+    std::stable_sort(stale.begin(), stale.end(),
+        [](const CookNode* a, const CookNode* b)
+        {
+            float time_a = a->previous ? a->previous->milliseconds : 0.0f;
+            float time_b = b->previous ? b->previous->milliseconds : 0.0f;
+            return time_a > time_b;
+        });
+
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> workers {};
+
+    for (uint32_t i = 0; i < std::min<size_t>(jobs, stale.size()); i++)
+    {
+        workers.emplace_back(
+            [&]()
+            {
+                for (size_t index = next++; index < stale.size(); index = next++)
+                    Cook(*stale[index], post_process_flags);
+            });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void PrintGraph(const std::vector<CookNode>& nodes)
+{
+    for (const auto& node : nodes)
+    {
+        std::cout << Key(node.source) << (node.stale_reason.empty() ? "" : "  [stale: " + node.stale_reason + "]") << "\n";
+
+        for (size_t i = 1; i < node.inputs.size(); i++)
+            std::cout << "  <- " << Key(node.inputs[i]) << "\n";
+
+        if (node.previous)
+        {
+            for (const auto& output : node.previous->outputs)
+                std::cout << "  -> " << output.path << "\n";
+        }
+    }
+}
+
+void PrintUsage()
+{
+    std::cerr << "Usage: KSAssetCooker <source directory> [--jobs <count>] [--force] [--dry-run] [--graph] "
+                 "[--manifest <path>] [--report <path>]\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options {};
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--jobs" && i + 1 < argc)
+            options.jobs = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--manifest" && i + 1 < argc)
+            options.manifest = argv[++i];
+        else if (arg == "--report" && i + 1 < argc)
+            options.report = argv[++i];
+        else if (arg == "--force")
+            options.force = true;
+        else if (arg == "--dry-run")
+            options.dry_run = true;
+        else if (arg == "--graph")
+            options.print_graph = true;
+        else if (arg.starts_with("--") || !options.source_dir.empty())
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+            options.source_dir = arg;
+    }
+
+    if (!std::filesystem::is_directory(options.source_dir))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (options.manifest.empty())
+        options.manifest = options.source_dir / ".kscook.json";
+
+    const uint32_t post_process_flags = KS::ModelImporter::DEFAULT_POST_PROCESSING_FLAGS;
+
+    Manifest manifest {};
+    if (auto stream = KS::FileIO::OpenReadStream(options.manifest); stream && !options.force)
+    {
+        try
+        {
+            KS::JSONLoader json { stream.value() };
+            json(cereal::make_nvp("Assets", manifest));
+        }
+        catch (const cereal::Exception&)
+        {
+            std::cerr << "Ignoring unreadable manifest " << options.manifest.string() << "\n";
+            manifest.clear();
+        }
+    }
+
+    // Build the graph
+    std::vector<CookNode> nodes {};
+
+    for (const auto& it : std::filesystem::recursive_directory_iterator(options.source_dir))
+    {
+        auto extension = it.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (it.is_regular_file() && std::find(MODEL_EXTENSIONS.begin(), MODEL_EXTENSIONS.end(), extension) != MODEL_EXTENSIONS.end())
+        {
+            CookNode node {};
+            node.source = it.path();
+            node.inputs = FindInputs(it.path());
+
+            if (auto record = manifest.find(Key(it.path())); record != manifest.end())
+                node.previous = &record->second;
+
+            nodes.emplace_back(std::move(node));
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const CookNode& a, const CookNode& b) { return a.source < b.source; });
+
+    std::map<std::filesystem::path, uint32_t> stem_counts {};
+    for (const auto& node : nodes)
+        stem_counts[node.source.parent_path() / node.source.stem()]++;
+
+    for (auto& node : nodes)
+    {
+        auto output_dir = node.source.parent_path() / node.source.stem();
+        if (stem_counts[output_dir] > 1)
+            output_dir += "_" + node.source.extension().string().substr(1);
+        node.output_dir = output_dir;
+    }
+
+    std::vector<CookNode*> stale {};
+    for (auto& node : nodes)
+    {
+        node.stale_reason = FindStaleReason(node, post_process_flags);
+        if (!node.stale_reason.empty())
+            stale.emplace_back(&node);
+    }
+
+    if (options.print_graph)
+        PrintGraph(nodes);
+
+    std::cout << nodes.size() << " source models, " << stale.size() << " stale\n";
+
+    if (options.dry_run)
+    {
+        for (const auto* node : stale)
+            std::cout << "  " << Key(node->source) << ": " << node->stale_reason << "\n";
+        return 0;
+    }
+
+    KS::Timer total_timer {};
+    CookParallel(stale, options.jobs, post_process_flags);
+    float total = total_timer.TimePassed().count();
+
+    // Sources that disappeared are dropped, failed ones are left out so they are retried next time
+    Manifest updated {};
+    size_t failures = 0;
+
+    for (const auto& node : nodes)
+    {
+        if (node.stale_reason.empty())
+            updated[Key(node.source)] = *node.previous;
+        else if (!node.failed)
+            updated[Key(node.source)] = node.result;
+        else
+            failures++;
+    }
+
+    auto write_manifest = [&](std::ostream& out)
+    {
+        KS::JSONSaver json { out };
+        json(cereal::make_nvp("Assets", updated));
+    };
+
+    if (!KS::FileIO::WriteFileAtomic(options.manifest, write_manifest, std::ios::out | std::ios::trunc))
+        std::cerr << "Failed to write manifest " << options.manifest.string() << "\n";
+
+    // Timings, slowest first
+    std::vector<const CookNode*> cooked { stale.begin(), stale.end() };
+    std::sort(cooked.begin(), cooked.end(),
+        [](const CookNode* a, const CookNode* b) { return a->result.milliseconds > b->result.milliseconds; });
+
+    for (const auto* node : cooked)
+    {
+        std::cout << std::setw(10) << std::fixed << std::setprecision(1) << node->result.milliseconds << " ms  "
+                  << (node->failed ? "FAILED " : "") << Key(node->source) << "\n";
+    }
+
+    std::cout << "Cooked " << stale.size() - failures << " of " << stale.size() << " stale models in " << std::fixed
+              << std::setprecision(1) << total << " ms using " << options.jobs << " jobs\n";
+
+    if (!options.report.empty())
+    {
+        auto write_report = [&](std::ostream& out)
+        {
+            KS::JSONSaver json { out };
+            json(cereal::make_nvp("TotalMilliseconds", total));
+            json(cereal::make_nvp("Jobs", options.jobs));
+
+            std::map<std::string, float> timings {};
+            for (const auto* node : cooked)
+                timings[Key(node->source)] = node->failed ? -1.0f : node->result.milliseconds;
+
+            json(cereal::make_nvp("Assets", timings));
+            json(cereal::make_nvp("Memory", KS::MemoryTracker::TakeSnapshot()));
+        };
+
+        KS::FileIO::WriteFileAtomic(options.report, write_report, std::ios::out | std::ios::trunc);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+# Cooks a small source tree with KSAssetCooker. Cooking again has to skip the unchanged model,
+# and editing the material library the model references has to make it stale again.
+#
+# Usage: cmake -DCOOKER=<KSAssetCooker> -DWORK_DIR=<scratch directory> -P AssetCookerTest.cmake
+
+if(NOT COOKER OR NOT WORK_DIR)
+    message(FATAL_ERROR "COOKER and WORK_DIR are required")
+endif()
+
+set(SOURCE_DIR ${WORK_DIR}/source)
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${SOURCE_DIR})
+
+file(WRITE ${SOURCE_DIR}/triangle.obj
+    "mtllib triangle.mtl\n"
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+    "vt 0 0\nvt 1 0\nvt 0 1\n"
+    "vn 0 0 1\n"
+    "usemtl flat\n"
+    "f 1/1/1 2/2/1 3/3/1\n")
+
+file(WRITE ${SOURCE_DIR}/triangle.mtl "newmtl flat\nKd 1 0 0\n")
+
+# Runs the cooker and fails unless its output matches every given regex
+function(cook arguments)
+    execute_process(COMMAND ${COOKER} ${SOURCE_DIR} --jobs 1 ${arguments}
+        OUTPUT_VARIABLE output ERROR_VARIABLE output RESULT_VARIABLE result)
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "KSAssetCooker ${arguments} failed (${result}):\n${output}")
+    endif()
+
+    foreach(expected ${ARGN})
+        if(NOT output MATCHES "${expected}")
+            message(FATAL_ERROR "KSAssetCooker ${arguments}: expected '${expected}' in:\n${output}")
+        endif()
+    endforeach()
+endfunction()
+
+cook("" "1 source models, 1 stale" "Cooked 1 of 1 stale models")
+
+if(NOT EXISTS ${SOURCE_DIR}/triangle/triangle.json OR NOT EXISTS ${SOURCE_DIR}/.kscook.json)
+    message(FATAL_ERROR "KSAssetCooker did not write the model or its manifest")
+endif()
+
+cook("" "1 source models, 0 stale" "Cooked 0 of 0 stale models")
+
+# The size changes too, modification times can be equal within the file system's resolution
+file(APPEND ${SOURCE_DIR}/triangle.mtl "Ks 0 0 0\n")
+
+cook("--dry-run" "1 source models, 1 stale" "input changed: [^\n]*triangle\\.mtl")
+cook("" "1 source models, 1 stale" "Cooked 1 of 1 stale models")
+cook("" "1 source models, 0 stale")
+
+file(REMOVE_RECURSE ${WORK_DIR})
@@ -0,0 +1,132 @@
+// Replays a frame capture on the null device, so the CPU side of the same frames can be compared between builds
+//
+// Usage: KSFrameReplay <capture file> [--timings <file>]
+//   Captures are made with KEngine --capture <file>, run from the directory the assets were loaded from.
+//   Timings are written as JSON, per stage percentiles in milliseconds (default replay_timings.json)
+//
+// The scene calls and frame times are replayed through the fixed step simulation, snapshot extraction, Scene::Tick
+// and the model renderer's draw recording and submission. Systems the application adds are not part of a capture.
+
+#include <device/Device.hpp>
+#include <ecs/EntityComponentSystem.hpp>
+#include <fileio/FileIO.hpp>
+#include <renderer/CommandPackets.hpp>
+#include <renderer/ModelRenderer.hpp>
+#include <renderer/Shader.hpp>
+#include <resources/Model.hpp>
+#include <scene/Scene.hpp>
+#include <tools/FrameCapture.hpp>
+#include <tools/Timer.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+void PrintUsage()
+{
+    std::cerr << "Usage: KSFrameReplay <capture file> [--timings <file>]\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string capture_path = argv[1];
+    std::string timings_path = "replay_timings.json";
+
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--timings" && i + 1 < argc)
+        {
+            timings_path = argv[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    auto capture = KS::FrameCapture::Load(capture_path);
+    if (!capture)
+        return 1;
+
+    // Same lookup order as the application
+    if (KS::FileIO::Exists("assets.kspak"))
+        KS::FileIO::MountArchive("assets.kspak");
+
+    KS::Device device { KS::DeviceInitParams {} };
+    KS::EntityComponentSystem ecs {};
+    KS::Scene scene { device, ecs.GetWorld() };
+    KS::CommandRecorder recorder { 0 };
+    KS::DeviceCommandTranslator translator { device };
+    KS::RenderSnapshot snapshot {};
+
+    // The main pass's vertex inputs, the shader input descs only matter to a real pipeline
+    KS::ModelRenderer::DrawInputs draw_inputs {};
+    draw_inputs.meshInputFlags = KS::Shader::HAS_POSITIONS | KS::Shader::HAS_NORMALS | KS::Shader::HAS_UVS | KS::Shader::HAS_TANGENTS;
+
+    // The setup frame loads everything, it is not timed
+    const auto& frames = capture->GetFrames();
+    scene.Replay(device, frames[0]);
+    device.NewFrame();
+    scene.ExtractSnapshot(snapshot, 1.0f);
+    scene.Tick(device, snapshot);
+    device.EndFrame();
+
+    KS::StageTimings timings {};
+    KS::Timer frametimer {}, stagetimer {};
+
+    for (size_t i = 1; i < frames.size(); i++)
+    {
+        frametimer.Reset();
+        stagetimer.Reset();
+
+        device.NewFrame();
+        scene.Replay(device, frames[i]);
+        float alpha = ecs.Update(frames[i].dt);
+        timings.Add("update", stagetimer.Tick().count());
+
+        scene.ExtractSnapshot(snapshot, alpha);
+        timings.Add("extract", stagetimer.Tick().count());
+
+        scene.Tick(device, snapshot);
+        timings.Add("scene tick", stagetimer.Tick().count());
+
+        KS::ModelRenderer::RecordDraws(recorder, scene, draw_inputs);
+        recorder.Submit(translator);
+        timings.Add("record + submit", stagetimer.Tick().count());
+
+        device.EndFrame();
+        timings.Add("end frame", stagetimer.Tick().count());
+        timings.Add("frame", frametimer.TimePassed().count());
+    }
+
+    std::cout << frames.size() - 1 << " frames, " << scene.GetModelCount() << " draws in the last one\n";
+    for (const char* stage : { "update", "extract", "scene tick", "record + submit", "end frame", "frame" })
+    {
+        auto summary = timings.Summarize(stage);
+        std::cout << std::left << std::setw(18) << stage << std::right << std::fixed << std::setprecision(3)
+                  << "p50 " << summary.p50 << " ms  p90 " << summary.p90 << " ms  p99 " << summary.p99 << " ms  max "
+                  << summary.max << " ms\n";
+    }
+
+    if (!timings.WriteJSON(timings_path))
+    {
+        std::cerr << "Could not write " << timings_path << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Runs the engine self tests, registered with ctest
+//
+// Usage: KSTests [test name]
+//   Without a name all tests run, the exit code is the number of failed tests
+
+#include <containers/BlockingQueue.hpp>
+#include <containers/ByteBuffer.hpp>
+#include <containers/FlatHashMap.hpp>
+#include <containers/LinearArena.hpp>
+#include <containers/SlotMap.hpp>
+#include <ecs/FixedTimestep.hpp>
+#include <ecs/SystemScheduler.hpp>
+#include <ecs/WorldSnapshot.hpp>
+#include <fileio/AssetArchive.hpp>
+#include <fileio/AsyncFileReader.hpp>
+#include <fileio/Compression.hpp>
+#include <fileio/FileWatcher.hpp>
+#include <fileio/MappedFile.hpp>
+#include <math/DynamicAABBTree.hpp>
+#include <math/Geometry.hpp>
+#include <renderer/CommandPackets.hpp>
+#include <resources/Material.hpp>
+#include <resources/Mesh.hpp>
+#include <resources/Model.hpp>
+#include <scene/Scene.hpp>
+#include <tools/AllocationCounter.hpp>
+#include <tools/FrameCapture.hpp>
+#include <tools/FramePipeline.hpp>
+#include <tools/MemoryTracker.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace
+{
+
+struct Test
+{
+    const char* name;
+    void (*function)();
+};
+
+const Test TESTS[] = {
+    { "SlotMap", &KS::Tests::TestSlotMap },
+    { "ByteBuffer", &KS::Tests::TestByteBuffer },
+    { "LinearArena", &KS::Tests::TestLinearArena },
+    { "FlatHashMap", &KS::Tests::TestFlatHashMap },
+    { "Compression", &KS::Tests::TestCompression },
+    { "AssetArchive", &KS::Tests::TestAssetArchive },
+    { "AsyncFileReader", &KS::Tests::TestAsyncFileReader },
+    { "MappedFile", &KS::Tests::TestMappedFile },
+    { "FileWatcher", &KS::Tests::TestFileWatcher },
+    { "SPSCQueue", &KS::Tests::TestSPSCQueue },
+    { "MPMCQueue", &KS::Tests::TestMPMCQueue },
+    { "BlockingQueue", &KS::Tests::TestBlockingQueue },
+    { "SystemScheduler", &KS::Tests::TestSystemScheduler },
+    { "FixedTimestep", &KS::Tests::TestFixedTimestep },
+    { "WorldSnapshot", &KS::Tests::TestWorldSnapshot },
+    { "DynamicAABBTree", &KS::Tests::TestDynamicAABBTree },
+    { "BoundingBoxTransform", &KS::Tests::TestBoundingBoxTransform },
+    { "CommandPackets", &KS::Tests::TestCommandPackets },
+    { "HeadlessScene", &KS::Tests::TestHeadlessScene },
+    { "FramePipeline", &KS::Tests::TestFramePipeline },
+    { "FrameCapture", &KS::Tests::TestFrameCapture },
+    { "Material", &KS::Tests::TestMaterial },
+    { "MeshData", &KS::Tests::TestMeshData },
+    { "MemoryTracker", &KS::Tests::TestMemoryTracker },
+    { "AllocationCounter", &KS::Tests::TestAllocationCounter },
+    { "SteadyStateFrame", &KS::Tests::TestSteadyStateFrame },
+};
+
+bool RunTest(const Test& test)
+{
+    try
+    {
+        test.function();
+    }
+    catch (...)
+    {
+        std::cerr << "FAILED " << test.name << "\n";
+        return false;
+    }
+
+    std::cout << "passed " << test.name << "\n";
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // The tests fail with a bare throw, without an active exception that ends up in std::terminate instead of a catch
+    std::set_terminate([]()
+    {
+        std::cerr << "FAILED (terminated)\n";
+        std::_Exit(1);
+    });
+
+    int failed = 0;
+    bool found = false;
+
+    for (const auto& test : TESTS)
+    {
+        if (argc > 1 && std::strcmp(argv[1], test.name) != 0)
+            continue;
+
+        found = true;
+        failed += RunTest(test) ? 0 : 1;
+    }
+
+    if (!found)
+    {
+        std::cerr << "No test named " << argv[1] << "\n";
+        return 1;
+    }
+
+    return failed;
+}